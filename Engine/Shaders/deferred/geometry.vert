@@ -20,6 +20,9 @@ layout(location = 0) in vec3 position;
 layout(location = 1) in vec2 texcoord_0;
 layout(location = 2) in vec3 normal;
 
+// Per-instance model matrix, copies of a mesh are drawn with one instanced draw
+layout(location = 3) in mat4 instance_model;
+
 layout(set = 0, binding = 1) uniform GlobalUniform {
     mat4 model;
     mat4 view_proj;
@@ -32,11 +35,11 @@ layout (location = 2) out vec3 o_normal;
 
 void main(void)
 {
-    o_pos = global_uniform.model * vec4(position, 1.0);
+    o_pos = instance_model * vec4(position, 1.0);
 
     o_uv = texcoord_0;
 
-    o_normal = mat3(global_uniform.model) * normal;
+    o_normal = mat3(instance_model) * normal;
 
     gl_Position = global_uniform.view_proj * o_pos;
 }
@@ -20,6 +20,10 @@ public:
     void OnUIRender() override;
 
 private:
+    /// @brief Selects the nearest node with bounds under the point, in pixels from the top left of the image.
+    void PickNode(float x, float y);
+
+    std::vector<uint32_t> PickResults;
     std::vector<VkDescriptorSet> ViewportDescriptorSets;
     eventpp::CallbackList<void(const ImVec2& PortSize)> OnViewportChange;
     ImVec2 ViewportSize{0, 0};
@@ -22,6 +22,12 @@ void Editor::Initialize(Engine* RuntimeEngine)
     EditorManager = std::make_unique<EditorUIManager>(GRuntimeGlobalContext.renderSystem->GetDevice());
     EditorManager->Initialize();
     GEditorGlobalContext.Initialize({EditorManager.get()});
+
+    // The selection may be a node of a world that is no longer shown or about to be destroyed
+    GRuntimeGlobalContext.worldManager->OnWorldsChanged.append([](scene::Scene*)
+    {
+        GEditorGlobalContext.selectedNode = nullptr;
+    });
 }
 
 void Editor::Clear()
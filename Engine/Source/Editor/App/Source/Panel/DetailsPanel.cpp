@@ -1,12 +1,75 @@
 #include "Panel/DetailsPanel.hpp"
 
+#include <string>
+
 #include <imgui.h>
 
 #include "Engine/Asset/AssetRegistry.hpp"
 #include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Engine/SceneGraph/Components/Light.hpp"
+#include "Engine/SceneGraph/Components/PerspectiveCamera.hpp"
 #include "Engine/SceneGraph/Components/SubMesh.hpp"
+#include "Reflection/StaticRefl.hpp"
 #include "UIManage/EditorGlobalContext.hpp"
 
+namespace
+{
+    bool DrawField(const char* label, bool& value) { return ImGui::Checkbox(label, &value); }
+
+    bool DrawField(const char* label, int32_t& value) { return ImGui::DragInt(label, &value); }
+
+    bool DrawField(const char* label, uint32_t& value) { return ImGui::DragScalar(label, ImGuiDataType_U32, &value); }
+
+    bool DrawField(const char* label, float& value) { return ImGui::DragFloat(label, &value, 0.01f); }
+
+    bool DrawField(const char* label, glm::vec2& value) { return ImGui::DragFloat2(label, &value.x, 0.01f); }
+
+    bool DrawField(const char* label, glm::vec3& value) { return ImGui::DragFloat3(label, &value.x, 0.01f); }
+
+    bool DrawField(const char* label, glm::vec4& value) { return ImGui::DragFloat4(label, &value.x, 0.01f); }
+
+    /// Shown only, editing a string needs a resizing InputText the editor doesn't build
+    bool DrawField(const char* label, std::string& value)
+    {
+        ImGui::LabelText(label, "%s", value.c_str());
+        return false;
+    }
+
+    template <typename T, typename = void>
+    struct HasDrawField : std::false_type
+    {
+    };
+
+    template <typename T>
+    struct HasDrawField<T, std::void_t<decltype(DrawField("", std::declval<T&>()))>> : std::true_type
+    {
+    };
+
+    /// Draws a widget for every variable of the ReflInfo of T that has a DrawField, and a tree node for every
+    /// variable whose type has a ReflInfo of its own. Returns whether one changed.
+    template <typename T>
+    bool DrawReflectedFields(T& instance)
+    {
+        bool changed = false;
+        ForEachVariable(instance, [&changed](std::string_view name, auto& value)
+        {
+            using ValueType = std::decay_t<decltype(value)>;
+            if constexpr (HasDrawField<ValueType>::value)
+            {
+                changed |= DrawField(std::string(name).c_str(), value);
+            }
+            else if constexpr (HasReflInfo_Value<ValueType>)
+            {
+                if (ImGui::TreeNode(std::string(name).c_str()))
+                {
+                    changed |= DrawReflectedFields(value);
+                    ImGui::TreePop();
+                }
+            }
+        });
+        return changed;
+    }
+}
 
 DetailsPanel::DetailsPanel()
 {
@@ -40,11 +103,36 @@ void DetailsPanel::DisplaySelectedNode(scene::Node* node)
     auto& handles = node->GetComponentHandles();
     for (auto handle : handles)
     {
-        if (handle.type == rttr::type::get<scene::SubMesh>())
+        if (handle.type == scene::GetComponentTypeID<scene::Light>())
+        {
+            auto* light = scene->GetComponentManager()->GetComponent<scene::Light>(handle);
+            if (light && ImGui::CollapsingHeader("Light", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                scene::LightProperties properties = light->get_properties();
+                if (DrawReflectedFields(properties))
+                {
+                    light->set_properties(properties);
+                }
+            }
+        }
+        else if (handle.type == scene::GetComponentTypeID<scene::PerspectiveCamera>())
         {
-            auto* subMesh = scene->GetComponentManager()->GetComponentFormNode<scene::SubMesh>(node->GetID());
-            if (ImGui::CollapsingHeader("SubMesh", ImGuiTreeNodeFlags_DefaultOpen))
+            auto* camera = scene->GetComponentManager()->GetComponent<scene::PerspectiveCamera>(handle);
+            if (camera && ImGui::CollapsingHeader("Perspective Camera", ImGuiTreeNodeFlags_DefaultOpen))
             {
+                DrawReflectedFields(*camera);
+            }
+        }
+        else if (handle.type == scene::GetComponentTypeID<scene::SubMesh>())
+        {
+            auto* subMesh = scene->GetComponentManager()->GetComponent<scene::SubMesh>(handle);
+            if (subMesh && ImGui::CollapsingHeader("SubMesh", ImGuiTreeNodeFlags_DefaultOpen))
+            {
+                // What the submesh was imported from, changing it here wouldn't reload the mesh data
+                ImGui::BeginDisabled();
+                DrawReflectedFields(*subMesh);
+                ImGui::EndDisabled();
+
                 static int currentSelection = -1; // -1 表示“无选择”
                 auto options = AssetRegistry::Get().GetAllAssetsOfType(AssetType::Mesh);
 
@@ -80,7 +168,7 @@ void DetailsPanel::DisplaySelectedNode(scene::Node* node)
                     ImGui::EndCombo();
                 }
             }
-            if (subMesh->bHasMeshData)
+            if (subMesh && subMesh->bHasMeshData)
             {
             }
         }
@@ -101,6 +189,7 @@ void DetailsPanel::DrawComponentSelector(scene::Node* node)
         if (ImGui::MenuItem("SubMesh"))
         {
             scene->GetComponentManager()->AddComponent<::scene::SubMesh>(node);
+            scene->UpdateNodeBounds(*node);
         }
         if (ImGui::MenuItem("Camera"))
         {
@@ -16,11 +16,10 @@ HierarchyPanel::HierarchyPanel()
 
 void HierarchyPanel::OnUIRender()
 {
+    // Nodes can also be picked in the viewport
+    VisibleNode = GEditorGlobalContext.selectedNode;
     CreateTree();
-    if (VisibleNode)
-    {
-        GEditorGlobalContext.selectedNode = VisibleNode;
-    }
+    GEditorGlobalContext.selectedNode = VisibleNode;
 }
 
 void HierarchyPanel::DrawGameObjectNode(void* gameObject)
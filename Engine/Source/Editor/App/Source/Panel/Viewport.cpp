@@ -4,7 +4,13 @@
 #include "backends/imgui_impl_vulkan.h"
 #include "Framework/Core/Sampler.hpp"
 #include "Logging/Logger.hpp"
+#include "Memory/FrameAllocator.hpp"
 #include "Render/RenderSystem.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/SpatialIndex.hpp"
+#include "Engine/SceneGraph/Components/PerspectiveCamera.hpp"
+#include "UIManage/EditorGlobalContext.hpp"
+#include "World/WorldManager.hpp"
 
 
 ViewportPanel::ViewportPanel()
@@ -30,6 +36,11 @@ void ViewportPanel::OnUIRender()
     ImGui::SetNextWindowSize(ImVec2(500, 600), ImGuiCond_Once);
     ImGui::Begin("Viewport", nullptr, ImGuiWindowFlags_NoScrollbar | ImGuiWindowFlags_NoScrollWithMouse);
     ImGui::Text("Viewport fuck vulkan");
+
+    // Scratch memory of the last frame, heap blocks should drop to 0 once the arenas have grown
+    const FrameAllocator::FrameStats frameStats = FrameAllocator::GetLastFrameStats();
+    ImGui::Text("Frame arena: %zu allocations, %.1f KB, %zu heap blocks, %zu threads", frameStats.allocations,
+                frameStats.bytes / 1024.0, frameStats.heapAllocations, frameStats.threads);
     ImVec2 currentViewportSize = ImGui::GetContentRegionAvail();
 
     bool hasChanged = (std::abs(ViewportSize.x - currentViewportSize.x) > 2) ||
@@ -47,7 +58,42 @@ void ViewportPanel::OnUIRender()
     if (ViewportDescriptorSets[index] != nullptr)
     {
         ImGui::Image(ViewportDescriptorSets[index], ViewportSize);
+        if (ImGui::IsItemClicked(ImGuiMouseButton_Left))
+        {
+            const ImVec2 mouse = ImGui::GetMousePos();
+            const ImVec2 imageMin = ImGui::GetItemRectMin();
+            PickNode(mouse.x - imageMin.x, mouse.y - imageMin.y);
+        }
     }
 
     ImGui::End();
 }
+
+void ViewportPanel::PickNode(float x, float y)
+{
+    scene::Scene* world = GRuntimeGlobalContext.worldManager->GetActiveWorld();
+    scene::PerspectiveCamera* camera = GRuntimeGlobalContext.worldManager->GetViewportCamera();
+    if (!world || !camera || !camera->GetOwner() || ViewportSize.x <= 0.0f || ViewportSize.y <= 0.0f)
+    {
+        return;
+    }
+
+    // The image shows the projection without the Vulkan flip, so y points up in NDC
+    const glm::vec2 ndc(2.0f * x / ViewportSize.x - 1.0f, 1.0f - 2.0f * y / ViewportSize.y);
+    const glm::mat4 inverseViewProjection = glm::inverse(camera->GetProjection() * camera->GetView());
+    const glm::vec4 point = inverseViewProjection * glm::vec4(ndc, 0.5f, 1.0f);
+
+    scene::Ray ray;
+    ray.origin = glm::vec3(camera->GetOwner()->GetTransform().GetWorldMatrix()[3]);
+    ray.direction = glm::normalize(glm::vec3(point) / point.w - ray.origin);
+
+    scene::SpatialIndex& spatialIndex = world->GetSpatialIndex();
+    PickResults.clear();
+    spatialIndex.QueryRay(ray, camera->GetFarPlane(), PickResults);
+
+    // A miss keeps what was selected, in the hierarchy panel or by an earlier pick
+    if (!PickResults.empty())
+    {
+        GEditorGlobalContext.selectedNode = spatialIndex.GetNode(PickResults.front());
+    }
+}
@@ -7,6 +7,7 @@
 class WorldManager;
 class RenderSystem;
 class WindowSystem;
+class WorkStealingThreadPool;
 
 struct EngineInitParams;
 
@@ -20,6 +21,7 @@ public:
     void ShutdownSystems();
 
 public:
+    std::shared_ptr<WorkStealingThreadPool> threadPool;
     std::shared_ptr<WindowSystem> windowSystem;
     std::shared_ptr<RenderSystem> renderSystem;
     std::shared_ptr<WorldManager> worldManager;
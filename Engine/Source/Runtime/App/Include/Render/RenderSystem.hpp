@@ -31,6 +31,13 @@ struct ApplicationOptions
 {
     bool benchmark_enabled{false};
     vkb::Window* window{nullptr};
+    /// Record the geometry subpass into secondary command buffers on the thread pool, set by the
+    /// VKORA_THREADED_RECORDING CMake option
+#if defined(VKORA_THREADED_RECORDING)
+    bool threaded_recording{true};
+#else
+    bool threaded_recording{false};
+#endif
 };
 
 class RenderSystem
@@ -67,6 +74,12 @@ public:
     void SetApiVersion(uint32_t requested_api_version);
     void SetRenderContext(std::unique_ptr<vkb::RenderContext>&& rc);
     void SetRenderPipeline(std::unique_ptr<vkb::RenderPipeline>&& rp);
+
+    /**
+     * @brief Rebuilds the scene pipeline for the active world and its viewport camera, the subpasses keep
+     *        references into the world they were made for
+     */
+    void RebuildScenePipeline();
     /**
      * @brief Add a sample-specific device extension
      * @param extension The extension name
@@ -136,6 +149,11 @@ private: // -----------------Member
      */
     std::unique_ptr<vkb::RenderPipeline> render_pipeline;
 
+    /**
+     * @brief The camera the subpasses of render_pipeline refer to, its pool moves it when cameras come and go
+     */
+    scene::Camera* pipeline_camera = nullptr;
+
     //std::unique_ptr<EditorUIManager> EditorUI;
     std::unique_ptr<vkb::RenderPass> EditorUIRenderpass;
 
@@ -181,6 +199,9 @@ private: // -----------------Member
 
     std::unique_ptr<vkb::DebugUtils> debug_utils;
 
+    /** @brief Threads the geometry subpass records on, 1 records inline */
+    uint32_t recording_thread_count{1};
+
 public:
     vkb::Instance const& GetInstance() const { return *instance; }
     vkb::Instance& GetInstance() { return *instance; }
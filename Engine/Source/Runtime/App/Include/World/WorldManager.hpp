@@ -1,9 +1,14 @@
 #pragma once
+#include <future>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
+
+#include <eventpp/callbacklist.h>
 
 #include "Engine/SceneGraph/Scene.hpp"
+#include "Engine/SceneGraph/SceneSerializer.hpp"
 
 namespace scene
 {
@@ -17,19 +22,63 @@ public:
     ~WorldManager() = default;
 
     scene::Scene* CreateWorld(const std::string& name);
+    /// @brief Loads a scene file on the calling thread, replaces the world of the same name.
     bool LoadWorld(const std::string& name, const std::string& filePath);
+
+    /// @brief Loads a scene file on a background thread while the active world keeps ticking. The world is
+    ///        added by the first UpdateActiveWorld after it finished loading, and made active if asked to.
+    void LoadWorldAsync(const std::string& name, const std::string& filePath, bool activate = true);
+
+    /// @brief How loaded worlds find the models and materials of their submeshes. They are resolved on the
+    ///        thread that adds the world, before it is added.
+    void SetAssetResolver(scene::SceneSerializer::AssetResolver resolver);
+
+    bool IsLoading(const std::string& name) const;
     void SetActiveWorld(const std::string& name);
+    /// @brief The active world cannot be destroyed, activate another one first.
     void DestroyWorld(const std::string& name);
 
     scene::Scene* GetActiveWorld() { return activeWorld; }
+    /// @brief The camera of the active world, looked up again on every call since its pool moves it.
     scene::PerspectiveCamera* GetViewportCamera();
     scene::Scene* GetWorld(const std::string& name);
 
     void UpdateActiveWorld(float deltaTime);
 
+    /// Called with the active world when it changes or a world is about to be replaced or destroyed, while
+    /// the old world still exists. Whatever points into a world has to let go of it.
+    eventpp::CallbackList<void(scene::Scene* activeWorld)> OnWorldsChanged;
+
 private:
+    struct PendingWorld
+    {
+        std::string name;
+        bool activate;
+        std::future<std::unique_ptr<scene::Scene>> world;
+    };
+
+    /// Adds the worlds that finished loading, on the thread that updates them
+    void AddLoadedWorlds();
+
+    /// Gives the submeshes of a loaded world their GPU data back, when a resolver was set
+    void ResolveAssets(scene::Scene& world);
+
+    /// Replacing the active world activates the new one before the old one is destroyed
+    void AddWorld(const std::string& name, std::unique_ptr<scene::Scene> world);
+
+    /// Makes world active with its viewport camera and rebuilds the scene pipeline for it
+    void Activate(scene::Scene* world);
+
+    /// The node of the first perspective camera of the world, a new camera node when it has none
+    static scene::NodeID FindOrAddViewportCamera(scene::Scene& world);
+
     std::unordered_map<std::string, std::unique_ptr<scene::Scene>> worlds;
     scene::Scene* activeWorld = nullptr;
 
-    scene::PerspectiveCamera* ViewportCamera = nullptr;
+    /// The node of the viewport camera of every world
+    std::unordered_map<const scene::Scene*, scene::NodeID> viewportCameras;
+
+    std::vector<PendingWorld> pendingWorlds;
+
+    scene::SceneSerializer::AssetResolver assetResolver;
 };
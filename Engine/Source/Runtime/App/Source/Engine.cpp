@@ -9,6 +9,7 @@
 
 #include "Engine/Asset/AssetImporter.hpp"
 #include "Engine/Asset/AssetRegistry.hpp"
+#include "Memory/FrameAllocator.hpp"
 #include "Misc/Paths.hpp"
 #include "World/WorldManager.hpp"
 
@@ -132,6 +133,9 @@ void Engine::Run()
 
 bool Engine::TickOneFrame(float DeltaTime)
 {
+    // Scratch data of the last frame is dropped here, nothing of it is in use between two frames
+    FrameAllocator::BeginFrame();
+
     LogicalTick(DeltaTime);
     CalculateFPS(DeltaTime);
 
@@ -1,4 +1,8 @@
 #include "GlobalContext.hpp"
+
+#include <algorithm>
+
+#include "Async/WorkStealingThreadPool.hpp"
 #include "WindowSystem.hpp"
 #include "Render/RenderSystem.hpp"
 #include "Engine/SceneGraph/Scene.hpp"
@@ -10,6 +14,9 @@ RuntimeGlobalContext GRuntimeGlobalContext;
 
 void RuntimeGlobalContext::StartSystems(const std::string& config_file_path)
 {
+    // The main thread helps while it waits for the workers
+    threadPool = std::make_shared<WorkStealingThreadPool>(std::max(1u, std::thread::hardware_concurrency()) - 1);
+
     vkb::Window::Properties window_properties;
     window_properties.title = "VkoraEngine";
     windowSystem = std::make_shared<WindowSystem>(window_properties);
@@ -22,4 +29,5 @@ void RuntimeGlobalContext::ShutdownSystems()
     renderSystem.reset();
     worldManager.reset();
     windowSystem.reset();
+    threadPool.reset();
 }
@@ -1,6 +1,10 @@
 #include "Render/RenderSystem.hpp"
 
+#include <algorithm>
+#include <thread>
+
 #include "GlobalContext.hpp"
+#include "Async/WorkStealingThreadPool.hpp"
 #include "backends/imgui_impl_vulkan.h"
 #include "Engine/SceneGraph/Components/PerspectiveCamera.hpp"
 #include "Framework/Core/CommandBuffer.hpp"
@@ -16,6 +20,22 @@
 #include "Tools/Utils.hpp"
 #include "World/WorldManager.hpp"
 
+namespace
+{
+    /// The workers of the thread pool record the geometry subpass together with the main thread. The pool
+    /// keeps a worker even without a spare core, recording then stays inline on the main thread.
+    uint32_t GetRecordingThreadCount(bool threaded)
+    {
+        if (!threaded)
+        {
+            return 1;
+        }
+        const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+        const auto workers = static_cast<uint32_t>(GRuntimeGlobalContext.threadPool->GetWorkerCount());
+        return std::min(workers + 1, cores);
+    }
+}
+
 RenderSystem::~RenderSystem()
 {
     Finish();
@@ -38,6 +58,7 @@ bool RenderSystem::Prepare(const ApplicationOptions& options)
     LOG_INFO("Initializing vulkan render system!")
     assert(options.window != nullptr && "Window is invalid");
     window = options.window;
+    recording_thread_count = GetRecordingThreadCount(options.threaded_recording);
 
     // static vk::detail::DynamicLoader dl;
     // VULKAN_HPP_DEFAULT_DISPATCHER.init(dl.getProcAddress<PFN_vkGetInstanceProcAddr>("vkGetInstanceProcAddr"));
@@ -144,7 +165,8 @@ bool RenderSystem::Prepare(const ApplicationOptions& options)
     device = CreateDevice(gpu);
     // VULKAN_HPP_DEFAULT_DISPATCHER.init(device->GetHandle());
     CreateRenderContext();
-    render_context->prepare(1, vkb::RenderTarget::ONE_IMAGE_FUNC);
+    // Thread index 0 records the frame, the geometry subpass records its secondary command buffers from 1 on
+    render_context->prepare(recording_thread_count + 1, vkb::RenderTarget::ONE_IMAGE_FUNC);
 
     // stats = std::make_unique<vkb::stats::HPPStats>(*render_context);
 
@@ -154,8 +176,9 @@ bool RenderSystem::Prepare(const ApplicationOptions& options)
     std::set<VkImageUsageFlagBits> usage = {VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT};
     GetRenderContext().update_swapchain(usage);
 
+    pipeline_camera = GRuntimeGlobalContext.worldManager->GetViewportCamera();
     render_pipeline = CreateOneRenderpassTwoSubpasses(*GRuntimeGlobalContext.worldManager->GetActiveWorld()
-                                                      , *GRuntimeGlobalContext.worldManager->GetViewportCamera());
+                                                      , *pipeline_camera);
     return true;
 }
 
@@ -295,6 +318,12 @@ void RenderSystem::DrawRenderpass(vkb::CommandBuffer& command_buffer, vkb::Rende
 
 void RenderSystem::Update(float delta_time)
 {
+    // The subpasses hold on to the camera, they are built again once it moved
+    if (render_pipeline && GRuntimeGlobalContext.worldManager->GetViewportCamera() != pipeline_camera)
+    {
+        RebuildScenePipeline();
+    }
+
     // update_gui(delta_time);
     auto command_buffer = render_context->begin();
     UIManager->BeginFrame();
@@ -435,6 +464,26 @@ void RenderSystem::SetRenderPipeline(std::unique_ptr<vkb::RenderPipeline>&& rp)
     render_pipeline.reset(rp.release());
 }
 
+void RenderSystem::RebuildScenePipeline()
+{
+    if (!render_pipeline)
+    {
+        return;
+    }
+
+    // The frames in flight still record from the old world
+    Finish();
+
+    auto* camera = GRuntimeGlobalContext.worldManager->GetViewportCamera();
+    if (!ViewportRTs.empty())
+    {
+        const VkExtent2D& extent = ViewportRTs[0]->get_extent();
+        camera->SetAspectRatio(static_cast<float>(extent.width) / static_cast<float>(extent.height));
+    }
+    pipeline_camera = camera;
+    render_pipeline = CreateOneRenderpassTwoSubpasses(*GRuntimeGlobalContext.worldManager->GetActiveWorld(), *camera);
+}
+
 void RenderSystem::AddDeviceExtension(const char* extension, bool optional)
 {
     device_extensions[extension] = optional;
@@ -497,6 +546,8 @@ std::unique_ptr<vkb::RenderPipeline> RenderSystem::CreateOneRenderpassTwoSubpass
 
     // Outputs are depth, albedo, and normal
     scene_subpass->set_output_attachments({1, 2, 3});
+    scene_subpass->set_thread_pool(GRuntimeGlobalContext.threadPool.get());
+    scene_subpass->set_recording_thread_count(recording_thread_count);
 
     // Lighting subpass
     auto lighting_vs = vkb::ShaderSource{Paths::GetShaderFullPath("deferred/lighting.vert.spv")};
@@ -1,39 +1,85 @@
 #include "World/WorldManager.hpp"
 
+#include <algorithm>
+#include <chrono>
+
+#include "Async/WorkStealingThreadPool.hpp"
 #include "Engine/SceneGraph/Scene.hpp"
 #include "Logging/Logger.hpp"
 #include "Engine/SceneGraph/ComponentPool.hpp"
 #include "Engine/SceneGraph/Components/PerspectiveCamera.hpp"
+#include "Engine/SceneGraph/SceneSerializer.hpp"
+#include "GlobalContext.hpp"
+#include "Render/RenderSystem.hpp"
 
 scene::Scene* WorldManager::CreateWorld(const std::string& name)
 {
     auto world = std::make_unique<scene::Scene>(name);
+    scene::Scene* created = world.get();
 
-    auto cameraNode = std::make_unique<scene::Node>(world.get(), "DefaultCamera");
-    ViewportCamera = world->GetComponentManager()->AddComponent<scene::PerspectiveCamera>(cameraNode.get());
+    AddWorld(name, std::move(world));
+    Activate(created);
+    return created;
+}
 
-    world->AddNode(std::move(cameraNode));
+bool WorldManager::LoadWorld(const std::string& name, const std::string& filePath)
+{
+    auto world = scene::SceneSerializer::Load(filePath, name);
+    if (!world)
+    {
+        return false;
+    }
 
-    activeWorld = world.get();
+    ResolveAssets(*world);
+    AddWorld(name, std::move(world));
+    return true;
+}
 
-    worlds[name] = std::move(world);
-    return worlds[name].get();
+void WorldManager::LoadWorldAsync(const std::string& name, const std::string& filePath, bool activate)
+{
+    // A thread of its own, a load on the shared pool would hold up the systems of the active world
+    pendingWorlds.push_back({name, activate, std::async(std::launch::async, [name, filePath]()
+    {
+        return scene::SceneSerializer::Load(filePath, name);
+    })});
 }
 
-bool WorldManager::LoadWorld(const std::string& name, const std::string& filePath)
+void WorldManager::SetAssetResolver(scene::SceneSerializer::AssetResolver resolver)
+{
+    assetResolver = std::move(resolver);
+}
+
+bool WorldManager::IsLoading(const std::string& name) const
 {
-    return false;
+    return std::any_of(pendingWorlds.begin(), pendingWorlds.end(),
+                       [&name](const PendingWorld& pending) { return pending.name == name; });
 }
 
 void WorldManager::SetActiveWorld(const std::string& name)
 {
-    activeWorld = GetWorld(name);
+    scene::Scene* world = GetWorld(name);
+    if (!world)
+    {
+        LOG_WARN("World not found: {} ", name)
+        return;
+    }
+    Activate(world);
 }
 
 void WorldManager::DestroyWorld(const std::string& name)
 {
-    if (worlds.erase(name))
+    auto it = worlds.find(name);
+    if (it != worlds.end() && it->second.get() == activeWorld)
     {
+        LOG_WARN("Cannot destroy the active world: {} ", name)
+        return;
+    }
+
+    if (it != worlds.end())
+    {
+        OnWorldsChanged(activeWorld);
+        viewportCameras.erase(it->second.get());
+        worlds.erase(it);
         LOG_INFO("World destroyed: {} ", name)
     }
     else
@@ -44,7 +90,21 @@ void WorldManager::DestroyWorld(const std::string& name)
 
 scene::PerspectiveCamera* WorldManager::GetViewportCamera()
 {
-    return ViewportCamera;
+    if (!activeWorld)
+    {
+        return nullptr;
+    }
+
+    scene::ComponentManager& manager = *activeWorld->GetComponentManager();
+    scene::NodeID& cameraNode = viewportCameras[activeWorld];
+    auto* camera = manager.GetComponentFormNode<scene::PerspectiveCamera>(cameraNode);
+    if (!camera)
+    {
+        // The camera was removed, the world gets another one
+        cameraNode = FindOrAddViewportCamera(*activeWorld);
+        camera = manager.GetComponentFormNode<scene::PerspectiveCamera>(cameraNode);
+    }
+    return camera;
 }
 
 scene::Scene* WorldManager::GetWorld(const std::string& name)
@@ -55,8 +115,109 @@ scene::Scene* WorldManager::GetWorld(const std::string& name)
 
 void WorldManager::UpdateActiveWorld(float deltaTime)
 {
+    AddLoadedWorlds();
+
     if (activeWorld)
     {
-        //activeWorld->Update(deltaTime);
+        activeWorld->Update(deltaTime, GRuntimeGlobalContext.threadPool.get());
     }
 }
+
+void WorldManager::AddLoadedWorlds()
+{
+    for (auto it = pendingWorlds.begin(); it != pendingWorlds.end();)
+    {
+        if (it->world.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++it;
+            continue;
+        }
+
+        auto world = it->world.get();
+        if (world)
+        {
+            LOG_INFO("World loaded: {} ", it->name)
+            scene::Scene* loaded = world.get();
+            ResolveAssets(*loaded);
+            AddWorld(it->name, std::move(world));
+            if (it->activate && activeWorld != loaded)
+            {
+                Activate(loaded);
+            }
+        }
+        else
+        {
+            LOG_ERROR("Failed to load world: {} ", it->name)
+        }
+        it = pendingWorlds.erase(it);
+    }
+}
+
+void WorldManager::ResolveAssets(scene::Scene& world)
+{
+    if (!assetResolver.findSubMesh)
+    {
+        return;
+    }
+
+    const size_t missing = scene::SceneSerializer::ResolveSubMeshes(world, assetResolver);
+    if (missing > 0)
+    {
+        LOG_WARN("World {} has {} submeshes whose model isn't loaded", world.GetName(), missing)
+    }
+}
+
+void WorldManager::AddWorld(const std::string& name, std::unique_ptr<scene::Scene> world)
+{
+    viewportCameras[world.get()] = FindOrAddViewportCamera(*world);
+
+    auto it = worlds.find(name);
+    if (it == worlds.end())
+    {
+        worlds.emplace(name, std::move(world));
+        return;
+    }
+
+    // The renderer and the editor's selection may point into the world being replaced, they let go of it first
+    std::unique_ptr<scene::Scene> replaced = std::move(it->second);
+    it->second = std::move(world);
+    if (replaced.get() == activeWorld)
+    {
+        Activate(it->second.get());
+    }
+    else
+    {
+        OnWorldsChanged(activeWorld);
+    }
+    viewportCameras.erase(replaced.get());
+}
+
+void WorldManager::Activate(scene::Scene* world)
+{
+    const bool changed = activeWorld != world;
+    activeWorld = world;
+    if (changed)
+    {
+        OnWorldsChanged(world);
+    }
+
+    if (GRuntimeGlobalContext.renderSystem)
+    {
+        GRuntimeGlobalContext.renderSystem->RebuildScenePipeline();
+    }
+}
+
+scene::NodeID WorldManager::FindOrAddViewportCamera(scene::Scene& world)
+{
+    auto& cameras = world.GetComponentManager()->GetComponentsByClass<scene::PerspectiveCamera>();
+    if (cameras.size() > 0)
+    {
+        return cameras.GetOwnerID(0);
+    }
+
+    auto cameraNode = std::make_unique<scene::Node>(&world, "DefaultCamera");
+    world.GetComponentManager()->AddComponent<scene::PerspectiveCamera>(cameraNode.get());
+    const scene::NodeID cameraID = cameraNode->GetID();
+    world.AddNode(std::move(cameraNode));
+    return cameraID;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// @brief Thread pool with a task queue per worker.
+///
+/// A worker runs the newest task of its own queue first and steals the oldest task of another queue once
+/// its own is empty. Tasks submitted from a worker go to the queue of that worker, so chains of dependent
+/// tasks stay on one thread while the idle workers take over whatever is left behind.
+class WorkStealingThreadPool
+{
+public:
+    explicit WorkStealingThreadPool(size_t workerThreads = std::thread::hardware_concurrency());
+
+    ~WorkStealingThreadPool();
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    /// @brief Queues a task. Tasks catch their own exceptions, one that escapes a worker terminates the program.
+    void Submit(std::function<void()> task);
+
+    /// @brief Runs one queued task on the calling thread. Returns false when no task was queued,
+    ///        so a thread that waits for tasks can help instead of blocking.
+    bool RunPendingTask();
+
+    size_t GetWorkerCount() const { return workers.size(); }
+
+    void Shutdown();
+
+private:
+    struct TaskQueue
+    {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool PopTask(size_t queueIndex, std::function<void()>& task);
+
+    bool StealTask(size_t thiefIndex, std::function<void()>& task);
+
+    void WorkerLoop(size_t index);
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> numQueued{0};
+
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<bool> shutdown{false};
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "Memory/LinearArena.hpp"
+
+/// @brief Arenas for scratch data that only lives until the end of the frame, one for every thread.
+///
+/// BeginFrame is called once a frame while no frame work is running. The arena of a thread is reset the
+/// first time that thread asks for it in a new frame, so workers never have to be reached from the main
+/// thread. Tools and tests that tick a scene outside of the engine loop call BeginFrame themselves, or the
+/// arenas are never reset. Hot path containers opt in by taking the arena as their memory resource:
+/// @code
+/// std::pmr::vector<scene::Node*> visible(&FrameAllocator::Get());
+/// @endcode
+class FrameAllocator
+{
+public:
+    struct FrameStats
+    {
+        size_t allocations = 0;
+
+        size_t bytes = 0;
+
+        /// Blocks the arenas took from the heap, 0 once they are as large as a frame needs
+        size_t heapAllocations = 0;
+
+        /// Threads that used their arena during the frame
+        size_t threads = 0;
+    };
+
+    /// @brief The arena of the calling thread, memory from it is valid until the next BeginFrame.
+    static LinearArena& Get();
+
+    /// @brief Ends the current frame, its statistics are kept for GetLastFrameStats.
+    static void BeginFrame();
+
+    static FrameStats GetLastFrameStats();
+
+    static uint64_t GetFrameIndex();
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+/// @brief Bump allocator over blocks taken from the heap, everything it handed out is freed at once by Reset.
+///
+/// Deallocating does nothing, so it suits data that is built, used and dropped together. As a
+/// std::pmr::memory_resource it backs any pmr container:
+/// @code
+/// std::pmr::vector<uint32_t> indices(&arena);
+/// @endcode
+class LinearArena : public std::pmr::memory_resource
+{
+public:
+    struct Stats
+    {
+        size_t allocations = 0;
+
+        size_t bytes = 0;
+
+        /// Blocks taken from the heap since the last Reset
+        size_t heapAllocations = 0;
+    };
+
+    explicit LinearArena(size_t blockSize = 64 * 1024);
+
+    ~LinearArena() override;
+
+    LinearArena(const LinearArena&) = delete;
+    LinearArena& operator=(const LinearArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /// @brief Uninitialized storage for count objects of T.
+    template <typename T>
+    T* AllocateArray(size_t count) { return static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))); }
+
+    /// @brief Frees everything at once. When the arena needed more than one block since the last Reset they
+    ///        are replaced by one block of their total size, so the same amount fits without the heap next time.
+    void Reset();
+
+    const Stats& GetStats() const { return stats; }
+
+    /// @brief Bytes of all blocks the arena holds, the most it can hand out without going to the heap.
+    size_t GetCapacity() const { return capacity; }
+
+private:
+    struct Block
+    {
+        Block* next;
+        size_t size;
+    };
+
+    void AddBlock(size_t minSize);
+
+    void FreeBlocks();
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    size_t blockSize;
+
+    Block* blocks = nullptr;
+    uint8_t* cursor = nullptr;
+    uint8_t* end = nullptr;
+
+    size_t capacity = 0;
+
+    Stats stats;
+};
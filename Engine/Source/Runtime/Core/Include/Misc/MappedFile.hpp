@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+/// @brief A file mapped read-only into memory, the pages are read by the OS when they are first touched.
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    explicit MappedFile(const std::filesystem::path& path);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /// @brief Returns false when the file doesn't exist, is empty or can't be mapped.
+    bool Open(const std::filesystem::path& path);
+
+    void Close();
+
+    bool IsOpen() const { return data != nullptr; }
+
+    const uint8_t* GetData() const { return data; }
+
+    size_t GetSize() const { return size; }
+
+private:
+    const uint8_t* data = nullptr;
+
+    size_t size = 0;
+
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <iostream>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
 #include "Traits/FunctionTraits.hpp"
 #include "Traits/VariableTraits.hpp"
 
@@ -25,7 +30,7 @@ struct BasicFieldTraits<T, true> : public FunctionTraits<T>
     constexpr bool IsConst() const noexcept { return Traits::bIsConst; }
     constexpr bool IsFunction() const noexcept { return true; }
     constexpr bool IsVariable() const noexcept { return false; }
-    constexpr size_t ParamCount() const noexcept { return std::tuple_size_v<typename Traits::Args>; }
+    constexpr size_t ParamCount() const noexcept { return std::tuple_size_v<typename Traits::Params>; }
 };
 
 template <typename T>
@@ -41,26 +46,80 @@ struct BasicFieldTraits<T, false> : public VariableTraits<T>
 template <typename T>
 struct FieldTraits : public BasicFieldTraits<T, IsFunction_Value<T>>
 {
-    constexpr FieldTraits(T&& InPointer): Pointer(InPointer)
+    constexpr FieldTraits(T&& InPointer, std::string_view InName = {}): Pointer(InPointer), Name(InName)
     {
     }
 
     T Pointer;
+
+    /// Name of the member without its class, "m_int" for &ExampleClass::m_int
+    std::string_view Name;
 };
 
+/// @brief The member name of a member pointer expression, what follows the last "::".
+constexpr std::string_view FieldName(std::string_view Expression)
+{
+    const size_t Separator = Expression.rfind(':');
+    return Separator == std::string_view::npos ? Expression : Expression.substr(Separator + 1);
+}
+
 template <typename T>
 struct ReflInfo;
 
+/// @brief Whether T has a ReflInfo with Variables. Declare the ReflInfo next to the type, a translation unit
+///        that asks before it has seen the ReflInfo gets false.
+template <typename T, typename = void>
+struct HasReflInfo : std::false_type
+{
+};
+
+template <typename T>
+struct HasReflInfo<T, std::void_t<decltype(ReflInfo<T>::Variables)>> : std::true_type
+{
+};
+
+template <typename T>
+constexpr bool HasReflInfo_Value = HasReflInfo<T>::value;
+
+/// @brief Calls InFunc(Field) for every variable of the ReflInfo of Class, unrolled at compile time.
+template <typename Class, typename Func>
+constexpr void ForEachField(Func&& InFunc)
+{
+    std::apply([&InFunc](const auto&... Fields)
+    {
+        // Unused when the ReflInfo has no variables
+        [[maybe_unused]] const auto Visit = [&InFunc](const auto& Field)
+        {
+            if constexpr (!IsFunction_Value<decltype(std::decay_t<decltype(Field)>::Pointer)>)
+            {
+                InFunc(Field);
+            }
+        };
+        (Visit(Fields), ...);
+    }, ReflInfo<Class>::Variables);
+}
+
+/// @brief Calls InFunc(Name, Member) for every variable of the ReflInfo of the instance, with the member
+///        as a reference of its own type. Member is const when Instance is.
+template <typename Class, typename Func>
+void ForEachVariable(Class& Instance, Func&& InFunc)
+{
+    ForEachField<std::remove_const_t<Class>>([&](const auto& Field)
+    {
+        InFunc(Field.Name, Instance.*(Field.Pointer));
+    });
+}
+
 template <typename T>
 constexpr auto GenReflInfo()
 {
     return ReflInfo<T>{};
 }
 
-template <size_t Idx, typename... Args, typename Class>
-void VisitTuple(const std::tuple<Args...>& Tuple, Class* ClassInstance)
+template <size_t Idx, typename... Fields, typename Class>
+void VisitTuple(const std::tuple<Fields...>& Tuple, Class* ClassInstance)
 {
-    using TupleType = std::tuple<Args...>;
+    using TupleType = std::tuple<Fields...>;
     if constexpr (Idx >= std::tuple_size_v<TupleType>)
     {
         return;
@@ -68,7 +127,7 @@ void VisitTuple(const std::tuple<Args...>& Tuple, Class* ClassInstance)
     else
     {
         if constexpr (auto elem = std::get<Idx>(Tuple);
-            elem.ParamCount() == 1 && std::is_same_v<typename decltype(elem)::Args, std::tuple<int>>)
+            elem.ParamCount() == 1 && std::is_same_v<typename decltype(elem)::Params, std::tuple<int>>)
         {
             (ClassInstance->*elem.Pointer)(3);
         }
@@ -76,10 +135,10 @@ void VisitTuple(const std::tuple<Args...>& Tuple, Class* ClassInstance)
     }
 }
 
-template <size_t Idx = 0, typename... Args, typename Class>
-void VisitVarTuple(const std::tuple<Args...>& Tuple, Class* ClassInstance)
+template <size_t Idx = 0, typename... Fields, typename Class>
+void VisitVarTuple(const std::tuple<Fields...>& Tuple, Class* ClassInstance)
 {
-    using TupleType = std::tuple<Args...>;
+    using TupleType = std::tuple<Fields...>;
     if constexpr (Idx >= std::tuple_size_v<TupleType>)
     {
         return;
@@ -94,10 +153,10 @@ void VisitVarTuple(const std::tuple<Args...>& Tuple, Class* ClassInstance)
     }
 }
 
-#define REFL_INGO(x) template <> struct ReflInfo<x> {
+#define REFL_INGO(x) template <> struct ReflInfo<x> { static constexpr std::string_view Name = #x;
 
 #define VARIABLES(...) static constexpr auto Variables = std::make_tuple(__VA_ARGS__);
 
-#define VAR(v) FieldTraits<decltype(v)>{v}
+#define VAR(v) FieldTraits<decltype(v)>{v, FieldName(#v)}
 
 #define REFL_END() };
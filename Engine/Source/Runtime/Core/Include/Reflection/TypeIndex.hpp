@@ -0,0 +1,29 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/// @brief Dense integer ids of types, counted from 0 for each Family in the order the types are first asked
+///        for. An id is an array index, where an rttr::type or std::type_index has to be hashed to find
+///        anything. Ids depend on that order, so they only hold for one run and are never saved.
+///
+///        The ids are given out at run time, not at compile time. Numbering types at compile time needs a list
+///        of all of them, and the component types are declared across the engine, the editor and the games.
+///        Get is a function-local static, so after the first call for a type it costs a guarded load.
+template <typename Family>
+class TypeIndex
+{
+public:
+    template <typename T>
+    static uint32_t Get()
+    {
+        static const uint32_t Index = Next.fetch_add(1, std::memory_order_relaxed);
+        return Index;
+    }
+
+    /// @brief Number of ids given out so far.
+    static uint32_t GetCount() { return Next.load(std::memory_order_relaxed); }
+
+private:
+    static inline std::atomic<uint32_t> Next{0};
+};
@@ -0,0 +1,137 @@
+#include "Async/WorkStealingThreadPool.hpp"
+
+#include <cassert>
+
+namespace
+{
+    // Lets Submit find the queue of the worker it is called from
+    thread_local const WorkStealingThreadPool* tlsPool = nullptr;
+    thread_local size_t tlsQueueIndex = 0;
+}
+
+WorkStealingThreadPool::WorkStealingThreadPool(size_t workerThreads)
+{
+    if (workerThreads == 0) workerThreads = 1;
+
+    for (size_t i = 0; i < workerThreads; i++)
+    {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (size_t i = 0; i < workerThreads; i++)
+    {
+        workers.emplace_back(&WorkStealingThreadPool::WorkerLoop, this, i);
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    Shutdown();
+}
+
+void WorkStealingThreadPool::Submit(std::function<void()> task)
+{
+    assert(task);
+
+    const size_t index = (tlsPool == this) ? tlsQueueIndex : nextQueue.fetch_add(1) % queues.size();
+    {
+        std::lock_guard<std::mutex> lock(queues[index]->mutex);
+        queues[index]->tasks.push_back(std::move(task));
+    }
+    numQueued.fetch_add(1);
+
+    // A worker checks numQueued under the lock before it sleeps, so it can't miss this wake up
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_one();
+}
+
+bool WorkStealingThreadPool::RunPendingTask()
+{
+    std::function<void()> task;
+    const size_t index = (tlsPool == this) ? tlsQueueIndex : 0;
+    if (!PopTask(index, task) && !StealTask(index, task))
+    {
+        return false;
+    }
+
+    task();
+    return true;
+}
+
+void WorkStealingThreadPool::Shutdown()
+{
+    if (shutdown.exchange(true)) return;
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wakeUp.notify_all();
+
+    for (auto& worker : workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+}
+
+bool WorkStealingThreadPool::PopTask(size_t queueIndex, std::function<void()>& task)
+{
+    TaskQueue& queue = *queues[queueIndex];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(queue.tasks.back());
+    queue.tasks.pop_back();
+    numQueued.fetch_sub(1);
+    return true;
+}
+
+bool WorkStealingThreadPool::StealTask(size_t thiefIndex, std::function<void()>& task)
+{
+    for (size_t i = 1; i < queues.size(); i++)
+    {
+        TaskQueue& queue = *queues[(thiefIndex + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+        {
+            continue;
+        }
+
+        task = std::move(queue.tasks.front());
+        queue.tasks.pop_front();
+        numQueued.fetch_sub(1);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingThreadPool::WorkerLoop(size_t index)
+{
+    tlsPool = this;
+    tlsQueueIndex = index;
+
+    while (true)
+    {
+        std::function<void()> task;
+        if (PopTask(index, task) || StealTask(index, task))
+        {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]
+        {
+            return shutdown.load() || numQueued.load() > 0;
+        });
+
+        // Queued tasks still run after Shutdown
+        if (shutdown.load() && numQueued.load() == 0) break;
+    }
+}
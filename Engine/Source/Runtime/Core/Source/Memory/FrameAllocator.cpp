@@ -0,0 +1,85 @@
+#include "Memory/FrameAllocator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+    struct ThreadArena;
+
+    std::mutex registryMutex;
+    std::vector<ThreadArena*> threadArenas;
+    FrameAllocator::FrameStats lastFrameStats;
+
+    std::atomic<uint64_t> frameIndex{0};
+
+    struct ThreadArena
+    {
+        ThreadArena()
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadArenas.push_back(this);
+        }
+
+        ~ThreadArena()
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            threadArenas.erase(std::find(threadArenas.begin(), threadArenas.end(), this));
+        }
+
+        LinearArena arena;
+
+        /// Frame the arena was last reset for
+        uint64_t frame = 0;
+    };
+}
+
+LinearArena& FrameAllocator::Get()
+{
+    thread_local ThreadArena threadArena;
+
+    const uint64_t frame = frameIndex.load(std::memory_order_acquire);
+    if (threadArena.frame != frame)
+    {
+        threadArena.arena.Reset();
+        threadArena.frame = frame;
+    }
+    return threadArena.arena;
+}
+
+void FrameAllocator::BeginFrame()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    const uint64_t frame = frameIndex.load(std::memory_order_relaxed);
+
+    FrameStats stats;
+    for (const ThreadArena* threadArena : threadArenas)
+    {
+        // An arena that wasn't asked for during the frame still holds the numbers of an older one
+        if (threadArena->frame != frame)
+        {
+            continue;
+        }
+        const LinearArena::Stats& arenaStats = threadArena->arena.GetStats();
+        stats.allocations += arenaStats.allocations;
+        stats.bytes += arenaStats.bytes;
+        stats.heapAllocations += arenaStats.heapAllocations;
+        stats.threads++;
+    }
+    lastFrameStats = stats;
+
+    frameIndex.store(frame + 1, std::memory_order_release);
+}
+
+FrameAllocator::FrameStats FrameAllocator::GetLastFrameStats()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return lastFrameStats;
+}
+
+uint64_t FrameAllocator::GetFrameIndex()
+{
+    return frameIndex.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,82 @@
+#include "Memory/LinearArena.hpp"
+
+#include <algorithm>
+#include <new>
+
+LinearArena::LinearArena(size_t blockSize) :
+    blockSize{blockSize}
+{
+}
+
+LinearArena::~LinearArena()
+{
+    FreeBlocks();
+}
+
+void* LinearArena::Allocate(size_t size, size_t alignment)
+{
+    const auto alignUp = [alignment](uint8_t* pointer)
+    {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+        return reinterpret_cast<uint8_t*>((address + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1));
+    };
+
+    uint8_t* result = alignUp(cursor);
+    if (cursor == nullptr || result > end || static_cast<size_t>(end - result) < size)
+    {
+        AddBlock(size + alignment);
+        result = alignUp(cursor);
+    }
+    cursor = result + size;
+
+    stats.allocations++;
+    stats.bytes += size;
+    return result;
+}
+
+void LinearArena::Reset()
+{
+    if (blocks != nullptr && blocks->next != nullptr)
+    {
+        // The last frame didn't fit into one block, the next block holds all of them
+        blockSize = capacity;
+        FreeBlocks();
+    }
+    else if (blocks != nullptr)
+    {
+        cursor = reinterpret_cast<uint8_t*>(blocks + 1);
+    }
+    stats = {};
+}
+
+void LinearArena::AddBlock(size_t minSize)
+{
+    const size_t size = std::max(blockSize, minSize + sizeof(Block));
+    Block* block = static_cast<Block*>(::operator new(size));
+    block->next = blocks;
+    block->size = size;
+    blocks = block;
+
+    cursor = reinterpret_cast<uint8_t*>(block + 1);
+    end = reinterpret_cast<uint8_t*>(block) + size;
+    capacity += size;
+    stats.heapAllocations++;
+}
+
+void LinearArena::FreeBlocks()
+{
+    while (blocks != nullptr)
+    {
+        Block* next = blocks->next;
+        ::operator delete(blocks);
+        blocks = next;
+    }
+    cursor = nullptr;
+    end = nullptr;
+    capacity = 0;
+}
+
+void* LinearArena::do_allocate(size_t bytes, size_t alignment)
+{
+    return Allocate(bytes, alignment);
+}
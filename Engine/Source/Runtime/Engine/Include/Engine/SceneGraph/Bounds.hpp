@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <glm/glm.hpp>
+
+#include "Reflection/StaticRefl.hpp"
+
+namespace scene
+{
+    /// @brief Axis aligned bounding box.
+    struct AABB
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+        AABB() = default;
+
+        AABB(const glm::vec3& min, const glm::vec3& max) :
+            min{min}, max{max}
+        {
+        }
+
+        bool IsValid() const { return min.x <= max.x && min.y <= max.y && min.z <= max.z; }
+
+        glm::vec3 GetCenter() const { return (min + max) * 0.5f; }
+
+        glm::vec3 GetExtents() const { return (max - min) * 0.5f; }
+
+        /// @brief Half of the surface area, the cost of a box in the spatial index.
+        float GetHalfArea() const
+        {
+            const glm::vec3 size = max - min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        void Merge(const glm::vec3& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        void Merge(const AABB& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        bool Contains(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.min)) && glm::all(glm::greaterThanEqual(max, other.max));
+        }
+
+        bool Overlaps(const AABB& other) const
+        {
+            return glm::all(glm::lessThanEqual(min, other.max)) && glm::all(glm::greaterThanEqual(max, other.min));
+        }
+
+        bool Overlaps(const glm::vec3& center, float radius) const
+        {
+            const glm::vec3 closest = glm::clamp(center, min, max);
+            const glm::vec3 offset = closest - center;
+            return glm::dot(offset, offset) <= radius * radius;
+        }
+
+        /// @brief The box around this box moved by the matrix, from the center and the absolute
+        ///        rotation and scale instead of the eight corners.
+        AABB Transformed(const glm::mat4& matrix) const
+        {
+            const glm::vec3 center = glm::vec3(matrix * glm::vec4(GetCenter(), 1.0f));
+            const glm::vec3 extents = GetExtents();
+            const glm::vec3 worldExtents = glm::abs(glm::vec3(matrix[0])) * extents.x +
+                                           glm::abs(glm::vec3(matrix[1])) * extents.y +
+                                           glm::abs(glm::vec3(matrix[2])) * extents.z;
+            return {center - worldExtents, center + worldExtents};
+        }
+
+        static AABB Merged(const AABB& a, const AABB& b)
+        {
+            return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+        }
+    };
+
+    struct Ray
+    {
+        glm::vec3 origin = glm::vec3(0.0f);
+        glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);
+
+        /// @brief Distance along the ray to where it enters the box, or a negative value when it misses.
+        ///        A ray that starts inside the box enters it at 0.
+        float Intersect(const AABB& box, float maxDistance) const
+        {
+            const glm::vec3 inverse = 1.0f / direction;
+            const glm::vec3 t0 = (box.min - origin) * inverse;
+            const glm::vec3 t1 = (box.max - origin) * inverse;
+            const glm::vec3 lower = glm::min(t0, t1);
+            const glm::vec3 upper = glm::max(t0, t1);
+            const float enter = std::max(std::max(lower.x, lower.y), std::max(lower.z, 0.0f));
+            const float exit = std::min(std::min(upper.x, upper.y), std::min(upper.z, maxDistance));
+            return enter <= exit ? enter : -1.0f;
+        }
+    };
+
+    /// @brief The six planes of a view projection matrix, pointing inwards.
+    struct Frustum
+    {
+        enum class Result
+        {
+            Outside,
+            Intersects,
+            Inside
+        };
+
+        glm::vec4 planes[6];
+
+        Frustum() = default;
+
+        /// @brief Works for depth in 0..1 and for reversed depth, both give the same planes.
+        explicit Frustum(const glm::mat4& viewProjection)
+        {
+            const glm::mat4 m = glm::transpose(viewProjection);
+            planes[0] = m[3] + m[0];
+            planes[1] = m[3] - m[0];
+            planes[2] = m[3] + m[1];
+            planes[3] = m[3] - m[1];
+            planes[4] = m[2];
+            planes[5] = m[3] - m[2];
+            for (auto& plane : planes)
+            {
+                plane /= glm::length(glm::vec3(plane));
+            }
+        }
+
+        Result Classify(const AABB& box) const
+        {
+            const glm::vec3 center = box.GetCenter();
+            const glm::vec3 extents = box.GetExtents();
+            Result result = Result::Inside;
+            for (const auto& plane : planes)
+            {
+                const glm::vec3 normal = glm::vec3(plane);
+                const float distance = glm::dot(normal, center) + plane.w;
+                const float radius = glm::dot(glm::abs(normal), extents);
+                if (distance < -radius)
+                {
+                    return Result::Outside;
+                }
+                if (distance < radius)
+                {
+                    result = Result::Intersects;
+                }
+            }
+            return result;
+        }
+
+        bool Overlaps(const AABB& box) const { return Classify(box) != Result::Outside; }
+    };
+}
+
+REFL_INGO(scene::AABB)
+VARIABLES(VAR(&scene::AABB::min), VAR(&scene::AABB::max))
+REFL_END()
@@ -3,16 +3,20 @@
 #include <string>
 #include <rttr/registration>
 
+#include "Reflection/TypeIndex.hpp"
+
 namespace scene
 {
     class Node;
     using NodeID = uint32_t;
-    using ComponentTypeID = rttr::type;
+    /// Dense id of a component type, an index into the pools of a ComponentManager, see GetComponentTypeID
+    using ComponentTypeID = uint32_t;
 
     struct ComponentHandle
     {
         ComponentTypeID type;
-        size_t index; // 组件在对应 Pool 中的索引
+        uint32_t index; // 组件在对应 Pool 中的槽位, 组件移动时不变
+        uint32_t generation; // 槽位被复用时递增, 用于识别已销毁的组件
     };
 
     /// @brief A generic class which can be used by nodes. 
@@ -24,6 +28,11 @@ namespace scene
 
         Component(const std::string& name);
 
+        /// @brief Copies the name, the copy has no owner until a pool adds it for a node.
+        Component(const Component& other);
+
+        Component& operator=(const Component& other);
+
         Component(Component&& other) noexcept;
 
         Component& operator=(Component&& other) noexcept;
@@ -44,4 +53,11 @@ namespace scene
 
         Node* owner = nullptr;
     };
+
+    /// @brief Id of the component type T, the same for every scene of a run.
+    template <typename T>
+    ComponentTypeID GetComponentTypeID()
+    {
+        return TypeIndex<Component>::Get<T>();
+    }
 } // namespace scene
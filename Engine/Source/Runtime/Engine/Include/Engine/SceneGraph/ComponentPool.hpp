@@ -1,67 +1,670 @@
 #pragma once
 
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include "Engine/SceneGraph/Node.hpp"
 
 namespace scene
 {
+    class GroupStorage;
+
     class IComponentPool
     {
     public:
         virtual ~IComponentPool() = default;
         virtual void DestroyComponentForNode(uint32_t nodeID) = 0;
+
+        /// @brief Skips the nodes without a component in this pool.
+        void DestroyComponentsForNodes(const std::vector<NodeID>& nodeIDs)
+        {
+            for (NodeID nodeID : nodeIDs)
+            {
+                DestroyComponentForNode(nodeID);
+            }
+        }
+
+        virtual bool Contains(NodeID nodeID) const = 0;
+
+        virtual size_t GetSize() const = 0;
+
+        /// @brief Owner of every component, in the order they are stored.
+        virtual const std::vector<NodeID>& GetOwnerIDs() const = 0;
+
+        /// @brief An empty pool of the same component type.
+        virtual std::unique_ptr<IComponentPool> CreateEmpty() const = 0;
+
+        /// @brief Whether the components can be copied into another pool, for prefabs.
+        virtual bool IsCopyable() const = 0;
+
+        /// @brief Adds a copy of the component of the node to a pool of the same type, for another node.
+        ///        The copy has no owner, the pool only stores it.
+        virtual void CopyComponent(NodeID nodeID, IComponentPool& destination, NodeID destinationID) const = 0;
+
+        /// @brief Makes room for capacity components without allocating on every add.
+        virtual void Reserve(size_t capacity) = 0;
+
+        /// @brief Adds a copy of every component of prototypes, a pool of the same type whose NodeIDs are
+        ///        indices into nodes, and registers the handles with the nodes.
+        virtual void AddCopies(const IComponentPool& prototypes, Node* const* nodes) = 0;
+
+    protected:
+        friend class GroupStorage;
+
+        virtual uint32_t GetDenseIndexOf(NodeID nodeID) const = 0;
+
+        virtual void SwapDense(uint32_t a, uint32_t b) = 0;
+
+        /// The group that orders this pool, a pool belongs to one group at most
+        GroupStorage* group = nullptr;
+    };
+
+    /// @brief Keeps the nodes that have a component in each of a set of pools at the front of every one of
+    ///        them, in the same order. The first GetSize components of the pools then belong to the same
+    ///        nodes, and iterating the group is a linear scan without lookups.
+    class GroupStorage
+    {
+    public:
+        /// @brief Throws std::logic_error when one of the pools already belongs to another group, the two
+        ///        groups would reorder the pool against each other.
+        explicit GroupStorage(std::vector<IComponentPool*> groupPools) :
+            pools{std::move(groupPools)}
+        {
+            for (IComponentPool* pool : pools)
+            {
+                if (pool->group != nullptr)
+                {
+                    throw std::logic_error("A component pool can only be owned by one group");
+                }
+            }
+
+            IComponentPool* smallest = pools.front();
+            for (IComponentPool* pool : pools)
+            {
+                pool->group = this;
+                smallest = (pool->GetSize() < smallest->GetSize()) ? pool : smallest;
+            }
+
+            // OnAdd only swaps components that were already visited into the position of this one
+            const std::vector<NodeID>& owners = smallest->GetOwnerIDs();
+            for (size_t i = 0; i < owners.size(); i++)
+            {
+                OnAdd(owners[i]);
+            }
+        }
+
+        GroupStorage(const GroupStorage&) = delete;
+
+        GroupStorage& operator=(const GroupStorage&) = delete;
+
+        ~GroupStorage()
+        {
+            for (IComponentPool* pool : pools)
+            {
+                pool->group = nullptr;
+            }
+        }
+
+        size_t GetSize() const { return size; }
+
+        /// @brief The group that owns the pool, nullptr when it has none.
+        static GroupStorage* GetGroupOf(const IComponentPool& pool) { return pool.group; }
+
+        /// @brief Whether this group is made of exactly the pools, in any order.
+        bool HasPools(IComponentPool* const* groupPools, size_t num) const
+        {
+            if (num != pools.size())
+            {
+                return false;
+            }
+            for (size_t i = 0; i < num; i++)
+            {
+                if (groupPools[i]->group != this)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /// @brief Called by the pools after a component was added for the node.
+        void OnAdd(NodeID nodeID)
+        {
+            for (IComponentPool* pool : pools)
+            {
+                if (!pool->Contains(nodeID))
+                {
+                    return;
+                }
+            }
+            for (IComponentPool* pool : pools)
+            {
+                pool->SwapDense(pool->GetDenseIndexOf(nodeID), size);
+            }
+            size++;
+        }
+
+        /// @brief Called by the pools before the component of the node is removed.
+        void OnRemove(NodeID nodeID)
+        {
+            if (size == 0 || !pools.front()->Contains(nodeID) || pools.front()->GetDenseIndexOf(nodeID) >= size)
+            {
+                return;
+            }
+            size--;
+            for (IComponentPool* pool : pools)
+            {
+                pool->SwapDense(pool->GetDenseIndexOf(nodeID), size);
+            }
+        }
+
+    private:
+        std::vector<IComponentPool*> pools;
+
+        uint32_t size = 0;
     };
 
+    /// @brief Sparse set of the components of one type.
+    ///
+    /// The components are packed in fixed-size pages, so iterating is a walk over contiguous memory and adding
+    /// a component never moves the ones already in the pool. Removing one moves the last component into the
+    /// hole to keep the pages packed. Nodes find their component through a paged array indexed by NodeID,
+    /// handles through a slot that follows the component when it moves, and whose generation is bumped when
+    /// the slot is reused, so a handle to a removed component is detected instead of returning another one.
+    /// A pool that belongs to a group may reorder its components when a node gains or loses one.
     template <typename T>
     class ComponentPool : public IComponentPool
     {
     public:
-        size_t AddComponent(Node* owner)
+        static constexpr uint32_t InvalidIndex = ~0u;
+
+        /// Components per page, a power of two
+        static constexpr uint32_t PageSize = 1024;
+
+        /// NodeIDs per page of the sparse array, a power of two
+        static constexpr uint32_t SparsePageSize = 4096;
+
+        template <bool Const>
+        class Iterator
+        {
+        public:
+            using Pool = std::conditional_t<Const, const ComponentPool, ComponentPool>;
+            using Reference = std::conditional_t<Const, const T&, T&>;
+
+            Iterator(Pool* pool, uint32_t index) :
+                pool{pool}, index{index}
+            {
+            }
+
+            Reference operator*() const { return pool->At(index); }
+
+            std::conditional_t<Const, const T*, T*> operator->() const { return &pool->At(index); }
+
+            Iterator& operator++()
+            {
+                index++;
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return index == other.index; }
+
+            bool operator!=(const Iterator& other) const { return index != other.index; }
+
+        private:
+            Pool* pool;
+
+            uint32_t index;
+        };
+
+        ComponentPool() = default;
+
+        ComponentPool(const ComponentPool&) = delete;
+
+        ComponentPool& operator=(const ComponentPool&) = delete;
+
+        ~ComponentPool() override
+        {
+            for (uint32_t i = 0; i < count; i++)
+            {
+                At(i).~T();
+            }
+        }
+
+        /// @brief Adds a default constructed component for the node and returns the slot and generation
+        ///        of its handle. The node must not have a component of this type yet.
+        std::pair<uint32_t, uint32_t> AddComponent(NodeID nodeID, Node* owner)
+        {
+            return Emplace(nodeID, owner);
+        }
+
+        void Reserve(size_t capacity) override
         {
-            size_t newIndex = components.size();
-            components.emplace_back();
-            components.back().owner = owner;
+            while (pages.size() * PageSize < capacity)
+            {
+                pages.emplace_back(new Storage[PageSize]);
+            }
+            denseOwners.reserve(capacity);
+            denseSlots.reserve(capacity);
+            slots.reserve(std::max(slots.size(), capacity));
+        }
 
-            NodeID id = owner->GetID();
-            ownerNodeMap[id] = newIndex;
-            indexToNodeMap[newIndex] = id;
+        std::unique_ptr<IComponentPool> CreateEmpty() const override
+        {
+            return std::make_unique<ComponentPool>();
+        }
 
-            return newIndex;
+        bool IsCopyable() const override { return std::is_copy_constructible_v<T>; }
+
+        void CopyComponent(NodeID nodeID, IComponentPool& destination, NodeID destinationID) const override
+        {
+            if constexpr (std::is_copy_constructible_v<T>)
+            {
+                const uint32_t dense = GetDenseIndex(nodeID);
+                if (dense != InvalidIndex)
+                {
+                    static_cast<ComponentPool&>(destination).Emplace(destinationID, nullptr, At(dense));
+                }
+            }
+        }
+
+        void AddCopies(const IComponentPool& prototypes, Node* const* nodes) override
+        {
+            if constexpr (std::is_copy_constructible_v<T>)
+            {
+                const auto& source = static_cast<const ComponentPool&>(prototypes);
+                const ComponentTypeID type = GetComponentTypeID<T>();
+                for (uint32_t dense = 0; dense < source.count; dense++)
+                {
+                    Node* owner = nodes[source.denseOwners[dense]];
+                    const auto [slot, generation] = Emplace(owner->GetID(), owner, source.At(dense));
+                    owner->RegisterComponent({type, slot, generation});
+                }
+            }
         }
 
         T* GetComponent(NodeID nodeID)
         {
-            if (ownerNodeMap.count(nodeID))
+            const uint32_t dense = GetDenseIndex(nodeID);
+            return (dense != InvalidIndex) ? &At(dense) : nullptr;
+        }
+
+        /// @brief Returns nullptr once the component of the handle was removed, even if the slot was reused.
+        T* GetComponent(uint32_t slot, uint32_t generation)
+        {
+            if (slot >= slots.size() || slots[slot].generation != generation || slots[slot].dense == InvalidIndex)
             {
-                return &components[ownerNodeMap[nodeID]];
+                return nullptr;
             }
-            return nullptr;
+            return &At(slots[slot].dense);
         }
 
         void DestroyComponentForNode(NodeID nodeID) override
         {
-            if (!ownerNodeMap.count(nodeID)) return;
+            if (GetDenseIndex(nodeID) == InvalidIndex) return;
+
+            if (group)
+            {
+                group->OnRemove(nodeID);
+            }
+
+            const uint32_t dense = GetDenseIndex(nodeID);
+
+            const uint32_t slot = denseSlots[dense];
+            const uint32_t last = count - 1;
+            if (dense != last)
+            {
+                // The pool keeps the owner right, the move operations of a component type don't have to
+                Node* movedOwner = At(last).owner;
+                At(dense) = std::move(At(last));
+                At(dense).owner = movedOwner;
+
+                denseOwners[dense] = denseOwners[last];
+                denseSlots[dense] = denseSlots[last];
+                GetSparseEntry(denseOwners[dense]) = dense;
+                slots[denseSlots[dense]].dense = dense;
+            }
+            At(last).~T();
+            count--;
+            denseOwners.pop_back();
+            denseSlots.pop_back();
+
+            GetSparseEntry(nodeID) = InvalidIndex;
+            slots[slot].dense = InvalidIndex;
+            slots[slot].generation++;
+            freeSlots.push_back(slot);
+        }
+
+        bool Contains(NodeID nodeID) const override { return GetDenseIndex(nodeID) != InvalidIndex; }
+
+        size_t GetSize() const override { return count; }
+
+        const std::vector<NodeID>& GetOwnerIDs() const override { return denseOwners; }
+
+        size_t size() const { return count; }
+
+        bool empty() const { return count == 0; }
+
+        T& operator[](size_t index) { return At(static_cast<uint32_t>(index)); }
+
+        const T& operator[](size_t index) const { return At(static_cast<uint32_t>(index)); }
+
+        NodeID GetOwnerID(size_t index) const { return denseOwners[index]; }
+
+        Iterator<false> begin() { return {this, 0}; }
+
+        Iterator<false> end() { return {this, count}; }
+
+        Iterator<true> begin() const { return {this, 0}; }
+
+        Iterator<true> end() const { return {this, count}; }
+
+        /// @brief Calls func on every component, page by page.
+        template <typename Func>
+        void ForEach(Func&& func)
+        {
+            for (uint32_t first = 0; first < count; first += PageSize)
+            {
+                T* page = reinterpret_cast<T*>(pages[first / PageSize].get());
+                const uint32_t num = std::min(PageSize, count - first);
+                for (uint32_t i = 0; i < num; i++)
+                {
+                    func(page[i]);
+                }
+            }
+        }
+
+    protected:
+        uint32_t GetDenseIndexOf(NodeID nodeID) const override { return GetDenseIndex(nodeID); }
+
+        void SwapDense(uint32_t a, uint32_t b) override
+        {
+            if (a == b)
+            {
+                return;
+            }
+
+            Node* ownerA = At(a).owner;
+            Node* ownerB = At(b).owner;
+            std::swap(At(a), At(b));
+            At(a).owner = ownerB;
+            At(b).owner = ownerA;
+            std::swap(denseOwners[a], denseOwners[b]);
+            std::swap(denseSlots[a], denseSlots[b]);
+            GetSparseEntry(denseOwners[a]) = a;
+            GetSparseEntry(denseOwners[b]) = b;
+            slots[denseSlots[a]].dense = a;
+            slots[denseSlots[b]].dense = b;
+        }
+
+    private:
+        using Storage = typename std::aligned_storage<sizeof(T), alignof(T)>::type;
+
+        struct Slot
+        {
+            uint32_t dense;
+            uint32_t generation;
+        };
+
+        T& At(uint32_t index)
+        {
+            return *reinterpret_cast<T*>(&pages[index / PageSize][index % PageSize]);
+        }
+
+        const T& At(uint32_t index) const
+        {
+            return *reinterpret_cast<const T*>(&pages[index / PageSize][index % PageSize]);
+        }
+
+        template <typename... Args>
+        std::pair<uint32_t, uint32_t> Emplace(NodeID nodeID, Node* owner, Args&&... args)
+        {
+            assert(GetDenseIndex(nodeID) == InvalidIndex && "The node already has a component of this type");
+
+            if (count == pages.size() * PageSize)
+            {
+                pages.emplace_back(new Storage[PageSize]);
+            }
+            const uint32_t dense = count;
+            T* component = new (&pages[dense / PageSize][dense % PageSize]) T(std::forward<Args>(args)...);
+            component->owner = owner;
+            count++;
+
+            uint32_t slot;
+            if (!freeSlots.empty())
+            {
+                slot = freeSlots.back();
+                freeSlots.pop_back();
+            }
+            else
+            {
+                slot = static_cast<uint32_t>(slots.size());
+                slots.push_back({InvalidIndex, 0});
+            }
+            slots[slot].dense = dense;
+
+            denseOwners.push_back(nodeID);
+            denseSlots.push_back(slot);
+            GetSparseEntry(nodeID) = dense;
+
+            if (group)
+            {
+                group->OnAdd(nodeID);
+            }
+
+            return {slot, slots[slot].generation};
+        }
+
+        uint32_t GetDenseIndex(NodeID nodeID) const
+        {
+            const size_t page = nodeID / SparsePageSize;
+            if (page >= sparsePages.size() || !sparsePages[page])
+            {
+                return InvalidIndex;
+            }
+            return sparsePages[page][nodeID % SparsePageSize];
+        }
+
+        uint32_t& GetSparseEntry(NodeID nodeID)
+        {
+            const size_t page = nodeID / SparsePageSize;
+            if (page >= sparsePages.size())
+            {
+                sparsePages.resize(page + 1);
+            }
+            if (!sparsePages[page])
+            {
+                sparsePages[page].reset(new uint32_t[SparsePageSize]);
+                std::fill_n(sparsePages[page].get(), SparsePageSize, InvalidIndex);
+            }
+            return sparsePages[page][nodeID % SparsePageSize];
+        }
+
+        /// Dense storage, the first count components are alive
+        std::vector<std::unique_ptr<Storage[]>> pages;
+        uint32_t count = 0;
+
+        /// Per dense index
+        std::vector<NodeID> denseOwners;
+        std::vector<uint32_t> denseSlots;
+
+        /// Per handle slot
+        std::vector<Slot> slots;
+        std::vector<uint32_t> freeSlots;
+
+        /// NodeID -> dense index, pages are only allocated for the ID ranges in use
+        std::vector<std::unique_ptr<uint32_t[]>> sparsePages;
+    };
+
+    /// @brief Iterates the nodes that have a component of every type. The smallest pool drives the iteration
+    ///        and the other components are found through the sparse arrays of their pools. Components must
+    ///        not be added or removed while iterating.
+    template <typename... Types>
+    class View
+    {
+    public:
+        using Value = std::tuple<NodeID, Types&...>;
+
+        class Iterator
+        {
+        public:
+            Iterator(const View* view, size_t index) :
+                view{view}, index{index}
+            {
+                SkipMissing();
+            }
+
+            Value operator*() const
+            {
+                const NodeID nodeID = (*view->leadOwners)[index];
+                return Value{nodeID, *std::get<ComponentPool<Types>*>(view->pools)->GetComponent(nodeID)...};
+            }
+
+            Iterator& operator++()
+            {
+                index++;
+                SkipMissing();
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return index == other.index; }
+
+            bool operator!=(const Iterator& other) const { return index != other.index; }
+
+        private:
+            void SkipMissing()
+            {
+                while (index < view->GetLeadSize() && !view->ContainsAll((*view->leadOwners)[index]))
+                {
+                    index++;
+                }
+            }
+
+            const View* view;
+
+            size_t index;
+        };
+
+        /// @brief A missing pool makes the view empty.
+        explicit View(ComponentPool<Types>*... viewPools) :
+            pools{viewPools...}
+        {
+            const IComponentPool* all[] = {viewPools...};
+            const IComponentPool* lead = nullptr;
+            for (const IComponentPool* pool : all)
+            {
+                if (pool == nullptr)
+                {
+                    return;
+                }
+                lead = (lead == nullptr || pool->GetSize() < lead->GetSize()) ? pool : lead;
+            }
+            leadOwners = &lead->GetOwnerIDs();
+        }
+
+        Iterator begin() const { return {this, 0}; }
+
+        Iterator end() const { return {this, GetLeadSize()}; }
+
+        /// @brief Calls func(nodeID, components...) for every node of the view.
+        template <typename Func>
+        void ForEach(Func&& func) const
+        {
+            const size_t num = GetLeadSize();
+            for (size_t i = 0; i < num; i++)
+            {
+                const NodeID nodeID = (*leadOwners)[i];
+                const std::tuple<Types*...> components{std::get<ComponentPool<Types>*>(pools)->GetComponent(nodeID)...};
+                if ((... && (std::get<Types*>(components) != nullptr)))
+                {
+                    func(nodeID, *std::get<Types*>(components)...);
+                }
+            }
+        }
+
+    private:
+        size_t GetLeadSize() const { return leadOwners ? leadOwners->size() : 0; }
+
+        bool ContainsAll(NodeID nodeID) const
+        {
+            return (... && std::get<ComponentPool<Types>*>(pools)->Contains(nodeID));
+        }
+
+        std::tuple<ComponentPool<Types>*...> pools;
+
+        const std::vector<NodeID>* leadOwners = nullptr;
+    };
+
+    /// @brief Iterates the nodes of a group, the components of every type are at the same index of their pool.
+    template <typename... Types>
+    class Group
+    {
+    public:
+        using First = std::tuple_element_t<0, std::tuple<Types...>>;
+        using Value = std::tuple<NodeID, Types&...>;
+
+        class Iterator
+        {
+        public:
+            Iterator(const Group* group, uint32_t index) :
+                group{group}, index{index}
+            {
+            }
 
-            size_t indexOfRemoved = ownerNodeMap[nodeID];
-            size_t indexOfLast = components.size() - 1;
-            NodeID nodeOfLast = indexToNodeMap[indexOfLast];
+            Value operator*() const
+            {
+                return Value{std::get<0>(group->pools)->GetOwnerID(index), (*std::get<ComponentPool<Types>*>(group->pools))[index]...};
+            }
 
-            components[indexOfRemoved] = std::move(components[indexOfLast]);
+            Iterator& operator++()
+            {
+                index++;
+                return *this;
+            }
+
+            bool operator==(const Iterator& other) const { return index == other.index; }
+
+            bool operator!=(const Iterator& other) const { return index != other.index; }
 
-            ownerNodeMap[nodeOfLast] = indexOfRemoved;
-            indexToNodeMap[indexOfRemoved] = nodeOfLast;
+        private:
+            const Group* group;
 
-            components.pop_back();
+            uint32_t index;
+        };
 
-            ownerNodeMap.erase(nodeID);
-            indexToNodeMap.erase(indexOfLast);
+        Group(const GroupStorage& storage, ComponentPool<Types>*... groupPools) :
+            storage{storage}, pools{groupPools...}
+        {
         }
 
-        std::vector<T>& GetData() { return components; }
+        size_t size() const { return storage.GetSize(); }
+
+        Iterator begin() const { return {this, 0}; }
+
+        Iterator end() const { return {this, static_cast<uint32_t>(storage.GetSize())}; }
+
+        /// @brief Calls func(nodeID, components...) for every node of the group.
+        template <typename Func>
+        void ForEach(Func&& func) const
+        {
+            const ComponentPool<First>& first = *std::get<0>(pools);
+            const size_t num = storage.GetSize();
+            for (size_t i = 0; i < num; i++)
+            {
+                func(first.GetOwnerID(i), (*std::get<ComponentPool<Types>*>(pools))[i]...);
+            }
+        }
 
     private:
-        std::vector<T> components;
-        std::unordered_map<uint32_t, size_t> ownerNodeMap; // NodeID -> Index
-        std::unordered_map<size_t, uint32_t> indexToNodeMap; // Index -> NodeID (用于Swap)}
+        const GroupStorage& storage;
+
+        std::tuple<ComponentPool<Types>*...> pools;
     };
 
     class ComponentManager
@@ -71,10 +674,19 @@ namespace scene
         T* AddComponent(Node* owner)
         {
             auto pool = GetOrCreatePool<T>();
-            size_t index = pool->AddComponent(owner);
-            rttr::type t = rttr::type::get<T>();
-            owner->RegisterComponent({t, index});
-            return &pool->GetData()[index];
+            const auto [slot, generation] = pool->AddComponent(owner->GetID(), owner);
+            owner->RegisterComponent({GetComponentTypeID<T>(), slot, generation});
+            return pool->GetComponent(slot, generation);
+        }
+
+        /// @brief Returns nullptr when the component of the handle was destroyed.
+        template <typename T>
+        T* GetComponent(const ComponentHandle& handle)
+        {
+            auto* pool = GetPool<T>();
+            if (pool && handle.type == GetComponentTypeID<T>())
+                return pool->GetComponent(handle.index, handle.generation);
+            return nullptr;
         }
 
         template <typename T>
@@ -87,29 +699,89 @@ namespace scene
         }
 
         template <typename T>
-        std::vector<T>& GetComponentsByClass()
+        ComponentPool<T>& GetComponentsByClass()
         {
-            auto* pool = GetOrCreatePool<T>();
-            return pool->GetData();
+            return *GetOrCreatePool<T>();
+        }
+
+        /// @brief Nodes that have a component of every type, see View.
+        template <typename... Types>
+        View<Types...> GetView()
+        {
+            return View<Types...>(GetPool<Types>()...);
+        }
+
+        /// @brief Nodes that have a component of every type, with the pools kept in the same order so
+        ///        iterating is a linear scan. The group is created on first use and kept up to date from then
+        ///        on. The types may come in any order, GetGroup<B, A> returns the group of GetGroup<A, B>.
+        ///        A pool can only be in one group, asking for a group that shares a pool with another one
+        ///        throws std::logic_error.
+        template <typename... Types>
+        Group<Types...> GetGroup()
+        {
+            IComponentPool* const groupPools[] = {GetOrCreatePool<Types>()...};
+            constexpr size_t num = sizeof...(Types);
+
+            GroupStorage* storage = GroupStorage::GetGroupOf(*groupPools[0]);
+            if (storage == nullptr || !storage->HasPools(groupPools, num))
+            {
+                groups.push_back(
+                    std::make_unique<GroupStorage>(std::vector<IComponentPool*>(groupPools, groupPools + num)));
+                storage = groups.back().get();
+            }
+            return Group<Types...>(*storage, GetOrCreatePool<Types>()...);
         }
 
         void DestroyComponentsOfNode(Node* node)
         {
             for (const auto& handle : node->GetComponentHandles())
             {
-                if (componentPools.count(handle.type))
+                if (handle.type < componentPools.size() && componentPools[handle.type])
                 {
                     componentPools[handle.type]->DestroyComponentForNode(node->GetID());
                 }
             }
         }
 
+        /// @brief Destroys the components of many nodes with one pass over every pool, a node without
+        ///        a component in a pool only costs an array read there.
+        void DestroyComponentsOfNodes(const std::vector<NodeID>& nodeIDs)
+        {
+            for (auto& pool : componentPools)
+            {
+                if (pool && pool->GetSize() > 0)
+                {
+                    pool->DestroyComponentsForNodes(nodeIDs);
+                }
+            }
+        }
+
+        /// @brief The pool of the type, nullptr when the scene has none.
+        IComponentPool* GetPool(ComponentTypeID typeId) const
+        {
+            return typeId < componentPools.size() ? componentPools[typeId].get() : nullptr;
+        }
+
+        /// @brief The pool of the type, an empty one like prototype is created when the scene has none.
+        IComponentPool& GetOrCreatePool(ComponentTypeID typeId, const IComponentPool& prototype)
+        {
+            if (typeId >= componentPools.size())
+            {
+                componentPools.resize(typeId + 1);
+            }
+            if (!componentPools[typeId])
+            {
+                componentPools[typeId] = prototype.CreateEmpty();
+            }
+            return *componentPools[typeId];
+        }
+
     private:
         template <typename T>
         ComponentPool<T>* GetPool()
         {
-            ComponentTypeID typeId = rttr::type::get<T>();
-            if (componentPools.count(typeId))
+            const ComponentTypeID typeId = GetComponentTypeID<T>();
+            if (typeId < componentPools.size())
             {
                 return static_cast<ComponentPool<T>*>(componentPools[typeId].get());
             }
@@ -119,14 +791,23 @@ namespace scene
         template <typename T>
         ComponentPool<T>* GetOrCreatePool()
         {
-            ComponentTypeID typeId = rttr::type::get<T>();
-            if (!componentPools.count(typeId))
+            const ComponentTypeID typeId = GetComponentTypeID<T>();
+            if (typeId >= componentPools.size())
+            {
+                componentPools.resize(typeId + 1);
+            }
+            if (!componentPools[typeId])
             {
                 componentPools[typeId] = std::make_unique<ComponentPool<T>>();
             }
             return static_cast<ComponentPool<T>*>(componentPools[typeId].get());
         }
 
-        std::unordered_map<ComponentTypeID, std::unique_ptr<IComponentPool>> componentPools;
+        /// Indexed by ComponentTypeID, null for the types this scene has no pool of
+        std::vector<std::unique_ptr<IComponentPool>> componentPools;
+
+        /// Found through the group of their pools. Declared after the pools, a group detaches from its pools
+        /// when it is destroyed
+        std::vector<std::unique_ptr<GroupStorage>> groups;
     };
 }
@@ -28,6 +28,7 @@
 #include "Framework/Common/glmCommon.hpp"
 
 #include "Framework/Core/ShaderModule.hpp"
+#include "Reflection/StaticRefl.hpp"
 
 
 namespace scene
@@ -62,6 +63,10 @@ namespace scene
         Light();
         Light(const std::string& name);
 
+        /// @brief The copy has no node set, get_node returns its owner.
+        Light(const Light& other);
+        Light& operator=(const Light& other);
+
         Light(Light&& other) noexcept;
         Light& operator=(Light&& other) noexcept;
 
@@ -80,10 +85,22 @@ namespace scene
         const LightProperties& get_properties() const;
 
     private:
+        friend struct ::ReflInfo<Light>;
+
         Node* node{nullptr};
 
-        LightType light_type;
+        LightType light_type{Directional};
 
         LightProperties properties;
     };
 }
+
+REFL_INGO(scene::LightProperties)
+VARIABLES(VAR(&scene::LightProperties::direction), VAR(&scene::LightProperties::color),
+          VAR(&scene::LightProperties::intensity), VAR(&scene::LightProperties::range),
+          VAR(&scene::LightProperties::inner_cone_angle), VAR(&scene::LightProperties::outer_cone_angle))
+REFL_END()
+
+REFL_INGO(scene::Light)
+VARIABLES(VAR(&scene::Light::light_type), VAR(&scene::Light::properties))
+REFL_END()
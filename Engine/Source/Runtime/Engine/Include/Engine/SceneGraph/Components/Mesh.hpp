@@ -23,6 +23,7 @@
 #include <vector>
 #include <glm/glm.hpp>
 #include "Engine/SceneGraph/Component.hpp"
+#include "Reflection/StaticRefl.hpp"
 
 /**
  * @brief The structure of a meshlet for mesh shader
@@ -62,19 +63,39 @@ namespace scene
 {
     class SubMesh;
 
+    /// @brief Groups the submeshes drawn for a model. The submeshes are components of their own nodes, and
+    ///        are referred to by handle since their pool moves them when another submesh is removed.
     class Mesh : public Component
     {
     public:
-        Mesh(const std::string& name);
+        Mesh(const std::string& name = {});
+
+        /// @brief Copies the name only, the submesh handles belong to the nodes of other.
+        Mesh(const Mesh& other);
+        Mesh& operator=(const Mesh& other);
+
         Mesh(Mesh&& other) noexcept;
         Mesh& operator=(Mesh&& other) noexcept;
         virtual ~Mesh() = default;
 
+        /// @brief Adds a submesh, it has to be a component of a node of the same scene.
         void SetSubmesh(SubMesh& submesh);
 
-        const std::vector<SubMesh*>& GetSubmeshes() const;
+        size_t GetSubmeshCount() const;
+
+        /// @brief Returns nullptr once the submesh was destroyed.
+        SubMesh* GetSubmesh(size_t index) const;
 
     private:
-        std::vector<SubMesh*> submeshes;
+        /// Links the copies it instantiates to their submeshes by handle
+        friend class Prefab;
+
+        std::vector<ComponentHandle> submeshes;
     };
 }
+
+// Only the name is saved here, SceneSerializer saves the submeshes as the nodes that own them since the handles
+// are only valid in the scene that made them
+REFL_INGO(scene::Mesh)
+VARIABLES()
+REFL_END()
@@ -23,6 +23,7 @@
 #include "Framework/Common/VkError.hpp"
 #include "Framework/Common/glmCommon.hpp"
 #include "Framework/Common/VkHelpers.hpp"
+#include "Reflection/StaticRefl.hpp"
 
 
 namespace scene
@@ -33,8 +34,8 @@ namespace scene
         PerspectiveCamera();
         PerspectiveCamera(const std::string& name);
 
-        PerspectiveCamera(const PerspectiveCamera&) = delete;
-        PerspectiveCamera& operator=(const PerspectiveCamera&) = delete;
+        PerspectiveCamera(const PerspectiveCamera& other);
+        PerspectiveCamera& operator=(const PerspectiveCamera& other);
 
         PerspectiveCamera(PerspectiveCamera&& other) noexcept;
         PerspectiveCamera& operator=(PerspectiveCamera&& other) noexcept;
@@ -60,6 +61,8 @@ namespace scene
         virtual glm::mat4 GetProjection() override;
 
     private:
+        friend struct ::ReflInfo<PerspectiveCamera>;
+
         /**
          * @brief Screen size aspect ratio
          */
@@ -75,3 +78,8 @@ namespace scene
         float near_plane{0.1f};
     };
 }
+
+REFL_INGO(scene::PerspectiveCamera)
+VARIABLES(VAR(&scene::PerspectiveCamera::aspect_ratio), VAR(&scene::PerspectiveCamera::fov),
+          VAR(&scene::PerspectiveCamera::far_plane), VAR(&scene::PerspectiveCamera::near_plane))
+REFL_END()
@@ -23,11 +23,13 @@
 #include <unordered_map>
 #include <vector>
 
+#include "Engine/SceneGraph/Bounds.hpp"
 #include "Engine/SceneGraph/Component.hpp"
 #include "Framework/Common/VkCommon.hpp"
 
 #include "Framework/Core/Buffer.hpp"
 #include "Framework/Core/ShaderModule.hpp"
+#include "Reflection/StaticRefl.hpp"
 
 
 namespace scene
@@ -72,6 +74,9 @@ namespace scene
 
         // "Position" : 
         std::unordered_map<std::string, MeshData::VertexAttribute> vertex_attributes;
+
+        // Object space bounds of the vertex positions, filled in at import
+        AABB bounds;
     };
 
     class SubMesh : public Component
@@ -81,6 +86,12 @@ namespace scene
 
         virtual ~SubMesh() = default;
 
+        /// @brief The copy shares meshData, the material and the layout with other. Buffers the submesh owns
+        ///        itself are not copied, a copy of such a submesh has no geometry.
+        SubMesh(const SubMesh& other);
+
+        SubMesh& operator=(const SubMesh& other);
+
         SubMesh(SubMesh&& other) noexcept;
 
         SubMesh& operator=(SubMesh&& other) noexcept;
@@ -88,7 +99,13 @@ namespace scene
         RTTR_ENABLE(Component)
     public:
         MeshData* meshData = nullptr;
+        /// The model the submesh was imported from and its index in there, saved with the scene in place of
+        /// the GPU data
         std::string ModelPath;
+        std::uint32_t SubmeshIndex = 0;
+        /// Name of the material, set by set_material. Saved so a material other than the one of the model
+        /// can be found again.
+        std::string MaterialName;
         bool bHasMeshData = false;
 
         VkIndexType index_type{};
@@ -103,6 +120,9 @@ namespace scene
 
         std::unique_ptr<vkb::Buffer> index_buffer;
 
+        // Object space bounds of the vertex positions, filled in at import
+        AABB bounds;
+
         void set_attribute(const std::string& name, const VertexAttribute& attribute);
 
         bool get_attribute(const std::string& name, VertexAttribute& attribute) const;
@@ -115,6 +135,27 @@ namespace scene
 
         vkb::ShaderVariant& get_mut_shader_variant();
 
+        /**
+         * @brief Object space bounds of the submesh, those of its mesh data when it has any
+         */
+        const AABB& get_bounds() const;
+
+        /**
+         * @brief Sets the bounds and moves the node in the spatial index of its scene
+         */
+        void set_bounds(const AABB& new_bounds);
+
+        /**
+         * @brief Draws the submesh from the mesh data and moves the node in the spatial index to its bounds
+         */
+        void set_mesh_data(MeshData* mesh_data);
+
+        /**
+         * @brief Shares the mesh data, the layout, the material and the shader variant of the imported submesh
+         *        the ModelPath and SubmeshIndex refer to. The name, the bounds and the material name stay.
+         */
+        void set_asset(const SubMesh& asset);
+
     private:
         std::unordered_map<std::string, VertexAttribute> vertex_attributes;
 
@@ -123,3 +164,9 @@ namespace scene
         vkb::ShaderVariant shader_variant;
     };
 }
+
+// The GPU data is saved as a reference to the imported model, SceneSerializer::ResolveSubMeshes finds it again
+REFL_INGO(scene::SubMesh)
+VARIABLES(VAR(&scene::SubMesh::ModelPath), VAR(&scene::SubMesh::SubmeshIndex), VAR(&scene::SubMesh::MaterialName),
+          VAR(&scene::SubMesh::bounds))
+REFL_END()
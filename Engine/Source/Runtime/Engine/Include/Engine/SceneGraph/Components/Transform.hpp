@@ -21,19 +21,28 @@
 #include <glm/detail/type_quat.hpp>
 
 #include "Engine/SceneGraph/Component.hpp"
+#include "Engine/SceneGraph/TransformSystem.hpp"
 
 
 namespace scene
 {
     class Node;
 
+    /// @brief Local transform of a node.
+    ///
+    /// Nodes that belong to a scene keep a copy of their local transform in the scene's TransformSystem,
+    /// which owns the world matrix. Nodes without a scene fall back to computing it from their parents.
     class Transform : public Component
     {
         RTTR_ENABLE(Component)
     public:
         Transform(Node& node);
 
-        virtual ~Transform() = default;
+        Transform(const Transform&) = delete;
+
+        Transform& operator=(const Transform&) = delete;
+
+        virtual ~Transform();
 
         Node& GetNode();
 
@@ -43,6 +52,9 @@ namespace scene
 
         void SetScale(const glm::vec3& scale);
 
+        /// @brief Sets the whole local transform with one update of the TransformSystem.
+        void SetLocal(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+
         const glm::vec3& GetTranslation() const;
 
         const glm::quat& GetRotation() const;
@@ -55,10 +67,13 @@ namespace scene
 
         glm::mat4 GetWorldMatrix();
 
+        TransformSystem::Handle GetHandle() const { return handle; }
+
         /**
          * @brief Marks the world transform invalid if any of
          *        the local transform are changed or the parent
-         *        world transform has changed.
+         *        world transform has changed. Also hands the
+         *        local transform to the TransformSystem.
          */
         void InvalidateWorldMatrix();
 
@@ -66,8 +81,20 @@ namespace scene
         static glm::quat EulerDegreesToQuat(const glm::vec3& eulerDegrees);
 
     private:
+        friend class Node;
+
+        /// @brief Adopts a handle the TransformSystem already created and parented.
+        Transform(Node& node, TransformSystem& system, TransformSystem::Handle handle);
+
+        /// @brief Hands the parent of the node over to the TransformSystem.
+        void UpdateParent();
+
         Node& node;
 
+        TransformSystem* system = nullptr;
+
+        TransformSystem::Handle handle = TransformSystem::InvalidHandle;
+
         glm::vec3 translation = glm::vec3(0.0, 0.0, 0.0);
 
         glm::quat rotation = glm::quat(1.0, 0.0, 0.0, 0.0);
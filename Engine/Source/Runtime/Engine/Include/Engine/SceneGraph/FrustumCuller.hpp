@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Engine/SceneGraph/Bounds.hpp"
+
+class WorkStealingThreadPool;
+
+namespace scene
+{
+    /// @brief Tests a flat list of world space boxes against a frustum, four boxes at a time.
+    ///
+    /// The boxes are kept as centers and extents in one array per component, so a plane is tested
+    /// against four boxes with a load per component and no shuffles. Unlike the SpatialIndex nothing is
+    /// kept between frames, the list is filled again from the boxes of the frame and tested in one pass.
+    class FrustumCuller
+    {
+    public:
+        struct Stats
+        {
+            size_t visible = 0;
+
+            size_t culled = 0;
+        };
+
+        /// Boxes tested by one task when the test runs on a thread pool
+        static constexpr size_t ChunkSize = 1024;
+
+        void Clear();
+
+        void Reserve(size_t count);
+
+        /// @brief Returns the index of the box in the results of Cull. A box that isn't valid is never culled.
+        uint32_t Add(const AABB& worldBounds);
+
+        size_t GetCount() const { return count; }
+
+        /// @brief Sets visible[i] to 1 for every box that overlaps the frustum and to 0 for the others.
+        ///        With a thread pool the chunks run in parallel and the calling thread helps out.
+        Stats Cull(const Frustum& frustum, std::vector<uint8_t>& visible,
+                   WorkStealingThreadPool* threadPool = nullptr) const;
+
+        /// @brief Same as above, visible points at GetCount() entries the caller allocated, e.g. from the frame arena.
+        Stats Cull(const Frustum& frustum, uint8_t* visible, WorkStealingThreadPool* threadPool = nullptr) const;
+
+    private:
+        /// Tests the boxes [first, last), first is a multiple of 4
+        size_t CullRange(const Frustum& frustum, size_t first, size_t last, uint8_t* visible) const;
+
+        size_t count = 0;
+
+        /// Padded to a multiple of 4 with boxes that are always visible
+        std::vector<float> centerX;
+        std::vector<float> centerY;
+        std::vector<float> centerZ;
+        std::vector<float> extentX;
+        std::vector<float> extentY;
+        std::vector<float> extentZ;
+    };
+}
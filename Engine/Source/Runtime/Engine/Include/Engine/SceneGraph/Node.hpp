@@ -85,6 +85,10 @@ namespace scene
 
     private:
         friend class Scene;
+        friend class Prefab;
+
+        /// @brief A node of a scene whose transform was created with the rest of its subtree.
+        Node(Scene* scene, std::string name, Node* parent, TransformSystem::Handle transformHandle);
 
         void RemoveChild(Node* child)
         {
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Engine/SceneGraph/Bounds.hpp"
+#include "Engine/SceneGraph/ComponentPool.hpp"
+
+namespace scene
+{
+    class Node;
+    class Scene;
+
+    /// @brief A recorded subtree of nodes with their components, instantiated many times in one batch.
+    ///
+    /// Recording copies the names and local transforms of the nodes, the bounds they were given in the
+    /// spatial index and their components into pools owned by the prefab, where the NodeID of a component
+    /// is the index of its node in the subtree. Instantiating creates the nodes of every copy first, then
+    /// reserves each pool of the scene once and copies its components for all the copies in one pass, with
+    /// the owners and handles fixed up from the index. Components that can't be copied are not recorded.
+    /// A Mesh is copied without its submesh handles, each copy is given the submeshes of its own nodes.
+    ///
+    /// The nodes are still allocated one by one. Scenes and parents own them through std::unique_ptr<Node>
+    /// and destroy them one at a time, a block of nodes could only be freed once all of them are gone.
+    class Prefab
+    {
+    public:
+        /// @brief Records the node and its descendants, the prefab keeps no reference to them.
+        explicit Prefab(Node& root);
+
+        /// @brief Adds count copies to the scene, as roots or as children of parent, and returns their roots.
+        std::vector<Node*> Instantiate(Scene& scene, size_t count, Node* parent = nullptr) const;
+
+        /// @brief Adds a copy for every translation, which replaces the one of the recorded root.
+        std::vector<Node*> Instantiate(Scene& scene, const std::vector<glm::vec3>& translations,
+                                       Node* parent = nullptr) const;
+
+        size_t GetNodeCount() const { return nodes.size(); }
+
+        size_t GetComponentCount() const;
+
+    private:
+        static constexpr uint32_t NoParent = ~0u;
+
+        static constexpr uint32_t NoSlot = ~0u;
+
+        /// Depth first, every parent comes before its children
+        struct NodeRecord
+        {
+            std::string name;
+            uint32_t parent;
+            uint32_t numChildren;
+            uint32_t numComponents;
+            glm::vec3 translation;
+            glm::quat rotation;
+            glm::vec3 scale;
+            bool hasBounds;
+            AABB localBounds;
+        };
+
+        struct ComponentRecord
+        {
+            ComponentTypeID type;
+            std::unique_ptr<IComponentPool> pool;
+        };
+
+        /// Where a copy finds the handle of a component, the pools register the handles of a new node in
+        /// the order of the records, so the position is the same in every copy
+        struct HandleSlot
+        {
+            uint32_t node;
+            uint32_t slot;
+        };
+
+        /// A recorded mesh, with the handle slots of its submeshes
+        struct MeshRecord
+        {
+            HandleSlot mesh;
+            std::vector<HandleSlot> submeshes;
+        };
+
+        void RecordComponents(ComponentManager& manager, Node& node, uint32_t index);
+
+        void RecordMeshes(ComponentManager& manager, const std::vector<Node*>& recorded);
+
+        /// @brief Position of the handle of the recorded component among the handles of a copy of the node,
+        ///        NoSlot when the component wasn't recorded.
+        uint32_t FindHandleSlot(ComponentTypeID type, uint32_t node) const;
+
+        std::vector<Node*> Instantiate(Scene& scene, size_t count, const glm::vec3* translations, Node* parent) const;
+
+        std::vector<NodeRecord> nodes;
+
+        std::vector<ComponentRecord> components;
+
+        std::vector<MeshRecord> meshes;
+    };
+}
@@ -1,12 +1,17 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
 
 #include "rttr/type.h"
 
+#include "Engine/SceneGraph/Component.hpp"
+
+
+class WorkStealingThreadPool;
 
 namespace scene
 {
@@ -14,16 +19,22 @@ namespace scene
     class Node;
     class Component;
     class SubMesh;
+    class TransformSystem;
+    class SpatialIndex;
+    class System;
+    class SystemScheduler;
 
     /// @brief A collection of nodes organized in a tree structure.
     ///		   It can contain more than one root node.
     class Scene
     {
     public:
-        Scene() = default;
+        Scene();
 
         Scene(const std::string& name);
 
+        ~Scene();
+
         void SetName(const std::string& name);
 
         const std::string& GetName() const;
@@ -34,18 +45,55 @@ namespace scene
 
         void AddNode(std::unique_ptr<Node> node);
 
+        /// @brief Marks the node and its children, they are destroyed by the next FlushDestroyed.
         void MarkNodeForDeletion(Node* node);
 
+        /// @brief Destroys the marked nodes and their components, and recycles their IDs.
+        ///        Called at the end of the frame, no pointer to a marked node may be kept past it.
+        void FlushDestroyed();
+
+        /// @brief Returns a released ID when there is one, so the sparse arrays of the pools stay small.
+        NodeID CreateNodeID();
+
         ComponentManager* GetComponentManager() const;
 
+        TransformSystem& GetTransformSystem();
+
+        /// @brief World space bounds of the nodes that were given some, for culling and picking.
+        SpatialIndex& GetSpatialIndex();
+
+        /// @brief Puts the node into the spatial index with the bounds of its submesh, or takes it out when
+        ///        the node has no submesh with bounds. Called when a submesh is added or given new bounds.
+        void UpdateNodeBounds(Node& node);
+
+        /// @brief Registers a system that runs on every Update, declare its component access on the result.
+        System& AddSystem(const std::string& name, std::function<void(float deltaTime)> function);
+
+        SystemScheduler& GetSystemScheduler();
+
+        /// @brief Runs the systems, destroys the marked nodes, then brings the world matrices and the spatial
+        ///        index up to date.
+        void Update(float deltaTime, WorkStealingThreadPool* threadPool = nullptr);
+
     private:
         std::string name;
 
+        /// Declared before the nodes, their transforms release their handles when they are destroyed
+        std::unique_ptr<TransformSystem> transformSystem;
+
+        std::unique_ptr<SpatialIndex> spatialIndex;
+
+        std::unique_ptr<SystemScheduler> systemScheduler;
+
         /// List of all the nodes
         std::vector<std::unique_ptr<Node>> nodes;
         /// 
         std::unique_ptr<ComponentManager> componentManager;
 
         std::vector<Node*> nodesToDestroy;
+
+        std::vector<NodeID> freeNodeIDs;
+
+        NodeID nextNodeID = 0;
     };
 } // namespace sg
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <variant>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <rttr/type>
+
+#include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Reflection/StaticRefl.hpp"
+
+namespace scene
+{
+    class Material;
+    class Node;
+    class Scene;
+    class SubMesh;
+
+    /// @brief Reads and writes versioned binary scene files.
+    ///
+    /// A file is a header, a table of chunks and the chunks themselves, each 16 byte aligned so their records
+    /// can be read in place from a mapped file:
+    ///   STRS  the names of the nodes, component types and properties
+    ///   NODE  a record per node with its parent and local transform, parents come before their children
+    ///   COMP  one per component type, the property layout, the owner of every component and a fixed size
+    ///         record per component
+    ///   MESH  the node of every mesh next to the node of each of its submeshes
+    /// The layout of a COMP chunk is matched against the registered properties once when the chunk is loaded,
+    /// so loading a component only copies its values into the pool.
+    class SceneSerializer
+    {
+    public:
+        static constexpr uint32_t Version = 1;
+
+        /// @brief A value of a property, the alternatives are in the order of the value kinds of the format.
+        using Value = std::variant<bool, int32_t, uint32_t, int64_t, uint64_t, float, double, glm::vec2, glm::vec3,
+                                   glm::vec4, glm::quat, glm::mat4, std::string>;
+
+        /// @brief Saves the components of type T with the scene. A type with a ReflInfo saves its name and the
+        ///        variables of the ReflInfo through accessors generated from it, any other type falls back to
+        ///        its RTTR properties. Register the types before any scene is saved or loaded, the registry is
+        ///        not guarded against concurrent use. The engine components register themselves at static
+        ///        initialization, registering a type again does nothing.
+        template <typename T>
+        static void RegisterComponent()
+        {
+            std::string typeName;
+            if constexpr (HasReflInfo_Value<T>)
+            {
+                typeName = std::string(ReflInfo<T>::Name);
+            }
+            else
+            {
+                typeName = rttr::type::get<T>().get_name().to_string();
+            }
+            if (FindComponentType(typeName) != nullptr)
+            {
+                return;
+            }
+
+            ComponentType componentType;
+            componentType.name = std::move(typeName);
+            componentType.forEach = [](ComponentManager& manager, const ComponentVisitor& visit)
+            {
+                auto& pool = manager.GetComponentsByClass<T>();
+                for (size_t i = 0; i < pool.size(); i++)
+                {
+                    visit(pool.GetOwnerID(i), pool[i]);
+                }
+            };
+            componentType.add = [](ComponentManager& manager, Node* owner) -> Component&
+            {
+                return *manager.AddComponent<T>(owner);
+            };
+            componentType.contains = [](ComponentManager& manager, NodeID nodeID)
+            {
+                return manager.GetComponentFormNode<T>(nodeID) != nullptr;
+            };
+
+            if constexpr (HasReflInfo_Value<T>)
+            {
+                componentType.properties.push_back({"name", ValueIndex<std::string>,
+                    [](const Component& component) -> Value { return component.GetName(); },
+                    [](Component& component, Value&& value) { component.SetName(std::get<std::string>(value)); }});
+
+                AddReflFields<T>(componentType, "", [](auto& component) -> auto&
+                {
+                    if constexpr (std::is_const_v<std::remove_reference_t<decltype(component)>>)
+                    {
+                        return static_cast<const T&>(component);
+                    }
+                    else
+                    {
+                        return static_cast<T&>(component);
+                    }
+                });
+            }
+            else
+            {
+                AddRttrProperties(componentType, rttr::type::get<T>());
+            }
+            GetComponentTypes().push_back(std::move(componentType));
+        }
+
+        static bool Save(Scene& scene, const std::filesystem::path& path);
+
+        /// @brief Maps the file and builds a new scene from it. Only touches the new scene, so it can run on
+        ///        any thread. Returns nullptr when the file is missing, corrupt or of a newer version.
+        static std::unique_ptr<Scene> Load(const std::filesystem::path& path, const std::string& name);
+
+        static std::unique_ptr<Scene> Load(const uint8_t* data, size_t size, const std::string& name);
+
+        /// @brief Finds the assets the submeshes of a loaded scene refer to.
+        struct AssetResolver
+        {
+            /// The submesh imported from a model, nullptr when the model isn't loaded
+            std::function<const SubMesh*(const std::string& modelPath, uint32_t submeshIndex)> findSubMesh;
+            /// A material by name, for submeshes that don't use the material of their model. Can be empty.
+            std::function<const Material*(const std::string& name)> findMaterial;
+        };
+
+        /// @brief Gives the submeshes of a loaded scene their mesh data, material and shader variant back. Call
+        ///        it on the thread that owns the renderer's assets, once Load returned. Returns the number of
+        ///        submeshes whose model wasn't found.
+        static size_t ResolveSubMeshes(Scene& scene, const AssetResolver& resolver);
+
+        /// @brief Writes a scene file as JSON, for reading and diffing scene files.
+        static bool ExportJson(const std::filesystem::path& path, const std::filesystem::path& jsonPath);
+
+    private:
+        using ComponentVisitor = std::function<void(NodeID, Component&)>;
+
+        /// Index of T in Value, the size of Value when T can't be saved
+        template <typename T, typename... Types>
+        static constexpr size_t IndexOf(const std::variant<Types...>*)
+        {
+            constexpr bool matches[] = {std::is_same_v<T, Types>...};
+            for (size_t i = 0; i < sizeof...(Types); i++)
+            {
+                if (matches[i])
+                {
+                    return i;
+                }
+            }
+            return sizeof...(Types);
+        }
+
+        template <typename T>
+        static constexpr uint32_t ValueIndex = static_cast<uint32_t>(IndexOf<T>(static_cast<const Value*>(nullptr)));
+
+        struct Property
+        {
+            std::string name;
+            /// Index of the alternative of Value, the value kind in the file
+            uint32_t kind;
+            std::function<Value(const Component&)> get;
+            std::function<void(Component&, Value&&)> set;
+        };
+
+        struct ComponentType
+        {
+            std::string name;
+            std::vector<Property> properties;
+            std::function<void(ComponentManager&, const ComponentVisitor&)> forEach;
+            std::function<Component&(ComponentManager&, Node*)> add;
+            /// Whether the node already has a component of the type, a file may not give it a second one
+            std::function<bool(ComponentManager&, NodeID)> contains;
+        };
+
+        /// The variables of the ReflInfo of Struct, reached from the component through access. An enum is saved
+        /// as an int32, a struct with a ReflInfo of its own as a property per variable named "struct.variable",
+        /// variables of other types are skipped
+        template <typename Struct, typename Access>
+        static void AddReflFields(ComponentType& componentType, const std::string& prefix, const Access& access)
+        {
+            ForEachField<Struct>([&componentType, &prefix, &access](const auto& field)
+            {
+                using FieldType = typename std::decay_t<decltype(field)>::Type;
+                const auto pointer = field.Pointer;
+                const auto fieldAccess = [access, pointer](auto& component) -> auto&
+                {
+                    return access(component).*pointer;
+                };
+                std::string name = prefix + std::string(field.Name);
+
+                if constexpr (HasReflInfo_Value<FieldType>)
+                {
+                    AddReflFields<FieldType>(componentType, name + ".", fieldAccess);
+                }
+                else if constexpr (std::is_enum_v<FieldType>)
+                {
+                    componentType.properties.push_back({std::move(name), ValueIndex<int32_t>,
+                        [fieldAccess](const Component& component) -> Value
+                        {
+                            return static_cast<int32_t>(fieldAccess(component));
+                        },
+                        [fieldAccess](Component& component, Value&& value)
+                        {
+                            fieldAccess(component) = static_cast<FieldType>(std::get<int32_t>(value));
+                        }});
+                }
+                else if constexpr (ValueIndex<FieldType> < std::variant_size_v<Value>)
+                {
+                    componentType.properties.push_back({std::move(name), ValueIndex<FieldType>,
+                        [fieldAccess](const Component& component) -> Value
+                        {
+                            return fieldAccess(component);
+                        },
+                        [fieldAccess](Component& component, Value&& value)
+                        {
+                            fieldAccess(component) = std::get<FieldType>(std::move(value));
+                        }});
+                }
+            });
+        }
+
+        /// The dynamic fallback, the writable RTTR properties of a saveable type
+        static void AddRttrProperties(ComponentType& componentType, const rttr::type& type);
+
+        static std::vector<ComponentType>& GetComponentTypes();
+
+        static const ComponentType* FindComponentType(const std::string& typeName);
+    };
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "Engine/SceneGraph/Bounds.hpp"
+#include "Engine/SceneGraph/Component.hpp"
+#include "Engine/SceneGraph/TransformSystem.hpp"
+
+class DynamicBVH;
+
+namespace scene
+{
+    class Node;
+
+    /// @brief Dynamic AABB tree over the world space bounds of the nodes of a scene.
+    ///
+    /// The tree is the DynamicBVH of the physics engine. Its leaves hold the bounds grown by a margin, so a
+    /// node that moves a little stays in its leaf, and only the nodes whose transform changed are looked at
+    /// by Update. Queries append handles to a caller owned array, they test the exact bounds of a leaf only
+    /// when its grown bounds are not inside the query shape.
+    class SpatialIndex
+    {
+    public:
+        using Handle = uint32_t;
+
+        static constexpr Handle InvalidHandle = ~0u;
+
+        /// @param margin How far a node can move before it is reinserted, about what most nodes move in a frame
+        explicit SpatialIndex(float margin = 0.5f);
+
+        ~SpatialIndex();
+
+        /// @brief Adds the node with bounds in its local space, or replaces its bounds when it was added before.
+        Handle SetBounds(Node& node, const AABB& localBounds);
+
+        /// @brief SetBounds for many nodes at once. The new ones are built into a subtree of their own that goes
+        ///        into the tree as a whole, which costs much less than adding them one by one.
+        void AddNodes(Node* const* nodes, const AABB* localBounds, size_t count);
+
+        void Remove(NodeID nodeID);
+
+        void RemoveNodes(const std::vector<NodeID>& nodeIDs);
+
+        Handle Find(NodeID nodeID) const;
+
+        /// @brief Moves the nodes whose world matrix was rebuilt by the last UpdateWorldMatrices.
+        void Update(const TransformSystem& transforms);
+
+        void QueryFrustum(const Frustum& frustum, std::vector<Handle>& results) const;
+
+        void QuerySphere(const glm::vec3& center, float radius, std::vector<Handle>& results) const;
+
+        void QueryAABB(const AABB& box, std::vector<Handle>& results) const;
+
+        /// @brief The hits are sorted by the distance along the ray, nearest first.
+        void QueryRay(const Ray& ray, float maxDistance, std::vector<Handle>& results) const;
+
+        Node* GetNode(Handle handle) const { return proxies[handle].node; }
+
+        const AABB& GetWorldBounds(Handle handle) const { return proxies[handle].worldBounds; }
+
+        const AABB& GetLocalBounds(Handle handle) const { return proxies[handle].localBounds; }
+
+        size_t GetCount() const { return proxies.size() - freeProxies.size(); }
+
+        /// @brief Height of the tree, for tests and statistics.
+        int32_t GetHeight() const;
+
+    private:
+        struct Proxy
+        {
+            Node* node = nullptr;
+            AABB localBounds;
+            AABB worldBounds;
+            /// Leaf of the proxy in the tree
+            int32_t leaf = -1;
+        };
+
+        /// A proxy for the node, which must not have one yet, with no leaf in the tree
+        Handle CreateProxy(Node& node);
+
+        /// Moves the leaf of the proxy when its world bounds left the grown bounds
+        void MoveProxy(Handle handle, const glm::mat4& worldMatrix);
+
+        /// Walks the tree with classify and appends the leaves inside it, or partly inside it and accepted
+        template <typename Classify, typename Accept>
+        void Query(const Classify& classify, const Accept& accept, std::vector<Handle>& results) const;
+
+        std::unique_ptr<DynamicBVH> tree;
+
+        std::vector<Proxy> proxies;
+        std::vector<Handle> freeProxies;
+
+        /// Transform of every proxy, to release its entry in transformProxies
+        std::vector<TransformSystem::Handle> proxyTransforms;
+
+        /// Proxy of every transform, indexed by TransformSystem::Handle, so Update only visits what moved
+        std::vector<Handle> transformProxies;
+
+        /// Proxy of every node, indexed by NodeID
+        std::vector<Handle> nodeProxies;
+    };
+}
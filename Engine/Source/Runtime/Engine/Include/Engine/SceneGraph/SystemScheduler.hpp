@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Engine/SceneGraph/Component.hpp"
+
+class WorkStealingThreadPool;
+
+namespace scene
+{
+    /// @brief A function run once per frame, with the component types it reads and writes.
+    class System
+    {
+    public:
+        using Function = std::function<void(float deltaTime)>;
+
+        System(std::string name, Function function);
+
+        System(const System&) = delete;
+
+        System& operator=(const System&) = delete;
+
+        template <typename... Types>
+        System& Reads()
+        {
+            (reads.push_back(GetComponentTypeID<Types>()), ...);
+            return *this;
+        }
+
+        template <typename... Types>
+        System& Writes()
+        {
+            (writes.push_back(GetComponentTypeID<Types>()), ...);
+            return *this;
+        }
+
+        const std::string& GetName() const;
+
+        /// @brief Whether the two systems can't run at the same time, because one of them writes
+        ///        a component type the other one reads or writes.
+        bool ConflictsWith(const System& other) const;
+
+    private:
+        friend class SystemScheduler;
+
+        std::string name;
+
+        Function function;
+
+        std::vector<ComponentTypeID> reads;
+
+        std::vector<ComponentTypeID> writes;
+    };
+
+    struct SystemTiming
+    {
+        const System* system;
+
+        /// Relative to the start of the frame
+        double startMs;
+
+        double durationMs;
+
+        bool onCriticalPath;
+    };
+
+    /// @brief Runs the systems of a scene once per frame.
+    ///
+    /// Systems run in the order they were added, except that a system only waits for the earlier
+    /// systems it conflicts with. Every frame the scheduler builds that dependency graph and runs the
+    /// systems whose dependencies finished on the thread pool, so systems that touch different
+    /// components run at the same time. Systems must not add or remove nodes or components.
+    ///
+    /// The timings of the last frame include the critical path, the chain of dependent systems that
+    /// took the longest and bounds the frame no matter how many threads there are.
+    class SystemScheduler
+    {
+    public:
+        System& AddSystem(const std::string& name, System::Function function);
+
+        void RemoveSystem(const std::string& name);
+
+        /// @brief Runs every system once, on the calling thread when there is no thread pool.
+        ///
+        /// When systems throw, the others still run and the first exception is rethrown at the end.
+        void Run(float deltaTime, WorkStealingThreadPool* threadPool = nullptr);
+
+        const std::vector<SystemTiming>& GetTimings() const { return timings; }
+
+        double GetFrameMs() const { return frameMs; }
+
+        double GetCriticalPathMs() const { return criticalPathMs; }
+
+    private:
+        void BuildGraph();
+
+        void RunSystem(size_t index, float deltaTime, WorkStealingThreadPool* threadPool);
+
+        void FindCriticalPath();
+
+        std::vector<std::unique_ptr<System>> systems;
+
+        /// Per system, rebuilt by BuildGraph
+        std::vector<std::vector<size_t>> dependencies;
+        std::vector<std::vector<size_t>> dependents;
+        std::unique_ptr<std::atomic<int>[]> remainingDependencies;
+
+        std::atomic<size_t> numPending{0};
+        std::mutex finishedMutex;
+        std::condition_variable finished;
+        /// First exception thrown by a system this frame, guarded by finishedMutex
+        std::exception_ptr error;
+
+        std::chrono::steady_clock::time_point frameStart;
+
+        std::vector<SystemTiming> timings;
+        double frameMs = 0.0;
+        double criticalPathMs = 0.0;
+    };
+}
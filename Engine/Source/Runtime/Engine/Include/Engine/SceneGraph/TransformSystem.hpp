@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/detail/type_quat.hpp>
+
+class WorkStealingThreadPool;
+
+namespace scene
+{
+    /// @brief Scene-wide storage of the local and world transforms of every node.
+    ///
+    /// Nodes refer to their entry through a handle that stays valid for the node's lifetime. The hot data
+    /// (parent, local TRS, world matrix and dirty flag) is kept in flat arrays sorted in depth first order,
+    /// so every parent comes before its children and every subtree is one contiguous range.
+    /// UpdateWorldMatrices is a single pass over those arrays that rebuilds only the world matrices whose
+    /// own or inherited local transform changed, and skips the root subtrees where nothing changed. Root
+    /// subtrees don't depend on each other, the changed ones are spread over the thread pool when one is
+    /// given and they hold enough nodes to be worth it.
+    class TransformSystem
+    {
+    public:
+        using Handle = uint32_t;
+
+        static constexpr Handle InvalidHandle = ~0u;
+
+        Handle Create();
+
+        /// @brief Creates the transforms of a whole subtree with one growth of every array.
+        /// @param parent Parent of the subtree's root, or InvalidHandle for a new root
+        /// @param parents Per transform, the index of its parent in the subtree, InvalidHandle for the root.
+        ///        They are in depth first order, so every parent comes first and every subtree is contiguous.
+        /// @param count Number of transforms
+        /// @param created Receives the count new handles
+        void CreateSubtree(Handle parent, const Handle* parents, size_t count, Handle* created);
+
+        /// @brief Makes room for count transforms, before many are created at once.
+        void Reserve(size_t count);
+
+        /// @brief Releases the handle, its children become roots.
+        void Destroy(Handle handle);
+
+        void SetParent(Handle handle, Handle parent);
+
+        Handle GetParent(Handle handle) const;
+
+        void SetLocal(Handle handle, const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale);
+
+        /// @brief Returns the world matrix, computed from the parents when the node or one of its ancestors
+        ///        changed since the last UpdateWorldMatrices. Reads of nodes elsewhere in the scene stay a lookup.
+        glm::mat4 GetWorldMatrix(Handle handle) const
+        {
+            const uint32_t slot = links[handle].slot;
+            const bool current = !anyDirty || (sorted && !stale[slot]);
+            return current ? worldMatrices[slot] : ComputeWorldMatrix(handle);
+        }
+
+        /// @brief Whether the last UpdateWorldMatrices rebuilt the world matrix of the handle.
+        bool HasChanged(Handle handle) const;
+
+        /// @brief Whether the last UpdateWorldMatrices rebuilt any world matrix.
+        bool AnyChanged() const { return anyChanged; }
+
+        /// @brief The handles whose world matrix the last UpdateWorldMatrices rebuilt, in no particular order.
+        const std::vector<Handle>& GetChangedHandles() const { return changedHandles; }
+
+        /// @brief Rebuilds the world matrices that are out of date. The calling thread runs pool tasks while it
+        ///        waits, so it can be called from a task of the same pool.
+        void UpdateWorldMatrices(WorkStealingThreadPool* threadPool = nullptr);
+
+        /// Nodes of the changed subtrees one pool task updates at least, smaller updates stay on one thread
+        static constexpr size_t MinSlotsPerTask = 4096;
+
+        size_t GetCount() const { return links.size() - freeHandles.size(); }
+
+    private:
+        struct Link
+        {
+            Handle parent = InvalidHandle;
+            Handle firstChild = InvalidHandle;
+            Handle nextSibling = InvalidHandle;
+            Handle prevSibling = InvalidHandle;
+            uint32_t slot = 0;
+        };
+
+        void Unlink(Handle handle);
+
+        void MarkDirty(Handle handle);
+
+        void Sort();
+
+        void UpdateSubtree(size_t subtree);
+
+        /// @brief Clears the changed flags of a subtree nothing was marked dirty in.
+        void ClearSubtree(size_t subtree);
+
+        glm::mat4 ComputeWorldMatrix(Handle handle) const;
+
+        glm::mat4 GetLocalMatrix(uint32_t slot) const;
+
+        /// Per handle, the slot moves when the arrays are sorted
+        std::vector<Link> links;
+        std::vector<Handle> freeHandles;
+
+        /// Per slot, in depth first order after Sort. Slots of destroyed handles hold InvalidHandle until then.
+        std::vector<Handle> handles;
+        std::vector<int32_t> parentSlots;
+        std::vector<glm::vec3> translations;
+        std::vector<glm::quat> rotations;
+        std::vector<glm::vec3> scales;
+        std::vector<glm::mat4> worldMatrices;
+        std::vector<uint8_t> dirty;
+        std::vector<uint8_t> changed;
+
+        /// Per slot, set when the slot or one of its ancestors was marked dirty since the last update. Only kept
+        /// while the arrays are sorted, MarkDirty sets the subtree's range [slot, subtreeEnds[slot]) at once.
+        std::vector<uint8_t> stale;
+        std::vector<uint32_t> subtreeEnds;
+
+        /// [begin, end) slot range of every root subtree
+        std::vector<std::pair<uint32_t, uint32_t>> subtrees;
+
+        /// Per slot, only set for the slot of a root, on behalf of its whole subtree
+        std::vector<uint8_t> dirtySubtrees;
+        std::vector<uint8_t> changedSubtrees;
+
+        bool sorted = true;
+        bool anyDirty = false;
+        bool anyChanged = false;
+
+        /// Subtrees with dirty nodes, the ones an update walks
+        std::vector<uint32_t> dirtySubtreeList;
+
+        /// Collected from the dirty subtrees once they are updated
+        std::vector<Handle> changedHandles;
+
+        std::vector<uint32_t> sortOrder;
+        std::vector<Handle> sortStack;
+    };
+}
@@ -91,6 +91,9 @@ namespace asset
         void ReadMeshDataFromFile(scene::MeshData& mesh_data, const std::string& file_name,
                                   VkBufferUsageFlags additional_buffer_usage_flags = 0);
 
+        // Vertex positions only, nothing is uploaded. Enough to build a convex collider from the mesh.
+        static bool ReadPositionsFromFile(std::vector<glm::vec3>& positions, const std::string& file_name);
+
     private:
         std::vector<Vertex> vertices;
 
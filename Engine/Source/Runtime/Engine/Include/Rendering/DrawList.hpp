@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace vkb
+{
+    /**
+     * @brief The draws of a frame as compact packets in a flat array, sorted by a 64 bit key
+     *
+     * The key orders the packets by pass first and puts the opaque draws before the transparent ones.
+     * Opaque draws are then grouped by pipeline, material and geometry so copies of a mesh end up next to
+     * each other and can be drawn instanced, and go front to back inside a group. Transparent draws go back
+     * to front and only fall back to pipeline and material at equal depth:
+     * @verbatim
+     * opaque       [63-62] pass  [61] 0  [60-45] pipeline  [44-29] material  [28-13] geometry  [12-0] depth
+     * transparent  [63-62] pass  [61] 1  [60-32] ~depth  [31-16] pipeline  [15-0] material
+     * @endverbatim
+     */
+    class DrawList
+    {
+    public:
+        struct Packet
+        {
+            uint64_t key;
+
+            /// Index of the draw in the caller's own list
+            uint32_t index;
+        };
+
+        /**
+         * @brief Run of sorted packets that can go out as one instanced draw
+         */
+        struct Batch
+        {
+            uint32_t first;
+
+            uint32_t count;
+        };
+
+        /**
+         * @brief Builds the key of a draw
+         * @param pass Pass the draw belongs to, 0 to 3
+         * @param transparent Whether the draw is blended and has to be drawn back to front
+         * @param pipeline Id of the pipeline state, ids above 0xFFFF count as 0xFFFF
+         * @param material Id of the material, ids above 0xFFFF count as 0xFFFF
+         * @param geometry Id of the vertex and index buffers, ids above 0xFFFF count as 0xFFFF, unused for
+         *        transparent draws
+         * @param depth Distance from the camera along the view direction, negative depths count as 0
+         */
+        static uint64_t make_key(uint32_t pass, bool transparent, uint32_t pipeline, uint32_t material,
+                                 uint32_t geometry, float depth);
+
+        void clear();
+
+        void reserve(size_t count);
+
+        void add(uint64_t key, uint32_t index);
+
+        /**
+         * @brief Sorts the packets by key with a radix sort, packets with equal keys keep their order
+         */
+        void sort();
+
+        const std::vector<Packet>& get_packets() const;
+
+        /**
+         * @brief Index of the first transparent packet of a sorted list of one pass, the size when there is none
+         */
+        size_t find_first_transparent() const;
+
+        /**
+         * @brief Splits the sorted packets in [first, last) into runs and appends them to batches
+         * @param same_instance Called with two packets next to each other, true when the second one can be
+         *        drawn as another instance of the run of the first one. The keys can't answer that since their
+         *        ids saturate at 16 bits.
+         */
+        template <typename SameInstance>
+        void build_batches(size_t first, size_t last, SameInstance same_instance, std::vector<Batch>& batches) const
+        {
+            for (size_t i = first; i < last; i++)
+            {
+                if (i == first || !same_instance(packets[i - 1], packets[i]))
+                {
+                    batches.push_back({static_cast<uint32_t>(i), 0});
+                }
+                batches.back().count++;
+            }
+        }
+
+    private:
+        std::vector<Packet> packets;
+
+        /// Second buffer of the radix sort, kept so sorting allocates nothing once it is large enough
+        std::vector<Packet> scratch;
+    };
+} // namespace vkb
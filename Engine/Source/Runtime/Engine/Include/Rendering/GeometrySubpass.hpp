@@ -17,12 +17,20 @@
 
 #pragma once
 
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
 #include "Framework/Common/VkError.hpp"
 
 #include "Framework/Common/glmCommon.hpp"
 
 #include "Framework/Rendering/Subpass.hpp"
 
+#include "Engine/SceneGraph/FrustumCuller.hpp"
+#include "Rendering/DrawList.hpp"
+
 namespace scene
 {
     class SubMesh;
@@ -30,8 +38,14 @@ namespace scene
     class Camera;
     class Mesh;
     class Scene;
+    class Material;
+
+    template <typename T>
+    class ComponentPool;
 }
 
+class WorkStealingThreadPool;
+
 namespace vkb
 {
     class CommandBuffer;
@@ -72,6 +86,16 @@ namespace vkb
     class GeometrySubpass : public vkb::Subpass
     {
     public:
+        /**
+         * @brief Submeshes drawn by the last draw, and the draw calls they took once copies were merged
+         */
+        struct DrawStats
+        {
+            size_t submeshes{0};
+
+            size_t draws{0};
+        };
+
         /**
          * @brief Constructs a subpass for the geometry pass of Deferred rendering
          * @param render_context Render context
@@ -88,20 +112,109 @@ namespace vkb
         virtual void prepare() override;
 
         /**
-         * @brief Record draw commands
+         * @brief Culls and sorts the submeshes of the frame into batches and uploads their instances
+         */
+        virtual void prepare_draw() override;
+
+        /**
+         * @brief Record draw commands of the batches prepare_draw sorted
          */
         virtual void draw(vkb::CommandBuffer& command_buffer) override;
 
+        /**
+         * @brief Secondary command buffers once more than one recording thread is set and the batches of the
+         *        frame are enough for two of them, inline otherwise
+         */
+        virtual VkSubpassContents get_subpass_contents() const override;
+
         /**
          * @brief Thread index to use for allocating resources
          */
         void set_thread_index(uint32_t index);
 
+        /**
+         * @brief Number of threads the sorted draws are split over, each records a secondary command buffer on
+         *        the thread pool
+         *
+         * Recording thread i uses the per-thread pools of thread index i + 1 of the render frame, so the render
+         * context has to be prepared with at least count + 1 threads. With 1 the draws are recorded inline, and
+         * so they are while a frame has fewer than 2 * min_batches_per_thread batches.
+         */
+        void set_recording_thread_count(uint32_t count);
+
+        /**
+         * @brief Thread pool the frustum test is spread over, without one it runs on the recording thread
+         */
+        void set_thread_pool(WorkStealingThreadPool* pool);
+
+        /**
+         * @brief Submeshes that passed and failed the frustum test in the last draw
+         */
+        const scene::FrustumCuller::Stats& get_cull_stats() const;
+
+        const DrawStats& get_draw_stats() const;
+
     protected:
+        /**
+         * @brief What a recording thread tracks between the draws it records
+         */
+        struct RecordState
+        {
+            size_t thread_index{0};
+
+            /// Layout bound by the last draw that bound a pipeline, and the vertex inputs of its shaders
+            PipelineLayout* pipeline_layout{nullptr};
+
+            std::vector<ShaderResource> vertex_inputs;
+
+            /// Per-instance model matrix input of the bound vertex shader, null when it reads the model from the
+            /// uniform
+            const ShaderResource* instance_input{nullptr};
+
+            DrawStats stats;
+
+            /// Scratch containers of the draws, kept from frame to frame so recording a draw doesn't allocate
+            std::vector<ShaderModule*> shader_modules;
+
+            VertexInputState vertex_input_state;
+
+            std::vector<std::reference_wrapper<const vkb::Buffer>> vertex_buffers;
+
+            std::vector<VkDeviceSize> vertex_offsets;
+
+            /**
+             * @brief Forgets the bindings and statistics of the last frame, the scratch containers keep their
+             *        memory
+             */
+            void begin(size_t index);
+        };
+
         virtual void update_uniform(vkb::CommandBuffer& command_buffer, scene::Node& node, size_t thread_index);
 
-        void draw_submesh(vkb::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh,
-                          VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE);
+        /**
+         * @brief Records the batches [first, last) of the draw list, opaque ones first and then the transparent
+         *        ones with blending. Each call binds all state again, it can start anywhere in the list.
+         */
+        void record_batches(vkb::CommandBuffer& command_buffer, RecordState& state, size_t first, size_t last);
+
+        void record_batch_range(vkb::CommandBuffer& command_buffer, RecordState& state, size_t first, size_t last,
+                                bool transparent);
+
+        /**
+         * @brief Records the draw of a batch of copies of a submesh
+         *
+         * When the vertex shader reads its model matrix from the per-instance input "instance_model", as
+         * deferred/geometry.vert does, the batch goes out as one instanced draw. Otherwise every copy gets its
+         * own uniform and draw.
+         * @param sub_mesh First submesh of the batch, the others share its geometry, material and pipeline
+         * @param batch Packets of the draw list the copies come from
+         * @param bind_pipeline False when the previous draw used the same shader variant and rasterization state
+         * @param bind_material False when the previous draw used the same material and pipeline, its push
+         *        constants and textures are still bound
+         */
+        void draw_submesh(vkb::CommandBuffer& command_buffer, RecordState& state, scene::SubMesh& sub_mesh,
+                          const DrawList::Batch& batch, VkFrontFace front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+                          bool bind_pipeline = true, bool bind_material = true);
 
         virtual void prepare_pipeline_state(vkb::CommandBuffer& command_buffer, VkFrontFace front_face,
                                             bool double_sided_material);
@@ -111,23 +224,75 @@ namespace vkb
 
         virtual void prepare_push_constants(vkb::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh);
 
-        virtual void draw_submesh_command(vkb::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh);
+        virtual void draw_submesh_command(vkb::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh,
+                                          uint32_t instance_count = 1, uint32_t first_instance = 0);
+
+        /**
+         * @brief Uploads the model matrices of all packets of the draw list in their sorted order, and the camera
+         *        uniform the instanced draws share
+         */
+        void prepare_instances();
 
         /**
-         * @brief Sorts objects based on distance from camera and classifies them
-         *        into opaque and transparent in the arrays provided
+         * @brief Culls the submeshes outside of the camera frustum and sorts the others into the draw list,
+         *        the packets index cull_candidates. Opaque submeshes are grouped by pipeline and material and
+         *        go front-to-back, transparent ones go back-to-front after them.
          */
-        void get_sorted_nodes(std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>& opaque_nodes,
-                              std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>& transparent_nodes);
+        void get_sorted_nodes(DrawList& draw_list);
+
+        VkFrontFace get_front_face(const scene::SubMesh& sub_mesh, bool transparent) const;
 
         scene::Camera& camera;
 
-        std::vector<scene::Mesh>& meshes;
+        scene::ComponentPool<scene::Mesh>& meshes;
 
         scene::Scene& scene;
 
         uint32_t thread_index{0};
 
+        uint32_t recording_thread_count{1};
+
+        /// Every recording thread gets this many batches at least, too little work isn't worth a command buffer
+        static constexpr size_t min_batches_per_thread = 64;
+
+        WorkStealingThreadPool* thread_pool{nullptr};
+
+        /// World bounds of every submesh, filled and tested again every draw
+        scene::FrustumCuller culler;
+
+        /// Submeshes the frustum was tested against, the packets of the draw list index them
+        std::vector<scene::SubMesh*> cull_candidates;
+
+        scene::FrustumCuller::Stats cull_stats;
+
+        DrawList draw_list;
+
+        /// Small ids of the visible pipelines, materials and geometry of the frame, for the fields of the sort keys
+        std::unordered_map<size_t, uint32_t> pipeline_ids;
+
+        std::unordered_map<const scene::Material*, uint32_t> material_ids;
+
+        std::unordered_map<const void*, uint32_t> geometry_ids;
+
+        /// Batches of the whole draw list, the transparent ones start at first_transparent_batch
+        std::vector<DrawList::Batch> draw_batches;
+
+        size_t first_transparent_batch{0};
+
+        std::vector<RecordState> record_states;
+
+        std::vector<std::shared_ptr<vkb::CommandBuffer>> secondary_command_buffers;
+
+        /// Instance buffer and camera uniform of the current draw, a batch starts at its first packet in it
+        BufferAllocation instance_allocation;
+
+        BufferAllocation camera_allocation;
+
+        /// Shader modules get their resource modes set when a layout is prepared, threads take turns
+        std::mutex pipeline_layout_mutex;
+
+        DrawStats draw_stats;
+
         vkb::RasterizationState base_rasterization_state{};
     };
 } // namespace vkb
@@ -30,6 +30,9 @@ namespace scene
     class Node;
     class Light;
     class Scene;
+
+    template <typename T>
+    class ComponentPool;
 }
 
 namespace vkb
@@ -116,6 +119,6 @@ namespace vkb
     scene::Node& add_free_camera(scene::Scene& scene, const std::string& node_name, VkExtent2D extent);
 
 
-    void allocate_lightState(std::vector<scene::Light>& scene_lights,
+    void allocate_lightState(scene::ComponentPool<scene::Light>& scene_lights,
                              size_t max_lights_per_type, vkb::LightingState& lighting_state);
 } // namespace vkb
@@ -7,6 +7,17 @@ namespace scene
     {
     }
 
+    Component::Component(const Component& other) :
+        name(other.name)
+    {
+    }
+
+    Component& Component::operator=(const Component& other)
+    {
+        name = other.name;
+        return *this;
+    }
+
     Component& Component::operator=(Component&& other) noexcept
     {
         if (this != &other)
@@ -18,6 +18,10 @@
 
 #include "Engine/SceneGraph/Components/Light.hpp"
 
+#include <rttr/registration>
+
+#include "Engine/SceneGraph/SceneSerializer.hpp"
+
 
 namespace scene
 {
@@ -31,18 +35,42 @@ namespace scene
     {
     }
 
+    Light::Light(const Light& other)
+        : Component(other),
+          light_type(other.light_type),
+          properties(other.properties)
+    {
+    }
+
+    Light& Light::operator=(const Light& other)
+    {
+        if (this != &other)
+        {
+            Component::operator=(other);
+            node = nullptr;
+            light_type = other.light_type;
+            properties = other.properties;
+        }
+        return *this;
+    }
+
     Light::Light(Light&& other) noexcept
+        : Component(std::move(other)),
+          node(other.node),
+          light_type(other.light_type),
+          properties(other.properties)
     {
-        node = other.node;
-        light_type = other.light_type;
-        properties = other.properties;
     }
 
     Light& Light::operator=(Light&& other) noexcept
     {
-        node = other.node;
-        light_type = other.light_type;
-        properties = other.properties;
+        if (this != &other)
+        {
+            Component::operator=(std::move(other));
+            node = other.node;
+            light_type = other.light_type;
+            properties = other.properties;
+        }
         return *this;
     }
 
@@ -53,7 +81,8 @@ namespace scene
 
     Node* Light::get_node()
     {
-        return node;
+        // A light loaded with a scene only knows the node it was added to
+        return node != nullptr ? node : owner;
     }
 
     void Light::set_light_type(const LightType& type)
@@ -76,3 +105,8 @@ namespace scene
         return properties;
     }
 }
+
+RTTR_REGISTRATION
+{
+    scene::SceneSerializer::RegisterComponent<scene::Light>();
+}
@@ -18,6 +18,13 @@
 
 #include "Engine/SceneGraph/Components/Mesh.hpp"
 
+#include <cassert>
+#include <rttr/registration>
+
+#include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Engine/SceneGraph/Components/SubMesh.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/SceneSerializer.hpp"
 
 namespace scene
 {
@@ -26,18 +33,32 @@ namespace scene
     {
     }
 
+    Mesh::Mesh(const Mesh& other)
+        : Component(other)
+    {
+    }
+
+    Mesh& Mesh::operator=(const Mesh& other)
+    {
+        if (this != &other)
+        {
+            Component::operator=(other);
+            submeshes.clear();
+        }
+        return *this;
+    }
+
     Mesh::Mesh(Mesh&& other) noexcept
         : Component(std::move(other))
           , submeshes(std::move(other.submeshes))
     {
-        SetName(other.GetName());
     }
 
     Mesh& Mesh::operator=(Mesh&& other) noexcept
     {
         if (this != &other)
         {
-            SetName(other.GetName());
+            Component::operator=(std::move(other));
             submeshes = std::move(other.submeshes);
         }
         return *this;
@@ -45,11 +66,38 @@ namespace scene
 
     void Mesh::SetSubmesh(SubMesh& submesh)
     {
-        submeshes.push_back(&submesh);
+        Node* node = submesh.GetOwner();
+        assert(node && "Only submeshes of a node can be added to a mesh");
+
+        // The newest handle, the node keeps the ones of components it had before
+        const ComponentTypeID type = GetComponentTypeID<SubMesh>();
+        const auto& handles = node->GetComponentHandles();
+        for (auto it = handles.rbegin(); it != handles.rend(); ++it)
+        {
+            if (it->type == type)
+            {
+                submeshes.push_back(*it);
+                return;
+            }
+        }
     }
 
-    const std::vector<SubMesh*>& Mesh::GetSubmeshes() const
+    size_t Mesh::GetSubmeshCount() const
     {
-        return submeshes;
+        return submeshes.size();
     }
+
+    SubMesh* Mesh::GetSubmesh(size_t index) const
+    {
+        if (owner == nullptr)
+        {
+            return nullptr;
+        }
+        return owner->GetScene()->GetComponentManager()->GetComponent<SubMesh>(submeshes[index]);
+    }
+}
+
+RTTR_REGISTRATION
+{
+    scene::SceneSerializer::RegisterComponent<scene::Mesh>();
 }
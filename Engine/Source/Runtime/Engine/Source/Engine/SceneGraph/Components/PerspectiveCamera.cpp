@@ -19,6 +19,9 @@
 #include "Engine/SceneGraph/Components/PerspectiveCamera.hpp"
 
 #include <glm/gtc/matrix_transform.hpp>
+#include <rttr/registration>
+
+#include "Engine/SceneGraph/SceneSerializer.hpp"
 
 
 namespace scene
@@ -33,6 +36,25 @@ namespace scene
     {
     }
 
+    PerspectiveCamera::PerspectiveCamera(const PerspectiveCamera& other)
+        : Camera{other},
+          aspect_ratio{other.aspect_ratio},
+          fov{other.fov},
+          far_plane{other.far_plane},
+          near_plane{other.near_plane}
+    {
+    }
+
+    PerspectiveCamera& PerspectiveCamera::operator=(const PerspectiveCamera& other)
+    {
+        Camera::operator=(other);
+        aspect_ratio = other.aspect_ratio;
+        fov = other.fov;
+        far_plane = other.far_plane;
+        near_plane = other.near_plane;
+        return *this;
+    }
+
     PerspectiveCamera::PerspectiveCamera(PerspectiveCamera&& other) noexcept
         : Camera{other.GetName()}
     {
@@ -97,3 +119,8 @@ namespace scene
         return glm::perspective(fov, aspect_ratio, far_plane, near_plane);
     }
 }
+
+RTTR_REGISTRATION
+{
+    scene::SceneSerializer::RegisterComponent<scene::PerspectiveCamera>();
+}
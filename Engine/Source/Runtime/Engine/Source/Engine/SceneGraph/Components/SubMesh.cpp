@@ -17,13 +17,61 @@
 
 
 #include "Engine/SceneGraph/Components/SubMesh.hpp"
+#include "Engine/SceneGraph/Components/Material.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+#include "Engine/SceneGraph/SceneSerializer.hpp"
 
 
 namespace scene
 {
+    SubMesh::SubMesh(const SubMesh& other)
+        : Component(other),
+          meshData(other.meshData),
+          ModelPath(other.ModelPath),
+          SubmeshIndex(other.SubmeshIndex),
+          MaterialName(other.MaterialName),
+          bHasMeshData(other.bHasMeshData),
+          index_type(other.index_type),
+          index_buffer_offset(other.index_buffer_offset),
+          vertices_count(other.vertices_count),
+          index_count(other.index_count),
+          bounds(other.bounds),
+          vertex_attributes(other.vertex_attributes),
+          material(other.material),
+          shader_variant(other.shader_variant)
+    {
+    }
+
+    SubMesh& SubMesh::operator=(const SubMesh& other)
+    {
+        if (this == &other)
+            return *this;
+        Component::operator =(other);
+        meshData = other.meshData;
+        ModelPath = other.ModelPath;
+        SubmeshIndex = other.SubmeshIndex;
+        MaterialName = other.MaterialName;
+        bHasMeshData = other.bHasMeshData;
+        index_type = other.index_type;
+        index_buffer_offset = other.index_buffer_offset;
+        vertices_count = other.vertices_count;
+        index_count = other.index_count;
+        vertex_buffers.clear();
+        index_buffer.reset();
+        bounds = other.bounds;
+        vertex_attributes = other.vertex_attributes;
+        material = other.material;
+        shader_variant = other.shader_variant;
+        return *this;
+    }
+
     SubMesh::SubMesh(SubMesh&& other) noexcept
         : Component(std::move(other)),
+          meshData(other.meshData),
           ModelPath(std::move(other.ModelPath)),
+          SubmeshIndex(other.SubmeshIndex),
+          MaterialName(std::move(other.MaterialName)),
           bHasMeshData(other.bHasMeshData),
           index_type(other.index_type),
           index_buffer_offset(other.index_buffer_offset),
@@ -31,6 +79,7 @@ namespace scene
           index_count(other.index_count),
           vertex_buffers(std::move(other.vertex_buffers)),
           index_buffer(std::move(other.index_buffer)),
+          bounds(other.bounds),
           vertex_attributes(std::move(other.vertex_attributes)),
           material(other.material),
           shader_variant(std::move(other.shader_variant))
@@ -42,7 +91,10 @@ namespace scene
         if (this == &other)
             return *this;
         Component::operator =(std::move(other));
+        meshData = other.meshData;
         ModelPath = std::move(other.ModelPath);
+        SubmeshIndex = other.SubmeshIndex;
+        MaterialName = std::move(other.MaterialName);
         bHasMeshData = other.bHasMeshData;
         index_type = other.index_type;
         index_buffer_offset = other.index_buffer_offset;
@@ -50,6 +102,7 @@ namespace scene
         index_count = other.index_count;
         vertex_buffers = std::move(other.vertex_buffers);
         index_buffer = std::move(other.index_buffer);
+        bounds = other.bounds;
         vertex_attributes = std::move(other.vertex_attributes);
         material = other.material;
         shader_variant = std::move(other.shader_variant);
@@ -83,6 +136,7 @@ namespace scene
     void SubMesh::set_material(const Material& new_material)
     {
         material = &new_material;
+        MaterialName = new_material.GetName();
     }
 
     const Material* SubMesh::get_material() const
@@ -99,6 +153,42 @@ namespace scene
     {
         return shader_variant;
     }
+
+    const AABB& SubMesh::get_bounds() const
+    {
+        return meshData ? meshData->bounds : bounds;
+    }
+
+    void SubMesh::set_bounds(const AABB& new_bounds)
+    {
+        bounds = new_bounds;
+        if (owner)
+        {
+            owner->GetScene()->UpdateNodeBounds(*owner);
+        }
+    }
+
+    void SubMesh::set_mesh_data(MeshData* mesh_data)
+    {
+        meshData = mesh_data;
+        bHasMeshData = mesh_data != nullptr;
+        if (owner)
+        {
+            owner->GetScene()->UpdateNodeBounds(*owner);
+        }
+    }
+
+    void SubMesh::set_asset(const SubMesh& asset)
+    {
+        index_type = asset.index_type;
+        index_buffer_offset = asset.index_buffer_offset;
+        vertices_count = asset.vertices_count;
+        index_count = asset.index_count;
+        vertex_attributes = asset.vertex_attributes;
+        material = asset.material;
+        shader_variant = asset.shader_variant;
+        set_mesh_data(asset.meshData);
+    }
 }
 
 RTTR_REGISTRATION
@@ -106,4 +196,6 @@ RTTR_REGISTRATION
     using namespace rttr;
     registration::class_<scene::SubMesh>("scene::SubMesh")
         .constructor<const std::string&>();
+
+    scene::SceneSerializer::RegisterComponent<scene::SubMesh>();
 }
@@ -21,12 +21,33 @@
 #include <glm/gtx/matrix_decompose.hpp>
 
 #include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
 
 namespace scene
 {
     Transform::Transform(Node& n) :
         node{n}
     {
+        if (auto* scene = n.GetScene())
+        {
+            system = &scene->GetTransformSystem();
+            handle = system->Create();
+        }
+    }
+
+    Transform::Transform(Node& n, TransformSystem& system, TransformSystem::Handle handle) :
+        node{n},
+        system{&system},
+        handle{handle}
+    {
+    }
+
+    Transform::~Transform()
+    {
+        if (system)
+        {
+            system->Destroy(handle);
+        }
     }
 
     Node& Transform::GetNode()
@@ -55,6 +76,16 @@ namespace scene
         InvalidateWorldMatrix();
     }
 
+    void Transform::SetLocal(const glm::vec3& new_translation, const glm::quat& new_rotation,
+                             const glm::vec3& new_scale)
+    {
+        translation = new_translation;
+        rotation = new_rotation;
+        scale = new_scale;
+
+        InvalidateWorldMatrix();
+    }
+
     const glm::vec3& Transform::GetTranslation() const
     {
         return translation;
@@ -88,6 +119,11 @@ namespace scene
 
     glm::mat4 Transform::GetWorldMatrix()
     {
+        if (system)
+        {
+            return system->GetWorldMatrix(handle);
+        }
+
         UpdateWorldTransform();
 
         return world_matrix;
@@ -96,6 +132,30 @@ namespace scene
     void Transform::InvalidateWorldMatrix()
     {
         update_world_matrix = true;
+
+        if (system)
+        {
+            system->SetLocal(handle, translation, rotation, scale);
+        }
+    }
+
+    void Transform::UpdateParent()
+    {
+        if (!system)
+        {
+            return;
+        }
+
+        // A parent in another scene can't be followed, the node is treated as a root
+        auto* parent = node.GetParent();
+        if (parent && parent->GetTransform().system == system)
+        {
+            system->SetParent(handle, parent->GetTransform().handle);
+        }
+        else
+        {
+            system->SetParent(handle, TransformSystem::InvalidHandle);
+        }
     }
 
     // Helper: quat -> euler (degrees)
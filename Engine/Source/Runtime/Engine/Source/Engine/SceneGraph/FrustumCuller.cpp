@@ -0,0 +1,201 @@
+#include "Engine/SceneGraph/FrustumCuller.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+#include "Async/WorkStealingThreadPool.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_CULLER_SSE
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#define FRUSTUM_CULLER_NEON
+#include <arm_neon.h>
+#endif
+
+namespace scene
+{
+    namespace
+    {
+        /// Extents of a box that every plane keeps, for boxes without bounds and the padding
+        constexpr float UnboundedExtent = std::numeric_limits<float>::max();
+
+        /// Bit i is set when box first + i is outside of one of the planes
+        int OutsideMask(const Frustum& frustum, const float* cx, const float* cy, const float* cz, const float* ex,
+                        const float* ey, const float* ez)
+        {
+#if defined(FRUSTUM_CULLER_SSE)
+            const __m128 centerX = _mm_loadu_ps(cx);
+            const __m128 centerY = _mm_loadu_ps(cy);
+            const __m128 centerZ = _mm_loadu_ps(cz);
+            const __m128 extentX = _mm_loadu_ps(ex);
+            const __m128 extentY = _mm_loadu_ps(ey);
+            const __m128 extentZ = _mm_loadu_ps(ez);
+            const __m128 zero = _mm_setzero_ps();
+
+            __m128 outside = zero;
+            for (const glm::vec4& plane : frustum.planes)
+            {
+                // Distance of the centers and the radius of the boxes along the normal, out when both fall short
+                __m128 distance = _mm_add_ps(_mm_mul_ps(centerX, _mm_set1_ps(plane.x)), _mm_set1_ps(plane.w));
+                distance = _mm_add_ps(distance, _mm_mul_ps(centerY, _mm_set1_ps(plane.y)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(centerZ, _mm_set1_ps(plane.z)));
+                __m128 radius = _mm_mul_ps(extentX, _mm_set1_ps(std::abs(plane.x)));
+                radius = _mm_add_ps(radius, _mm_mul_ps(extentY, _mm_set1_ps(std::abs(plane.y))));
+                radius = _mm_add_ps(radius, _mm_mul_ps(extentZ, _mm_set1_ps(std::abs(plane.z))));
+                outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+            }
+            return _mm_movemask_ps(outside);
+#elif defined(FRUSTUM_CULLER_NEON)
+            const float32x4_t centerX = vld1q_f32(cx);
+            const float32x4_t centerY = vld1q_f32(cy);
+            const float32x4_t centerZ = vld1q_f32(cz);
+            const float32x4_t extentX = vld1q_f32(ex);
+            const float32x4_t extentY = vld1q_f32(ey);
+            const float32x4_t extentZ = vld1q_f32(ez);
+            const float32x4_t zero = vdupq_n_f32(0.0f);
+
+            uint32x4_t outside = vdupq_n_u32(0);
+            for (const glm::vec4& plane : frustum.planes)
+            {
+                float32x4_t distance = vmlaq_n_f32(vdupq_n_f32(plane.w), centerX, plane.x);
+                distance = vmlaq_n_f32(distance, centerY, plane.y);
+                distance = vmlaq_n_f32(distance, centerZ, plane.z);
+                float32x4_t radius = vmulq_n_f32(extentX, std::abs(plane.x));
+                radius = vmlaq_n_f32(radius, extentY, std::abs(plane.y));
+                radius = vmlaq_n_f32(radius, extentZ, std::abs(plane.z));
+                outside = vorrq_u32(outside, vcltq_f32(vaddq_f32(distance, radius), zero));
+            }
+            return static_cast<int>((vgetq_lane_u32(outside, 0) & 1) | (vgetq_lane_u32(outside, 1) & 2) |
+                                    (vgetq_lane_u32(outside, 2) & 4) | (vgetq_lane_u32(outside, 3) & 8));
+#else
+            int mask = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                for (const glm::vec4& plane : frustum.planes)
+                {
+                    const float distance = plane.x * cx[i] + plane.y * cy[i] + plane.z * cz[i] + plane.w;
+                    const float radius = std::abs(plane.x) * ex[i] + std::abs(plane.y) * ey[i] +
+                                         std::abs(plane.z) * ez[i];
+                    if (distance + radius < 0.0f)
+                    {
+                        mask |= 1 << i;
+                        break;
+                    }
+                }
+            }
+            return mask;
+#endif
+        }
+    }
+
+    void FrustumCuller::Clear()
+    {
+        count = 0;
+        for (auto* components : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ})
+        {
+            components->clear();
+        }
+    }
+
+    void FrustumCuller::Reserve(size_t capacity)
+    {
+        const size_t padded = (capacity + 3) & ~static_cast<size_t>(3);
+        for (auto* components : {&centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ})
+        {
+            components->reserve(padded);
+        }
+    }
+
+    uint32_t FrustumCuller::Add(const AABB& worldBounds)
+    {
+        // Every group of four is complete, the box replaces the padding or starts a new group
+        if (count % 4 == 0)
+        {
+            centerX.resize(count + 4, 0.0f);
+            centerY.resize(count + 4, 0.0f);
+            centerZ.resize(count + 4, 0.0f);
+            extentX.resize(count + 4, UnboundedExtent);
+            extentY.resize(count + 4, UnboundedExtent);
+            extentZ.resize(count + 4, UnboundedExtent);
+        }
+
+        if (worldBounds.IsValid())
+        {
+            const glm::vec3 center = worldBounds.GetCenter();
+            const glm::vec3 extents = worldBounds.GetExtents();
+            centerX[count] = center.x;
+            centerY[count] = center.y;
+            centerZ[count] = center.z;
+            extentX[count] = extents.x;
+            extentY[count] = extents.y;
+            extentZ[count] = extents.z;
+        }
+        return static_cast<uint32_t>(count++);
+    }
+
+    FrustumCuller::Stats FrustumCuller::Cull(const Frustum& frustum, std::vector<uint8_t>& visible,
+                                             WorkStealingThreadPool* threadPool) const
+    {
+        visible.resize(count);
+        return Cull(frustum, visible.data(), threadPool);
+    }
+
+    FrustumCuller::Stats FrustumCuller::Cull(const Frustum& frustum, uint8_t* visible,
+                                             WorkStealingThreadPool* threadPool) const
+    {
+        Stats stats;
+        if (threadPool == nullptr || count <= ChunkSize)
+        {
+            stats.visible = CullRange(frustum, 0, count, visible);
+        }
+        else
+        {
+            const size_t numChunks = (count + ChunkSize - 1) / ChunkSize;
+            std::atomic<size_t> numPending{numChunks};
+            std::atomic<size_t> numVisible{0};
+            for (size_t chunk = 0; chunk < numChunks; chunk++)
+            {
+                threadPool->Submit([&, chunk]()
+                {
+                    const size_t first = chunk * ChunkSize;
+                    numVisible += CullRange(frustum, first, std::min(first + ChunkSize, count), visible);
+                    numPending--;
+                });
+            }
+
+            // The chunks are short, the calling thread takes its share instead of sleeping
+            while (numPending.load() > 0)
+            {
+                if (!threadPool->RunPendingTask())
+                {
+                    std::this_thread::yield();
+                }
+            }
+            stats.visible = numVisible.load();
+        }
+        stats.culled = count - stats.visible;
+        return stats;
+    }
+
+    size_t FrustumCuller::CullRange(const Frustum& frustum, size_t first, size_t last, uint8_t* visible) const
+    {
+        size_t numVisible = 0;
+        for (size_t group = first; group < last; group += 4)
+        {
+            const int outside = OutsideMask(frustum, &centerX[group], &centerY[group], &centerZ[group],
+                                            &extentX[group], &extentY[group], &extentZ[group]);
+            const size_t end = std::min(group + 4, last);
+            for (size_t i = group; i < end; i++)
+            {
+                const uint8_t isVisible = ((outside >> (i - group)) & 1) == 0 ? 1 : 0;
+                visible[i] = isVisible;
+                numVisible += isVisible;
+            }
+        }
+        return numVisible;
+    }
+}
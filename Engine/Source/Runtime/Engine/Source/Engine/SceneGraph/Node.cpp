@@ -26,8 +26,17 @@ namespace scene
     Node::Node(Scene* scene, std::string name, Node* parent)
         : scene(scene), name(std::move(name)), parent(parent), transform(*this)
     {
+        // Nodes outside of a scene have no components, their IDs don't need to be recycled
         static NodeID nextID = 0;
-        id = nextID++;
+        id = scene ? scene->CreateNodeID() : nextID++;
+
+        transform.UpdateParent();
+    }
+
+    Node::Node(Scene* scene, std::string name, Node* parent, TransformSystem::Handle transformHandle)
+        : scene(scene), id(scene->CreateNodeID()), name(std::move(name)),
+          transform(*this, scene->GetTransformSystem(), transformHandle), parent(parent)
+    {
     }
 
     const NodeID Node::GetID() const
@@ -49,6 +58,7 @@ namespace scene
     {
         parent = &p;
 
+        transform.UpdateParent();
         transform.InvalidateWorldMatrix();
     }
 
@@ -72,6 +82,11 @@ namespace scene
 
     void Node::Destroy()
     {
+        if (isMarkedForDeletion)
+        {
+            return;
+        }
+
         isMarkedForDeletion = true;
         scene->MarkNodeForDeletion(this);
         // 递归标记所有子节点
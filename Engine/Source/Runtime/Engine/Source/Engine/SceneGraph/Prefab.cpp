@@ -0,0 +1,279 @@
+#include "Engine/SceneGraph/Prefab.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "Engine/SceneGraph/Components/Mesh.hpp"
+#include "Engine/SceneGraph/Components/SubMesh.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+#include "Engine/SceneGraph/SpatialIndex.hpp"
+#include "Engine/SceneGraph/TransformSystem.hpp"
+#include "Logging/Logger.hpp"
+
+namespace scene
+{
+    Prefab::Prefab(Node& root)
+    {
+        Scene* scene = root.GetScene();
+        std::vector<Node*> recorded;
+        std::vector<std::pair<Node*, uint32_t>> stack{{&root, NoParent}};
+        while (!stack.empty())
+        {
+            const auto [node, parent] = stack.back();
+            stack.pop_back();
+
+            const auto index = static_cast<uint32_t>(nodes.size());
+            recorded.push_back(node);
+            const Transform& transform = node->GetTransform();
+            nodes.push_back({node->GetName(), parent, 0, 0, transform.GetTranslation(), transform.GetRotation(),
+                             transform.GetScale(), false, AABB()});
+            if (scene)
+            {
+                const SpatialIndex& spatialIndex = scene->GetSpatialIndex();
+                const SpatialIndex::Handle proxy = spatialIndex.Find(node->GetID());
+                if (proxy != SpatialIndex::InvalidHandle)
+                {
+                    nodes[index].hasBounds = true;
+                    nodes[index].localBounds = spatialIndex.GetLocalBounds(proxy);
+                }
+                RecordComponents(*scene->GetComponentManager(), *node, index);
+            }
+
+            const auto& children = node->GetChildren();
+            for (auto child = children.rbegin(); child != children.rend(); ++child)
+            {
+                if (!(*child)->IsMarked())
+                {
+                    stack.emplace_back(child->get(), index);
+                    nodes[index].numChildren++;
+                }
+            }
+        }
+
+        if (scene)
+        {
+            RecordMeshes(*scene->GetComponentManager(), recorded);
+        }
+    }
+
+    void Prefab::RecordComponents(ComponentManager& manager, Node& node, uint32_t index)
+    {
+        for (const auto& handle : node.GetComponentHandles())
+        {
+            const IComponentPool* source = manager.GetPool(handle.type);
+            if (!source || !source->Contains(node.GetID()))
+            {
+                continue;
+            }
+            if (!source->IsCopyable())
+            {
+                LOG_WARN("Prefab of {} skips a component of {} that can't be copied", nodes.front().name,
+                         node.GetName())
+                continue;
+            }
+
+            auto record = std::find_if(components.begin(), components.end(),
+                                       [&handle](const ComponentRecord& r) { return r.type == handle.type; });
+            if (record == components.end())
+            {
+                components.push_back({handle.type, source->CreateEmpty()});
+                record = components.end() - 1;
+            }
+            // A node keeps the handles of the components it lost, only the live one is copied
+            if (!record->pool->Contains(index))
+            {
+                source->CopyComponent(node.GetID(), *record->pool, index);
+                nodes[index].numComponents++;
+            }
+        }
+    }
+
+    void Prefab::RecordMeshes(ComponentManager& manager, const std::vector<Node*>& recorded)
+    {
+        std::unordered_map<NodeID, uint32_t> indices;
+        for (uint32_t i = 0; i < recorded.size(); i++)
+        {
+            indices.emplace(recorded[i]->GetID(), i);
+        }
+
+        const ComponentTypeID meshType = GetComponentTypeID<Mesh>();
+        const ComponentTypeID submeshType = GetComponentTypeID<SubMesh>();
+        for (uint32_t i = 0; i < recorded.size(); i++)
+        {
+            const Mesh* mesh = manager.GetComponentFormNode<Mesh>(recorded[i]->GetID());
+            const uint32_t meshSlot = FindHandleSlot(meshType, i);
+            if (!mesh || meshSlot == NoSlot)
+            {
+                continue;
+            }
+
+            MeshRecord record{{i, meshSlot}, {}};
+            for (size_t s = 0; s < mesh->GetSubmeshCount(); s++)
+            {
+                const SubMesh* submesh = mesh->GetSubmesh(s);
+                if (!submesh)
+                {
+                    continue;
+                }
+                const auto it = indices.find(submesh->GetOwner()->GetID());
+                if (it == indices.end())
+                {
+                    LOG_WARN("Prefab of {} skips a submesh of the mesh of {} outside the prefab", nodes.front().name,
+                             recorded[i]->GetName())
+                    continue;
+                }
+                const uint32_t submeshSlot = FindHandleSlot(submeshType, it->second);
+                if (submeshSlot != NoSlot)
+                {
+                    record.submeshes.push_back({it->second, submeshSlot});
+                }
+            }
+            meshes.push_back(std::move(record));
+        }
+    }
+
+    uint32_t Prefab::FindHandleSlot(ComponentTypeID type, uint32_t node) const
+    {
+        uint32_t slot = 0;
+        for (const auto& record : components)
+        {
+            if (record.pool->Contains(node))
+            {
+                if (record.type == type)
+                {
+                    return slot;
+                }
+                slot++;
+            }
+        }
+        return NoSlot;
+    }
+
+    size_t Prefab::GetComponentCount() const
+    {
+        size_t count = 0;
+        for (const auto& record : components)
+        {
+            count += record.pool->GetSize();
+        }
+        return count;
+    }
+
+    std::vector<Node*> Prefab::Instantiate(Scene& scene, size_t count, Node* parent) const
+    {
+        return Instantiate(scene, count, nullptr, parent);
+    }
+
+    std::vector<Node*> Prefab::Instantiate(Scene& scene, const std::vector<glm::vec3>& translations,
+                                           Node* parent) const
+    {
+        return Instantiate(scene, translations.size(), translations.data(), parent);
+    }
+
+    std::vector<Node*> Prefab::Instantiate(Scene& scene, size_t count, const glm::vec3* translations,
+                                           Node* parent) const
+    {
+        std::vector<Node*> roots;
+        if (count == 0)
+        {
+            return roots;
+        }
+        roots.reserve(count);
+
+        const size_t numNodes = nodes.size();
+        TransformSystem& transforms = scene.GetTransformSystem();
+        transforms.Reserve(transforms.GetCount() + count * numNodes);
+        if (parent)
+        {
+            parent->children.reserve(parent->children.size() + count);
+        }
+
+        // Every pool of the scene grows once, then each copy gets its components right after its nodes
+        // were created, while they are still in the cache
+        ComponentManager& manager = *scene.GetComponentManager();
+        std::vector<IComponentPool*> pools;
+        for (const auto& record : components)
+        {
+            IComponentPool& pool = manager.GetOrCreatePool(record.type, *record.pool);
+            pool.Reserve(pool.GetSize() + record.pool->GetSize() * count);
+            pools.push_back(&pool);
+        }
+
+        // The transforms of a copy are created and linked as one subtree, in the order of the records
+        std::vector<TransformSystem::Handle> parentIndices(numNodes);
+        for (size_t n = 0; n < numNodes; n++)
+        {
+            parentIndices[n] = (nodes[n].parent == NoParent) ? TransformSystem::InvalidHandle : nodes[n].parent;
+        }
+        // A parent in another scene can't be followed, the copies are treated as roots like Node does
+        const TransformSystem::Handle parentHandle =
+            (parent && parent->GetScene() == &scene) ? parent->transform.GetHandle() : TransformSystem::InvalidHandle;
+        std::vector<TransformSystem::Handle> handles(numNodes);
+
+        // The nodes of copy i are created[i * numNodes, (i + 1) * numNodes), in the order of the records
+        std::vector<Node*> created(count * numNodes);
+        for (size_t i = 0; i < count; i++)
+        {
+            transforms.CreateSubtree(parentHandle, parentIndices.data(), numNodes, handles.data());
+
+            Node** block = created.data() + i * numNodes;
+            for (size_t n = 0; n < numNodes; n++)
+            {
+                const NodeRecord& record = nodes[n];
+                Node* nodeParent = (record.parent == NoParent) ? parent : block[record.parent];
+
+                std::unique_ptr<Node> node(new Node(&scene, record.name, nodeParent, handles[n]));
+                node->children.reserve(record.numChildren);
+                node->componentHandles.reserve(record.numComponents);
+                const glm::vec3& translation = (n == 0 && translations) ? translations[i] : record.translation;
+                node->transform.SetLocal(translation, record.rotation, record.scale);
+                block[n] = node.get();
+
+                if (nodeParent)
+                {
+                    nodeParent->children.push_back(std::move(node));
+                }
+                else
+                {
+                    scene.AddNode(std::move(node));
+                }
+            }
+
+            for (size_t p = 0; p < pools.size(); p++)
+            {
+                pools[p]->AddCopies(*components[p].pool, block);
+            }
+            // The handles were just registered, the copies are linked without looking the components up
+            for (const MeshRecord& record : meshes)
+            {
+                const HandleSlot& meshSlot = record.mesh;
+                Mesh* mesh = manager.GetComponent<Mesh>(block[meshSlot.node]->componentHandles[meshSlot.slot]);
+                mesh->submeshes.reserve(record.submeshes.size());
+                for (const HandleSlot& submesh : record.submeshes)
+                {
+                    mesh->submeshes.push_back(block[submesh.node]->componentHandles[submesh.slot]);
+                }
+            }
+            roots.push_back(block[0]);
+        }
+
+        // All the copies go into the spatial index as one subtree
+        std::vector<Node*> boundedNodes;
+        std::vector<AABB> localBounds;
+        for (size_t i = 0; i < count; i++)
+        {
+            for (size_t n = 0; n < numNodes; n++)
+            {
+                if (nodes[n].hasBounds)
+                {
+                    boundedNodes.push_back(created[i * numNodes + n]);
+                    localBounds.push_back(nodes[n].localBounds);
+                }
+            }
+        }
+        scene.GetSpatialIndex().AddNodes(boundedNodes.data(), localBounds.data(), boundedNodes.size());
+
+        return roots;
+    }
+}
@@ -20,15 +20,30 @@
 #include "Engine/SceneGraph/Node.hpp"
 #include "Engine/SceneGraph/Components/SubMesh.hpp"
 #include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Engine/SceneGraph/SpatialIndex.hpp"
+#include "Engine/SceneGraph/SystemScheduler.hpp"
+#include "Engine/SceneGraph/TransformSystem.hpp"
 
 namespace scene
 {
+    Scene::Scene() :
+        transformSystem{std::make_unique<TransformSystem>()},
+        spatialIndex{std::make_unique<SpatialIndex>()},
+        systemScheduler{std::make_unique<SystemScheduler>()}
+    {
+    }
+
     Scene::Scene(const std::string& name) :
-        name{name}
+        name{name},
+        transformSystem{std::make_unique<TransformSystem>()},
+        spatialIndex{std::make_unique<SpatialIndex>()},
+        systemScheduler{std::make_unique<SystemScheduler>()}
     {
         componentManager = std::make_unique<ComponentManager>();
     }
 
+    Scene::~Scene() = default;
+
     void Scene::SetName(const std::string& new_name)
     {
         name = new_name;
@@ -57,14 +72,119 @@ namespace scene
 
     void Scene::MarkNodeForDeletion(Node* node)
     {
-        if (std::find(nodesToDestroy.begin(), nodesToDestroy.end(), node) == nodesToDestroy.end())
+        // Node::Destroy sets the flag before it calls back, so every node is only added once
+        if (!node->isMarkedForDeletion)
+        {
+            node->Destroy();
+            return;
+        }
+        nodesToDestroy.push_back(node);
+    }
+
+    void Scene::FlushDestroyed()
+    {
+        if (nodesToDestroy.empty())
+        {
+            return;
+        }
+
+        std::vector<NodeID> ids;
+        ids.reserve(nodesToDestroy.size());
+        for (Node* node : nodesToDestroy)
+        {
+            ids.push_back(node->GetID());
+        }
+
+        if (componentManager)
+        {
+            componentManager->DestroyComponentsOfNodes(ids);
+        }
+        spatialIndex->RemoveNodes(ids);
+
+        // The children of a marked node go with it, only the parents that stay need to let go of theirs
+        std::vector<Node*> parents;
+        for (Node* node : nodesToDestroy)
+        {
+            Node* parent = node->GetParent();
+            if (parent && !parent->IsMarked())
+            {
+                parents.push_back(parent);
+            }
+        }
+        std::sort(parents.begin(), parents.end());
+        parents.erase(std::unique(parents.begin(), parents.end()), parents.end());
+
+        const auto isMarked = [](const std::unique_ptr<Node>& node) { return node->IsMarked(); };
+        for (Node* parent : parents)
+        {
+            parent->children.erase(std::remove_if(parent->children.begin(), parent->children.end(), isMarked),
+                                   parent->children.end());
+        }
+        nodes.erase(std::remove_if(nodes.begin(), nodes.end(), isMarked), nodes.end());
+
+        freeNodeIDs.insert(freeNodeIDs.end(), ids.begin(), ids.end());
+        nodesToDestroy.clear();
+    }
+
+    NodeID Scene::CreateNodeID()
+    {
+        if (freeNodeIDs.empty())
         {
-            nodesToDestroy.push_back(node);
+            return nextNodeID++;
         }
+
+        const NodeID id = freeNodeIDs.back();
+        freeNodeIDs.pop_back();
+        return id;
     }
 
     ComponentManager* Scene::GetComponentManager() const
     {
         return componentManager.get();
     }
+
+    TransformSystem& Scene::GetTransformSystem()
+    {
+        return *transformSystem;
+    }
+
+    SpatialIndex& Scene::GetSpatialIndex()
+    {
+        return *spatialIndex;
+    }
+
+    void Scene::UpdateNodeBounds(Node& node)
+    {
+        const SubMesh* submesh = componentManager ? componentManager->GetComponentFormNode<SubMesh>(node.GetID())
+                                                  : nullptr;
+        if (submesh && submesh->get_bounds().IsValid())
+        {
+            spatialIndex->SetBounds(node, submesh->get_bounds());
+        }
+        else
+        {
+            spatialIndex->Remove(node.GetID());
+        }
+    }
+
+    System& Scene::AddSystem(const std::string& systemName, std::function<void(float deltaTime)> function)
+    {
+        return systemScheduler->AddSystem(systemName, std::move(function));
+    }
+
+    SystemScheduler& Scene::GetSystemScheduler()
+    {
+        return *systemScheduler;
+    }
+
+    void Scene::Update(float deltaTime, WorkStealingThreadPool* threadPool)
+    {
+        systemScheduler->Run(deltaTime, threadPool);
+
+        // What the systems destroyed is gone before the transforms are sorted and the frame is drawn
+        FlushDestroyed();
+
+        transformSystem->UpdateWorldMatrices(threadPool);
+        spatialIndex->Update(*transformSystem);
+    }
 }
@@ -0,0 +1,1056 @@
+#include "Engine/SceneGraph/SceneSerializer.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <unordered_map>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <nlohmann/json.hpp>
+
+#include "Engine/SceneGraph/Components/Material.hpp"
+#include "Engine/SceneGraph/Components/Mesh.hpp"
+#include "Engine/SceneGraph/Components/SubMesh.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+#include "Logging/Logger.hpp"
+#include "Misc/MappedFile.hpp"
+
+namespace scene
+{
+    namespace
+    {
+        using json = nlohmann::ordered_json;
+
+        constexpr uint32_t MakeFourCC(char a, char b, char c, char d)
+        {
+            return static_cast<uint32_t>(a) | (static_cast<uint32_t>(b) << 8) | (static_cast<uint32_t>(c) << 16) |
+                   (static_cast<uint32_t>(d) << 24);
+        }
+
+        constexpr uint32_t FileMagic = MakeFourCC('V', 'K', 'S', 'C');
+        constexpr uint32_t StringsChunk = MakeFourCC('S', 'T', 'R', 'S');
+        constexpr uint32_t NodesChunk = MakeFourCC('N', 'O', 'D', 'E');
+        constexpr uint32_t ComponentsChunk = MakeFourCC('C', 'O', 'M', 'P');
+        constexpr uint32_t MeshesChunk = MakeFourCC('M', 'E', 'S', 'H');
+
+        constexpr uint32_t NoParent = UINT32_MAX;
+        constexpr size_t ChunkAlignment = 16;
+
+        struct FileHeader
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t numChunks;
+            uint32_t reserved;
+        };
+
+        struct ChunkEntry
+        {
+            uint32_t id;
+            /// Number of records, the strings of STRS, the components of COMP or the links of MESH
+            uint32_t count;
+            uint64_t offset;
+            uint64_t size;
+        };
+
+        struct NodeRecord
+        {
+            uint32_t name;
+            uint32_t parent;
+            float translation[3];
+            /// x, y, z, w
+            float rotation[4];
+            float scale[3];
+        };
+
+        /// A submesh of a mesh, both by the index of the node that owns them
+        struct MeshLink
+        {
+            uint32_t mesh;
+            uint32_t submesh;
+        };
+
+        struct ComponentChunkHeader
+        {
+            uint32_t typeName;
+            uint32_t numProperties;
+            /// Size of the record of a component
+            uint32_t stride;
+            uint32_t reserved;
+        };
+
+        struct PropertyRecord
+        {
+            uint32_t name;
+            uint32_t kind;
+            /// Offset of the value in the record of a component
+            uint32_t offset;
+            uint32_t size;
+        };
+
+        static_assert(sizeof(FileHeader) == 16, "The file header is part of the format");
+        static_assert(sizeof(ChunkEntry) == 24, "The chunk table is part of the format");
+        static_assert(sizeof(NodeRecord) == 48, "The node record is part of the format");
+        static_assert(sizeof(MeshLink) == 8, "The mesh link is part of the format");
+        static_assert(sizeof(ComponentChunkHeader) == 16 && sizeof(PropertyRecord) == 16,
+                      "The component chunk is part of the format");
+
+        /// The property types that can be saved, new kinds are only ever appended
+        enum class ValueKind : uint32_t
+        {
+            Bool,
+            Int32,
+            UInt32,
+            Int64,
+            UInt64,
+            Float,
+            Double,
+            Vec2,
+            Vec3,
+            Vec4,
+            Quat,
+            Mat4,
+            String,
+            Count
+        };
+
+        static_assert(static_cast<size_t>(ValueKind::Count) == std::variant_size_v<SceneSerializer::Value>,
+                      "Every value kind is an alternative of SceneSerializer::Value");
+
+        const char* const ValueKindNames[] = {"bool", "int32", "uint32", "int64", "uint64", "float", "double",
+                                              "vec2", "vec3", "vec4", "quat", "mat4", "string"};
+
+        bool GetValueKind(const rttr::type& type, ValueKind& kind)
+        {
+            static const std::pair<rttr::type, ValueKind> kinds[] = {
+                {rttr::type::get<bool>(), ValueKind::Bool},
+                {rttr::type::get<int32_t>(), ValueKind::Int32},
+                {rttr::type::get<uint32_t>(), ValueKind::UInt32},
+                {rttr::type::get<int64_t>(), ValueKind::Int64},
+                {rttr::type::get<uint64_t>(), ValueKind::UInt64},
+                {rttr::type::get<float>(), ValueKind::Float},
+                {rttr::type::get<double>(), ValueKind::Double},
+                {rttr::type::get<glm::vec2>(), ValueKind::Vec2},
+                {rttr::type::get<glm::vec3>(), ValueKind::Vec3},
+                {rttr::type::get<glm::vec4>(), ValueKind::Vec4},
+                {rttr::type::get<glm::quat>(), ValueKind::Quat},
+                {rttr::type::get<glm::mat4>(), ValueKind::Mat4},
+                {rttr::type::get<std::string>(), ValueKind::String},
+            };
+
+            for (const auto& [kindType, valueKind] : kinds)
+            {
+                if (kindType == type)
+                {
+                    kind = valueKind;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        uint32_t GetValueSize(ValueKind kind)
+        {
+            switch (kind)
+            {
+            case ValueKind::Bool:
+            case ValueKind::Int32:
+            case ValueKind::UInt32:
+            case ValueKind::Float:
+            case ValueKind::String:
+                return 4;
+            case ValueKind::Int64:
+            case ValueKind::UInt64:
+            case ValueKind::Double:
+            case ValueKind::Vec2:
+                return 8;
+            case ValueKind::Vec3:
+                return 12;
+            case ValueKind::Vec4:
+            case ValueKind::Quat:
+                return 16;
+            case ValueKind::Mat4:
+                return 64;
+            default:
+                return 0;
+            }
+        }
+
+        template <typename T>
+        T ReadRaw(const uint8_t* source)
+        {
+            T value;
+            std::memcpy(&value, source, sizeof(T));
+            return value;
+        }
+
+        template <typename T>
+        void WriteRaw(uint8_t* destination, const T& value)
+        {
+            std::memcpy(destination, &value, sizeof(T));
+        }
+
+        size_t AlignUp(size_t value)
+        {
+            return (value + ChunkAlignment - 1) & ~(ChunkAlignment - 1);
+        }
+
+        class StringTable
+        {
+        public:
+            uint32_t Add(const std::string& string)
+            {
+                auto [it, inserted] = indices.emplace(string, static_cast<uint32_t>(strings.size()));
+                if (inserted)
+                {
+                    strings.push_back(string);
+                }
+                return it->second;
+            }
+
+            /// Offsets of the strings, with the end of the last one, then the characters
+            std::vector<uint8_t> Build() const
+            {
+                std::vector<uint8_t> bytes((strings.size() + 1) * sizeof(uint32_t));
+                uint32_t offset = 0;
+                for (size_t i = 0; i < strings.size(); i++)
+                {
+                    WriteRaw(bytes.data() + i * sizeof(uint32_t), offset);
+                    offset += static_cast<uint32_t>(strings[i].size());
+                }
+                WriteRaw(bytes.data() + strings.size() * sizeof(uint32_t), offset);
+
+                for (const auto& string : strings)
+                {
+                    bytes.insert(bytes.end(), string.begin(), string.end());
+                }
+                return bytes;
+            }
+
+            size_t size() const { return strings.size(); }
+
+        private:
+            std::vector<std::string> strings;
+            std::unordered_map<std::string, uint32_t> indices;
+        };
+
+        struct Chunk
+        {
+            uint32_t id;
+            uint32_t count;
+            std::vector<uint8_t> bytes;
+        };
+
+        /// Bounds checked access to the chunks of a file in memory
+        class SceneFile
+        {
+        public:
+            struct ChunkView
+            {
+                const uint8_t* data;
+                size_t size;
+                uint32_t count;
+            };
+
+            bool Parse(const uint8_t* fileData, size_t fileSize)
+            {
+                if (fileSize < sizeof(FileHeader))
+                {
+                    return Fail("file is too small");
+                }
+
+                const auto header = ReadRaw<FileHeader>(fileData);
+                if (header.magic != FileMagic)
+                {
+                    return Fail("not a scene file");
+                }
+                if (header.version > SceneSerializer::Version)
+                {
+                    return Fail("version " + std::to_string(header.version) + " is newer than this build");
+                }
+                version = header.version;
+
+                const size_t tableEnd = sizeof(FileHeader) + size_t(header.numChunks) * sizeof(ChunkEntry);
+                if (tableEnd > fileSize)
+                {
+                    return Fail("chunk table is truncated");
+                }
+
+                for (uint32_t i = 0; i < header.numChunks; i++)
+                {
+                    const auto entry = ReadRaw<ChunkEntry>(fileData + sizeof(FileHeader) + i * sizeof(ChunkEntry));
+                    if (entry.offset > fileSize || entry.size > fileSize - entry.offset)
+                    {
+                        return Fail("chunk is out of the file");
+                    }
+
+                    const ChunkView chunk{fileData + entry.offset, static_cast<size_t>(entry.size), entry.count};
+                    if (entry.id == StringsChunk)
+                    {
+                        strings = chunk;
+                    }
+                    else if (entry.id == NodesChunk)
+                    {
+                        nodes = chunk;
+                    }
+                    else if (entry.id == ComponentsChunk)
+                    {
+                        components.push_back(chunk);
+                    }
+                    else if (entry.id == MeshesChunk)
+                    {
+                        meshLinks = chunk;
+                    }
+                    // Chunks of later versions are skipped
+                }
+
+                const size_t offsetsSize = (size_t(strings.count) + 1) * sizeof(uint32_t);
+                if (strings.size < offsetsSize ||
+                    ReadRaw<uint32_t>(strings.data + strings.count * sizeof(uint32_t)) > strings.size - offsetsSize)
+                {
+                    return Fail("string table is corrupt");
+                }
+
+                // Offsets that never decrease stay below the checked last one, GetString can trust every one
+                uint32_t previousOffset = 0;
+                for (uint32_t i = 0; i <= strings.count; i++)
+                {
+                    const uint32_t offset = ReadRaw<uint32_t>(strings.data + i * sizeof(uint32_t));
+                    if (offset < previousOffset)
+                    {
+                        return Fail("string table is corrupt");
+                    }
+                    previousOffset = offset;
+                }
+                if (nodes.size < size_t(nodes.count) * sizeof(NodeRecord))
+                {
+                    return Fail("node chunk is truncated");
+                }
+                if (meshLinks.size < size_t(meshLinks.count) * sizeof(MeshLink))
+                {
+                    return Fail("mesh chunk is truncated");
+                }
+
+                return true;
+            }
+
+            bool GetString(uint32_t index, std::string& string) const
+            {
+                if (index >= strings.count)
+                {
+                    return false;
+                }
+
+                // Parse checked that the offsets are ordered and end inside the chunk
+                const uint32_t begin = ReadRaw<uint32_t>(strings.data + index * sizeof(uint32_t));
+                const uint32_t end = ReadRaw<uint32_t>(strings.data + (index + 1) * sizeof(uint32_t));
+
+                const uint8_t* characters = strings.data + (size_t(strings.count) + 1) * sizeof(uint32_t);
+                string.assign(reinterpret_cast<const char*>(characters + begin), end - begin);
+                return true;
+            }
+
+            const NodeRecord* GetNodes() const { return reinterpret_cast<const NodeRecord*>(nodes.data); }
+
+            uint32_t GetNodeCount() const { return nodes.count; }
+
+            const std::vector<ChunkView>& GetComponentChunks() const { return components; }
+
+            const MeshLink* GetMeshLinks() const { return reinterpret_cast<const MeshLink*>(meshLinks.data); }
+
+            /// Zero for files saved before meshes kept their submeshes
+            uint32_t GetMeshLinkCount() const { return meshLinks.count; }
+
+            uint32_t GetVersion() const { return version; }
+
+            const std::string& GetError() const { return error; }
+
+        private:
+            bool Fail(const std::string& reason)
+            {
+                error = reason;
+                return false;
+            }
+
+            ChunkView strings{nullptr, 0, 0};
+            ChunkView nodes{nullptr, 0, 0};
+            std::vector<ChunkView> components;
+            ChunkView meshLinks{nullptr, 0, 0};
+            uint32_t version = 0;
+            std::string error;
+        };
+
+        /// The parts of a COMP chunk, checked against its size
+        struct ComponentChunk
+        {
+            ComponentChunkHeader header;
+            const PropertyRecord* properties;
+            const uint32_t* owners;
+            const uint8_t* records;
+        };
+
+        bool ReadComponentChunk(const SceneFile::ChunkView& chunk, ComponentChunk& result)
+        {
+            if (chunk.size < sizeof(ComponentChunkHeader))
+            {
+                return false;
+            }
+            result.header = ReadRaw<ComponentChunkHeader>(chunk.data);
+
+            const size_t propertiesEnd = sizeof(ComponentChunkHeader) +
+                                         size_t(result.header.numProperties) * sizeof(PropertyRecord);
+            const size_t recordsBegin = AlignUp(propertiesEnd + size_t(chunk.count) * sizeof(uint32_t));
+            if (recordsBegin > chunk.size ||
+                size_t(result.header.stride) * chunk.count > chunk.size - recordsBegin)
+            {
+                return false;
+            }
+
+            result.properties = reinterpret_cast<const PropertyRecord*>(chunk.data + sizeof(ComponentChunkHeader));
+            result.owners = reinterpret_cast<const uint32_t*>(chunk.data + propertiesEnd);
+            result.records = chunk.data + recordsBegin;
+
+            for (uint32_t i = 0; i < result.header.numProperties; i++)
+            {
+                const PropertyRecord& property = result.properties[i];
+                if (property.kind >= static_cast<uint32_t>(ValueKind::Count) ||
+                    property.size != GetValueSize(static_cast<ValueKind>(property.kind)) ||
+                    property.offset + size_t(property.size) > result.header.stride)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        void WriteValue(const SceneSerializer::Value& value, uint8_t* destination, StringTable& strings)
+        {
+            switch (static_cast<ValueKind>(value.index()))
+            {
+            case ValueKind::Bool:
+                WriteRaw<uint32_t>(destination, std::get<bool>(value) ? 1 : 0);
+                break;
+            case ValueKind::Quat:
+            {
+                const auto& quat = std::get<glm::quat>(value);
+                WriteRaw(destination, glm::vec4(quat.x, quat.y, quat.z, quat.w));
+                break;
+            }
+            case ValueKind::String:
+                WriteRaw(destination, strings.Add(std::get<std::string>(value)));
+                break;
+            default:
+                std::visit([destination](const auto& alternative)
+                {
+                    if constexpr (std::is_trivially_copyable_v<std::decay_t<decltype(alternative)>>)
+                    {
+                        WriteRaw(destination, alternative);
+                    }
+                }, value);
+                break;
+            }
+        }
+
+        SceneSerializer::Value ReadValue(ValueKind kind, const uint8_t* source, const SceneFile& file)
+        {
+            switch (kind)
+            {
+            case ValueKind::Bool:
+                return ReadRaw<uint32_t>(source) != 0;
+            case ValueKind::Int32:
+                return ReadRaw<int32_t>(source);
+            case ValueKind::UInt32:
+                return ReadRaw<uint32_t>(source);
+            case ValueKind::Int64:
+                return ReadRaw<int64_t>(source);
+            case ValueKind::UInt64:
+                return ReadRaw<uint64_t>(source);
+            case ValueKind::Float:
+                return ReadRaw<float>(source);
+            case ValueKind::Double:
+                return ReadRaw<double>(source);
+            case ValueKind::Vec2:
+                return ReadRaw<glm::vec2>(source);
+            case ValueKind::Vec3:
+                return ReadRaw<glm::vec3>(source);
+            case ValueKind::Vec4:
+                return ReadRaw<glm::vec4>(source);
+            case ValueKind::Quat:
+            {
+                const auto xyzw = ReadRaw<glm::vec4>(source);
+                return glm::quat(xyzw.w, xyzw.x, xyzw.y, xyzw.z);
+            }
+            case ValueKind::Mat4:
+                return ReadRaw<glm::mat4>(source);
+            case ValueKind::String:
+            {
+                std::string string;
+                file.GetString(ReadRaw<uint32_t>(source), string);
+                return string;
+            }
+            default:
+                return {};
+            }
+        }
+
+        /// The value of an RTTR property of the given kind
+        SceneSerializer::Value FromVariant(ValueKind kind, const rttr::variant& value)
+        {
+            switch (kind)
+            {
+            case ValueKind::Bool:
+                return value.get_value<bool>();
+            case ValueKind::Int32:
+                return value.get_value<int32_t>();
+            case ValueKind::UInt32:
+                return value.get_value<uint32_t>();
+            case ValueKind::Int64:
+                return value.get_value<int64_t>();
+            case ValueKind::UInt64:
+                return value.get_value<uint64_t>();
+            case ValueKind::Float:
+                return value.get_value<float>();
+            case ValueKind::Double:
+                return value.get_value<double>();
+            case ValueKind::Vec2:
+                return value.get_value<glm::vec2>();
+            case ValueKind::Vec3:
+                return value.get_value<glm::vec3>();
+            case ValueKind::Vec4:
+                return value.get_value<glm::vec4>();
+            case ValueKind::Quat:
+                return value.get_value<glm::quat>();
+            case ValueKind::Mat4:
+                return value.get_value<glm::mat4>();
+            case ValueKind::String:
+                return value.get_value<std::string>();
+            default:
+                return {};
+            }
+        }
+
+        json ValueToJson(ValueKind kind, const uint8_t* source, const SceneFile& file)
+        {
+            const auto floats = [source](int count)
+            {
+                json array = json::array();
+                for (int i = 0; i < count; i++)
+                {
+                    array.push_back(ReadRaw<float>(source + i * sizeof(float)));
+                }
+                return array;
+            };
+
+            switch (kind)
+            {
+            case ValueKind::Bool:
+                return ReadRaw<uint32_t>(source) != 0;
+            case ValueKind::Int32:
+                return ReadRaw<int32_t>(source);
+            case ValueKind::UInt32:
+                return ReadRaw<uint32_t>(source);
+            case ValueKind::Int64:
+                return ReadRaw<int64_t>(source);
+            case ValueKind::UInt64:
+                return ReadRaw<uint64_t>(source);
+            case ValueKind::Float:
+                return ReadRaw<float>(source);
+            case ValueKind::Double:
+                return ReadRaw<double>(source);
+            case ValueKind::Vec2:
+                return floats(2);
+            case ValueKind::Vec3:
+                return floats(3);
+            case ValueKind::Vec4:
+            case ValueKind::Quat:
+                return floats(4);
+            case ValueKind::Mat4:
+                return floats(16);
+            case ValueKind::String:
+            {
+                std::string string;
+                file.GetString(ReadRaw<uint32_t>(source), string);
+                return string;
+            }
+            default:
+                return nullptr;
+            }
+        }
+
+        json FloatsToJson(const float* values, int count)
+        {
+            return json(std::vector<float>(values, values + count));
+        }
+    }
+
+    void SceneSerializer::AddRttrProperties(ComponentType& componentType, const rttr::type& type)
+    {
+        for (const auto& property : type.get_properties())
+        {
+            ValueKind kind;
+            if (property.is_readonly() || !GetValueKind(property.get_type(), kind))
+            {
+                continue;
+            }
+
+            // rttr::instance finds the derived type of the component through its RTTR_ENABLE
+            componentType.properties.push_back({std::string(property.get_name()), static_cast<uint32_t>(kind),
+                [property, kind](const Component& component)
+                {
+                    return FromVariant(kind, property.get_value(component));
+                },
+                [property](Component& component, Value&& value)
+                {
+                    std::visit([&](auto&& alternative) { property.set_value(component, std::move(alternative)); },
+                               std::move(value));
+                }});
+        }
+    }
+
+    std::vector<SceneSerializer::ComponentType>& SceneSerializer::GetComponentTypes()
+    {
+        static std::vector<ComponentType> componentTypes;
+        return componentTypes;
+    }
+
+    const SceneSerializer::ComponentType* SceneSerializer::FindComponentType(const std::string& typeName)
+    {
+        for (const auto& componentType : GetComponentTypes())
+        {
+            if (componentType.name == typeName)
+            {
+                return &componentType;
+            }
+        }
+        return nullptr;
+    }
+
+    bool SceneSerializer::Save(Scene& scene, const std::filesystem::path& path)
+    {
+        StringTable strings;
+        std::vector<Chunk> chunks;
+
+        // Depth first, so every parent is written before its children
+        std::vector<NodeRecord> nodeRecords;
+        std::unordered_map<NodeID, uint32_t> nodeIndices;
+        std::vector<std::pair<Node*, uint32_t>> stack;
+        const auto& roots = scene.GetNodes();
+        for (auto it = roots.rbegin(); it != roots.rend(); ++it)
+        {
+            stack.emplace_back(it->get(), NoParent);
+        }
+        while (!stack.empty())
+        {
+            auto [node, parent] = stack.back();
+            stack.pop_back();
+            if (node->IsMarked())
+            {
+                continue;
+            }
+
+            const auto index = static_cast<uint32_t>(nodeRecords.size());
+            nodeIndices[node->GetID()] = index;
+
+            const Transform& transform = node->GetTransform();
+            const glm::vec3& translation = transform.GetTranslation();
+            const glm::quat& rotation = transform.GetRotation();
+            const glm::vec3& scale = transform.GetScale();
+
+            NodeRecord record{};
+            record.name = strings.Add(node->GetName());
+            record.parent = parent;
+            std::memcpy(record.translation, &translation, sizeof(record.translation));
+            record.rotation[0] = rotation.x;
+            record.rotation[1] = rotation.y;
+            record.rotation[2] = rotation.z;
+            record.rotation[3] = rotation.w;
+            std::memcpy(record.scale, &scale, sizeof(record.scale));
+            nodeRecords.push_back(record);
+
+            const auto& children = node->GetChildren();
+            for (auto child = children.rbegin(); child != children.rend(); ++child)
+            {
+                stack.emplace_back(child->get(), index);
+            }
+        }
+
+        Chunk nodeChunk{NodesChunk, static_cast<uint32_t>(nodeRecords.size()), {}};
+        nodeChunk.bytes.resize(nodeRecords.size() * sizeof(NodeRecord));
+        std::memcpy(nodeChunk.bytes.data(), nodeRecords.data(), nodeChunk.bytes.size());
+        chunks.push_back(std::move(nodeChunk));
+
+        ComponentManager& componentManager = *scene.GetComponentManager();
+        for (const auto& componentType : GetComponentTypes())
+        {
+            std::vector<PropertyRecord> propertyRecords;
+            uint32_t stride = 0;
+            for (const auto& property : componentType.properties)
+            {
+                const uint32_t size = GetValueSize(static_cast<ValueKind>(property.kind));
+                propertyRecords.push_back({strings.Add(property.name), property.kind, stride, size});
+                stride += size;
+            }
+
+            std::vector<uint32_t> owners;
+            std::vector<uint8_t> records;
+            componentType.forEach(componentManager, [&](NodeID nodeID, Component& component)
+            {
+                auto node = nodeIndices.find(nodeID);
+                if (node == nodeIndices.end())
+                {
+                    return;
+                }
+
+                owners.push_back(node->second);
+                records.resize(records.size() + stride);
+                uint8_t* record = records.data() + records.size() - stride;
+                for (size_t i = 0; i < propertyRecords.size(); i++)
+                {
+                    WriteValue(componentType.properties[i].get(component), record + propertyRecords[i].offset, strings);
+                }
+            });
+
+            if (owners.empty())
+            {
+                continue;
+            }
+
+            const ComponentChunkHeader header{strings.Add(componentType.name),
+                                              static_cast<uint32_t>(propertyRecords.size()), stride, 0};
+
+            Chunk chunk{ComponentsChunk, static_cast<uint32_t>(owners.size()), {}};
+            chunk.bytes.resize(sizeof(header) + propertyRecords.size() * sizeof(PropertyRecord));
+            std::memcpy(chunk.bytes.data(), &header, sizeof(header));
+            std::memcpy(chunk.bytes.data() + sizeof(header), propertyRecords.data(),
+                        propertyRecords.size() * sizeof(PropertyRecord));
+            const auto* ownerBytes = reinterpret_cast<const uint8_t*>(owners.data());
+            chunk.bytes.insert(chunk.bytes.end(), ownerBytes, ownerBytes + owners.size() * sizeof(uint32_t));
+            chunk.bytes.resize(AlignUp(chunk.bytes.size()));
+            chunk.bytes.insert(chunk.bytes.end(), records.begin(), records.end());
+            chunks.push_back(std::move(chunk));
+        }
+
+        // The handles of a mesh are only valid in this scene, its submeshes are saved as the nodes that own them
+        std::vector<MeshLink> meshLinks;
+        auto& meshes = componentManager.GetComponentsByClass<Mesh>();
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            const auto meshNode = nodeIndices.find(meshes.GetOwnerID(i));
+            if (meshNode == nodeIndices.end())
+            {
+                continue;
+            }
+            for (size_t s = 0; s < meshes[i].GetSubmeshCount(); s++)
+            {
+                const SubMesh* submesh = meshes[i].GetSubmesh(s);
+                const auto submeshNode = submesh ? nodeIndices.find(submesh->GetOwner()->GetID()) : nodeIndices.end();
+                if (submeshNode != nodeIndices.end())
+                {
+                    meshLinks.push_back({meshNode->second, submeshNode->second});
+                }
+            }
+        }
+        if (!meshLinks.empty())
+        {
+            Chunk meshChunk{MeshesChunk, static_cast<uint32_t>(meshLinks.size()), {}};
+            meshChunk.bytes.resize(meshLinks.size() * sizeof(MeshLink));
+            std::memcpy(meshChunk.bytes.data(), meshLinks.data(), meshChunk.bytes.size());
+            chunks.push_back(std::move(meshChunk));
+        }
+
+        // Built last, the other chunks add their names to it
+        chunks.insert(chunks.begin(), Chunk{StringsChunk, static_cast<uint32_t>(strings.size()), strings.Build()});
+
+        const FileHeader fileHeader{FileMagic, Version, static_cast<uint32_t>(chunks.size()), 0};
+        std::vector<ChunkEntry> table;
+        size_t offset = AlignUp(sizeof(FileHeader) + chunks.size() * sizeof(ChunkEntry));
+        for (const auto& chunk : chunks)
+        {
+            table.push_back({chunk.id, chunk.count, offset, chunk.bytes.size()});
+            offset = AlignUp(offset + chunk.bytes.size());
+        }
+
+        std::vector<uint8_t> file(offset, 0);
+        std::memcpy(file.data(), &fileHeader, sizeof(fileHeader));
+        std::memcpy(file.data() + sizeof(fileHeader), table.data(), table.size() * sizeof(ChunkEntry));
+        for (size_t i = 0; i < chunks.size(); i++)
+        {
+            std::memcpy(file.data() + table[i].offset, chunks[i].bytes.data(), chunks[i].bytes.size());
+        }
+
+        std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+        if (!stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size())))
+        {
+            LOG_ERROR("Failed to write scene file: {}", path.string())
+            return false;
+        }
+        return true;
+    }
+
+    std::unique_ptr<Scene> SceneSerializer::Load(const std::filesystem::path& path, const std::string& name)
+    {
+        MappedFile file;
+        if (!file.Open(path))
+        {
+            LOG_ERROR("Failed to open scene file: {}", path.string())
+            return nullptr;
+        }
+        return Load(file.GetData(), file.GetSize(), name);
+    }
+
+    std::unique_ptr<Scene> SceneSerializer::Load(const uint8_t* data, size_t size, const std::string& name)
+    {
+        SceneFile file;
+        if (!file.Parse(data, size))
+        {
+            LOG_ERROR("Failed to load scene {}: {}", name, file.GetError())
+            return nullptr;
+        }
+
+        auto scene = std::make_unique<Scene>(name);
+
+        const NodeRecord* records = file.GetNodes();
+        std::vector<Node*> nodes(file.GetNodeCount());
+        std::string nodeName;
+        for (uint32_t i = 0; i < file.GetNodeCount(); i++)
+        {
+            const NodeRecord& record = records[i];
+            file.GetString(record.name, nodeName);
+
+            if (record.parent == NoParent)
+            {
+                auto node = std::make_unique<Node>(scene.get(), nodeName);
+                nodes[i] = node.get();
+                scene->AddNode(std::move(node));
+            }
+            else if (record.parent < i)
+            {
+                nodes[i] = nodes[record.parent]->CreateChild(nodeName);
+            }
+            else
+            {
+                LOG_ERROR("Failed to load scene {}: node {} comes before its parent", name, i)
+                return nullptr;
+            }
+
+            Transform& transform = nodes[i]->GetTransform();
+            transform.SetTranslation(glm::vec3(record.translation[0], record.translation[1], record.translation[2]));
+            transform.SetRotation(glm::quat(record.rotation[3], record.rotation[0], record.rotation[1], record.rotation[2]));
+            transform.SetScale(glm::vec3(record.scale[0], record.scale[1], record.scale[2]));
+        }
+
+        ComponentManager& componentManager = *scene->GetComponentManager();
+        for (const auto& chunkView : file.GetComponentChunks())
+        {
+            ComponentChunk chunk;
+            std::string typeName;
+            if (!ReadComponentChunk(chunkView, chunk) || !file.GetString(chunk.header.typeName, typeName))
+            {
+                LOG_ERROR("Failed to load scene {}: component chunk is corrupt", name)
+                return nullptr;
+            }
+
+            const ComponentType* componentType = FindComponentType(typeName);
+            if (componentType == nullptr)
+            {
+                LOG_WARN("Scene {} has components of unregistered type {}, skipped", name, typeName)
+                continue;
+            }
+
+            // Matched by name once per chunk, properties that were renamed or changed type keep their default
+            struct Binding
+            {
+                const Property* property;
+                uint32_t offset;
+            };
+
+            std::vector<Binding> bindings;
+            std::string propertyName;
+            for (uint32_t i = 0; i < chunk.header.numProperties; i++)
+            {
+                const PropertyRecord& record = chunk.properties[i];
+                file.GetString(record.name, propertyName);
+                const auto property = std::find_if(componentType->properties.begin(), componentType->properties.end(),
+                                                   [&](const Property& p) { return p.name == propertyName; });
+                if (property == componentType->properties.end() || property->kind != record.kind)
+                {
+                    LOG_WARN("Property {}::{} of scene {} doesn't match, skipped", typeName, propertyName, name)
+                    continue;
+                }
+                bindings.push_back({&*property, record.offset});
+            }
+
+            for (uint32_t i = 0; i < chunkView.count; i++)
+            {
+                const uint32_t owner = chunk.owners[i];
+                if (owner >= nodes.size())
+                {
+                    LOG_ERROR("Failed to load scene {}: component owner {} doesn't exist", name, owner)
+                    return nullptr;
+                }
+                if (componentType->contains(componentManager, nodes[owner]->GetID()))
+                {
+                    LOG_ERROR("Failed to load scene {}: node {} has two {} components", name, owner, typeName)
+                    return nullptr;
+                }
+
+                Component& component = componentType->add(componentManager, nodes[owner]);
+                const uint8_t* record = chunk.records + size_t(i) * chunk.header.stride;
+                for (const auto& binding : bindings)
+                {
+                    binding.property->set(component, ReadValue(static_cast<ValueKind>(binding.property->kind),
+                                                               record + binding.offset, file));
+                }
+            }
+        }
+
+        const MeshLink* meshLinks = file.GetMeshLinks();
+        for (uint32_t i = 0; i < file.GetMeshLinkCount(); i++)
+        {
+            const MeshLink& link = meshLinks[i];
+            Mesh* mesh = (link.mesh < nodes.size())
+                ? componentManager.GetComponentFormNode<Mesh>(nodes[link.mesh]->GetID()) : nullptr;
+            SubMesh* submesh = (link.submesh < nodes.size())
+                ? componentManager.GetComponentFormNode<SubMesh>(nodes[link.submesh]->GetID()) : nullptr;
+            if (!mesh || !submesh)
+            {
+                LOG_WARN("Scene {} links a mesh of node {} to a submesh of node {} that aren't there, skipped", name,
+                         link.mesh, link.submesh)
+                continue;
+            }
+            mesh->SetSubmesh(*submesh);
+        }
+
+        // The submeshes are read a property at a time, they go into the spatial index once they are complete
+        for (SubMesh& submesh : componentManager.GetComponentsByClass<SubMesh>())
+        {
+            scene->UpdateNodeBounds(*submesh.GetOwner());
+        }
+
+        return scene;
+    }
+
+    size_t SceneSerializer::ResolveSubMeshes(Scene& scene, const AssetResolver& resolver)
+    {
+        size_t missing = 0;
+        for (SubMesh& submesh : scene.GetComponentManager()->GetComponentsByClass<SubMesh>())
+        {
+            if (submesh.ModelPath.empty())
+            {
+                continue;
+            }
+
+            const SubMesh* asset = resolver.findSubMesh(submesh.ModelPath, submesh.SubmeshIndex);
+            if (!asset)
+            {
+                LOG_WARN("Submesh {} of scene {}: model {} isn't loaded", submesh.GetName(), scene.GetName(),
+                         submesh.ModelPath)
+                missing++;
+                continue;
+            }
+            submesh.set_asset(*asset);
+
+            // set_asset keeps the material name, it differs when the material was swapped after the import
+            const Material* material = submesh.get_material();
+            if (!submesh.MaterialName.empty() && (!material || material->GetName() != submesh.MaterialName))
+            {
+                material = resolver.findMaterial ? resolver.findMaterial(submesh.MaterialName) : nullptr;
+                if (material)
+                {
+                    submesh.set_material(*material);
+                }
+                else
+                {
+                    LOG_WARN("Submesh {} of scene {}: material {} isn't loaded, keeps the one of its model",
+                             submesh.GetName(), scene.GetName(), submesh.MaterialName)
+                }
+            }
+        }
+        return missing;
+    }
+
+    bool SceneSerializer::ExportJson(const std::filesystem::path& path, const std::filesystem::path& jsonPath)
+    {
+        MappedFile mappedFile;
+        SceneFile file;
+        if (!mappedFile.Open(path) || !file.Parse(mappedFile.GetData(), mappedFile.GetSize()))
+        {
+            LOG_ERROR("Failed to read scene file {}: {}", path.string(), file.GetError())
+            return false;
+        }
+
+        json document;
+        document["version"] = file.GetVersion();
+
+        std::string string;
+        json nodes = json::array();
+        const NodeRecord* records = file.GetNodes();
+        for (uint32_t i = 0; i < file.GetNodeCount(); i++)
+        {
+            const NodeRecord& record = records[i];
+            file.GetString(record.name, string);
+
+            json node;
+            node["index"] = i;
+            node["name"] = string;
+            node["parent"] = (record.parent == NoParent) ? json(nullptr) : json(record.parent);
+            node["translation"] = FloatsToJson(record.translation, 3);
+            node["rotation"] = FloatsToJson(record.rotation, 4);
+            node["scale"] = FloatsToJson(record.scale, 3);
+            nodes.push_back(std::move(node));
+        }
+        document["nodes"] = std::move(nodes);
+
+        json components = json::array();
+        for (const auto& chunkView : file.GetComponentChunks())
+        {
+            ComponentChunk chunk;
+            if (!ReadComponentChunk(chunkView, chunk))
+            {
+                LOG_ERROR("Failed to read scene file {}: component chunk is corrupt", path.string())
+                return false;
+            }
+
+            json componentType;
+            file.GetString(chunk.header.typeName, string);
+            componentType["type"] = string;
+
+            json instances = json::array();
+            for (uint32_t i = 0; i < chunkView.count; i++)
+            {
+                const uint8_t* record = chunk.records + size_t(i) * chunk.header.stride;
+                json instance;
+                instance["node"] = chunk.owners[i];
+                for (uint32_t p = 0; p < chunk.header.numProperties; p++)
+                {
+                    const PropertyRecord& property = chunk.properties[p];
+                    const auto kind = static_cast<ValueKind>(property.kind);
+                    file.GetString(property.name, string);
+                    instance[string] = {{"type", ValueKindNames[property.kind]},
+                                        {"value", ValueToJson(kind, record + property.offset, file)}};
+                }
+                instances.push_back(std::move(instance));
+            }
+            componentType["components"] = std::move(instances);
+            components.push_back(std::move(componentType));
+        }
+        document["components"] = std::move(components);
+
+        json meshLinks = json::array();
+        for (uint32_t i = 0; i < file.GetMeshLinkCount(); i++)
+        {
+            meshLinks.push_back({{"mesh", file.GetMeshLinks()[i].mesh}, {"submesh", file.GetMeshLinks()[i].submesh}});
+        }
+        document["meshes"] = std::move(meshLinks);
+
+        std::ofstream stream(jsonPath, std::ios::trunc);
+        if (!(stream << document.dump(4) << '\n'))
+        {
+            LOG_ERROR("Failed to write {}", jsonPath.string())
+            return false;
+        }
+        return true;
+    }
+}
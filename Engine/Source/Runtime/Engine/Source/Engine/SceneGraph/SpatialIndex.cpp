@@ -0,0 +1,266 @@
+#include "Engine/SceneGraph/SpatialIndex.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "DynamicBVH.h"
+#include "Engine/SceneGraph/Node.hpp"
+
+namespace scene
+{
+    namespace
+    {
+        Vec3 ToVec3(const glm::vec3& v)
+        {
+            return Vec3(v.x, v.y, v.z);
+        }
+
+        Bounds ToBounds(const AABB& box)
+        {
+            Bounds bounds;
+            bounds.mins = ToVec3(box.min);
+            bounds.maxs = ToVec3(box.max);
+            return bounds;
+        }
+
+        AABB ToAABB(const Bounds& bounds)
+        {
+            return {glm::vec3(bounds.mins.x, bounds.mins.y, bounds.mins.z),
+                    glm::vec3(bounds.maxs.x, bounds.maxs.y, bounds.maxs.z)};
+        }
+    }
+
+    SpatialIndex::SpatialIndex(float margin) :
+        tree{std::make_unique<DynamicBVH>()}
+    {
+        tree->m_margin = margin;
+    }
+
+    SpatialIndex::~SpatialIndex() = default;
+
+    SpatialIndex::Handle SpatialIndex::SetBounds(Node& node, const AABB& localBounds)
+    {
+        Handle handle = Find(node.GetID());
+        if (handle == InvalidHandle)
+        {
+            handle = CreateProxy(node);
+        }
+
+        proxies[handle].localBounds = localBounds;
+        MoveProxy(handle, node.GetTransform().GetWorldMatrix());
+        return handle;
+    }
+
+    void SpatialIndex::AddNodes(Node* const* nodes, const AABB* localBounds, size_t count)
+    {
+        std::vector<Bounds> treeBounds;
+        std::vector<int> added;
+        treeBounds.reserve(count);
+        added.reserve(count);
+        proxies.reserve(proxies.size() + count);
+        proxyTransforms.reserve(proxyTransforms.size() + count);
+        for (size_t i = 0; i < count; i++)
+        {
+            Node& node = *nodes[i];
+            if (Find(node.GetID()) != InvalidHandle)
+            {
+                SetBounds(node, localBounds[i]);
+                continue;
+            }
+
+            const Handle handle = CreateProxy(node);
+            Proxy& proxy = proxies[handle];
+            proxy.localBounds = localBounds[i];
+            proxy.worldBounds = localBounds[i].Transformed(node.GetTransform().GetWorldMatrix());
+            treeBounds.push_back(ToBounds(proxy.worldBounds));
+            added.push_back(static_cast<int>(handle));
+        }
+
+        std::vector<int> leaves(added.size());
+        tree->CreateProxies(treeBounds.data(), added.data(), static_cast<int>(added.size()), leaves.data());
+        for (size_t i = 0; i < added.size(); i++)
+        {
+            proxies[added[i]].leaf = leaves[i];
+        }
+    }
+
+    SpatialIndex::Handle SpatialIndex::CreateProxy(Node& node)
+    {
+        Handle handle;
+        if (!freeProxies.empty())
+        {
+            handle = freeProxies.back();
+            freeProxies.pop_back();
+        }
+        else
+        {
+            handle = static_cast<Handle>(proxies.size());
+            proxies.emplace_back();
+            proxyTransforms.push_back(TransformSystem::InvalidHandle);
+        }
+
+        const NodeID nodeID = node.GetID();
+        if (nodeID >= nodeProxies.size())
+        {
+            nodeProxies.resize(nodeID + 1, InvalidHandle);
+        }
+        nodeProxies[nodeID] = handle;
+        proxies[handle].node = &node;
+
+        const TransformSystem::Handle transform = node.GetTransform().GetHandle();
+        if (transform >= transformProxies.size())
+        {
+            transformProxies.resize(transform + 1, InvalidHandle);
+        }
+        transformProxies[transform] = handle;
+        proxyTransforms[handle] = transform;
+        return handle;
+    }
+
+    void SpatialIndex::Remove(NodeID nodeID)
+    {
+        const Handle handle = Find(nodeID);
+        if (handle == InvalidHandle)
+        {
+            return;
+        }
+
+        tree->DestroyProxy(proxies[handle].leaf);
+
+        transformProxies[proxyTransforms[handle]] = InvalidHandle;
+        proxies[handle] = Proxy{};
+        proxyTransforms[handle] = TransformSystem::InvalidHandle;
+        freeProxies.push_back(handle);
+        nodeProxies[nodeID] = InvalidHandle;
+    }
+
+    void SpatialIndex::RemoveNodes(const std::vector<NodeID>& nodeIDs)
+    {
+        for (NodeID nodeID : nodeIDs)
+        {
+            Remove(nodeID);
+        }
+    }
+
+    SpatialIndex::Handle SpatialIndex::Find(NodeID nodeID) const
+    {
+        return nodeID < nodeProxies.size() ? nodeProxies[nodeID] : InvalidHandle;
+    }
+
+    void SpatialIndex::Update(const TransformSystem& transforms)
+    {
+        for (const TransformSystem::Handle transform : transforms.GetChangedHandles())
+        {
+            const Handle handle = transform < transformProxies.size() ? transformProxies[transform] : InvalidHandle;
+            if (handle != InvalidHandle)
+            {
+                MoveProxy(handle, transforms.GetWorldMatrix(transform));
+            }
+        }
+    }
+
+    int32_t SpatialIndex::GetHeight() const
+    {
+        return tree->GetHeight();
+    }
+
+    void SpatialIndex::QueryFrustum(const Frustum& frustum, std::vector<Handle>& results) const
+    {
+        Query([&frustum](const AABB& bounds)
+        {
+            switch (frustum.Classify(bounds))
+            {
+            case Frustum::Result::Outside:
+                return DynamicBVH::OVERLAP_NONE;
+            case Frustum::Result::Inside:
+                return DynamicBVH::OVERLAP_FULL;
+            default:
+                return DynamicBVH::OVERLAP_PARTIAL;
+            }
+        }, [&frustum](const AABB& bounds) { return frustum.Overlaps(bounds); }, results);
+    }
+
+    void SpatialIndex::QuerySphere(const glm::vec3& center, float radius, std::vector<Handle>& results) const
+    {
+        const float radiusSquared = radius * radius;
+        Query([&center, radius, radiusSquared](const AABB& bounds)
+        {
+            if (!bounds.Overlaps(center, radius))
+            {
+                return DynamicBVH::OVERLAP_NONE;
+            }
+            // Inside when the farthest corner is
+            const glm::vec3 farthest = glm::max(glm::abs(bounds.min - center), glm::abs(bounds.max - center));
+            return glm::dot(farthest, farthest) <= radiusSquared ? DynamicBVH::OVERLAP_FULL
+                                                                 : DynamicBVH::OVERLAP_PARTIAL;
+        }, [&center, radius](const AABB& bounds) { return bounds.Overlaps(center, radius); }, results);
+    }
+
+    void SpatialIndex::QueryAABB(const AABB& box, std::vector<Handle>& results) const
+    {
+        Query([&box](const AABB& bounds)
+        {
+            if (!box.Overlaps(bounds))
+            {
+                return DynamicBVH::OVERLAP_NONE;
+            }
+            return box.Contains(bounds) ? DynamicBVH::OVERLAP_FULL : DynamicBVH::OVERLAP_PARTIAL;
+        }, [&box](const AABB& bounds) { return box.Overlaps(bounds); }, results);
+    }
+
+    void SpatialIndex::QueryRay(const Ray& ray, float maxDistance, std::vector<Handle>& results) const
+    {
+        std::vector<std::pair<float, Handle>> hits;
+        tree->Visit([&ray, maxDistance](const Bounds& bounds)
+        {
+            return ray.Intersect(ToAABB(bounds), maxDistance) >= 0.0f ? DynamicBVH::OVERLAP_PARTIAL
+                                                                     : DynamicBVH::OVERLAP_NONE;
+        }, [this, &ray, maxDistance, &hits](int userData, bool)
+        {
+            const Handle handle = static_cast<Handle>(userData);
+            const float distance = ray.Intersect(proxies[handle].worldBounds, maxDistance);
+            if (distance >= 0.0f)
+            {
+                hits.emplace_back(distance, handle);
+            }
+        });
+
+        std::sort(hits.begin(), hits.end());
+        for (const auto& hit : hits)
+        {
+            results.push_back(hit.second);
+        }
+    }
+
+    template <typename Classify, typename Accept>
+    void SpatialIndex::Query(const Classify& classify, const Accept& accept, std::vector<Handle>& results) const
+    {
+        // The grown bounds hold the exact ones, a leaf inside the query needs no exact test
+        tree->Visit([&classify](const Bounds& bounds) { return classify(ToAABB(bounds)); },
+                    [this, &accept, &results](int userData, bool inside)
+                    {
+                        const Handle handle = static_cast<Handle>(userData);
+                        if (inside || accept(proxies[handle].worldBounds))
+                        {
+                            results.push_back(handle);
+                        }
+                    });
+    }
+
+    void SpatialIndex::MoveProxy(Handle handle, const glm::mat4& worldMatrix)
+    {
+        Proxy& proxy = proxies[handle];
+        const AABB previous = proxy.worldBounds;
+        proxy.worldBounds = proxy.localBounds.Transformed(worldMatrix);
+
+        if (proxy.leaf == -1)
+        {
+            proxy.leaf = tree->CreateProxy(ToBounds(proxy.worldBounds), static_cast<int>(handle));
+            return;
+        }
+
+        // The tree grows the leaf ahead of where the node is heading
+        tree->MoveProxy(proxy.leaf, ToBounds(proxy.worldBounds),
+                        ToVec3(proxy.worldBounds.GetCenter() - previous.GetCenter()));
+    }
+}
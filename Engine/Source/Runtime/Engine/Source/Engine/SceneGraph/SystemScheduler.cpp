@@ -0,0 +1,215 @@
+#include "Engine/SceneGraph/SystemScheduler.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#include "Async/WorkStealingThreadPool.hpp"
+#include "Memory/FrameAllocator.hpp"
+
+namespace scene
+{
+    namespace
+    {
+        bool Contains(const std::vector<ComponentTypeID>& types, const ComponentTypeID& type)
+        {
+            return std::find(types.begin(), types.end(), type) != types.end();
+        }
+
+        bool Overlaps(const std::vector<ComponentTypeID>& writes, const std::vector<ComponentTypeID>& accessed)
+        {
+            for (const auto& type : writes)
+            {
+                if (Contains(accessed, type))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
+
+    System::System(std::string name, Function function) :
+        name{std::move(name)}, function{std::move(function)}
+    {
+    }
+
+    const std::string& System::GetName() const
+    {
+        return name;
+    }
+
+    bool System::ConflictsWith(const System& other) const
+    {
+        return Overlaps(writes, other.reads) || Overlaps(writes, other.writes) || Overlaps(other.writes, reads);
+    }
+
+    System& SystemScheduler::AddSystem(const std::string& name, System::Function function)
+    {
+        systems.push_back(std::make_unique<System>(name, std::move(function)));
+        return *systems.back();
+    }
+
+    void SystemScheduler::RemoveSystem(const std::string& name)
+    {
+        systems.erase(std::remove_if(systems.begin(), systems.end(),
+                                     [&name](const auto& system) { return system->name == name; }),
+                      systems.end());
+    }
+
+    void SystemScheduler::Run(float deltaTime, WorkStealingThreadPool* threadPool)
+    {
+        // Systems may change their access between frames, the graph is cheap next to the systems
+        BuildGraph();
+
+        frameStart = std::chrono::steady_clock::now();
+        error = nullptr;
+
+        if (threadPool == nullptr)
+        {
+            for (size_t i = 0; i < systems.size(); i++)
+            {
+                RunSystem(i, deltaTime, nullptr);
+            }
+        }
+        else if (!systems.empty())
+        {
+            numPending = systems.size();
+            for (size_t i = 0; i < systems.size(); i++)
+            {
+                remainingDependencies[i] = static_cast<int>(dependencies[i].size());
+            }
+            for (size_t i = 0; i < systems.size(); i++)
+            {
+                if (dependencies[i].empty())
+                {
+                    threadPool->Submit([this, i, deltaTime, threadPool]() { RunSystem(i, deltaTime, threadPool); });
+                }
+            }
+
+            // Help out until there is nothing left to start, then wait for the systems that are still running
+            while (numPending.load() > 0 && threadPool->RunPendingTask())
+            {
+            }
+            std::unique_lock<std::mutex> lock(finishedMutex);
+            finished.wait(lock, [this]() { return numPending.load() == 0; });
+        }
+
+        frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+        FindCriticalPath();
+
+        if (error)
+        {
+            std::rethrow_exception(std::exchange(error, nullptr));
+        }
+    }
+
+    void SystemScheduler::BuildGraph()
+    {
+        // The lists keep their capacity from the last frame, so a graph that didn't change allocates nothing
+        const size_t num = systems.size();
+        if (num > dependencies.size())
+        {
+            remainingDependencies.reset(new std::atomic<int>[num]);
+        }
+        dependencies.resize(num);
+        dependents.resize(num);
+        for (size_t i = 0; i < num; i++)
+        {
+            dependencies[i].clear();
+            dependents[i].clear();
+        }
+        timings.assign(num, SystemTiming{});
+
+        for (size_t i = 0; i < num; i++)
+        {
+            timings[i].system = systems[i].get();
+            for (size_t j = 0; j < i; j++)
+            {
+                if (systems[i]->ConflictsWith(*systems[j]))
+                {
+                    dependencies[i].push_back(j);
+                    dependents[j].push_back(i);
+                }
+            }
+        }
+    }
+
+    void SystemScheduler::RunSystem(size_t index, float deltaTime, WorkStealingThreadPool* threadPool)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // A system that throws still counts as finished, so its dependents run and Run stops waiting.
+        // Run rethrows the first exception once no worker touches the frame's state anymore
+        const auto start = Clock::now();
+        try
+        {
+            systems[index]->function(deltaTime);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(finishedMutex);
+            if (!error)
+            {
+                error = std::current_exception();
+            }
+        }
+        const auto end = Clock::now();
+
+        timings[index].startMs = std::chrono::duration<double, std::milli>(start - frameStart).count();
+        timings[index].durationMs = std::chrono::duration<double, std::milli>(end - start).count();
+
+        if (threadPool == nullptr)
+        {
+            return;
+        }
+
+        for (size_t dependent : dependents[index])
+        {
+            if (remainingDependencies[dependent].fetch_sub(1) == 1)
+            {
+                threadPool->Submit([this, dependent, deltaTime, threadPool]() { RunSystem(dependent, deltaTime, threadPool); });
+            }
+        }
+
+        // Counted down under the lock, Run takes it before it returns, so the scheduler outlives the notify
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        if (numPending.fetch_sub(1) == 1)
+        {
+            finished.notify_all();
+        }
+    }
+
+    void SystemScheduler::FindCriticalPath()
+    {
+        // Longest chain of measured durations through the graph, systems only depend on earlier ones
+        const size_t num = systems.size();
+        LinearArena& frameArena = FrameAllocator::Get();
+        std::pmr::vector<double> finish(num, 0.0, &frameArena);
+        std::pmr::vector<size_t> previous(num, num, &frameArena);
+        size_t last = num;
+        for (size_t i = 0; i < num; i++)
+        {
+            double start = 0.0;
+            for (size_t dependency : dependencies[i])
+            {
+                if (finish[dependency] > start)
+                {
+                    start = finish[dependency];
+                    previous[i] = dependency;
+                }
+            }
+            finish[i] = start + timings[i].durationMs;
+            timings[i].onCriticalPath = false;
+            if (last == num || finish[i] > finish[last])
+            {
+                last = i;
+            }
+        }
+
+        criticalPathMs = (last == num) ? 0.0 : finish[last];
+        for (size_t i = last; i < num; i = previous[i])
+        {
+            timings[i].onCriticalPath = true;
+        }
+    }
+}
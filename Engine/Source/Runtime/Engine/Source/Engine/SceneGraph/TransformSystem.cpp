@@ -0,0 +1,523 @@
+#include "Engine/SceneGraph/TransformSystem.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <thread>
+
+#include <glm/gtc/quaternion.hpp>
+
+#include "Async/WorkStealingThreadPool.hpp"
+
+namespace scene
+{
+    namespace
+    {
+        template <typename T>
+        void Permute(std::vector<T>& values, const std::vector<uint32_t>& order)
+        {
+            std::vector<T> permuted(order.size());
+            for (size_t i = 0; i < order.size(); i++)
+            {
+                permuted[i] = values[order[i]];
+            }
+            values.swap(permuted);
+        }
+    }
+
+    TransformSystem::Handle TransformSystem::Create()
+    {
+        Handle handle;
+        if (!freeHandles.empty())
+        {
+            handle = freeHandles.back();
+            freeHandles.pop_back();
+            links[handle] = Link{};
+        }
+        else
+        {
+            handle = static_cast<Handle>(links.size());
+            links.emplace_back();
+        }
+
+        const auto slot = static_cast<uint32_t>(handles.size());
+        links[handle].slot = slot;
+
+        handles.push_back(handle);
+        parentSlots.push_back(-1);
+        translations.emplace_back(0.0f);
+        rotations.emplace_back(1.0f, 0.0f, 0.0f, 0.0f);
+        scales.emplace_back(1.0f);
+        worldMatrices.emplace_back(1.0f);
+        dirty.push_back(0);
+        changed.push_back(0);
+        stale.push_back(0);
+        subtreeEnds.push_back(slot + 1);
+        dirtySubtrees.push_back(0);
+        changedSubtrees.push_back(0);
+
+        // A new root at the end keeps the arrays in order
+        if (sorted)
+        {
+            subtrees.emplace_back(slot, slot + 1);
+        }
+
+        return handle;
+    }
+
+    void TransformSystem::CreateSubtree(Handle parent, const Handle* parents, size_t count, Handle* created)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        const auto first = static_cast<uint32_t>(handles.size());
+        for (size_t i = 0; i < count; i++)
+        {
+            Handle handle;
+            if (!freeHandles.empty())
+            {
+                handle = freeHandles.back();
+                freeHandles.pop_back();
+                links[handle] = Link{};
+            }
+            else
+            {
+                handle = static_cast<Handle>(links.size());
+                links.emplace_back();
+            }
+            created[i] = handle;
+
+            Link& link = links[handle];
+            link.slot = first + static_cast<uint32_t>(i);
+            link.parent = (parents[i] == InvalidHandle) ? parent : created[parents[i]];
+            if (link.parent != InvalidHandle)
+            {
+                link.nextSibling = links[link.parent].firstChild;
+                if (link.nextSibling != InvalidHandle)
+                {
+                    links[link.nextSibling].prevSibling = handle;
+                }
+                links[link.parent].firstChild = handle;
+            }
+        }
+
+        const size_t size = first + count;
+        handles.insert(handles.end(), created, created + count);
+        parentSlots.resize(size, -1);
+        for (size_t i = 1; i < count; i++)
+        {
+            parentSlots[first + i] = static_cast<int32_t>(first + parents[i]);
+        }
+        translations.resize(size, glm::vec3(0.0f));
+        rotations.resize(size, glm::quat(1.0f, 0.0f, 0.0f, 0.0f));
+        scales.resize(size, glm::vec3(1.0f));
+        worldMatrices.resize(size, glm::mat4(1.0f));
+        dirty.resize(size, 1);
+        changed.resize(size, 0);
+        stale.resize(size, 1);
+        subtreeEnds.resize(size);
+        for (size_t i = 0; i < count; i++)
+        {
+            subtreeEnds[first + i] = static_cast<uint32_t>(first + i + 1);
+        }
+        for (size_t i = count - 1; i > 0; i--)
+        {
+            subtreeEnds[first + parents[i]] = std::max(subtreeEnds[first + parents[i]], subtreeEnds[first + i]);
+        }
+        dirtySubtrees.resize(size, 0);
+        changedSubtrees.resize(size, 0);
+
+        if (parent == InvalidHandle)
+        {
+            // Already depth first, a new root subtree at the end keeps the arrays in order
+            if (sorted)
+            {
+                subtrees.emplace_back(first, static_cast<uint32_t>(size));
+            }
+            dirtySubtrees[first] = 1;
+            anyDirty = true;
+        }
+        else
+        {
+            MarkDirty(created[0]);
+            sorted = false;
+        }
+    }
+
+    void TransformSystem::Reserve(size_t count)
+    {
+        links.reserve(count);
+        handles.reserve(count);
+        parentSlots.reserve(count);
+        translations.reserve(count);
+        rotations.reserve(count);
+        scales.reserve(count);
+        worldMatrices.reserve(count);
+        dirty.reserve(count);
+        changed.reserve(count);
+        stale.reserve(count);
+        subtreeEnds.reserve(count);
+        dirtySubtrees.reserve(count);
+        changedSubtrees.reserve(count);
+    }
+
+    void TransformSystem::Destroy(Handle handle)
+    {
+        // The children keep their local transform, it is now relative to the world
+        Handle child = links[handle].firstChild;
+        while (child != InvalidHandle)
+        {
+            const Handle next = links[child].nextSibling;
+            links[child].parent = InvalidHandle;
+            links[child].prevSibling = InvalidHandle;
+            links[child].nextSibling = InvalidHandle;
+            MarkDirty(child);
+            child = next;
+        }
+        links[handle].firstChild = InvalidHandle;
+
+        Unlink(handle);
+
+        handles[links[handle].slot] = InvalidHandle;
+        freeHandles.push_back(handle);
+        sorted = false;
+    }
+
+    void TransformSystem::SetParent(Handle handle, Handle parent)
+    {
+        if (links[handle].parent == parent)
+        {
+            return;
+        }
+
+#ifndef NDEBUG
+        for (Handle ancestor = parent; ancestor != InvalidHandle; ancestor = links[ancestor].parent)
+        {
+            assert(ancestor != handle && "A node can't be parented to its own descendant");
+        }
+#endif
+
+        Unlink(handle);
+
+        if (parent != InvalidHandle)
+        {
+            Link& link = links[handle];
+            link.parent = parent;
+            link.nextSibling = links[parent].firstChild;
+            if (link.nextSibling != InvalidHandle)
+            {
+                links[link.nextSibling].prevSibling = handle;
+            }
+            links[parent].firstChild = handle;
+        }
+
+        MarkDirty(handle);
+        sorted = false;
+    }
+
+    TransformSystem::Handle TransformSystem::GetParent(Handle handle) const
+    {
+        return links[handle].parent;
+    }
+
+    void TransformSystem::SetLocal(Handle handle, const glm::vec3& translation, const glm::quat& rotation,
+                                   const glm::vec3& scale)
+    {
+        const uint32_t slot = links[handle].slot;
+        translations[slot] = translation;
+        rotations[slot] = rotation;
+        scales[slot] = scale;
+
+        MarkDirty(handle);
+    }
+
+    glm::mat4 TransformSystem::ComputeWorldMatrix(Handle handle) const
+    {
+        const uint32_t slot = links[handle].slot;
+
+        // Something changed since the last update, the cached matrix is only stale when it changed on the way up
+        bool outOfDate = false;
+        for (Handle ancestor = handle; ancestor != InvalidHandle && !outOfDate; ancestor = links[ancestor].parent)
+        {
+            outOfDate = dirty[links[ancestor].slot] != 0;
+        }
+        if (!outOfDate)
+        {
+            return worldMatrices[slot];
+        }
+
+        glm::mat4 world = GetLocalMatrix(slot);
+        for (Handle ancestor = links[handle].parent; ancestor != InvalidHandle; ancestor = links[ancestor].parent)
+        {
+            world = GetLocalMatrix(links[ancestor].slot) * world;
+        }
+        return world;
+    }
+
+    bool TransformSystem::HasChanged(Handle handle) const
+    {
+        return changed[links[handle].slot] != 0;
+    }
+
+    void TransformSystem::UpdateWorldMatrices(WorkStealingThreadPool* threadPool)
+    {
+        if (!sorted)
+        {
+            Sort();
+        }
+
+        // The changed flags of the last update still have to be cleared
+        if (!anyDirty && !anyChanged)
+        {
+            return;
+        }
+
+        // Usually only a few subtrees moved, they are the only ones walked
+        dirtySubtreeList.clear();
+        size_t dirtySlots = 0;
+        for (size_t i = 0; i < subtrees.size(); i++)
+        {
+            if (dirtySubtrees[subtrees[i].first])
+            {
+                dirtySubtreeList.push_back(static_cast<uint32_t>(i));
+                dirtySlots += subtrees[i].second - subtrees[i].first;
+            }
+            else
+            {
+                ClearSubtree(i);
+            }
+        }
+
+        if (threadPool == nullptr || dirtySlots < 2 * MinSlotsPerTask)
+        {
+            for (uint32_t subtree : dirtySubtreeList)
+            {
+                UpdateSubtree(subtree);
+            }
+        }
+        else
+        {
+            std::atomic<size_t> numPending{0};
+            size_t begin = 0;
+            size_t slots = 0;
+            for (size_t i = 0; i < dirtySubtreeList.size(); i++)
+            {
+                const auto& range = subtrees[dirtySubtreeList[i]];
+                slots += range.second - range.first;
+                if (slots < MinSlotsPerTask && i + 1 < dirtySubtreeList.size())
+                {
+                    continue;
+                }
+
+                const size_t end = i + 1;
+                numPending++;
+                threadPool->Submit([this, &numPending, begin, end]()
+                {
+                    for (size_t j = begin; j < end; j++)
+                    {
+                        UpdateSubtree(dirtySubtreeList[j]);
+                    }
+                    numPending--;
+                });
+                begin = end;
+                slots = 0;
+            }
+
+            // The calling thread may be a worker of the pool itself, it helps instead of blocking
+            while (numPending.load() > 0)
+            {
+                if (!threadPool->RunPendingTask())
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+
+        // Only the walked subtrees can hold changed slots
+        changedHandles.clear();
+        for (uint32_t subtree : dirtySubtreeList)
+        {
+            for (uint32_t slot = subtrees[subtree].first; slot < subtrees[subtree].second; slot++)
+            {
+                if (changed[slot])
+                {
+                    changedHandles.push_back(handles[slot]);
+                }
+            }
+        }
+
+        anyChanged = anyDirty;
+        anyDirty = false;
+    }
+
+    void TransformSystem::Unlink(Handle handle)
+    {
+        Link& link = links[handle];
+        if (link.prevSibling != InvalidHandle)
+        {
+            links[link.prevSibling].nextSibling = link.nextSibling;
+        }
+        else if (link.parent != InvalidHandle)
+        {
+            links[link.parent].firstChild = link.nextSibling;
+        }
+        if (link.nextSibling != InvalidHandle)
+        {
+            links[link.nextSibling].prevSibling = link.prevSibling;
+        }
+
+        link.parent = InvalidHandle;
+        link.prevSibling = InvalidHandle;
+        link.nextSibling = InvalidHandle;
+    }
+
+    void TransformSystem::MarkDirty(Handle handle)
+    {
+        const uint32_t slot = links[handle].slot;
+        dirty[slot] = 1;
+        anyDirty = true;
+
+        // A stale slot had its whole subtree marked already, by itself or an ancestor
+        if (sorted && !stale[slot])
+        {
+            std::fill(stale.begin() + slot, stale.begin() + subtreeEnds[slot], 1);
+        }
+
+        Handle root = handle;
+        while (links[root].parent != InvalidHandle)
+        {
+            root = links[root].parent;
+        }
+        dirtySubtrees[links[root].slot] = 1;
+    }
+
+    void TransformSystem::Sort()
+    {
+        // Depth first from every root, the roots keep their current order
+        sortOrder.clear();
+        subtrees.clear();
+        for (size_t slot = 0; slot < handles.size(); slot++)
+        {
+            const Handle root = handles[slot];
+            if (root == InvalidHandle || links[root].parent != InvalidHandle)
+            {
+                continue;
+            }
+
+            const auto begin = static_cast<uint32_t>(sortOrder.size());
+            sortStack.push_back(root);
+            while (!sortStack.empty())
+            {
+                const Handle handle = sortStack.back();
+                sortStack.pop_back();
+                sortOrder.push_back(links[handle].slot);
+
+                for (Handle child = links[handle].firstChild; child != InvalidHandle; child = links[child].nextSibling)
+                {
+                    sortStack.push_back(child);
+                }
+            }
+            subtrees.emplace_back(begin, static_cast<uint32_t>(sortOrder.size()));
+        }
+
+        Permute(handles, sortOrder);
+        Permute(translations, sortOrder);
+        Permute(rotations, sortOrder);
+        Permute(scales, sortOrder);
+        Permute(worldMatrices, sortOrder);
+        Permute(dirty, sortOrder);
+        Permute(changed, sortOrder);
+
+        for (size_t slot = 0; slot < handles.size(); slot++)
+        {
+            links[handles[slot]].slot = static_cast<uint32_t>(slot);
+        }
+
+        parentSlots.resize(handles.size());
+        for (size_t slot = 0; slot < handles.size(); slot++)
+        {
+            const Handle parent = links[handles[slot]].parent;
+            parentSlots[slot] = (parent == InvalidHandle) ? -1 : static_cast<int32_t>(links[parent].slot);
+        }
+
+        // Children come after their parent, going backwards every subtree is complete before its parent's
+        subtreeEnds.resize(handles.size());
+        for (size_t slot = 0; slot < handles.size(); slot++)
+        {
+            subtreeEnds[slot] = static_cast<uint32_t>(slot + 1);
+        }
+        for (size_t slot = handles.size(); slot-- > 0;)
+        {
+            if (parentSlots[slot] >= 0)
+            {
+                subtreeEnds[parentSlots[slot]] = std::max(subtreeEnds[parentSlots[slot]], subtreeEnds[slot]);
+            }
+        }
+        stale.resize(handles.size());
+        for (size_t slot = 0; slot < handles.size(); slot++)
+        {
+            const int32_t parent = parentSlots[slot];
+            stale[slot] = (dirty[slot] || (parent >= 0 && stale[parent])) ? 1 : 0;
+        }
+
+        // The subtrees were cut and joined, go over all of them once
+        dirtySubtrees.assign(handles.size(), 1);
+        changedSubtrees.assign(handles.size(), 1);
+
+        sorted = true;
+    }
+
+    void TransformSystem::UpdateSubtree(size_t subtree)
+    {
+        const uint32_t first = subtrees[subtree].first;
+        const uint32_t last = subtrees[subtree].second;
+        if (!dirtySubtrees[first])
+        {
+            ClearSubtree(subtree);
+            return;
+        }
+
+        for (uint32_t slot = first; slot < last; slot++)
+        {
+            // Parents come first, so their flag for this update is already known
+            const int32_t parent = parentSlots[slot];
+            const bool update = dirty[slot] || (parent >= 0 && changed[parent]);
+            changed[slot] = update ? 1 : 0;
+            dirty[slot] = 0;
+            stale[slot] = 0;
+            if (!update)
+            {
+                continue;
+            }
+
+            const glm::mat4 local = GetLocalMatrix(slot);
+            worldMatrices[slot] = (parent >= 0) ? worldMatrices[parent] * local : local;
+        }
+
+        dirtySubtrees[first] = 0;
+        changedSubtrees[first] = 1;
+    }
+
+    void TransformSystem::ClearSubtree(size_t subtree)
+    {
+        const uint32_t first = subtrees[subtree].first;
+        if (changedSubtrees[first])
+        {
+            std::fill(changed.begin() + first, changed.begin() + subtrees[subtree].second, 0);
+            changedSubtrees[first] = 0;
+        }
+    }
+
+    glm::mat4 TransformSystem::GetLocalMatrix(uint32_t slot) const
+    {
+        // Same as translate * rotate * scale, without the two matrix products
+        glm::mat4 local = glm::mat4_cast(rotations[slot]);
+        local[0] *= scales[slot].x;
+        local[1] *= scales[slot].y;
+        local[2] *= scales[slot].z;
+        local[3] = glm::vec4(translations[slot], 1.0f);
+        return local;
+    }
+}
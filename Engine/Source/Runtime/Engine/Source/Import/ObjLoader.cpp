@@ -72,6 +72,11 @@ namespace asset
             }
         }
 
+        for (const Vertex& vertex : vertices)
+        {
+            sub_mesh->bounds.Merge(vertex.pos);
+        }
+
         sub_mesh->vertices_count = vertices.size();
         sub_mesh->index_type = VK_INDEX_TYPE_UINT32;
         sub_mesh->index_count = indices.size();
@@ -184,6 +189,7 @@ namespace asset
                     uint32_t index = static_cast<uint32_t>(vertices.size());
                     uniqueVertices[vertex] = index;
                     vertices.push_back(vertex);
+                    mesh_data.bounds.Merge(vertex.pos);
                 }
 
                 indices.push_back(uniqueVertices[vertex]);
@@ -277,4 +283,27 @@ namespace asset
         device.get_fence_pool().reset();
         device.get_command_pool().reset_pool();
     }
+
+    bool ObjLoader::ReadPositionsFromFile(std::vector<glm::vec3>& positions, const std::string& file_name)
+    {
+        positions.clear();
+
+        tinyobj::attrib_t attrib;
+        std::vector<tinyobj::shape_t> shapes;
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, file_name.c_str()))
+        {
+            LOG_ERROR("Failed to load OBJ file '%s': %s", file_name.c_str(), err.c_str());
+            return false;
+        }
+
+        positions.reserve(attrib.vertices.size() / 3);
+        for (size_t i = 0; i + 2 < attrib.vertices.size(); i += 3)
+        {
+            positions.emplace_back(attrib.vertices[i + 0], attrib.vertices[i + 1], attrib.vertices[i + 2]);
+        }
+        return !positions.empty();
+    }
 }
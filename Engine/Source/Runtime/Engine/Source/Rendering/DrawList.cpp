@@ -0,0 +1,136 @@
+#include "Rendering/DrawList.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace vkb
+{
+    namespace
+    {
+        constexpr uint64_t transparent_bit = uint64_t{1} << 61;
+
+        /// Opaque draws only need a rough front to back order, the geometry takes the rest of the bits
+        constexpr uint32_t opaque_depth_bits = 13;
+
+        constexpr uint32_t transparent_depth_bits = 29;
+
+        constexpr uint32_t max_id = 0xFFFF;
+
+        /**
+         * @brief Positive floats order like their bit patterns, the top depth_bits of the 31 bits are kept
+         */
+        uint64_t quantize_depth(float depth, uint32_t depth_bits)
+        {
+            // Negative depths and NaN both end up in front
+            if (!(depth > 0.0f))
+            {
+                return 0;
+            }
+            uint32_t bits;
+            std::memcpy(&bits, &depth, sizeof(bits));
+            return bits >> (31 - depth_bits);
+        }
+    }
+
+    uint64_t DrawList::make_key(uint32_t pass, bool transparent, uint32_t pipeline, uint32_t material,
+                                uint32_t geometry, float depth)
+    {
+        const uint64_t pass_bits = static_cast<uint64_t>(pass & 0x3) << 62;
+        // Ids past the field saturate, the draws that share the last id still sort next to each other
+        // instead of landing among unrelated ones
+        const uint64_t pipeline_bits = std::min(pipeline, max_id);
+        const uint64_t material_bits = std::min(material, max_id);
+
+        if (!transparent)
+        {
+            const uint64_t geometry_bits = std::min(geometry, max_id);
+            return pass_bits | (pipeline_bits << 45) | (material_bits << 29) | (geometry_bits << 13) |
+                   quantize_depth(depth, opaque_depth_bits);
+        }
+
+        const uint64_t depth_value = quantize_depth(depth, transparent_depth_bits);
+        const uint64_t far_first = ~depth_value & ((uint64_t{1} << transparent_depth_bits) - 1);
+        return pass_bits | transparent_bit | (far_first << 32) | (pipeline_bits << 16) | material_bits;
+    }
+
+    void DrawList::clear()
+    {
+        packets.clear();
+    }
+
+    void DrawList::reserve(size_t count)
+    {
+        packets.reserve(count);
+        scratch.reserve(count);
+    }
+
+    void DrawList::add(uint64_t key, uint32_t index)
+    {
+        packets.push_back({key, index});
+    }
+
+    void DrawList::sort()
+    {
+        constexpr int digits = 8;
+        const size_t count = packets.size();
+        if (count < 2)
+        {
+            return;
+        }
+
+        // Counts of every byte of the keys in one pass over the packets
+        uint32_t histograms[digits][256] = {};
+        for (const Packet& packet : packets)
+        {
+            for (int digit = 0; digit < digits; digit++)
+            {
+                histograms[digit][(packet.key >> (digit * 8)) & 0xFF]++;
+            }
+        }
+
+        scratch.resize(count);
+        Packet* source = packets.data();
+        Packet* destination = scratch.data();
+        for (int digit = 0; digit < digits; digit++)
+        {
+            auto& histogram = histograms[digit];
+
+            // A byte all keys share doesn't change the order, with few pipelines and materials most don't
+            if (histogram[(source[0].key >> (digit * 8)) & 0xFF] == count)
+            {
+                continue;
+            }
+
+            uint32_t offset = 0;
+            for (uint32_t& bucket : histogram)
+            {
+                const uint32_t bucket_count = bucket;
+                bucket = offset;
+                offset += bucket_count;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                destination[histogram[(source[i].key >> (digit * 8)) & 0xFF]++] = source[i];
+            }
+            std::swap(source, destination);
+        }
+
+        if (source != packets.data())
+        {
+            packets.swap(scratch);
+        }
+    }
+
+    const std::vector<DrawList::Packet>& DrawList::get_packets() const
+    {
+        return packets;
+    }
+
+    size_t DrawList::find_first_transparent() const
+    {
+        const auto it = std::partition_point(packets.begin(), packets.end(),
+                                             [](const Packet& packet) { return (packet.key & transparent_bit) == 0; });
+        return static_cast<size_t>(it - packets.begin());
+    }
+} // namespace vkb
@@ -17,8 +17,15 @@
 
 #include "Rendering/GeometrySubpass.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+
 #include "Engine/SceneGraph/ComponentPool.hpp"
 #include "Framework/Core/CommandBuffer.hpp"
+#include "Framework/Core/CommandPool.hpp"
 #include "Framework/Core/VulkanDevice.hpp"
 #include "Engine/SceneGraph/Node.hpp"
 #include "Engine/SceneGraph/Scene.hpp"
@@ -29,9 +36,98 @@
 #include "Engine/SceneGraph/Components/Pbr_Material.hpp"
 #include "Engine/SceneGraph/Components/SubMesh.hpp"
 #include "Engine/SceneGraph/Components/Texture.hpp"
+#include "Async/WorkStealingThreadPool.hpp"
+#include "Memory/FrameAllocator.hpp"
 
 namespace vkb
 {
+    namespace
+    {
+        /**
+         * @brief Numbers the keys in the order they are first seen, so they fit into the fields of a sort key
+         */
+        template <typename Key>
+        uint32_t get_dense_id(std::unordered_map<Key, uint32_t>& ids, const Key& key)
+        {
+            return ids.try_emplace(key, static_cast<uint32_t>(ids.size())).first->second;
+        }
+
+        /// Vertex shader input the instanced draws feed the model matrices through
+        const char* const instance_model_input = "instance_model";
+
+        /**
+         * @brief Counts a recording task as done when it leaves, also when it throws, so the frame waiting on
+         *        the count can't hang
+         */
+        struct PendingGuard
+        {
+            std::atomic<size_t>& pending;
+
+            ~PendingGuard()
+            {
+                pending--;
+            }
+        };
+
+        /**
+         * @brief Identifies the vertex and index buffers of a submesh, the mesh data it shares with its copies or
+         *        the submesh itself when it owns its buffers
+         */
+        const void* get_geometry(const scene::SubMesh& sub_mesh)
+        {
+            return sub_mesh.meshData ? static_cast<const void*>(sub_mesh.meshData) : &sub_mesh;
+        }
+
+        struct VertexSource
+        {
+            const vkb::Buffer* buffer;
+
+            VkFormat format;
+
+            uint32_t offset;
+
+            uint32_t stride;
+
+            VkVertexInputRate input_rate;
+        };
+
+        /**
+         * @brief Finds the buffer and layout of a vertex attribute in the geometry of a submesh
+         */
+        bool get_vertex_source(const scene::SubMesh& sub_mesh, const std::string& name, VertexSource& source)
+        {
+            if (const scene::MeshData* mesh_data = sub_mesh.meshData)
+            {
+                const auto attribute_it = mesh_data->vertex_attributes.find(name);
+                if (attribute_it == mesh_data->vertex_attributes.end())
+                {
+                    return false;
+                }
+
+                const auto binding_it = mesh_data->vertex_buffer_bindings.find(attribute_it->second.binding_name);
+                if (binding_it == mesh_data->vertex_buffer_bindings.end() || binding_it->second.buffer == nullptr)
+                {
+                    return false;
+                }
+
+                source = {binding_it->second.buffer, attribute_it->second.format, attribute_it->second.offset,
+                          binding_it->second.stride, binding_it->second.input_rate};
+                return true;
+            }
+
+            scene::VertexAttribute attribute;
+            const auto buffer_it = sub_mesh.vertex_buffers.find(name);
+            if (!sub_mesh.get_attribute(name, attribute) || buffer_it == sub_mesh.vertex_buffers.end())
+            {
+                return false;
+            }
+
+            source = {&buffer_it->second, attribute.format, attribute.offset, attribute.stride,
+                      VK_VERTEX_INPUT_RATE_VERTEX};
+            return true;
+        }
+    }
+
     GeometrySubpass::GeometrySubpass(RenderContext& render_context, ShaderSource&& vertex_source,
                                      ShaderSource&& fragment_source, scene::Scene& scene_, scene::Camera& camera)
         : Subpass{render_context, std::move(vertex_source), std::move(fragment_source)},
@@ -47,8 +143,14 @@ namespace vkb
         auto& device = get_render_context().get_device();
         for (auto& mesh : meshes)
         {
-            for (auto& sub_mesh : mesh.GetSubmeshes())
+            for (size_t i = 0; i < mesh.GetSubmeshCount(); i++)
             {
+                const scene::SubMesh* sub_mesh = mesh.GetSubmesh(i);
+                if (sub_mesh == nullptr)
+                {
+                    continue;
+                }
+
                 auto& variant = sub_mesh->get_shader_variant();
                 auto& vert_module = device.get_resource_cache().request_shader_module(
                     VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), variant);
@@ -58,53 +160,263 @@ namespace vkb
         }
     }
 
-    void GeometrySubpass::get_sorted_nodes(std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>& opaque_nodes,
-                                           std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>>&
-                                           transparent_nodes)
+    void GeometrySubpass::get_sorted_nodes(DrawList& draw_list)
     {
-        // TODO opaque_nodes
-        auto camera_transform = camera.GetOwner()->GetTransform().GetWorldMatrix();
+        const glm::mat4 view = camera.GetView();
+        const scene::Frustum frustum{vulkan_style_projection(camera.GetProjection()) * view};
 
+        // The depths and the results of the test are only read here, they live in the frame arena
+        LinearArena& frame_arena = FrameAllocator::Get();
+        std::pmr::vector<float> depths(&frame_arena);
+
+        // Growing in the arena leaves the old buffer behind until the frame ends, the last frame is a good guess
+        depths.reserve(cull_candidates.capacity());
+
+        culler.Clear();
+        cull_candidates.clear();
         for (auto& mesh : meshes)
         {
-            for (auto& sub_mesh : mesh.GetSubmeshes())
+            for (size_t i = 0; i < mesh.GetSubmeshCount(); i++)
             {
-                if (sub_mesh->bHasMeshData && sub_mesh->get_material()->alpha_mode == scene::AlphaMode::Blend)
-                {
-                    transparent_nodes.emplace(0, std::make_pair(sub_mesh->GetOwner(), sub_mesh));
-                }
-                else
+                scene::SubMesh* sub_mesh = mesh.GetSubmesh(i);
+                if (sub_mesh == nullptr)
                 {
-                    opaque_nodes.emplace(0, std::make_pair(sub_mesh->GetOwner(), sub_mesh));
+                    continue;
                 }
+
+                // Submeshes without bounds can't be tested, the culler keeps them
+                const glm::mat4& world = sub_mesh->GetOwner()->GetTransform().GetWorldMatrix();
+                const scene::AABB& bounds = sub_mesh->get_bounds();
+                const scene::AABB world_bounds = bounds.IsValid() ? bounds.Transformed(world) : bounds;
+                const glm::vec3 center = bounds.IsValid() ? world_bounds.GetCenter() : glm::vec3(world[3]);
+
+                culler.Add(world_bounds);
+                cull_candidates.push_back(sub_mesh);
+                depths.push_back(-(view * glm::vec4(center, 1.0f)).z);
             }
         }
+
+        uint8_t* visible = frame_arena.AllocateArray<uint8_t>(culler.GetCount());
+        cull_stats = culler.Cull(frustum, visible, thread_pool);
+
+        // Ids are handed out again every frame, only what is visible now takes one, so they stay small and
+        // never refer to a freed material or geometry
+        pipeline_ids.clear();
+        material_ids.clear();
+        geometry_ids.clear();
+
+        draw_list.clear();
+        for (size_t i = 0; i < cull_candidates.size(); i++)
+        {
+            if (!visible[i])
+            {
+                continue;
+            }
+
+            scene::SubMesh* sub_mesh = cull_candidates[i];
+            const scene::Material* material = sub_mesh->get_material();
+            const bool transparent = sub_mesh->bHasMeshData && material->alpha_mode == scene::AlphaMode::Blend;
+
+            // Everything that goes into the pipeline, the shader variant and the rasterization state
+            const size_t pipeline = sub_mesh->get_shader_variant().get_id() * 4 +
+                                    (get_front_face(*sub_mesh, transparent) == VK_FRONT_FACE_CLOCKWISE ? 2 : 0) +
+                                    (material->double_sided ? 1 : 0);
+
+            draw_list.add(DrawList::make_key(0, transparent, get_dense_id(pipeline_ids, pipeline),
+                                             get_dense_id(material_ids, material),
+                                             get_dense_id(geometry_ids, get_geometry(*sub_mesh)), depths[i]),
+                          static_cast<uint32_t>(i));
+        }
+        draw_list.sort();
+    }
+
+    VkFrontFace GeometrySubpass::get_front_face(const scene::SubMesh& sub_mesh, bool transparent) const
+    {
+        if (transparent)
+        {
+            return VK_FRONT_FACE_COUNTER_CLOCKWISE;
+        }
+
+        // Invert the front face if the mesh was flipped
+        const auto& scale = sub_mesh.GetOwner()->GetTransform().GetScale();
+        bool flipped = scale.x * scale.y * scale.z < 0;
+        return flipped ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+    }
+
+    void GeometrySubpass::prepare_draw()
+    {
+        get_sorted_nodes(draw_list);
+
+        const auto& packets = draw_list.get_packets();
+        const size_t first_transparent = draw_list.find_first_transparent();
+
+        // Copies of a mesh with the same material and pipeline state next to each other go out as one draw
+        const auto same_instance = [&](bool transparent)
+        {
+            return [this, transparent](const DrawList::Packet& a, const DrawList::Packet& b)
+            {
+                const scene::SubMesh& lhs = *cull_candidates[a.index];
+                const scene::SubMesh& rhs = *cull_candidates[b.index];
+                return get_geometry(lhs) == get_geometry(rhs) && lhs.get_material() == rhs.get_material() &&
+                       lhs.get_shader_variant().get_id() == rhs.get_shader_variant().get_id() &&
+                       get_front_face(lhs, transparent) == get_front_face(rhs, transparent);
+            };
+        };
+
+        draw_batches.clear();
+        draw_list.build_batches(0, first_transparent, same_instance(false), draw_batches);
+        first_transparent_batch = draw_batches.size();
+        draw_list.build_batches(first_transparent, packets.size(), same_instance(true), draw_batches);
+
+        // Uploaded before recording starts, the recording threads only read it
+        prepare_instances();
     }
 
     void GeometrySubpass::draw(vkb::CommandBuffer& command_buffer)
     {
-        std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>> opaque_nodes;
-        std::multimap<float, std::pair<scene::Node*, scene::SubMesh*>> transparent_nodes;
+        // The render pass was begun with the contents the batches of this frame ask for
+        if (get_subpass_contents() == VK_SUBPASS_CONTENTS_INLINE)
+        {
+            record_states.resize(1);
+            record_states[0].begin(thread_index);
+
+            record_batches(command_buffer, record_states[0], 0, draw_batches.size());
 
-        get_sorted_nodes(opaque_nodes, transparent_nodes);
+            draw_stats = record_states[0].stats;
+            return;
+        }
 
-        // Draw opaque objects in front-to-back order
+        // Every thread gets a share of the batches
+        const size_t num_threads = std::clamp<size_t>(draw_batches.size() / min_batches_per_thread, 1,
+                                                      recording_thread_count);
+
+        // The command pools are created on first use, the buffers are requested here and only recorded by the tasks
+        auto& render_frame = get_render_context().get_active_frame();
+        const auto& queue = command_buffer.GetDevice().get_queue_by_flags(VK_QUEUE_GRAPHICS_BIT, 0);
+
+        record_states.resize(num_threads);
+        secondary_command_buffers.clear();
+        for (size_t i = 0; i < num_threads; i++)
         {
-            ScopedDebugLabel opaque_debug_label{command_buffer, "Opaque objects"};
+            record_states[i].begin(i + 1);
+
+            secondary_command_buffers.push_back(
+                render_frame.get_command_pool(queue, CommandBufferResetMode::ResetPool, i + 1)
+                            .request_command_buffer(VK_COMMAND_BUFFER_LEVEL_SECONDARY));
+        }
 
-            for (auto node_it = opaque_nodes.begin(); node_it != opaque_nodes.end(); node_it++)
+        // Secondary command buffers don't inherit the viewport and scissor
+        const VkExtent2D extent = command_buffer.get_current_framebuffer()->get_extent();
+
+        VkViewport viewport{};
+        viewport.width = static_cast<float>(extent.width);
+        viewport.height = static_cast<float>(extent.height);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+
+        VkRect2D scissor{};
+        scissor.extent = extent;
+
+        const auto record = [&, num_threads](size_t i)
+        {
+            vkb::CommandBuffer& secondary = *secondary_command_buffers[i];
+            secondary.begin(VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT |
+                            VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT, &command_buffer);
+            secondary.set_viewport(0, {viewport});
+            secondary.set_scissor(0, {scissor});
+
+            record_batches(secondary, record_states[i], draw_batches.size() * i / num_threads,
+                           draw_batches.size() * (i + 1) / num_threads);
+
+            secondary.end();
+        };
+
+        if (thread_pool == nullptr)
+        {
+            for (size_t i = 0; i < num_threads; i++)
+            {
+                record(i);
+            }
+        }
+        else
+        {
+            std::atomic<size_t> num_pending{num_threads};
+
+            // A task that throws must not unwind past the others, they still use the state of this frame
+            std::exception_ptr error;
+            std::mutex error_mutex;
+
+            for (size_t i = 0; i < num_threads; i++)
             {
-                update_uniform(command_buffer, *node_it->second.first, thread_index);
+                thread_pool->Submit([&, i]()
+                {
+                    PendingGuard pending_guard{num_pending};
+                    try
+                    {
+                        record(i);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock{error_mutex};
+                        if (!error)
+                        {
+                            error = std::current_exception();
+                        }
+                    }
+                });
+            }
 
-                // Invert the front face if the mesh was flipped
-                const auto& scale = node_it->second.first->GetTransform().GetScale();
-                bool flipped = scale.x * scale.y * scale.z < 0;
-                VkFrontFace front_face = flipped ? VK_FRONT_FACE_CLOCKWISE : VK_FRONT_FACE_COUNTER_CLOCKWISE;
+            // The calling thread records its share too instead of sleeping
+            while (num_pending.load() > 0)
+            {
+                if (!thread_pool->RunPendingTask())
+                {
+                    std::this_thread::yield();
+                }
+            }
 
-                draw_submesh(command_buffer, *node_it->second.second, front_face);
+            if (error)
+            {
+                std::rethrow_exception(error);
             }
         }
 
+        // Executed in order, the draws keep the order of the draw list
+        command_buffer.execute_commands(secondary_command_buffers);
+
+        draw_stats = {};
+        for (const RecordState& state : record_states)
+        {
+            draw_stats.submeshes += state.stats.submeshes;
+            draw_stats.draws += state.stats.draws;
+        }
+    }
+
+    void GeometrySubpass::RecordState::begin(size_t index)
+    {
+        thread_index = index;
+        pipeline_layout = nullptr;
+        vertex_inputs.clear();
+        instance_input = nullptr;
+        stats = {};
+    }
+
+    void GeometrySubpass::record_batches(vkb::CommandBuffer& command_buffer, RecordState& state, size_t first,
+                                         size_t last)
+    {
+        // Draw opaque objects grouped by state and front-to-back inside a group
+        {
+            ScopedDebugLabel opaque_debug_label{command_buffer, "Opaque objects"};
+
+            record_batch_range(command_buffer, state, first, std::min(last, first_transparent_batch), false);
+        }
+
+        // The blend state only matters to the transparent batches, or what comes after the last batch
+        if (last <= first_transparent_batch && last != draw_batches.size())
+        {
+            return;
+        }
+
         // Enable alpha blending TODO
         ColorBlendAttachmentState color_blend_attachment{};
         color_blend_attachment.blend_enable = VK_FALSE;
@@ -126,12 +438,35 @@ namespace vkb
         {
             ScopedDebugLabel transparent_debug_label{command_buffer, "Transparent objects"};
 
-            for (auto node_it = transparent_nodes.rbegin(); node_it != transparent_nodes.rend(); node_it++)
-            {
-                update_uniform(command_buffer, *node_it->second.first, thread_index);
+            record_batch_range(command_buffer, state, std::max(first, first_transparent_batch), last, true);
+        }
+    }
 
-                draw_submesh(command_buffer, *node_it->second.second);
-            }
+    void GeometrySubpass::record_batch_range(vkb::CommandBuffer& command_buffer, RecordState& state, size_t first,
+                                             size_t last, bool transparent)
+    {
+        const auto& packets = draw_list.get_packets();
+
+        // Only binds what changed since the previous batch
+        const scene::SubMesh* previous = nullptr;
+        VkFrontFace previous_front_face = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+
+        for (size_t i = first; i < last; i++)
+        {
+            const DrawList::Batch& batch = draw_batches[i];
+            scene::SubMesh& sub_mesh = *cull_candidates[packets[batch.first].index];
+
+            const VkFrontFace front_face = get_front_face(sub_mesh, transparent);
+            const bool same_material = previous && previous->get_material() == sub_mesh.get_material();
+            const bool same_pipeline = previous && previous_front_face == front_face &&
+                                       previous->get_material()->double_sided == sub_mesh.get_material()->double_sided &&
+                                       previous->get_shader_variant().get_id() == sub_mesh.get_shader_variant().get_id();
+
+            draw_submesh(command_buffer, state, sub_mesh, batch, front_face, !same_pipeline,
+                         !same_pipeline || !same_material);
+
+            previous = &sub_mesh;
+            previous_front_face = front_face;
         }
     }
 
@@ -158,72 +493,170 @@ namespace vkb
         command_buffer.bind_buffer(allocation.get_buffer(), allocation.get_offset(), allocation.get_size(), 0, 1, 0);
     }
 
-    void GeometrySubpass::draw_submesh(vkb::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh,
-                                       VkFrontFace front_face)
+    void GeometrySubpass::prepare_instances()
+    {
+        instance_allocation = {};
+        camera_allocation = {};
+
+        const auto& packets = draw_list.get_packets();
+        if (packets.empty())
+        {
+            return;
+        }
+
+        auto& render_frame = get_render_context().get_active_frame();
+
+        // The matrices are copied into the instance buffer right away, the frame arena holds them meanwhile
+        std::pmr::vector<glm::mat4> instance_models(&FrameAllocator::Get());
+        instance_models.reserve(packets.size());
+        for (const DrawList::Packet& packet : packets)
+        {
+            instance_models.push_back(cull_candidates[packet.index]->GetOwner()->GetTransform().GetWorldMatrix());
+        }
+
+        const size_t instance_size = instance_models.size() * sizeof(glm::mat4);
+        instance_allocation = render_frame.allocate_buffer(VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, instance_size,
+                                                           thread_index);
+        instance_allocation.update(reinterpret_cast<const uint8_t*>(instance_models.data()), instance_size);
+
+        // The model comes from the instances, only the camera is left in the uniform
+        GlobalUniform global_uniform;
+
+        global_uniform.model = glm::mat4(1.0f);
+
+        global_uniform.camera_view_proj = camera.GetPreRotation() * vkb::vulkan_style_projection(
+            camera.GetProjection()) * camera.GetView();
+
+        global_uniform.camera_position = glm::vec3(glm::inverse(camera.GetView())[3]);
+
+        camera_allocation = render_frame.allocate_buffer(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, sizeof(GlobalUniform),
+                                                         thread_index);
+        camera_allocation.update(global_uniform);
+    }
+
+    void GeometrySubpass::draw_submesh(vkb::CommandBuffer& command_buffer, RecordState& state,
+                                       scene::SubMesh& sub_mesh, const DrawList::Batch& batch,
+                                       VkFrontFace front_face, bool bind_pipeline, bool bind_material)
     {
         auto& device = command_buffer.GetDevice();
 
         ScopedDebugLabel submesh_debug_label{command_buffer, sub_mesh.GetName().c_str()};
 
-        prepare_pipeline_state(command_buffer, front_face, sub_mesh.get_material()->double_sided);
+        // The shader modules and the layout only change with the pipeline, the resource cache isn't asked again
+        if (bind_pipeline || state.pipeline_layout == nullptr)
+        {
+            prepare_pipeline_state(command_buffer, front_face, sub_mesh.get_material()->double_sided);
 
-        MultisampleState multisample_state{};
-        multisample_state.rasterization_samples = get_sample_count();
-        command_buffer.set_multisample_state(multisample_state);
+            MultisampleState multisample_state{};
+            multisample_state.rasterization_samples = get_sample_count();
+            command_buffer.set_multisample_state(multisample_state);
+
+            auto& vert_shader_module = device.get_resource_cache().request_shader_module(
+                VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), sub_mesh.get_shader_variant());
+            auto& frag_shader_module = device.get_resource_cache().request_shader_module(
+                VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), sub_mesh.get_shader_variant());
 
-        auto& vert_shader_module = device.get_resource_cache().request_shader_module(
-            VK_SHADER_STAGE_VERTEX_BIT, get_vertex_shader(), sub_mesh.get_shader_variant());
-        auto& frag_shader_module = device.get_resource_cache().request_shader_module(
-            VK_SHADER_STAGE_FRAGMENT_BIT, get_fragment_shader(), sub_mesh.get_shader_variant());
+            state.shader_modules.clear();
+            state.shader_modules.push_back(&vert_shader_module);
+            state.shader_modules.push_back(&frag_shader_module);
 
-        std::vector<ShaderModule*> shader_modules{&vert_shader_module, &frag_shader_module};
+            PipelineLayout* previous_layout = state.pipeline_layout;
+            {
+                std::lock_guard<std::mutex> lock{pipeline_layout_mutex};
+                state.pipeline_layout = &prepare_pipeline_layout(command_buffer, state.shader_modules);
+            }
 
-        auto& pipeline_layout = prepare_pipeline_layout(command_buffer, shader_modules);
+            command_buffer.bind_pipeline_layout(*state.pipeline_layout);
 
-        command_buffer.bind_pipeline_layout(pipeline_layout);
+            // Variants often share a layout, its inputs are only looked up again when it changes
+            if (state.pipeline_layout != previous_layout)
+            {
+                state.vertex_inputs = state.pipeline_layout->get_resources(ShaderResourceType::Input,
+                                                                           VK_SHADER_STAGE_VERTEX_BIT);
+            }
 
-        if (pipeline_layout.get_push_constant_range_stage(sizeof(PBRMaterialUniform)) != 0)
-        {
-            prepare_push_constants(command_buffer, sub_mesh);
+            const auto instance_input_it = std::find_if(state.vertex_inputs.begin(), state.vertex_inputs.end(),
+                                                        [](const ShaderResource& resource)
+                                                        {
+                                                            return resource.name == instance_model_input;
+                                                        });
+            state.instance_input = instance_input_it != state.vertex_inputs.end() ? &*instance_input_it : nullptr;
         }
 
-        DescriptorSetLayout& descriptor_set_layout = pipeline_layout.get_descriptor_set_layout(0);
+        auto& pipeline_layout = *state.pipeline_layout;
 
-        for (auto& texture : sub_mesh.get_material()->textures)
+        // Push constants and textures of the material stay bound until another material is drawn
+        if (bind_pipeline || bind_material)
         {
-            if (auto layout_binding = descriptor_set_layout.get_layout_binding(texture.first))
+            if (pipeline_layout.get_push_constant_range_stage(sizeof(PBRMaterialUniform)) != 0)
             {
-                command_buffer.bind_image(texture.second->get_image()->get_vk_image_view(),
-                                          texture.second->get_sampler()->vk_sampler,
-                                          0, layout_binding->binding, 0);
+                prepare_push_constants(command_buffer, sub_mesh);
+            }
+
+            DescriptorSetLayout& descriptor_set_layout = pipeline_layout.get_descriptor_set_layout(0);
+
+            for (auto& texture : sub_mesh.get_material()->textures)
+            {
+                if (auto layout_binding = descriptor_set_layout.get_layout_binding(texture.first))
+                {
+                    command_buffer.bind_image(texture.second->get_image()->get_vk_image_view(),
+                                              texture.second->get_sampler()->vk_sampler,
+                                              0, layout_binding->binding, 0);
+                }
             }
         }
 
-        auto vertex_input_resources = pipeline_layout.get_resources(ShaderResourceType::Input,
-                                                                    VK_SHADER_STAGE_VERTEX_BIT);
+        const auto& vertex_input_resources = state.vertex_inputs;
+        const ShaderResource* instance_input = state.instance_input;
 
-        VertexInputState vertex_input_state;
+        VertexInputState& vertex_input_state = state.vertex_input_state;
+        vertex_input_state.attributes.clear();
+        vertex_input_state.bindings.clear();
 
         for (auto& input_resource : vertex_input_resources)
         {
-            scene::VertexAttribute attribute;
+            VertexSource source;
 
-            if (!sub_mesh.get_attribute(input_resource.name, attribute))
+            if (!get_vertex_source(sub_mesh, input_resource.name, source))
             {
                 continue;
             }
 
             VkVertexInputAttributeDescription vertex_attribute{};
             vertex_attribute.binding = input_resource.location;
-            vertex_attribute.format = attribute.format;
+            vertex_attribute.format = source.format;
             vertex_attribute.location = input_resource.location;
-            vertex_attribute.offset = attribute.offset;
+            vertex_attribute.offset = source.offset;
 
             vertex_input_state.attributes.push_back(vertex_attribute);
 
             VkVertexInputBindingDescription vertex_binding{};
             vertex_binding.binding = input_resource.location;
-            vertex_binding.stride = attribute.stride;
+            vertex_binding.stride = source.stride;
+            vertex_binding.inputRate = source.input_rate;
+
+            vertex_input_state.bindings.push_back(vertex_binding);
+        }
+
+        // A matrix input takes one location per column, all of them read from the binding of the first one
+        if (instance_input != nullptr)
+        {
+            const uint32_t columns = std::max(instance_input->columns, 1u);
+            for (uint32_t column = 0; column < columns; column++)
+            {
+                VkVertexInputAttributeDescription vertex_attribute{};
+                vertex_attribute.binding = instance_input->location;
+                vertex_attribute.format = VK_FORMAT_R32G32B32A32_SFLOAT;
+                vertex_attribute.location = instance_input->location + column;
+                vertex_attribute.offset = column * sizeof(glm::vec4);
+
+                vertex_input_state.attributes.push_back(vertex_attribute);
+            }
+
+            VkVertexInputBindingDescription vertex_binding{};
+            vertex_binding.binding = instance_input->location;
+            vertex_binding.stride = sizeof(glm::mat4);
+            vertex_binding.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
 
             vertex_input_state.bindings.push_back(vertex_binding);
         }
@@ -233,19 +666,47 @@ namespace vkb
         // Find submesh vertex buffers matching the shader input attribute names
         for (auto& input_resource : vertex_input_resources)
         {
-            const auto& buffer_iter = sub_mesh.vertex_buffers.find(input_resource.name);
+            VertexSource source;
 
-            if (buffer_iter != sub_mesh.vertex_buffers.end())
+            if (get_vertex_source(sub_mesh, input_resource.name, source))
             {
-                std::vector<std::reference_wrapper<const vkb::Buffer>> buffers;
-                buffers.emplace_back(std::ref(buffer_iter->second));
+                state.vertex_buffers.clear();
+                state.vertex_buffers.emplace_back(std::ref(*source.buffer));
+                state.vertex_offsets.assign(1, 0);
 
                 // Bind vertex buffers only for the attribute locations defined
-                command_buffer.bind_vertex_buffers(input_resource.location, std::move(buffers), {0});
+                command_buffer.bind_vertex_buffers(input_resource.location, state.vertex_buffers,
+                                                   state.vertex_offsets);
+            }
+        }
+
+        state.stats.submeshes += batch.count;
+
+        if (instance_input == nullptr)
+        {
+            // The shader reads the model from the uniform, every copy is its own draw
+            const auto& packets = draw_list.get_packets();
+            for (uint32_t i = batch.first; i < batch.first + batch.count; i++)
+            {
+                scene::SubMesh& copy = *cull_candidates[packets[i].index];
+                update_uniform(command_buffer, *copy.GetOwner(), state.thread_index);
+                draw_submesh_command(command_buffer, copy);
             }
+            state.stats.draws += batch.count;
+            return;
         }
 
-        draw_submesh_command(command_buffer, sub_mesh);
+        // The instance buffer holds the matrices in packet order, the batch starts at its first packet
+        state.vertex_buffers.clear();
+        state.vertex_buffers.emplace_back(std::ref(instance_allocation.get_buffer()));
+        state.vertex_offsets.assign(1, instance_allocation.get_offset());
+        command_buffer.bind_vertex_buffers(instance_input->location, state.vertex_buffers, state.vertex_offsets);
+
+        command_buffer.bind_buffer(camera_allocation.get_buffer(), camera_allocation.get_offset(),
+                                   camera_allocation.get_size(), 0, 1, 0);
+
+        draw_submesh_command(command_buffer, sub_mesh, batch.count, batch.first);
+        state.stats.draws++;
     }
 
     void GeometrySubpass::prepare_pipeline_state(vkb::CommandBuffer& command_buffer,
@@ -291,16 +752,28 @@ namespace vkb
         pbr_material_uniform.metallic_factor = pbr_material->metallic_factor;
         pbr_material_uniform.roughness_factor = pbr_material->roughness_factor;
 
-        auto data = to_bytes(pbr_material_uniform);
+        command_buffer.push_constants(pbr_material_uniform);
+    }
 
-        if (!data.empty())
+    void GeometrySubpass::draw_submesh_command(vkb::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh,
+                                               uint32_t instance_count, uint32_t first_instance)
+    {
+        // Submeshes sharing mesh data draw its buffers instead of their own
+        if (const scene::MeshData* mesh_data = sub_mesh.meshData)
         {
-            command_buffer.push_constants(data);
+            if (mesh_data->index_count != 0)
+            {
+                command_buffer.bind_index_buffer(*mesh_data->index_buffer, mesh_data->index_buffer_offset,
+                                                 mesh_data->index_type);
+                command_buffer.draw_indexed(mesh_data->index_count, instance_count, 0, 0, first_instance);
+            }
+            else
+            {
+                command_buffer.draw(mesh_data->vertices_count, instance_count, 0, first_instance);
+            }
+            return;
         }
-    }
 
-    void GeometrySubpass::draw_submesh_command(vkb::CommandBuffer& command_buffer, scene::SubMesh& sub_mesh)
-    {
         // Draw submesh indexed if indices exists
         if (sub_mesh.index_count != 0)
         {
@@ -308,12 +781,12 @@ namespace vkb
             command_buffer.bind_index_buffer(*sub_mesh.index_buffer, sub_mesh.index_buffer_offset, sub_mesh.index_type);
 
             // Draw submesh using indexed data
-            command_buffer.draw_indexed(sub_mesh.index_count, 1, 0, 0, 0);
+            command_buffer.draw_indexed(sub_mesh.index_count, instance_count, 0, 0, first_instance);
         }
         else
         {
             // Draw submesh using vertices only
-            command_buffer.draw(sub_mesh.vertices_count, 1, 0, 0);
+            command_buffer.draw(sub_mesh.vertices_count, instance_count, 0, first_instance);
         }
     }
 
@@ -321,4 +794,30 @@ namespace vkb
     {
         thread_index = index;
     }
+
+    void GeometrySubpass::set_recording_thread_count(uint32_t count)
+    {
+        recording_thread_count = std::max(count, 1u);
+    }
+
+    VkSubpassContents GeometrySubpass::get_subpass_contents() const
+    {
+        const bool threaded = recording_thread_count > 1 && draw_batches.size() >= 2 * min_batches_per_thread;
+        return threaded ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE;
+    }
+
+    void GeometrySubpass::set_thread_pool(WorkStealingThreadPool* pool)
+    {
+        thread_pool = pool;
+    }
+
+    const scene::FrustumCuller::Stats& GeometrySubpass::get_cull_stats() const
+    {
+        return cull_stats;
+    }
+
+    const GeometrySubpass::DrawStats& GeometrySubpass::get_draw_stats() const
+    {
+        return draw_stats;
+    }
 } // namespace vkb
@@ -222,7 +222,6 @@ namespace vkb
                             const glm::quat& rotation,
                             const scene::LightProperties& props, scene::Node* parent_node)
     {
-        auto light_ptr = std::make_unique<scene::Light>("light");
         auto node = std::make_unique<scene::Node>(&scene, "light node");
 
         if (parent_node)
@@ -230,18 +229,17 @@ namespace vkb
             node->SetParent(*parent_node);
         }
 
-        light_ptr->set_node(*node);
-        light_ptr->set_light_type(type);
-        light_ptr->set_properties(props);
-
         auto& t = node->GetTransform();
         t.SetTranslation(position);
         t.SetRotation(rotation);
 
-        // Storing the light component because the unique_ptr will be moved to the scene
-        auto& light = *light_ptr;
+        // The pool owns the light, configure the one it made
+        auto& light = *scene.GetComponentManager()->AddComponent<scene::Light>(node.get());
+        light.SetName("light");
+        light.set_node(*node);
+        light.set_light_type(type);
+        light.set_properties(props);
 
-        scene.GetComponentManager()->AddComponent<scene::Light>(node.get());
         scene.AddNode(std::move(node));
         return light;
     }
@@ -298,7 +296,7 @@ namespace vkb
         return *cameraNode;
     }
 
-    void allocate_lightState(std::vector<scene::Light>& scene_lights, size_t max_lights_per_type,
+    void allocate_lightState(scene::ComponentPool<scene::Light>& scene_lights, size_t max_lights_per_type,
                              LightingState& lighting_state)
     {
         for (auto& scene_light : scene_lights)
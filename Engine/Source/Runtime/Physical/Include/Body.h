@@ -7,6 +7,8 @@
 #include "Math/Matrix.h"
 #include "Math/Bounds.h"
 #include "Shapes/ShapeSphere.h"
+#include "Shapes/ShapeBox.h"
+#include "Shapes/ShapeConvex.h"
 
 /*
 ====================================================
@@ -23,11 +25,19 @@ public:
 	Vec3 m_linearVelocity;
 	Vec3 m_angularVelocity;
 
+	// Written by the contact solver to push penetrating bodies apart.  They move the body
+	// once, in ApplyPushVelocity, and never become momentum.
+	Vec3 m_pushLinearVelocity;
+	Vec3 m_pushAngularVelocity;
+
 	float m_invMass;
 	float m_elasticity;
 	float m_friction;
 	Shape *m_shape;
 
+	bool m_isAwake;		// sleeping bodies are skipped by Update and the broadphase
+	float m_sleepTime;	// how long the body has been slow enough to sleep
+
 	Vec3 GetCenterOfMassWorldSpace() const;
 	Vec3 GetCenterOfMassModelSpace() const;
 
@@ -41,5 +51,17 @@ public:
 	void ApplyImpulseLinear(const Vec3 &impulse);
 	void ApplyImpulseAngular(const Vec3 &impulse);
 
+	void SetAwake(const bool awake);
+
+	void ApplyPushVelocity(const float dt_sec);
+
 	void Update(const float dt_sec);
-};
\ No newline at end of file
+};
+
+/*
+====================================================
+Batch queries over arrays of bodies
+====================================================
+*/
+void GetCentersOfMassWorldSpace(const Body *bodies, const int num, Vec3 *centers);
+void GetInverseInertiaTensorsWorldSpace(const Body *bodies, const int num, Mat3 *invInertias);
\ No newline at end of file
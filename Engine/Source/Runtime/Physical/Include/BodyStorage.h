@@ -0,0 +1,110 @@
+//
+//	BodyStorage.h
+//
+#pragma once
+#include "Body.h"
+#include <stdint.h>
+#include <vector>
+
+class BodyStorage;
+
+/*
+====================================================
+BodyHandle
+
+Body-like view of one entry in a BodyStorage.  The state can be read
+and written through the same m_ names as Body, except the orientation
+which goes through SetOrientation so the cached inertia is refreshed.
+A handle is invalidated by adding bodies to the storage.
+====================================================
+*/
+class BodyHandle {
+public:
+	BodyHandle( BodyStorage & storage, const int index );
+
+	int GetIndex() const { return m_index; }
+
+	void SetOrientation( const Quat & orientation );
+
+	Vec3 GetCenterOfMassWorldSpace() const;
+	Vec3 GetCenterOfMassModelSpace() const;
+
+	Vec3 WorldSpaceToBodySpace( const Vec3 & pt ) const;
+	Vec3 BodySpaceToWorldSpace( const Vec3 & pt ) const;
+
+	Mat3 GetInverseInertiaTensorWorldSpace() const;
+
+	void ApplyImpulse( const Vec3 & impulsePoint, const Vec3 & impulse );
+	void ApplyImpulseLinear( const Vec3 & impulse );
+	void ApplyImpulseAngular( const Vec3 & impulse );
+
+	void Update( const float dt_sec );
+
+public:
+	Vec3 & m_position;
+	const Quat & m_orientation;
+	Vec3 & m_linearVelocity;
+	Vec3 & m_angularVelocity;
+
+	float & m_invMass;
+	float & m_elasticity;
+	float & m_friction;
+	Shape * const & m_shape;
+
+private:
+	BodyStorage * m_storage;
+	int m_index;
+};
+
+/*
+====================================================
+BodyStorage
+
+Structure of arrays body container.  Integration runs over the flat
+arrays, and the shape data needed by the integrator (center of mass,
+body space inertia and its inverse) is copied in when a body is added
+so the hot loop never calls through Shape.  World space inverse
+inertia tensors are cached and only rebuilt after the orientation
+changed.
+====================================================
+*/
+class BodyStorage {
+public:
+	int Add( const Body & body );
+	void Clear();
+	void Reserve( const int num );
+	int Size() const { return (int)m_positions.size(); }
+
+	BodyHandle GetHandle( const int index ) { return BodyHandle( *this, index ); }
+	void CopyTo( const int index, Body & body ) const;
+
+	Mat3 GetInverseInertiaTensorWorldSpace( const int index ) const;
+
+	void IntegrateAll( const float dt_sec );
+
+public:
+	std::vector< Vec3 > m_positions;
+	std::vector< Quat > m_orientations;
+	std::vector< Vec3 > m_linearVelocities;
+	std::vector< Vec3 > m_angularVelocities;
+	std::vector< float > m_invMasses;
+	std::vector< float > m_elasticities;
+	std::vector< float > m_frictions;
+	std::vector< Shape * > m_shapes;
+
+private:
+	friend class BodyHandle;
+
+	void IntegrateAngular( const int index, const float dt_sec );
+
+	// Copied from the shape when the body is added
+	std::vector< Vec3 > m_centersOfMass;
+	std::vector< Mat3 > m_inertiaTensors;
+	std::vector< Mat3 > m_invInertiaTensors;
+
+	// Rebuilt lazily and kept without the inverse mass, m_invInertiaDirty is set whenever the
+	// orientation changes.  Reading a dirty tensor writes the cache, so don't query the same
+	// body from several threads.
+	mutable std::vector< Mat3 > m_invInertiaWorldSpace;
+	mutable std::vector< uint8_t > m_invInertiaDirty;
+};
\ No newline at end of file
@@ -3,6 +3,7 @@
 //
 #pragma once
 #include "Body.h"
+#include "DynamicBVH.h"
 #include <vector>
 
 
@@ -18,4 +19,81 @@ struct collisionPair_t {
 	}
 };
 
-void BroadPhase( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec );
\ No newline at end of file
+void BroadPhase( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec );
+void SweepAndPrune1D( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec );
+
+Bounds GetSweptBounds( const Body & body, const float dt_sec );
+
+/*
+====================================================
+SweepAndPrune
+
+Incremental sweep and prune.  The endpoint list is kept between
+steps and re-sorted with an insertion sort, which is close to
+linear when the bodies only move a little each frame.  The sweep
+axis is the one with the largest spread of body centers, and only
+pairs whose full bounds overlap are emitted.  Pairs of two static or
+sleeping bodies are left out.
+====================================================
+*/
+class SweepAndPrune {
+public:
+	SweepAndPrune();
+
+	void Update( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec );
+	void Reset();
+
+	int GetAxis() const { return m_axis; }
+
+private:
+	struct endPoint_t {
+		float value;
+		int id;
+		bool ismin;
+	};
+
+	void UpdateBounds( const Body * bodies, const int num, const float dt_sec );
+	int ChooseAxis() const;
+	void RebuildEndPoints();
+	void SortEndPoints();
+	void BuildPairs( std::vector< collisionPair_t > & finalPairs );
+
+	int m_axis;
+	std::vector< Bounds > m_bounds;
+	std::vector< endPoint_t > m_endPoints;
+	std::vector< int > m_active;
+	std::vector< int > m_activeSlot;
+};
+
+void BroadPhase( SweepAndPrune & sap, const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec );
+
+/*
+====================================================
+BVHBroadPhase
+
+Broadphase backed by a DynamicBVH, one proxy per body.  Pairs whose
+fat bounds overlap are kept between steps, and only bodies that left
+their fat bounds are re-inserted and queried again.  That makes it a
+better fit than sweep and prune for large, spread out worlds.  The
+tree can also be used directly for picking queries.  Sleeping bodies
+are not touched at all, and pairs of two static or sleeping bodies are
+left out.
+====================================================
+*/
+class BVHBroadPhase {
+public:
+	void Update( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec );
+	void Reset();
+
+	const DynamicBVH & GetTree() const { return m_tree; }
+
+private:
+	DynamicBVH m_tree;
+	std::vector< int > m_proxies;
+	std::vector< Bounds > m_bounds;
+	std::vector< bool > m_moved;
+	std::vector< collisionPair_t > m_candidates;
+	std::vector< int > m_query;
+};
+
+void BroadPhase( BVHBroadPhase & bvh, const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec );
\ No newline at end of file
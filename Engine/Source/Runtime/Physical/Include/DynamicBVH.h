@@ -0,0 +1,202 @@
+//
+//	DynamicBVH.h
+//
+#pragma once
+#include "Math/Vector.h"
+#include "Math/Bounds.h"
+#include <functional>
+#include <vector>
+
+/*
+====================================================
+DynamicBVH
+
+Dynamic bounding volume tree.  Leaves store fattened bounds, so a
+proxy that moves a little stays where it is and only proxies that
+leave their fat bounds are re-inserted.  The tree is kept balanced
+with AVL style rotations on the way back up from every insert and
+removal.
+====================================================
+*/
+class DynamicBVH {
+public:
+	// Return the fraction along the ray where the leaf was hit, or a negative value for a miss
+	typedef std::function< float ( int userData, const Vec3 & start, const Vec3 & end, float maxFraction ) > rayCallback_t;
+
+	// How the fat bounds of a node relate to a query shape
+	enum overlap_t {
+		OVERLAP_NONE,
+		OVERLAP_PARTIAL,
+		OVERLAP_FULL
+	};
+
+	DynamicBVH();
+
+	int CreateProxy( const Bounds & bounds, int userData );
+	void CreateProxies( const Bounds * bounds, const int * userData, const int num, int * proxyIds );
+	void DestroyProxy( int proxyId );
+	bool MoveProxy( int proxyId, const Bounds & bounds, const Vec3 & displacement );
+	void Clear();
+
+	int GetUserData( int proxyId ) const { return m_nodes[ proxyId ].userData; }
+	const Bounds & GetFatBounds( int proxyId ) const { return m_nodes[ proxyId ].bounds; }
+	int GetHeight() const { return ( m_root == nullNode ) ? 0 : m_nodes[ m_root ].height; }
+	int GetProxyCount() const { return m_proxyCount; }
+
+	void QueryBounds( const Bounds & bounds, std::vector< int > & results ) const;
+	void QuerySphere( const Vec3 & center, const float radius, std::vector< int > & results ) const;
+	void RayCast( const Vec3 & start, const Vec3 & end, std::vector< int > & results ) const;
+	bool RayCast( const Vec3 & start, const Vec3 & end, const rayCallback_t & callback, int & userData, float & fraction ) const;
+
+	// Calls visit( userData, inside ) for the leaves of every node that classify( bounds ) does not return
+	// OVERLAP_NONE for.  Below a node that is OVERLAP_FULL the leaves are visited with inside set, without
+	// calling classify again.  Both are template parameters so they inline into the traversal
+	template< typename classify_t, typename visit_t >
+	void Visit( const classify_t & classify, const visit_t & visit ) const;
+
+	// Collects the leaves Visit would visit
+	template< typename classify_t >
+	void Query( const classify_t & classify, std::vector< int > & results ) const;
+
+public:
+	static const int nullNode = -1;
+
+	// Fattening applied to the leaves, and how far ahead the displacement is predicted
+	float m_margin;
+	float m_displacementMultiplier;
+
+private:
+	// The tree is balanced, so even a million leaves stay well below this depth
+	static const int maxStackDepth = 256;
+
+	/*
+	====================================================
+	TraversalStack
+
+	Node stack of the queries, it lives on the fixed array and only moves to
+	the heap if a degenerate tree ever goes deeper
+	====================================================
+	*/
+	class TraversalStack {
+	public:
+		TraversalStack() : m_data( m_fixed ), m_capacity( maxStackDepth ), m_count( 0 ) {}
+		TraversalStack( const TraversalStack & ) = delete;
+		TraversalStack & operator = ( const TraversalStack & ) = delete;
+
+		void Push( const int node ) {
+			if ( m_count == m_capacity ) {
+				Grow();
+			}
+			m_data[ m_count++ ] = node;
+		}
+		int Pop() { return m_data[ --m_count ]; }
+		bool IsEmpty() const { return m_count == 0; }
+
+	private:
+		void Grow() {
+			m_capacity *= 2;
+			if ( m_data == m_fixed ) {
+				m_heap.assign( m_fixed, m_fixed + m_count );
+			}
+			m_heap.resize( m_capacity );
+			m_data = m_heap.data();
+		}
+
+		int m_fixed[ maxStackDepth ];
+		std::vector< int > m_heap;
+		int * m_data;
+		int m_capacity;
+		int m_count;
+	};
+
+	struct node_t {
+		Bounds bounds;
+		int parent;
+		int left;
+		int right;
+		int next;		// free list link
+		int height;		// leaf = 0, free node = -1
+		int userData;
+
+		bool IsLeaf() const { return left == nullNode; }
+	};
+
+	// A new leaf of CreateProxies, its center is kept next to it for the splits
+	struct buildLeaf_t {
+		Vec3 center;
+		int nodeId;
+	};
+
+	int AllocateNode();
+	void FreeNode( int nodeId );
+
+	int BuildSubtree( buildLeaf_t * leaves, const int num );
+
+	void InsertLeaf( int leaf );
+	void RemoveLeaf( int leaf );
+	void Refit( int nodeId );
+	int Balance( int nodeId );
+
+	std::vector< node_t > m_nodes;
+	int m_root;
+	int m_freeList;
+	int m_proxyCount;
+};
+
+/*
+====================================================
+DynamicBVH::Visit
+====================================================
+*/
+template< typename classify_t, typename visit_t >
+void DynamicBVH::Visit( const classify_t & classify, const visit_t & visit ) const {
+	if ( m_root == nullNode ) {
+		return;
+	}
+
+	TraversalStack stack;
+	TraversalStack subtree;
+	stack.Push( m_root );
+	while ( !stack.IsEmpty() ) {
+		const int nodeId = stack.Pop();
+		const node_t & node = m_nodes[ nodeId ];
+		const overlap_t overlap = classify( node.bounds );
+		if ( overlap == OVERLAP_NONE ) {
+			continue;
+		}
+
+		if ( node.IsLeaf() ) {
+			visit( node.userData, overlap == OVERLAP_FULL );
+			continue;
+		}
+
+		if ( overlap == OVERLAP_PARTIAL ) {
+			stack.Push( node.left );
+			stack.Push( node.right );
+			continue;
+		}
+
+		// Everything below is inside
+		subtree.Push( nodeId );
+		while ( !subtree.IsEmpty() ) {
+			const node_t & inner = m_nodes[ subtree.Pop() ];
+			if ( inner.IsLeaf() ) {
+				visit( inner.userData, true );
+			} else {
+				subtree.Push( inner.left );
+				subtree.Push( inner.right );
+			}
+		}
+	}
+}
+
+/*
+====================================================
+DynamicBVH::Query
+====================================================
+*/
+template< typename classify_t >
+void DynamicBVH::Query( const classify_t & classify, std::vector< int > & results ) const {
+	results.clear();
+	Visit( classify, [ &results ]( const int userData, const bool ) { results.push_back( userData ); } );
+}
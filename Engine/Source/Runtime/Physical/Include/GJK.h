@@ -0,0 +1,30 @@
+//
+//	GJK.h
+//
+#pragma once
+#include "Body.h"
+
+/*
+====================================================
+gjkCache_t
+
+Simplex a GJK query ended with, stored in the body spaces of the two
+bodies.  Passing the same cache to the next query of the pair starts
+GJK from these points moved to the new transforms, so pairs that
+barely moved converge in one or two support queries.  A cache must
+only be used with the pair, and body order, that filled it.
+====================================================
+*/
+struct gjkCache_t {
+	gjkCache_t() : numPts( 0 ), numIterations( 0 ) {}
+
+	int numPts;
+	Vec3 ptsA_BodySpace[ 4 ];
+	Vec3 ptsB_BodySpace[ 4 ];
+
+	int numIterations;	// support queries made by the last query, for profiling
+};
+
+bool GJK_DoesIntersect( const Body * bodyA, const Body * bodyB, gjkCache_t * cache = NULL );
+float GJK_ClosestPoints( const Body * bodyA, const Body * bodyB, Vec3 & ptOnA, Vec3 & ptOnB, gjkCache_t * cache = NULL );
+bool GJK_Query( const Body * bodyA, const Body * bodyB, const float bias, Vec3 & ptOnA, Vec3 & ptOnB, Vec3 & normal, gjkCache_t * cache = NULL );
\ No newline at end of file
@@ -3,6 +3,9 @@
 //
 #pragma once
 #include "Contact.h"
+#include "GJK.h"
 
 
-bool Intersect( Body * bodyA, Body * bodyB, const float dt, contact_t & contact );
\ No newline at end of file
+bool Intersect( Body * bodyA, Body * bodyB, contact_t & contact, gjkCache_t * cache = NULL );
+bool Intersect( Body * bodyA, Body * bodyB, const float dt, contact_t & contact, gjkCache_t * cache = NULL );
+int GetPerturbedContacts( Body * bodyA, Body * bodyB, const contact_t & contact, contact_t * contacts, const int maxContacts );
\ No newline at end of file
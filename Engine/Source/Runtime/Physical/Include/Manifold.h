@@ -0,0 +1,86 @@
+//
+//	Manifold.h
+//
+#pragma once
+#include "Contact.h"
+
+/*
+====================================================
+Manifold
+
+Up to four contact points between two touching bodies, kept across
+steps.  Every point keeps the impulses it accumulated, and they are
+applied again at the start of the next step (warm starting), so a
+resting contact starts out close to its solution instead of from
+zero.  The points are solved with sequential impulses that are
+clamped on the accumulated impulse.  Penetration is pushed out with
+split impulses: a Baumgarte bias drives the push velocities of the
+bodies instead of their real ones, so the correction moves them once
+and doesn't stay in their momentum.
+
+The contact normal points from B towards A, like contact_t.
+====================================================
+*/
+class Manifold {
+public:
+	static const int MAX_CONTACTS = 4;
+
+	Manifold();
+
+	void SetBodies( Body * bodyA, Body * bodyB );
+	void AddContact( const contact_t & contact );
+	void RemoveExpiredContacts();
+	void Clear() { m_numContacts = 0; }
+
+	void PreSolve( const float dt_sec, const bool warmStart );
+	void Solve();
+
+	int GetNumContacts() const { return m_numContacts; }
+	const contact_t & GetContact( const int idx ) const { return m_points[ idx ].contact; }
+	float GetNormalImpulse( const int idx ) const { return m_points[ idx ].normalImpulse; }
+
+	Body * m_bodyA;
+	Body * m_bodyB;
+
+private:
+	// A direction a point is solved along.  The angular terms are worked out
+	// once per step, so an iteration needs no matrix products.
+	struct row_t {
+		Vec3 dir;
+		Vec3 angularA;	// rA x dir
+		Vec3 angularB;	// rB x dir
+		Vec3 spinA;		// spin A gains per unit of impulse along dir
+		Vec3 spinB;
+		float mass;		// effective mass along dir
+	};
+
+	struct manifoldPoint_t {
+		contact_t contact;
+
+		// Accumulated over the iterations and kept across steps
+		float normalImpulse;
+		float tangentImpulse[ 2 ];
+
+		// Rebuilt by PreSolve
+		row_t normal;
+		row_t tangent[ 2 ];
+		float bias;
+
+		// Split impulse, solved on the push velocities and started from zero every step
+		float pushBias;
+		float pushImpulse;
+	};
+
+	void BuildRow( row_t & row, const Vec3 & dir, const Vec3 & rA, const Vec3 & rB ) const;
+	float GetRelativeSpeed( const row_t & row ) const;
+	void ApplyImpulse( const row_t & row, const float impulse );
+	float GetRelativePushSpeed( const row_t & row ) const;
+	void ApplyPushImpulse( const row_t & row, const float impulse );
+
+	manifoldPoint_t m_points[ MAX_CONTACTS ];
+	int m_numContacts;
+
+	Mat3 m_invInertiaA;
+	Mat3 m_invInertiaB;
+	float m_friction;
+};
\ No newline at end of file
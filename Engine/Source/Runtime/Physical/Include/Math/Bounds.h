@@ -32,4 +32,36 @@ public:
 public:
 	Vec3 mins;
 	Vec3 maxs;
-};
\ No newline at end of file
+};
+
+// The small members are inline, the broadphase trees call them for every node they touch
+
+inline const Bounds & Bounds::operator = ( const Bounds & rhs ) {
+	mins = rhs.mins;
+	maxs = rhs.maxs;
+	return *this;
+}
+
+inline bool Bounds::DoesIntersect( const Bounds & rhs ) const {
+	if ( maxs.x < rhs.mins.x || maxs.y < rhs.mins.y || maxs.z < rhs.mins.z ) {
+		return false;
+	}
+	if ( rhs.maxs.x < mins.x || rhs.maxs.y < mins.y || rhs.maxs.z < mins.z ) {
+		return false;
+	}
+	return true;
+}
+
+inline void Bounds::Expand( const Vec3 & rhs ) {
+	mins.x = ( rhs.x < mins.x ) ? rhs.x : mins.x;
+	mins.y = ( rhs.y < mins.y ) ? rhs.y : mins.y;
+	mins.z = ( rhs.z < mins.z ) ? rhs.z : mins.z;
+	maxs.x = ( rhs.x > maxs.x ) ? rhs.x : maxs.x;
+	maxs.y = ( rhs.y > maxs.y ) ? rhs.y : maxs.y;
+	maxs.z = ( rhs.z > maxs.z ) ? rhs.z : maxs.z;
+}
+
+inline void Bounds::Expand( const Bounds & rhs ) {
+	Expand( rhs.mins );
+	Expand( rhs.maxs );
+}
\ No newline at end of file
@@ -4,11 +4,48 @@
 #pragma once
 #include "Vector.h"
 #include "Matrix.h"
+#include <math.h>
 
 
+/*
+====================================================
+LCP_GaussSeidel
+
+Solves A * x = b in place.  x is the starting guess, pass last
+frame's solution to warm start or zero it for a cold start.
+Iterates until no row has a residual above residualTolerance or
+maxIterations sweeps are done, and returns the number of sweeps.
+====================================================
+*/
+template< int N >
+int LCP_GaussSeidel( const MatN< N > & A, const VecN< N > & b, VecN< N > & x, const int maxIterations, const float residualTolerance ) {
+	for ( int iter = 0; iter < maxIterations; iter++ ) {
+		float maxResidual = 0.0f;
+		for ( int i = 0; i < N; i++ ) {
+			const float residual = b[ i ] - A.rows[ i ].Dot( x );
+			const float dx = residual / A.rows[ i ][ i ];
+			if ( dx * 0.0f == dx * 0.0f ) {
+				x[ i ] = x[ i ] + dx;
+				maxResidual = fmaxf( maxResidual, fabsf( residual ) );
+			}
+		}
+
+		if ( maxResidual <= residualTolerance ) {
+			return iter + 1;
+		}
+	}
+	return maxIterations;
+}
+
 /*
 ====================================================
 LCP_GaussSeidel
 ====================================================
 */
-VecN LCP_GaussSeidel( const MatN & A, const VecN & b );
\ No newline at end of file
+template< int N >
+VecN< N > LCP_GaussSeidel( const MatN< N > & A, const VecN< N > & b ) {
+	VecN< N > x;
+	x.Zero();
+	LCP_GaussSeidel( A, b, x, N, 0.0f );
+	return x;
+}
\ No newline at end of file
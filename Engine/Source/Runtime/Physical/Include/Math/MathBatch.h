@@ -0,0 +1,22 @@
+//
+//	MathBatch.h
+//
+#pragma once
+#include "Vector.h"
+#include "Matrix.h"
+#include "Quat.h"
+
+/*
+====================================================
+Batch kernels
+
+Run the same operation over whole arrays, four elements at a time
+on the SIMD backends.  The inputs are the regular packed Vec3/Quat
+arrays, they are split into lanes on load.  results may alias an
+input array.
+====================================================
+*/
+void DotBatch( const Vec3 * a, const Vec3 * b, float * results, const int num );
+void CrossBatch( const Vec3 * a, const Vec3 * b, Vec3 * results, const int num );
+void RotateBatch( const Quat * orientations, const Vec3 * points, Vec3 * results, const int num );
+void MulBatch( const Mat3 * a, const Mat3 * b, Mat3 * results, const int num );
\ No newline at end of file
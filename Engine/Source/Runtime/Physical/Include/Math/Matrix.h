@@ -169,15 +169,19 @@ inline Mat3 Mat3::Transpose() const {
 }
 
 inline Mat3 Mat3::Inverse() const {
+	// The cofactors are the cross products of the rows, and they form the columns of the adjugate.
+	// Scalar on every backend: a four wide version spends more on the shuffles and the transpose
+	// than it saves on the products
+	const Vec3 c0 = rows[ 1 ].Cross( rows[ 2 ] );
+	const Vec3 c1 = rows[ 2 ].Cross( rows[ 0 ] );
+	const Vec3 c2 = rows[ 0 ].Cross( rows[ 1 ] );
+	const float det = rows[ 0 ].Dot( c0 );
+	const float invDet = 1.0f / det;
+
 	Mat3 inv;
-	for ( int i = 0; i < 3; i++ ) {
-		for ( int j = 0; j < 3; j++ ) {
-			inv.rows[ j ][ i ] = Cofactor( i, j );	// Perform the transpose while calculating the cofactors
-		}
-	}
-	float det = Determinant();
-	float invDet = 1.0f / det;
-	inv *= invDet;
+	inv.rows[ 0 ] = Vec3( c0.x, c1.x, c2.x ) * invDet;
+	inv.rows[ 1 ] = Vec3( c0.y, c1.y, c2.y ) * invDet;
+	inv.rows[ 2 ] = Vec3( c0.z, c1.z, c2.z ) * invDet;
 	return inv;
 }
 
@@ -207,7 +211,7 @@ inline Mat2 Mat3::Minor( const int i, const int j ) const {
 
 inline float Mat3::Cofactor( const int i, const int j ) const {
 	const Mat2 minor = Minor( i, j );
-	const float C = float( pow( -1, i + 1 + j + 1 ) ) * minor.Determinant();
+	const float C = ( ( ( i + j ) & 1 ) ? -1.0f : 1.0f ) * minor.Determinant();
 	return C;
 }
 
@@ -228,6 +232,19 @@ inline Mat3 Mat3::operator * ( const float rhs ) const {
 }
 
 inline Mat3 Mat3::operator * ( const Mat3 & rhs ) const {
+#if defined( PHYSICS_SIMD_ENABLED )
+	// Each row of the result is a weighted sum of the rows of rhs
+	const simd4_t b0 = Simd4Load3( rhs.rows[ 0 ].ToPtr() );
+	const simd4_t b1 = Simd4Load3( rhs.rows[ 1 ].ToPtr() );
+	const simd4_t b2 = Simd4Load3( rhs.rows[ 2 ].ToPtr() );
+
+	Mat3 tmp;
+	for ( int i = 0; i < 3; i++ ) {
+		const simd4_t row = Simd4Combine3( rows[ i ].x, b0, rows[ i ].y, b1, rows[ i ].z, b2 );
+		Simd4Store3( &tmp.rows[ i ].x, row );
+	}
+	return tmp;
+#else
 	Mat3 tmp;
 	for ( int i = 0; i < 3; i++ ) {
 		tmp.rows[ i ].x = rows[ i ].x * rhs.rows[ 0 ].x + rows[ i ].y * rhs.rows[ 1 ].x + rows[ i ].z * rhs.rows[ 2 ].x;
@@ -235,6 +252,7 @@ inline Mat3 Mat3::operator * ( const Mat3 & rhs ) const {
 		tmp.rows[ i ].z = rows[ i ].x * rhs.rows[ 0 ].z + rows[ i ].y * rhs.rows[ 1 ].z + rows[ i ].z * rhs.rows[ 2 ].z;
 	}
 	return tmp;
+#endif
 }
 
 inline Mat3 Mat3::operator + ( const Mat3 & rhs ) const {
@@ -408,7 +426,7 @@ inline Mat3 Mat4::Minor( const int i, const int j ) const {
 
 inline float Mat4::Cofactor( const int i, const int j ) const {
 	const Mat3 minor = Minor( i, j );
-	const float C = float( pow( -1, i + 1 + j + 1 ) ) * minor.Determinant();
+	const float C = ( ( ( i + j ) & 1 ) ? -1.0f : 1.0f ) * minor.Determinant();
 	return C;
 }
 
@@ -510,12 +528,26 @@ inline void Mat4::OrthoVulkan( float xmin, float xmax, float ymin, float ymax, f
 }
 
 inline Vec4 Mat4::operator * ( const Vec4 & rhs ) const {
+#if defined( PHYSICS_SIMD_ENABLED )
+	// Sum the columns weighted by rhs, rather than four horizontal dot products
+	simd4_t c0, c1, c2, c3;
+	Simd4LoadTranspose4( ToPtr(), c0, c1, c2, c3 );
+	simd4_t sum = Simd4Mul( c0, Simd4Splat( rhs.x ) );
+	sum = Simd4MulAdd( c1, Simd4Splat( rhs.y ), sum );
+	sum = Simd4MulAdd( c2, Simd4Splat( rhs.z ), sum );
+	sum = Simd4MulAdd( c3, Simd4Splat( rhs.w ), sum );
+
+	Vec4 tmp;
+	Simd4Store( tmp.ToPtr(), sum );
+	return tmp;
+#else
 	Vec4 tmp;
 	tmp[ 0 ] = rows[ 0 ].Dot( rhs );
 	tmp[ 1 ] = rows[ 1 ].Dot( rhs );
 	tmp[ 2 ] = rows[ 2 ].Dot( rhs );
 	tmp[ 3 ] = rows[ 3 ].Dot( rhs );
 	return tmp;
+#endif
 }
 
 inline Mat4 Mat4::operator * ( const float rhs ) const {
@@ -528,6 +560,20 @@ inline Mat4 Mat4::operator * ( const float rhs ) const {
 }
 
 inline Mat4 Mat4::operator * ( const Mat4 & rhs ) const {
+#if defined( PHYSICS_SIMD_ENABLED )
+	// Each row of the result is a weighted sum of the rows of rhs
+	const simd4_t b0 = Simd4Load( rhs.rows[ 0 ].ToPtr() );
+	const simd4_t b1 = Simd4Load( rhs.rows[ 1 ].ToPtr() );
+	const simd4_t b2 = Simd4Load( rhs.rows[ 2 ].ToPtr() );
+	const simd4_t b3 = Simd4Load( rhs.rows[ 3 ].ToPtr() );
+
+	Mat4 tmp;
+	for ( int i = 0; i < 4; i++ ) {
+		const simd4_t row = Simd4MulAdd( Simd4Splat( rows[ i ].w ), b3, Simd4Combine3( rows[ i ].x, b0, rows[ i ].y, b1, rows[ i ].z, b2 ) );
+		Simd4Store( tmp.rows[ i ].ToPtr(), row );
+	}
+	return tmp;
+#else
 	Mat4 tmp;
 	for ( int i = 0; i < 4; i++ ) {
 		tmp.rows[ i ].x = rows[ i ].x * rhs.rows[ 0 ].x + rows[ i ].y * rhs.rows[ 1 ].x + rows[ i ].z * rhs.rows[ 2 ].x + rows[ i ].w * rhs.rows[ 3 ].x;
@@ -536,115 +582,94 @@ inline Mat4 Mat4::operator * ( const Mat4 & rhs ) const {
 		tmp.rows[ i ].w = rows[ i ].x * rhs.rows[ 0 ].w + rows[ i ].y * rhs.rows[ 1 ].w + rows[ i ].z * rhs.rows[ 2 ].w + rows[ i ].w * rhs.rows[ 3 ].w;
 	}
 	return tmp;
+#endif
 }
 
 /*
 ====================================================
 MatMN
+
+M rows by N columns, stored inline like VecN.
 ====================================================
 */
+template< int M, int N >
 class MatMN {
 public:
-	MatMN() : M( 0 ), N( 0 ) {}
-	MatMN( int M, int N );
-	MatMN( const MatMN & rhs ) {
-		*this = rhs;
-	}
-	~MatMN() { delete[] rows; }
+	MatMN() {}
+	MatMN( const float value );
 
-	const MatMN & operator = ( const MatMN & rhs );
 	const MatMN & operator *= ( float rhs );
-	VecN operator * ( const VecN & rhs ) const;
-	MatMN operator * ( const MatMN & rhs ) const;
+	VecN< M > operator * ( const VecN< N > & rhs ) const;
+	template< int K >
+	MatMN< M, K > operator * ( const MatMN< N, K > & rhs ) const;
 	MatMN operator * ( const float rhs ) const;
 
 	void Zero();
-	MatMN Transpose() const;
+	MatMN< N, M > Transpose() const;
 
 public:
-	int		M;	// M rows
-	int		N;	// N columns
-	VecN *	rows;
+	VecN< N > rows[ M ];
 };
 
-inline MatMN::MatMN( int _M, int _N ) {
-	M = _M;
-	N = _N;
-	rows = new VecN[ M ];
+template< int M, int N >
+inline MatMN< M, N >::MatMN( const float value ) {
 	for ( int m = 0; m < M; m++ ) {
-		rows[ m ] = VecN( N );
+		rows[ m ] = VecN< N >( value );
 	}
 }
 
-inline const MatMN & MatMN::operator = ( const MatMN & rhs ) {
-	M = rhs.M;
-	N = rhs.N;
-	rows = new VecN[ M ];
-	for ( int m = 0; m < M; m++ ) {
-		rows[ m ] = rhs.rows[ m ];
-	}
-	return *this;
-}
-
-inline const MatMN & MatMN::operator *= ( float rhs ) {
+template< int M, int N >
+inline const MatMN< M, N > & MatMN< M, N >::operator *= ( float rhs ) {
 	for ( int m = 0; m < M; m++ ) {
 		rows[ m ] *= rhs;
 	}
 	return *this;
 }
 
-inline VecN MatMN::operator * ( const VecN & rhs ) const {
-	// Check that the incoming vector is of the correct dimension
-	if ( rhs.N != N ) {
-		return rhs;
-	}
-
-	VecN tmp( M );
+template< int M, int N >
+inline VecN< M > MatMN< M, N >::operator * ( const VecN< N > & rhs ) const {
+	VecN< M > tmp;
 	for ( int m = 0; m < M; m++ ) {
 		tmp[ m ] = rhs.Dot( rows[ m ] );
 	}
 	return tmp;
 }
 
-inline MatMN MatMN::operator * ( const MatMN & rhs ) const {
-	// Check that the incoming matrix of the correct dimension
-	if ( rhs.M != N && rhs.N != M ) {
-		return rhs;
-	}
-
-	MatMN tranposedRHS = rhs.Transpose();
+template< int M, int N >
+template< int K >
+inline MatMN< M, K > MatMN< M, N >::operator * ( const MatMN< N, K > & rhs ) const {
+	const MatMN< K, N > tranposedRHS = rhs.Transpose();
 
-	MatMN tmp( M, rhs.N );
+	MatMN< M, K > tmp;
 	for ( int m = 0; m < M; m++ ) {
-		for ( int n = 0; n < rhs.N; n++ ) {
-			tmp.rows[ m ][ n ] = rows[ m ].Dot( tranposedRHS.rows[ n ] );
+		for ( int k = 0; k < K; k++ ) {
+			tmp.rows[ m ][ k ] = rows[ m ].Dot( tranposedRHS.rows[ k ] );
 		}
 	}
 	return tmp;
 }
 
-inline MatMN MatMN::operator * ( const float rhs ) const {
+template< int M, int N >
+inline MatMN< M, N > MatMN< M, N >::operator * ( const float rhs ) const {
 	MatMN tmp = *this;
-	for ( int m = 0; m < M; m++ ) {
-		for ( int n = 0; n < N; n++ ) {
-			tmp.rows[ m ][ n ] *= rhs;
-		}
-	}
+	tmp *= rhs;
 	return tmp;
 }
 
-inline void MatMN::Zero() {
+template< int M, int N >
+inline void MatMN< M, N >::Zero() {
 	for ( int m = 0; m < M; m++ ) {
 		rows[ m ].Zero();
 	}
 }
 
-inline MatMN MatMN::Transpose() const {
-	MatMN tmp( N, M );
+template< int M, int N >
+inline MatMN< N, M > MatMN< M, N >::Transpose() const {
+	MatMN< N, M > tmp;
 	for ( int m = 0; m < M; m++ ) {
 		for ( int n = 0; n < N; n++ ) {
 			tmp.rows[ n ][ m ] = rows[ m ][ n ];
-		}		
+		}
 	}
 	return tmp;
 }
@@ -652,114 +677,88 @@ inline MatMN MatMN::Transpose() const {
 /*
 ====================================================
 MatN
+
+Square N by N matrix, stored inline like VecN.
 ====================================================
 */
+template< int N >
 class MatN {
 public:
-	MatN() : numDimensions( 0 ) {}
-	MatN( int N );
-	MatN( const MatN & rhs ) {
-		*this = rhs;
-	}
-	MatN( const MatMN & rhs ) {
-		*this = rhs;
-	}
-	~MatN() { delete[] rows; }
-
-	const MatN & operator = ( const MatN & rhs );
-	const MatN & operator = ( const MatMN & rhs );
+	MatN() {}
+	MatN( const MatMN< N, N > & rhs );
 
 	void Identity();
 	void Zero();
 	void Transpose();
 
 	void operator *= ( float rhs );
-	VecN operator * ( const VecN & rhs );
-	MatN operator * ( const MatN & rhs );
+	VecN< N > operator * ( const VecN< N > & rhs ) const;
+	MatN operator * ( const MatN & rhs ) const;
 
 public:
-	int		numDimensions;
-	VecN *	rows;
+	VecN< N > rows[ N ];
 };
 
-inline MatN::MatN( int N ) {
-	numDimensions = N;
-	rows = new VecN[ N ];
+template< int N >
+inline MatN< N >::MatN( const MatMN< N, N > & rhs ) {
 	for ( int i = 0; i < N; i++ ) {
-		rows[ i ] = VecN( N );
-	}
-}
-
-inline const MatN & MatN::operator = ( const MatN & rhs ) {
-	numDimensions = rhs.numDimensions;
-	rows = new VecN[ numDimensions ];
-	for ( int i = 0; i < numDimensions; i++ ) {
-		rows[ i ] = rhs.rows[ i ];
-	}
-	return *this;
-}
-
-inline const MatN & MatN::operator = ( const MatMN & rhs ) {
-	if ( rhs.M != rhs.N ) {
-		return *this;
-	}
-
-	numDimensions = rhs.N;
-	rows = new VecN[ numDimensions ];
-	for ( int i = 0; i < numDimensions; i++ ) {
 		rows[ i ] = rhs.rows[ i ];
 	}
-	return *this;
 }
 
-inline void MatN::Zero() {
-	for ( int i = 0; i < numDimensions; i++ ) {
+template< int N >
+inline void MatN< N >::Zero() {
+	for ( int i = 0; i < N; i++ ) {
 		rows[ i ].Zero();
 	}
 }
 
-inline void MatN::Identity() {
-	for ( int i = 0; i < numDimensions; i++ ) {
+template< int N >
+inline void MatN< N >::Identity() {
+	for ( int i = 0; i < N; i++ ) {
 		rows[ i ].Zero();
 		rows[ i ][ i ] = 1.0f;
 	}
 }
 
-inline void MatN::Transpose() {
-	MatN tmp( numDimensions );
-
-	for ( int i = 0; i < numDimensions; i++ ) {
-		for ( int j = 0; j < numDimensions; j++ ) {
-			tmp.rows[ i ][ j ] = rows[ j ][ i ];
+template< int N >
+inline void MatN< N >::Transpose() {
+	for ( int i = 0; i < N; i++ ) {
+		for ( int j = i + 1; j < N; j++ ) {
+			const float tmp = rows[ i ][ j ];
+			rows[ i ][ j ] = rows[ j ][ i ];
+			rows[ j ][ i ] = tmp;
 		}
 	}
-
-	*this = tmp;
 }
 
-inline void MatN::operator *= ( float rhs ) {
-	for ( int i = 0; i < numDimensions; i++ ) {
+template< int N >
+inline void MatN< N >::operator *= ( float rhs ) {
+	for ( int i = 0; i < N; i++ ) {
 		rows[ i ] *= rhs;
 	}
 }
 
-inline VecN MatN::operator * ( const VecN & rhs ) {
-	VecN tmp( numDimensions );
-
-	for ( int i = 0; i < numDimensions; i++ ) {
+template< int N >
+inline VecN< N > MatN< N >::operator * ( const VecN< N > & rhs ) const {
+	VecN< N > tmp;
+	for ( int i = 0; i < N; i++ ) {
 		tmp[ i ] = rows[ i ].Dot( rhs );
 	}
-
 	return tmp;
 }
 
-inline MatN MatN::operator * ( const MatN & rhs ) {
-	MatN tmp( numDimensions );
+template< int N >
+inline MatN< N > MatN< N >::operator * ( const MatN & rhs ) const {
+	MatN tmp;
 	tmp.Zero();
 
-	for ( int i = 0; i < numDimensions; i++ ) {
-		for ( int j = 0; j < numDimensions; j++ ) {
-			tmp.rows[ i ][ j ] += rows[ i ][ j ] * rhs.rows[ j ][ i ];
+	for ( int i = 0; i < N; i++ ) {
+		for ( int k = 0; k < N; k++ ) {
+			const float a = rows[ i ][ k ];
+			for ( int j = 0; j < N; j++ ) {
+				tmp.rows[ i ][ j ] += a * rhs.rows[ k ][ j ];
+			}
 		}
 	}
 
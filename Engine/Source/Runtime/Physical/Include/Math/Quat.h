@@ -142,9 +142,12 @@ inline float Quat::GetMagnitude() const {
 }
 
 inline Vec3 Quat::RotatePoint( const Vec3 & rhs ) const {
-	Quat vector( rhs.x, rhs.y, rhs.z, 0.0f );
-	Quat final = *this * vector * Inverse();
-	return Vec3( final.x, final.y, final.z );
+	// Expanded form of q * v * q^-1, without the two quaternion products
+	const Vec3 q( x, y, z );
+	const float qq = q.Dot( q );
+	const float invMagSqr = 1.0f / ( qq + w * w );
+	const Vec3 rotated = rhs * ( w * w - qq ) + q * ( 2.0f * q.Dot( rhs ) ) + q.Cross( rhs ) * ( 2.0f * w );
+	return rotated * invMagSqr;
 }
 
 inline bool Quat::IsValid() const {
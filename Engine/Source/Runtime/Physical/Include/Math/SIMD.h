@@ -0,0 +1,300 @@
+//
+//	SIMD.h
+//
+#pragma once
+
+/*
+ ================================
+ simd4_t
+
+ Four wide float vector used by the math kernels.  The backend is
+ picked at compile time: SSE on x86/x64, NEON on ARM, and a plain
+ scalar struct everywhere else.  The SSE backend uses fused multiply
+ adds when the compiler targets FMA.  There is no AVX backend, every
+ kernel works on four lanes, an AVX build runs the SSE code with VEX
+ encoded instructions.  Define PHYSICS_SIMD_SCALAR to force
+ the scalar path, e.g. to compare results or timings.  Without
+ PHYSICS_SIMD_ENABLED callers keep their plain scalar code, the
+ emulated vector is only there so the kernels always compile.
+
+ Vec3, Vec4, Mat3, Mat4 and Quat keep their scalar layout, the
+ kernels load from and store to it.
+ ================================
+ */
+#if !defined( PHYSICS_SIMD_SCALAR )
+	#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+		#define PHYSICS_SIMD_SSE
+	#elif defined( __ARM_NEON ) || defined( __ARM_NEON__ ) || defined( _M_ARM64 )
+		#define PHYSICS_SIMD_NEON
+	#endif
+#endif
+
+#if defined( PHYSICS_SIMD_SSE ) || defined( PHYSICS_SIMD_NEON )
+	#define PHYSICS_SIMD_ENABLED
+#endif
+
+#if defined( PHYSICS_SIMD_SSE )
+	#include <xmmintrin.h>
+	#include <emmintrin.h>
+	#if defined( __FMA__ )
+		#include <immintrin.h>
+	#endif
+	#define PHYSICS_SIMD_NAME "SSE"
+	typedef __m128 simd4_t;
+#elif defined( PHYSICS_SIMD_NEON )
+	#include <arm_neon.h>
+	#define PHYSICS_SIMD_NAME "NEON"
+	typedef float32x4_t simd4_t;
+#else
+	#define PHYSICS_SIMD_NAME "Scalar"
+	struct simd4_t {
+		float v[ 4 ];
+	};
+#endif
+
+#if defined( PHYSICS_SIMD_SSE )
+
+inline simd4_t Simd4Load( const float * ptr ) { return _mm_loadu_ps( ptr ); }
+inline void Simd4Store( float * ptr, const simd4_t a ) { _mm_storeu_ps( ptr, a ); }
+inline simd4_t Simd4Splat( const float value ) { return _mm_set1_ps( value ); }
+inline simd4_t Simd4Add( const simd4_t a, const simd4_t b ) { return _mm_add_ps( a, b ); }
+inline simd4_t Simd4Sub( const simd4_t a, const simd4_t b ) { return _mm_sub_ps( a, b ); }
+inline simd4_t Simd4Mul( const simd4_t a, const simd4_t b ) { return _mm_mul_ps( a, b ); }
+inline simd4_t Simd4Div( const simd4_t a, const simd4_t b ) { return _mm_div_ps( a, b ); }
+
+// a * b + c
+inline simd4_t Simd4MulAdd( const simd4_t a, const simd4_t b, const simd4_t c ) {
+#if defined( __FMA__ )
+	return _mm_fmadd_ps( a, b, c );
+#else
+	return _mm_add_ps( _mm_mul_ps( a, b ), c );
+#endif
+}
+
+// Loads x, y, z and clears w, without reading past the third float
+inline simd4_t Simd4Load3( const float * ptr ) {
+	const simd4_t xy = _mm_castpd_ps( _mm_load_sd( (const double *)ptr ) );
+	const simd4_t z = _mm_load_ss( ptr + 2 );
+	return _mm_movelh_ps( xy, z );
+}
+
+inline void Simd4Store3( float * ptr, const simd4_t a ) {
+	_mm_store_sd( (double *)ptr, _mm_castps_pd( a ) );
+	_mm_store_ss( ptr + 2, _mm_movehl_ps( a, a ) );
+}
+
+inline float Simd4Sum( const simd4_t a ) {
+	const simd4_t shuf = _mm_shuffle_ps( a, a, _MM_SHUFFLE( 2, 3, 0, 1 ) );
+	const simd4_t sums = _mm_add_ps( a, shuf );
+	return _mm_cvtss_f32( _mm_add_ss( sums, _mm_movehl_ps( shuf, sums ) ) );
+}
+
+// Loads four packed Vec3s and splits them into x, y and z lanes
+inline void Simd4LoadVec3x4( const float * ptr, simd4_t & x, simd4_t & y, simd4_t & z ) {
+	const simd4_t x0y0z0x1 = _mm_loadu_ps( ptr + 0 );
+	const simd4_t y1z1x2y2 = _mm_loadu_ps( ptr + 4 );
+	const simd4_t z2x3y3z3 = _mm_loadu_ps( ptr + 8 );
+	const simd4_t x2y2x3y3 = _mm_shuffle_ps( y1z1x2y2, z2x3y3z3, _MM_SHUFFLE( 2, 1, 3, 2 ) );
+	const simd4_t y0z0y1z1 = _mm_shuffle_ps( x0y0z0x1, y1z1x2y2, _MM_SHUFFLE( 1, 0, 2, 1 ) );
+	x = _mm_shuffle_ps( x0y0z0x1, x2y2x3y3, _MM_SHUFFLE( 2, 0, 3, 0 ) );
+	y = _mm_shuffle_ps( y0z0y1z1, x2y2x3y3, _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	z = _mm_shuffle_ps( y0z0y1z1, z2x3y3z3, _MM_SHUFFLE( 3, 0, 3, 1 ) );
+}
+
+inline void Simd4StoreVec3x4( float * ptr, const simd4_t x, const simd4_t y, const simd4_t z ) {
+	const simd4_t x0y0x1y1 = _mm_unpacklo_ps( x, y );
+	const simd4_t x2y2x3y3 = _mm_unpackhi_ps( x, y );
+	const simd4_t z0z0x1x1 = _mm_shuffle_ps( z, x0y0x1y1, _MM_SHUFFLE( 2, 2, 0, 0 ) );
+	const simd4_t y1y1z1z1 = _mm_shuffle_ps( x0y0x1y1, z, _MM_SHUFFLE( 1, 1, 3, 3 ) );
+	const simd4_t z2z2x3x3 = _mm_shuffle_ps( z, x2y2x3y3, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+	const simd4_t y3y3z3z3 = _mm_shuffle_ps( x2y2x3y3, z, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+	_mm_storeu_ps( ptr + 0, _mm_shuffle_ps( x0y0x1y1, z0z0x1x1, _MM_SHUFFLE( 2, 0, 1, 0 ) ) );
+	_mm_storeu_ps( ptr + 4, _mm_shuffle_ps( y1y1z1z1, x2y2x3y3, _MM_SHUFFLE( 1, 0, 2, 0 ) ) );
+	_mm_storeu_ps( ptr + 8, _mm_shuffle_ps( z2z2x3x3, y3y3z3z3, _MM_SHUFFLE( 2, 0, 2, 0 ) ) );
+}
+
+// Loads four packed 4 float structs and splits them into lanes
+inline void Simd4LoadTranspose4( const float * ptr, simd4_t & a, simd4_t & b, simd4_t & c, simd4_t & d ) {
+	a = _mm_loadu_ps( ptr + 0 );
+	b = _mm_loadu_ps( ptr + 4 );
+	c = _mm_loadu_ps( ptr + 8 );
+	d = _mm_loadu_ps( ptr + 12 );
+	_MM_TRANSPOSE4_PS( a, b, c, d );
+}
+
+#elif defined( PHYSICS_SIMD_NEON )
+
+inline simd4_t Simd4Load( const float * ptr ) { return vld1q_f32( ptr ); }
+inline void Simd4Store( float * ptr, const simd4_t a ) { vst1q_f32( ptr, a ); }
+inline simd4_t Simd4Splat( const float value ) { return vdupq_n_f32( value ); }
+inline simd4_t Simd4Add( const simd4_t a, const simd4_t b ) { return vaddq_f32( a, b ); }
+inline simd4_t Simd4Sub( const simd4_t a, const simd4_t b ) { return vsubq_f32( a, b ); }
+inline simd4_t Simd4Mul( const simd4_t a, const simd4_t b ) { return vmulq_f32( a, b ); }
+inline simd4_t Simd4MulAdd( const simd4_t a, const simd4_t b, const simd4_t c ) { return vmlaq_f32( c, a, b ); }
+
+inline simd4_t Simd4Div( const simd4_t a, const simd4_t b ) {
+	// Two Newton-Raphson steps on the reciprocal estimate
+	simd4_t inv = vrecpeq_f32( b );
+	inv = vmulq_f32( vrecpsq_f32( b, inv ), inv );
+	inv = vmulq_f32( vrecpsq_f32( b, inv ), inv );
+	return vmulq_f32( a, inv );
+}
+
+inline simd4_t Simd4Load3( const float * ptr ) {
+	const float32x2_t xy = vld1_f32( ptr );
+	const float32x2_t z0 = vld1_lane_f32( ptr + 2, vdup_n_f32( 0.0f ), 0 );
+	return vcombine_f32( xy, z0 );
+}
+
+inline void Simd4Store3( float * ptr, const simd4_t a ) {
+	vst1_f32( ptr, vget_low_f32( a ) );
+	vst1q_lane_f32( ptr + 2, a, 2 );
+}
+
+inline float Simd4Sum( const simd4_t a ) {
+	float32x2_t sum = vadd_f32( vget_low_f32( a ), vget_high_f32( a ) );
+	sum = vpadd_f32( sum, sum );
+	return vget_lane_f32( sum, 0 );
+}
+
+inline void Simd4LoadVec3x4( const float * ptr, simd4_t & x, simd4_t & y, simd4_t & z ) {
+	const float32x4x3_t xyz = vld3q_f32( ptr );
+	x = xyz.val[ 0 ];
+	y = xyz.val[ 1 ];
+	z = xyz.val[ 2 ];
+}
+
+inline void Simd4StoreVec3x4( float * ptr, const simd4_t x, const simd4_t y, const simd4_t z ) {
+	float32x4x3_t xyz;
+	xyz.val[ 0 ] = x;
+	xyz.val[ 1 ] = y;
+	xyz.val[ 2 ] = z;
+	vst3q_f32( ptr, xyz );
+}
+
+inline void Simd4LoadTranspose4( const float * ptr, simd4_t & a, simd4_t & b, simd4_t & c, simd4_t & d ) {
+	const float32x4x4_t abcd = vld4q_f32( ptr );
+	a = abcd.val[ 0 ];
+	b = abcd.val[ 1 ];
+	c = abcd.val[ 2 ];
+	d = abcd.val[ 3 ];
+}
+
+#else
+
+inline simd4_t Simd4Load( const float * ptr ) {
+	simd4_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		r.v[ i ] = ptr[ i ];
+	}
+	return r;
+}
+
+inline void Simd4Store( float * ptr, const simd4_t a ) {
+	for ( int i = 0; i < 4; i++ ) {
+		ptr[ i ] = a.v[ i ];
+	}
+}
+
+inline simd4_t Simd4Splat( const float value ) {
+	simd4_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		r.v[ i ] = value;
+	}
+	return r;
+}
+
+inline simd4_t Simd4Add( const simd4_t a, const simd4_t b ) {
+	simd4_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		r.v[ i ] = a.v[ i ] + b.v[ i ];
+	}
+	return r;
+}
+
+inline simd4_t Simd4Sub( const simd4_t a, const simd4_t b ) {
+	simd4_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		r.v[ i ] = a.v[ i ] - b.v[ i ];
+	}
+	return r;
+}
+
+inline simd4_t Simd4Mul( const simd4_t a, const simd4_t b ) {
+	simd4_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		r.v[ i ] = a.v[ i ] * b.v[ i ];
+	}
+	return r;
+}
+
+inline simd4_t Simd4Div( const simd4_t a, const simd4_t b ) {
+	simd4_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		r.v[ i ] = a.v[ i ] / b.v[ i ];
+	}
+	return r;
+}
+
+inline simd4_t Simd4MulAdd( const simd4_t a, const simd4_t b, const simd4_t c ) {
+	simd4_t r;
+	for ( int i = 0; i < 4; i++ ) {
+		r.v[ i ] = a.v[ i ] * b.v[ i ] + c.v[ i ];
+	}
+	return r;
+}
+
+inline simd4_t Simd4Load3( const float * ptr ) {
+	simd4_t r;
+	r.v[ 0 ] = ptr[ 0 ];
+	r.v[ 1 ] = ptr[ 1 ];
+	r.v[ 2 ] = ptr[ 2 ];
+	r.v[ 3 ] = 0.0f;
+	return r;
+}
+
+inline void Simd4Store3( float * ptr, const simd4_t a ) {
+	ptr[ 0 ] = a.v[ 0 ];
+	ptr[ 1 ] = a.v[ 1 ];
+	ptr[ 2 ] = a.v[ 2 ];
+}
+
+inline float Simd4Sum( const simd4_t a ) {
+	return ( a.v[ 0 ] + a.v[ 1 ] ) + ( a.v[ 2 ] + a.v[ 3 ] );
+}
+
+inline void Simd4LoadVec3x4( const float * ptr, simd4_t & x, simd4_t & y, simd4_t & z ) {
+	for ( int i = 0; i < 4; i++ ) {
+		x.v[ i ] = ptr[ i * 3 + 0 ];
+		y.v[ i ] = ptr[ i * 3 + 1 ];
+		z.v[ i ] = ptr[ i * 3 + 2 ];
+	}
+}
+
+inline void Simd4StoreVec3x4( float * ptr, const simd4_t x, const simd4_t y, const simd4_t z ) {
+	for ( int i = 0; i < 4; i++ ) {
+		ptr[ i * 3 + 0 ] = x.v[ i ];
+		ptr[ i * 3 + 1 ] = y.v[ i ];
+		ptr[ i * 3 + 2 ] = z.v[ i ];
+	}
+}
+
+inline void Simd4LoadTranspose4( const float * ptr, simd4_t & a, simd4_t & b, simd4_t & c, simd4_t & d ) {
+	for ( int i = 0; i < 4; i++ ) {
+		a.v[ i ] = ptr[ i * 4 + 0 ];
+		b.v[ i ] = ptr[ i * 4 + 1 ];
+		c.v[ i ] = ptr[ i * 4 + 2 ];
+		d.v[ i ] = ptr[ i * 4 + 3 ];
+	}
+}
+
+#endif
+
+inline float Simd4Dot4( const simd4_t a, const simd4_t b ) {
+	return Simd4Sum( Simd4Mul( a, b ) );
+}
+
+// a * x + b * y + c * z with broadcast scalars, the building block for the matrix products
+inline simd4_t Simd4Combine3( const float x, const simd4_t a, const float y, const simd4_t b, const float z, const simd4_t c ) {
+	return Simd4MulAdd( Simd4Splat( z ), c, Simd4MulAdd( Simd4Splat( y ), b, Simd4Mul( Simd4Splat( x ), a ) ) );
+}
\ No newline at end of file
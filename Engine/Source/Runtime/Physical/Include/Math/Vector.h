@@ -5,6 +5,7 @@
 #include <math.h>
 #include <assert.h>
 #include <stdio.h>
+#include "SIMD.h"
 
 /*
  ================================
@@ -615,11 +616,15 @@ inline float& Vec4::operator [] ( const int idx ) {
 }
 
 inline float Vec4::Dot( const Vec4 & rhs ) const {
+#if defined( PHYSICS_SIMD_ENABLED )
+	return Simd4Dot4( Simd4Load( &x ), Simd4Load( &rhs.x ) );
+#else
 	float xx = x * rhs.x;
 	float yy = y * rhs.y;
 	float zz = z * rhs.z;
 	float ww = w * rhs.w;
 	return ( xx + yy + zz + ww );
+#endif
 }
 
 inline const Vec4 & Vec4::Normalize() {
@@ -667,15 +672,17 @@ inline bool Vec4::IsValid() const {
 /*
  ================================
  VecN
+
+ Fixed size vector, the storage lives inline so copies and moves
+ never touch the heap.
  ================================
  */
+template< int N >
 class VecN {
 public:
-	VecN() : N( 0 ), data( NULL ) {}
-	VecN( int _N );
-	VecN( const VecN & rhs );
-	VecN & operator = ( const VecN & rhs );
-	~VecN() { delete[] data; }
+	VecN() {}
+	VecN( const float value );
+	VecN( const float * rhs );
 
 	float			operator[] ( const int idx ) const { return data[ idx ]; }
 	float &			operator[] ( const int idx ) { return data[ idx ]; }
@@ -688,80 +695,74 @@ public:
 
 	float Dot( const VecN & rhs ) const;
 	void Zero();
-	
+
+	static int GetSize() { return N; }
+
 public:
-	int		N;
-	float *	data;
+	float	data[ N ];
 };
 
-inline VecN::VecN( int _N ) {
-	N = _N;
-	data = new float[ _N ];
-}
-
-inline VecN::VecN( const VecN & rhs ) {
-	N = rhs.N;
-	data = new float[ N ];
+template< int N >
+inline VecN< N >::VecN( const float value ) {
 	for ( int i = 0; i < N; i++ ) {
-		data[ i ] = rhs.data[ i ];
+		data[ i ] = value;
 	}
 }
 
-inline VecN & VecN::operator = ( const VecN & rhs ) {
-	delete[] data;
-
-	N = rhs.N;
-	data = new float[ N ];
+template< int N >
+inline VecN< N >::VecN( const float * rhs ) {
 	for ( int i = 0; i < N; i++ ) {
-		data[ i ] = rhs.data[ i ];
+		data[ i ] = rhs[ i ];
 	}
-	return *this;
 }
 
-inline const VecN & VecN::operator *= ( float rhs ) {
+template< int N >
+inline const VecN< N > & VecN< N >::operator *= ( float rhs ) {
 	for ( int i = 0; i < N; i++ ) {
 		data[ i ] *= rhs;
 	}
 	return *this;
 }
 
-inline VecN VecN::operator * ( float rhs ) const {
+template< int N >
+inline VecN< N > VecN< N >::operator * ( float rhs ) const {
 	VecN tmp = *this;
 	tmp *= rhs;
 	return tmp;
 }
 
-inline VecN VecN::operator + ( const VecN & rhs ) const {
+template< int N >
+inline VecN< N > VecN< N >::operator + ( const VecN & rhs ) const {
 	VecN tmp = *this;
-	for ( int i = 0; i < N; i++ ) {
-		tmp.data[ i ] += rhs.data[ i ];
-	}
+	tmp += rhs;
 	return tmp;
 }
 
-inline VecN VecN::operator - ( const VecN & rhs ) const {
+template< int N >
+inline VecN< N > VecN< N >::operator - ( const VecN & rhs ) const {
 	VecN tmp = *this;
-	for ( int i = 0; i < N; i++ ) {
-		tmp.data[ i ] -= rhs.data[ i ];
-	}
+	tmp -= rhs;
 	return tmp;
 }
 
-inline const VecN & VecN::operator += ( const VecN & rhs ) {
+template< int N >
+inline const VecN< N > & VecN< N >::operator += ( const VecN & rhs ) {
 	for ( int i = 0; i < N; i++ ) {
 		data[ i ] += rhs.data[ i ];
 	}
 	return *this;
 }
 
-inline const VecN & VecN::operator -= ( const VecN & rhs ) {
+template< int N >
+inline const VecN< N > & VecN< N >::operator -= ( const VecN & rhs ) {
 	for ( int i = 0; i < N; i++ ) {
 		data[ i ] -= rhs.data[ i ];
 	}
 	return *this;
 }
 
-inline float VecN::Dot( const VecN & rhs ) const {
+template< int N >
+inline float VecN< N >::Dot( const VecN & rhs ) const {
 	float sum = 0;
 	for ( int i = 0; i < N; i++ ) {
 		sum += data[ i ] * rhs.data[ i ];
@@ -769,7 +770,8 @@ inline float VecN::Dot( const VecN & rhs ) const {
 	return sum;
 }
 
-inline void VecN::Zero() {
+template< int N >
+inline void VecN< N >::Zero() {
 	for ( int i = 0; i < N; i++ ) {
 		data[ i ] = 0.0f;
 	}
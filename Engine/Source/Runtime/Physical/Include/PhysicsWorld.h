@@ -0,0 +1,138 @@
+//
+//	PhysicsWorld.h
+//
+#pragma once
+#include "Body.h"
+#include "Broadphase.h"
+#include "Contact.h"
+#include "GJK.h"
+#include "Manifold.h"
+#include <functional>
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+class PriorityThreadPool;
+
+/*
+====================================================
+PhysicsWorld
+
+Owns the bodies and drives a full simulation step.  Contacts are
+grouped into islands of dynamic bodies that touch each other, and
+every island is solved on its own, in parallel when a thread pool is
+attached.  Islands are numbered by their lowest body index and their
+contacts are resolved in a fixed order, so the result of a step does
+not depend on how the islands were spread over the threads.
+
+Bodies that already touch keep a Manifold per pair, solved with
+m_numSolverIterations rounds of sequential impulses.  Contacts that
+are only reached later in the step are resolved one at a time in time
+of impact order.  Resolving an impact changes the course of its
+bodies, so their fast pairs are tested again for the rest of the step,
+up to m_maxSubsteps times per island, or once per thickness of the
+thinner body its fastest pair moves within the step when that's more.
+That lets fast projectiles bounce more than once per step without
+shrinking the step.
+
+An island whose bodies all stayed below the sleep speeds for
+m_timeToSleep falls asleep as a whole.  Sleeping bodies are skipped by
+every phase of the step until an awake body touches one of them, or an
+impulse is applied to one, which wakes the island it fell asleep with.
+
+Shapes are not owned by the world.
+====================================================
+*/
+class PhysicsWorld {
+public:
+	PhysicsWorld();
+
+	void SetThreadPool( PriorityThreadPool * threadPool, const int numTasks );
+	void Step( const float dt_sec );
+
+	int GetNumIslands() const { return m_islandBodyStart.empty() ? 0 : (int)m_islandBodyStart.size() - 1; }
+	int GetNumContacts() const { return (int)m_contacts.size(); }
+	int GetNumManifolds() const { return (int)m_manifolds.size(); }
+
+public:
+	std::vector< Body > m_bodies;
+	Vec3 m_gravity;
+	int m_numSolverIterations;
+	bool m_warmStarting;
+	int m_maxSubsteps;	// fewest retests per island, 0 resolves the impacts found at the start of the step only
+	bool m_allowSleeping;
+	float m_sleepLinearSpeed;
+	float m_sleepAngularSpeed;
+	float m_timeToSleep;
+
+private:
+	typedef std::function< void ( int begin, int end ) > rangeTask_t;
+
+	// Impact waiting to be resolved by SubstepIsland
+	struct pendingContact_t {
+		contact_t contact;
+		int pair;
+		bool dropped;
+	};
+
+	void ParallelFor( const int num, const int batchSize, const rangeTask_t & task );
+
+	void UpdateSleepGroups();
+	bool WakeTouchedBodies( const float dt_sec );
+	void WakeBody( const int id );
+	void PutIslandsToSleep();
+
+	void NarrowPhase( const float dt_sec );
+	void BuildIslands();
+	void SolveIsland( const int island, const float dt_sec );
+	void SubstepIsland( const int island, const float dt_sec );
+	void RetestFastPairs( std::vector< pendingContact_t > & pending, const int first, const int * fastPairIds, const int numFastPairs, const Body * hitA, const Body * hitB, const float time, const float dt_sec );
+	void AdvanceBody( Body * body, const float time );
+
+	int FindRoot( int id );
+	void Union( int a, int b );
+
+	PriorityThreadPool * m_threadPool;
+	int m_numTasks;
+	int m_stepCount;
+
+	BVHBroadPhase m_broadPhase;
+	std::vector< collisionPair_t > m_pairs;
+
+	// Per pair data kept across steps, dropped once the broadphase stops reporting the pair
+	struct pairCache_t {
+		gjkCache_t simplex;
+		Manifold manifold;
+		int lastStep;
+	};
+	std::unordered_map< uint64_t, pairCache_t > m_pairCaches;
+
+	std::vector< contact_t > m_narrowContacts;
+	std::vector< int > m_narrowHits;	// not vector< bool >, it is written from several threads
+	std::vector< int > m_narrowFast;
+	std::vector< pairCache_t * > m_narrowCaches;
+	std::vector< contact_t > m_contacts;
+	std::vector< int > m_contactPairs;
+	std::vector< Manifold * > m_manifolds;
+	std::vector< int > m_fastPairs;
+
+	// Islands are stored as ranges into the flat body and contact lists
+	std::vector< int > m_parents;
+	std::vector< int > m_islandOfBody;
+	std::vector< int > m_islandBodyStart;
+	std::vector< int > m_islandBodies;
+	std::vector< int > m_islandContactStart;
+	std::vector< int > m_islandContacts;
+	std::vector< int > m_islandManifoldStart;
+	std::vector< int > m_islandManifolds;
+	std::vector< int > m_islandFastPairStart;
+	std::vector< int > m_islandFastPairs;
+	std::vector< int > m_islandCursor;
+	std::vector< int > m_islandCanSleep;
+	std::vector< float > m_bodyTimes;
+
+	// Bodies that fell asleep together, so they are woken together
+	std::vector< int > m_sleepGroupOfBody;
+	std::vector< std::vector< int > > m_sleepGroups;
+	std::vector< int > m_freeSleepGroups;
+};
\ No newline at end of file
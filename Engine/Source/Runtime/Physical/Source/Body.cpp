@@ -2,6 +2,7 @@
 //  Body.cpp
 //
 #include "Body.h"
+#include "Math/MathBatch.h"
 
 /*
 ====================================================
@@ -11,8 +12,12 @@ Body::Body
 Body::Body() :
 m_position( 0.0f ),
 m_orientation( 0.0f, 0.0f, 0.0f, 1.0f ),
-m_shape( NULL ) {
+m_shape( NULL ),
+m_isAwake( true ),
+m_sleepTime( 0.0f ) {
 	m_linearVelocity.Zero();
+	m_pushLinearVelocity.Zero();
+	m_pushAngularVelocity.Zero();
 }
 
 /*
@@ -112,6 +117,8 @@ void Body::ApplyImpulseLinear( const Vec3 & impulse ) {
 		return;
 	}
 
+	SetAwake( true );
+
 	// p = mv
 	// dp = m dv = J
 	// => dv = J / m
@@ -128,6 +135,8 @@ void Body::ApplyImpulseAngular( const Vec3 & impulse ) {
 		return;
 	}
 
+	SetAwake( true );
+
 	// L = I w = r x p
 	// dL = I dw = r x J 
 	// => dw = I^-1 * ( r x J )
@@ -140,12 +149,37 @@ void Body::ApplyImpulseAngular( const Vec3 & impulse ) {
 	}
 }
 
+/*
+====================================================
+Body::SetAwake
+
+Putting a body to sleep stops it, waking it starts the count towards
+sleep over.  Static bodies never sleep.
+====================================================
+*/
+void Body::SetAwake( const bool awake ) {
+	if ( awake == m_isAwake || ( !awake && 0.0f == m_invMass ) ) {
+		return;
+	}
+
+	m_isAwake = awake;
+	m_sleepTime = 0.0f;
+	if ( !awake ) {
+		m_linearVelocity.Zero();
+		m_angularVelocity.Zero();
+	}
+}
+
 /*
 ====================================================
 Body::Update
 ====================================================
 */
 void Body::Update( const float dt_sec ) {
+	if ( !m_isAwake ) {
+		return;
+	}
+
 	m_position += m_linearVelocity * dt_sec;
 
 	// okay, we have an angular velocity around the center of mass, this needs to be
@@ -172,4 +206,79 @@ void Body::Update( const float dt_sec ) {
 
 	// Now get the new model position
 	m_position = positionCM + dq.RotatePoint( cmToPos );
+}
+
+/*
+====================================================
+Body::ApplyPushVelocity
+
+Moves the body by the push velocities for dt_sec and clears them.
+Unlike Update there is no precession, the push isn't a real motion.
+====================================================
+*/
+void Body::ApplyPushVelocity( const float dt_sec ) {
+	if ( 0.0f == m_invMass ) {
+		return;
+	}
+
+	const Vec3 positionCM = GetCenterOfMassWorldSpace();
+	const Vec3 cmToPos = m_position - positionCM;
+
+	const Vec3 dAngle = m_pushAngularVelocity * dt_sec;
+	const Quat dq = Quat( dAngle, dAngle.GetMagnitude() );
+	m_orientation = dq * m_orientation;
+	m_orientation.Normalize();
+
+	m_position = positionCM + m_pushLinearVelocity * dt_sec + dq.RotatePoint( cmToPos );
+
+	m_pushLinearVelocity.Zero();
+	m_pushAngularVelocity.Zero();
+}
+
+/*
+====================================================
+GetCentersOfMassWorldSpace
+====================================================
+*/
+void GetCentersOfMassWorldSpace( const Body * bodies, const int num, Vec3 * centers ) {
+	// Gather small chunks on the stack so the rotations can run through the batch kernel
+	const int chunkSize = 64;
+	Quat orientations[ chunkSize ];
+	Vec3 offsets[ chunkSize ];
+
+	for ( int start = 0; start < num; start += chunkSize ) {
+		const int count = ( num - start < chunkSize ) ? ( num - start ) : chunkSize;
+		for ( int i = 0; i < count; i++ ) {
+			orientations[ i ] = bodies[ start + i ].m_orientation;
+			offsets[ i ] = bodies[ start + i ].m_shape->GetCenterOfMass();
+		}
+
+		RotateBatch( orientations, offsets, offsets, count );
+
+		for ( int i = 0; i < count; i++ ) {
+			centers[ start + i ] = bodies[ start + i ].m_position + offsets[ i ];
+		}
+	}
+}
+
+/*
+====================================================
+GetInverseInertiaTensorsWorldSpace
+====================================================
+*/
+void GetInverseInertiaTensorsWorldSpace( const Body * bodies, const int num, Mat3 * invInertias ) {
+	// Bodies usually share shapes, only invert the shape's tensor when it changes
+	const Shape * lastShape = NULL;
+	Mat3 shapeInvInertia;
+
+	for ( int i = 0; i < num; i++ ) {
+		const Body & body = bodies[ i ];
+		if ( body.m_shape != lastShape ) {
+			lastShape = body.m_shape;
+			shapeInvInertia = lastShape->InertiaTensor().Inverse();
+		}
+
+		const Mat3 orient = body.m_orientation.ToMat3();
+		invInertias[ i ] = orient * ( shapeInvInertia * body.m_invMass ) * orient.Transpose();
+	}
 }
\ No newline at end of file
@@ -0,0 +1,340 @@
+//
+//  BodyStorage.cpp
+//
+#include "BodyStorage.h"
+#include "Math/SIMD.h"
+
+/*
+====================================================
+TransposeMultiply
+
+m^T * v without building the transpose
+====================================================
+*/
+static Vec3 TransposeMultiply( const Mat3 & m, const Vec3 & v ) {
+	return m.rows[ 0 ] * v.x + m.rows[ 1 ] * v.y + m.rows[ 2 ] * v.z;
+}
+
+/*
+========================================================================================================
+
+BodyHandle
+
+========================================================================================================
+*/
+
+/*
+====================================================
+BodyHandle::BodyHandle
+====================================================
+*/
+BodyHandle::BodyHandle( BodyStorage & storage, const int index ) :
+m_position( storage.m_positions[ index ] ),
+m_orientation( storage.m_orientations[ index ] ),
+m_linearVelocity( storage.m_linearVelocities[ index ] ),
+m_angularVelocity( storage.m_angularVelocities[ index ] ),
+m_invMass( storage.m_invMasses[ index ] ),
+m_elasticity( storage.m_elasticities[ index ] ),
+m_friction( storage.m_frictions[ index ] ),
+m_shape( storage.m_shapes[ index ] ),
+m_storage( &storage ),
+m_index( index ) {
+}
+
+/*
+====================================================
+BodyHandle::SetOrientation
+====================================================
+*/
+void BodyHandle::SetOrientation( const Quat & orientation ) {
+	m_storage->m_orientations[ m_index ] = orientation;
+	m_storage->m_invInertiaDirty[ m_index ] = 1;
+}
+
+/*
+====================================================
+BodyHandle::GetCenterOfMassWorldSpace
+====================================================
+*/
+Vec3 BodyHandle::GetCenterOfMassWorldSpace() const {
+	return m_position + m_orientation.RotatePoint( m_storage->m_centersOfMass[ m_index ] );
+}
+
+/*
+====================================================
+BodyHandle::GetCenterOfMassModelSpace
+====================================================
+*/
+Vec3 BodyHandle::GetCenterOfMassModelSpace() const {
+	return m_storage->m_centersOfMass[ m_index ];
+}
+
+/*
+====================================================
+BodyHandle::WorldSpaceToBodySpace
+====================================================
+*/
+Vec3 BodyHandle::WorldSpaceToBodySpace( const Vec3 & worldPt ) const {
+	Vec3 tmp			= worldPt - GetCenterOfMassWorldSpace();
+	Quat inverseOrient	= m_orientation.Inverse();
+	Vec3 bodySpace		= inverseOrient.RotatePoint( tmp );
+	return bodySpace;
+}
+
+/*
+====================================================
+BodyHandle::BodySpaceToWorldSpace
+====================================================
+*/
+Vec3 BodyHandle::BodySpaceToWorldSpace( const Vec3 & worldPt ) const {
+	Vec3 worldSpace = GetCenterOfMassWorldSpace() + m_orientation.RotatePoint( worldPt );
+	return worldSpace;
+}
+
+/*
+====================================================
+BodyHandle::GetInverseInertiaTensorWorldSpace
+====================================================
+*/
+Mat3 BodyHandle::GetInverseInertiaTensorWorldSpace() const {
+	return m_storage->GetInverseInertiaTensorWorldSpace( m_index );
+}
+
+/*
+====================================================
+BodyHandle::ApplyImpulse
+====================================================
+*/
+void BodyHandle::ApplyImpulse( const Vec3 & impulsePoint, const Vec3 & impulse ) {
+	if ( 0.0f == m_invMass ) {
+		return;
+	}
+
+	// impulsePoint is the world space location of the application of the impulse
+	// impulse is the world space direction and magnitude of the impulse
+	ApplyImpulseLinear( impulse );
+
+	Vec3 position = GetCenterOfMassWorldSpace();	// applying impulses must produce torques through the center of mass
+	Vec3 r = impulsePoint - position;
+	Vec3 dL = r.Cross( impulse );	// this is in world space
+	ApplyImpulseAngular( dL );
+}
+
+/*
+====================================================
+BodyHandle::ApplyImpulseLinear
+====================================================
+*/
+void BodyHandle::ApplyImpulseLinear( const Vec3 & impulse ) {
+	if ( 0.0f == m_invMass ) {
+		return;
+	}
+
+	m_linearVelocity += impulse * m_invMass;
+}
+
+/*
+====================================================
+BodyHandle::ApplyImpulseAngular
+====================================================
+*/
+void BodyHandle::ApplyImpulseAngular( const Vec3 & impulse ) {
+	if ( 0.0f == m_invMass ) {
+		return;
+	}
+
+	m_angularVelocity += GetInverseInertiaTensorWorldSpace() * impulse;
+
+	const float maxAngularSpeed = 30.0f; // same clamp as Body::ApplyImpulseAngular
+	if ( m_angularVelocity.GetLengthSqr() > maxAngularSpeed * maxAngularSpeed ) {
+		m_angularVelocity.Normalize();
+		m_angularVelocity *= maxAngularSpeed;
+	}
+}
+
+/*
+====================================================
+BodyHandle::Update
+====================================================
+*/
+void BodyHandle::Update( const float dt_sec ) {
+	m_position += m_linearVelocity * dt_sec;
+	m_storage->IntegrateAngular( m_index, dt_sec );
+}
+
+/*
+========================================================================================================
+
+BodyStorage
+
+========================================================================================================
+*/
+
+/*
+====================================================
+BodyStorage::Add
+====================================================
+*/
+int BodyStorage::Add( const Body & body ) {
+	m_positions.push_back( body.m_position );
+	m_orientations.push_back( body.m_orientation );
+	m_linearVelocities.push_back( body.m_linearVelocity );
+	m_angularVelocities.push_back( body.m_angularVelocity );
+	m_invMasses.push_back( body.m_invMass );
+	m_elasticities.push_back( body.m_elasticity );
+	m_frictions.push_back( body.m_friction );
+	m_shapes.push_back( body.m_shape );
+
+	const Mat3 inertiaTensor = body.m_shape->InertiaTensor();
+	m_centersOfMass.push_back( body.m_shape->GetCenterOfMass() );
+	m_inertiaTensors.push_back( inertiaTensor );
+	m_invInertiaTensors.push_back( inertiaTensor.Inverse() );
+
+	m_invInertiaWorldSpace.push_back( Mat3() );
+	m_invInertiaDirty.push_back( 1 );
+	return Size() - 1;
+}
+
+/*
+====================================================
+BodyStorage::Clear
+====================================================
+*/
+void BodyStorage::Clear() {
+	m_positions.clear();
+	m_orientations.clear();
+	m_linearVelocities.clear();
+	m_angularVelocities.clear();
+	m_invMasses.clear();
+	m_elasticities.clear();
+	m_frictions.clear();
+	m_shapes.clear();
+	m_centersOfMass.clear();
+	m_inertiaTensors.clear();
+	m_invInertiaTensors.clear();
+	m_invInertiaWorldSpace.clear();
+	m_invInertiaDirty.clear();
+}
+
+/*
+====================================================
+BodyStorage::Reserve
+====================================================
+*/
+void BodyStorage::Reserve( const int num ) {
+	m_positions.reserve( num );
+	m_orientations.reserve( num );
+	m_linearVelocities.reserve( num );
+	m_angularVelocities.reserve( num );
+	m_invMasses.reserve( num );
+	m_elasticities.reserve( num );
+	m_frictions.reserve( num );
+	m_shapes.reserve( num );
+	m_centersOfMass.reserve( num );
+	m_inertiaTensors.reserve( num );
+	m_invInertiaTensors.reserve( num );
+	m_invInertiaWorldSpace.reserve( num );
+	m_invInertiaDirty.reserve( num );
+}
+
+/*
+====================================================
+BodyStorage::CopyTo
+====================================================
+*/
+void BodyStorage::CopyTo( const int index, Body & body ) const {
+	body.m_position = m_positions[ index ];
+	body.m_orientation = m_orientations[ index ];
+	body.m_linearVelocity = m_linearVelocities[ index ];
+	body.m_angularVelocity = m_angularVelocities[ index ];
+	body.m_invMass = m_invMasses[ index ];
+	body.m_elasticity = m_elasticities[ index ];
+	body.m_friction = m_frictions[ index ];
+	body.m_shape = m_shapes[ index ];
+}
+
+/*
+====================================================
+BodyStorage::GetInverseInertiaTensorWorldSpace
+====================================================
+*/
+Mat3 BodyStorage::GetInverseInertiaTensorWorldSpace( const int index ) const {
+	if ( m_invInertiaDirty[ index ] ) {
+		const Mat3 orient = m_orientations[ index ].ToMat3();
+		m_invInertiaWorldSpace[ index ] = orient * m_invInertiaTensors[ index ] * orient.Transpose();
+		m_invInertiaDirty[ index ] = 0;
+	}
+	return m_invInertiaWorldSpace[ index ] * m_invMasses[ index ];
+}
+
+/*
+====================================================
+BodyStorage::IntegrateAngular
+
+Same integration as Body::Update, minus the linear part.  The
+precession term is evaluated in body space with the cached tensors
+instead of inverting the world space tensor.
+====================================================
+*/
+void BodyStorage::IntegrateAngular( const int index, const float dt_sec ) {
+	Vec3 & position = m_positions[ index ];
+	Quat & orientation = m_orientations[ index ];
+	Vec3 & angularVelocity = m_angularVelocities[ index ];
+
+	// Rotate around the center of mass, not the model origin
+	const Vec3 positionCM = position + orientation.RotatePoint( m_centersOfMass[ index ] );
+	const Vec3 cmToPos = position - positionCM;
+
+	// Total Torque is equal to external applied torques + internal torque (precession)
+	// a = I^-1 ( w x I * w ), with I = R * Ib * R^T
+	const Mat3 orient = orientation.ToMat3();
+	const Vec3 angularMomentum = orient * ( m_inertiaTensors[ index ] * TransposeMultiply( orient, angularVelocity ) );
+	const Vec3 torque = angularVelocity.Cross( angularMomentum );
+	const Vec3 alpha = orient * ( m_invInertiaTensors[ index ] * TransposeMultiply( orient, torque ) );
+	angularVelocity += alpha * dt_sec;
+
+	// Update orientation
+	const Vec3 dAngle = angularVelocity * dt_sec;
+	const Quat dq = Quat( dAngle, dAngle.GetMagnitude() );
+	orientation = dq * orientation;
+	orientation.Normalize();
+	m_invInertiaDirty[ index ] = 1;
+
+	// Now get the new model position
+	position = positionCM + dq.RotatePoint( cmToPos );
+}
+
+/*
+====================================================
+BodyStorage::IntegrateAll
+====================================================
+*/
+void BodyStorage::IntegrateAll( const float dt_sec ) {
+	const int num = Size();
+
+	// Positions and velocities are packed Vec3s, so the linear update is one flat float loop
+	static_assert( sizeof( Vec3 ) == sizeof( float ) * 3, "IntegrateAll treats Vec3 arrays as packed floats" );
+	float * positions = &m_positions.data()->x;
+	const float * velocities = m_linearVelocities.data()->ToPtr();
+	const int numFloats = num * 3;
+
+	int i = 0;
+#if defined( PHYSICS_SIMD_ENABLED )
+	const simd4_t dt = Simd4Splat( dt_sec );
+	for ( ; i + 4 <= numFloats; i += 4 ) {
+		Simd4Store( positions + i, Simd4MulAdd( Simd4Load( velocities + i ), dt, Simd4Load( positions + i ) ) );
+	}
+#endif
+	for ( ; i < numFloats; i++ ) {
+		positions[ i ] += velocities[ i ] * dt_sec;
+	}
+
+	// Bodies that don't spin keep their orientation and their cached inertia
+	for ( int j = 0; j < num; j++ ) {
+		const Vec3 & w = m_angularVelocities[ j ];
+		if ( 0.0f == w.x && 0.0f == w.y && 0.0f == w.z ) {
+			continue;
+		}
+		IntegrateAngular( j, dt_sec );
+	}
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 //  Broadphase.cpp
 //
 #include "Broadphase.h"
+#include <algorithm>
 
 struct psuedoBody_t {
 	int id;
@@ -9,6 +10,49 @@ struct psuedoBody_t {
 	bool ismin;
 };
 
+/*
+====================================================
+GetSweptBounds
+
+A body that covers more than half its own thickness in a step is
+swept in every direction.  It can bounce off something within the
+step, and the pairs for what it hits afterwards have to exist for the
+world to test them again.
+====================================================
+*/
+Bounds GetSweptBounds( const Body & body, const float dt_sec ) {
+	Bounds bounds = body.m_shape->GetBounds( body.m_position, body.m_orientation );
+
+	const Bounds localBounds = body.m_shape->GetBounds();
+	const float thickness = std::min( localBounds.WidthX(), std::min( localBounds.WidthY(), localBounds.WidthZ() ) );
+	const float distance = body.m_linearVelocity.GetMagnitude() * dt_sec;
+	if ( distance > 0.5f * thickness ) {
+		bounds.Expand( bounds.mins - Vec3( distance ) );
+		bounds.Expand( bounds.maxs + Vec3( distance ) );
+	} else {
+		// Expand the bounds by the linear velocity
+		bounds.Expand( bounds.mins + body.m_linearVelocity * dt_sec );
+		bounds.Expand( bounds.maxs + body.m_linearVelocity * dt_sec );
+	}
+
+	const float epsilon = 0.01f;
+	bounds.Expand( bounds.mins + Vec3(-1,-1,-1 ) * epsilon );
+	bounds.Expand( bounds.maxs + Vec3( 1, 1, 1 ) * epsilon );
+	return bounds;
+}
+
+/*
+====================================================
+IsResting
+
+Static and sleeping bodies don't move on their own, pairs of two of
+them can't start touching
+====================================================
+*/
+static bool IsResting( const Body & body ) {
+	return 0.0f == body.m_invMass || !body.m_isAwake;
+}
+
 /*
 ====================================================
 CompareSAP
@@ -34,16 +78,7 @@ void SortBodiesBounds( const Body * bodies, const int num, psuedoBody_t * sorted
 	axis.Normalize();
 
 	for ( int i = 0; i < num; i++ ) {
-		const Body & body = bodies[ i ];
-		Bounds bounds = body.m_shape->GetBounds( body.m_position, body.m_orientation );
-
-		// Expand the bounds by the linear velocity
-		bounds.Expand( bounds.mins + body.m_linearVelocity * dt_sec );
-		bounds.Expand( bounds.maxs + body.m_linearVelocity * dt_sec );
-
-		const float epsilon = 0.01f;
-		bounds.Expand( bounds.mins + Vec3(-1,-1,-1 ) * epsilon );
-		bounds.Expand( bounds.maxs + Vec3( 1, 1, 1 ) * epsilon );
+		const Bounds bounds = GetSweptBounds( bodies[ i ], dt_sec );
 
 		sortedArray[ i * 2 + 0 ].id = i;
 		sortedArray[ i * 2 + 0 ].value = axis.Dot( bounds.mins );
@@ -113,4 +148,344 @@ void BroadPhase( const Body * bodies, const int num, std::vector< collisionPair_
 	finalPairs.clear();
 
 	SweepAndPrune1D( bodies, num, finalPairs, dt_sec );
+}
+
+/*
+========================================================================================================
+
+SweepAndPrune
+
+========================================================================================================
+*/
+
+/*
+====================================================
+SweepAndPrune::SweepAndPrune
+====================================================
+*/
+SweepAndPrune::SweepAndPrune() :
+m_axis( 0 ) {
+}
+
+/*
+====================================================
+SweepAndPrune::Reset
+====================================================
+*/
+void SweepAndPrune::Reset() {
+	m_axis = 0;
+	m_bounds.clear();
+	m_endPoints.clear();
+	m_active.clear();
+	m_activeSlot.clear();
+}
+
+/*
+====================================================
+SweepAndPrune::Update
+====================================================
+*/
+void SweepAndPrune::Update( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec ) {
+	finalPairs.clear();
+
+	UpdateBounds( bodies, num, dt_sec );
+
+	// A changed body list or sweep axis leaves nothing to be incremental about
+	const int axis = ChooseAxis();
+	if ( (int)m_endPoints.size() != num * 2 || axis != m_axis ) {
+		m_axis = axis;
+		RebuildEndPoints();
+	} else {
+		SortEndPoints();
+	}
+
+	BuildPairs( finalPairs );
+
+	int numPairs = 0;
+	for ( int i = 0; i < (int)finalPairs.size(); i++ ) {
+		const collisionPair_t & pair = finalPairs[ i ];
+		if ( IsResting( bodies[ pair.a ] ) && IsResting( bodies[ pair.b ] ) ) {
+			continue;
+		}
+		finalPairs[ numPairs++ ] = pair;
+	}
+	finalPairs.resize( numPairs );
+}
+
+/*
+====================================================
+SweepAndPrune::UpdateBounds
+====================================================
+*/
+void SweepAndPrune::UpdateBounds( const Body * bodies, const int num, const float dt_sec ) {
+	const int numOld = (int)m_bounds.size();
+	m_bounds.resize( num );
+	for ( int i = 0; i < num; i++ ) {
+		// Sleeping bodies haven't moved since their bounds were taken
+		if ( i < numOld && !bodies[ i ].m_isAwake ) {
+			continue;
+		}
+		m_bounds[ i ] = GetSweptBounds( bodies[ i ], dt_sec );
+	}
+}
+
+/*
+====================================================
+SweepAndPrune::ChooseAxis
+====================================================
+*/
+int SweepAndPrune::ChooseAxis() const {
+	const int num = (int)m_bounds.size();
+	if ( num < 2 ) {
+		return m_axis;
+	}
+
+	Vec3 sum( 0.0f );
+	Vec3 sumSqr( 0.0f );
+	for ( int i = 0; i < num; i++ ) {
+		const Vec3 center = ( m_bounds[ i ].mins + m_bounds[ i ].maxs ) * 0.5f;
+		sum += center;
+		sumSqr += Vec3( center.x * center.x, center.y * center.y, center.z * center.z );
+	}
+
+	const float invNum = 1.0f / float( num );
+	float variance[ 3 ];
+	for ( int i = 0; i < 3; i++ ) {
+		const float mean = sum[ i ] * invNum;
+		variance[ i ] = sumSqr[ i ] * invNum - mean * mean;
+	}
+
+	int axis = 0;
+	if ( variance[ 1 ] > variance[ axis ] ) {
+		axis = 1;
+	}
+	if ( variance[ 2 ] > variance[ axis ] ) {
+		axis = 2;
+	}
+
+	// Only switch axis when the new one is clearly better, flip-flopping every
+	// step would throw away the sorted order that makes this cheap
+	const float hysteresis = 1.2f;
+	if ( variance[ axis ] < variance[ m_axis ] * hysteresis ) {
+		return m_axis;
+	}
+	return axis;
+}
+
+/*
+====================================================
+EndPointLess
+====================================================
+*/
+static bool EndPointLess( const float valueA, const bool isminA, const float valueB, const bool isminB ) {
+	if ( valueA != valueB ) {
+		return valueA < valueB;
+	}
+	// Touching bounds count as overlapping, so starts go before ends
+	return isminA && !isminB;
+}
+
+/*
+====================================================
+SweepAndPrune::RebuildEndPoints
+====================================================
+*/
+void SweepAndPrune::RebuildEndPoints() {
+	const int num = (int)m_bounds.size();
+	m_endPoints.resize( num * 2 );
+	for ( int i = 0; i < num; i++ ) {
+		m_endPoints[ i * 2 + 0 ].id = i;
+		m_endPoints[ i * 2 + 0 ].ismin = true;
+		m_endPoints[ i * 2 + 0 ].value = m_bounds[ i ].mins[ m_axis ];
+
+		m_endPoints[ i * 2 + 1 ].id = i;
+		m_endPoints[ i * 2 + 1 ].ismin = false;
+		m_endPoints[ i * 2 + 1 ].value = m_bounds[ i ].maxs[ m_axis ];
+	}
+
+	std::sort( m_endPoints.begin(), m_endPoints.end(), []( const endPoint_t & a, const endPoint_t & b ) {
+		return EndPointLess( a.value, a.ismin, b.value, b.ismin );
+	} );
+}
+
+/*
+====================================================
+SweepAndPrune::SortEndPoints
+====================================================
+*/
+void SweepAndPrune::SortEndPoints() {
+	const int num = (int)m_endPoints.size();
+	for ( int i = 0; i < num; i++ ) {
+		endPoint_t & ep = m_endPoints[ i ];
+		const Bounds & bounds = m_bounds[ ep.id ];
+		ep.value = ep.ismin ? bounds.mins[ m_axis ] : bounds.maxs[ m_axis ];
+	}
+
+	// Insertion sort, the list is nearly sorted from last frame
+	for ( int i = 1; i < num; i++ ) {
+		const endPoint_t ep = m_endPoints[ i ];
+		int j = i - 1;
+		while ( j >= 0 && EndPointLess( ep.value, ep.ismin, m_endPoints[ j ].value, m_endPoints[ j ].ismin ) ) {
+			m_endPoints[ j + 1 ] = m_endPoints[ j ];
+			j--;
+		}
+		m_endPoints[ j + 1 ] = ep;
+	}
+}
+
+/*
+====================================================
+SweepAndPrune::BuildPairs
+====================================================
+*/
+void SweepAndPrune::BuildPairs( std::vector< collisionPair_t > & finalPairs ) {
+	m_active.clear();
+	m_activeSlot.resize( m_bounds.size() );
+
+	const int num = (int)m_endPoints.size();
+	for ( int i = 0; i < num; i++ ) {
+		const endPoint_t & ep = m_endPoints[ i ];
+
+		if ( !ep.ismin ) {
+			// Swap remove the body from the active list
+			const int slot = m_activeSlot[ ep.id ];
+			const int last = m_active.back();
+			m_active[ slot ] = last;
+			m_activeSlot[ last ] = slot;
+			m_active.pop_back();
+			continue;
+		}
+
+		// Everything active overlaps on the sweep axis, check the other two
+		const Bounds & bounds = m_bounds[ ep.id ];
+		for ( int j = 0; j < (int)m_active.size(); j++ ) {
+			const int other = m_active[ j ];
+			if ( !bounds.DoesIntersect( m_bounds[ other ] ) ) {
+				continue;
+			}
+
+			collisionPair_t pair;
+			pair.a = other;
+			pair.b = ep.id;
+			finalPairs.push_back( pair );
+		}
+
+		m_activeSlot[ ep.id ] = (int)m_active.size();
+		m_active.push_back( ep.id );
+	}
+}
+
+/*
+====================================================
+BroadPhase
+====================================================
+*/
+void BroadPhase( SweepAndPrune & sap, const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec ) {
+	sap.Update( bodies, num, finalPairs, dt_sec );
+}
+
+/*
+========================================================================================================
+
+BVHBroadPhase
+
+========================================================================================================
+*/
+
+/*
+====================================================
+BVHBroadPhase::Reset
+====================================================
+*/
+void BVHBroadPhase::Reset() {
+	m_tree.Clear();
+	m_proxies.clear();
+	m_bounds.clear();
+	m_moved.clear();
+	m_candidates.clear();
+}
+
+/*
+====================================================
+BVHBroadPhase::Update
+====================================================
+*/
+void BVHBroadPhase::Update( const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec ) {
+	finalPairs.clear();
+
+	// Keep one proxy per body, the user data is the body index
+	while ( (int)m_proxies.size() > num ) {
+		m_tree.DestroyProxy( m_proxies.back() );
+		m_proxies.pop_back();
+	}
+	m_bounds.resize( num );
+	m_moved.assign( num, false );
+
+	for ( int i = 0; i < num; i++ ) {
+		// Sleeping bodies haven't moved, their bounds and proxy are still valid
+		if ( i < (int)m_proxies.size() && !bodies[ i ].m_isAwake ) {
+			continue;
+		}
+
+		m_bounds[ i ] = GetSweptBounds( bodies[ i ], dt_sec );
+
+		if ( i < (int)m_proxies.size() ) {
+			m_moved[ i ] = m_tree.MoveProxy( m_proxies[ i ], m_bounds[ i ], bodies[ i ].m_linearVelocity * dt_sec );
+		} else {
+			m_proxies.push_back( m_tree.CreateProxy( m_bounds[ i ], i ) );
+			m_moved[ i ] = true;
+		}
+	}
+
+	// Fat bounds only change on re-insertion, so candidates between two bodies
+	// that stayed put are still valid
+	int numCandidates = 0;
+	for ( int i = 0; i < (int)m_candidates.size(); i++ ) {
+		const collisionPair_t & pair = m_candidates[ i ];
+		if ( pair.a >= num || pair.b >= num || m_moved[ pair.a ] || m_moved[ pair.b ] ) {
+			continue;
+		}
+		m_candidates[ numCandidates++ ] = pair;
+	}
+	m_candidates.resize( numCandidates );
+
+	for ( int i = 0; i < num; i++ ) {
+		if ( !m_moved[ i ] ) {
+			continue;
+		}
+
+		m_tree.QueryBounds( m_tree.GetFatBounds( m_proxies[ i ] ), m_query );
+		for ( int j = 0; j < (int)m_query.size(); j++ ) {
+			const int other = m_query[ j ];
+
+			// Pairs of two moved bodies are found from both sides, only keep one of them
+			if ( other == i || ( m_moved[ other ] && other < i ) ) {
+				continue;
+			}
+
+			collisionPair_t pair;
+			pair.a = std::min( i, other );
+			pair.b = std::max( i, other );
+			m_candidates.push_back( pair );
+		}
+	}
+
+	for ( int i = 0; i < (int)m_candidates.size(); i++ ) {
+		const collisionPair_t & pair = m_candidates[ i ];
+		if ( IsResting( bodies[ pair.a ] ) && IsResting( bodies[ pair.b ] ) ) {
+			continue;
+		}
+		if ( m_bounds[ pair.a ].DoesIntersect( m_bounds[ pair.b ] ) ) {
+			finalPairs.push_back( pair );
+		}
+	}
+}
+
+/*
+====================================================
+BroadPhase
+====================================================
+*/
+void BroadPhase( BVHBroadPhase & bvh, const Body * bodies, const int num, std::vector< collisionPair_t > & finalPairs, const float dt_sec ) {
+	bvh.Update( bodies, num, finalPairs, dt_sec );
 }
\ No newline at end of file
@@ -0,0 +1,696 @@
+//
+//  DynamicBVH.cpp
+//
+#include "DynamicBVH.h"
+#include <algorithm>
+#include <cassert>
+
+/*
+====================================================
+Bounds helpers
+====================================================
+*/
+static Bounds Union( const Bounds & a, const Bounds & b ) {
+	Bounds tmp = a;
+	tmp.Expand( b );
+	return tmp;
+}
+
+static float SurfaceArea( const Bounds & bounds ) {
+	const float wx = bounds.WidthX();
+	const float wy = bounds.WidthY();
+	const float wz = bounds.WidthZ();
+	return 2.0f * ( wx * wy + wy * wz + wz * wx );
+}
+
+static bool Contains( const Bounds & outer, const Bounds & inner ) {
+	if ( inner.mins.x < outer.mins.x || inner.mins.y < outer.mins.y || inner.mins.z < outer.mins.z ) {
+		return false;
+	}
+	if ( inner.maxs.x > outer.maxs.x || inner.maxs.y > outer.maxs.y || inner.maxs.z > outer.maxs.z ) {
+		return false;
+	}
+	return true;
+}
+
+static Bounds Fatten( const Bounds & bounds, const float margin ) {
+	Bounds tmp;
+	tmp.mins = bounds.mins - Vec3( margin );
+	tmp.maxs = bounds.maxs + Vec3( margin );
+	return tmp;
+}
+
+/*
+====================================================
+RayBounds
+
+Slab test, returns true when the segment start + ( end - start ) * t
+touches the bounds for some t in [0, maxFraction]
+====================================================
+*/
+static bool RayBounds( const Vec3 & start, const Vec3 & dir, const Bounds & bounds, const float maxFraction, float & tEnter ) {
+	float tmin = 0.0f;
+	float tmax = maxFraction;
+	for ( int i = 0; i < 3; i++ ) {
+		if ( fabsf( dir[ i ] ) < 1e-8f ) {
+			if ( start[ i ] < bounds.mins[ i ] || start[ i ] > bounds.maxs[ i ] ) {
+				return false;
+			}
+			continue;
+		}
+
+		const float invD = 1.0f / dir[ i ];
+		float t0 = ( bounds.mins[ i ] - start[ i ] ) * invD;
+		float t1 = ( bounds.maxs[ i ] - start[ i ] ) * invD;
+		if ( t0 > t1 ) {
+			std::swap( t0, t1 );
+		}
+
+		tmin = std::max( tmin, t0 );
+		tmax = std::min( tmax, t1 );
+		if ( tmin > tmax ) {
+			return false;
+		}
+	}
+	tEnter = tmin;
+	return true;
+}
+
+/*
+====================================================
+SphereBounds
+====================================================
+*/
+static bool SphereBounds( const Vec3 & center, const float radius, const Bounds & bounds ) {
+	float distSqr = 0.0f;
+	for ( int i = 0; i < 3; i++ ) {
+		if ( center[ i ] < bounds.mins[ i ] ) {
+			const float d = bounds.mins[ i ] - center[ i ];
+			distSqr += d * d;
+		} else if ( center[ i ] > bounds.maxs[ i ] ) {
+			const float d = center[ i ] - bounds.maxs[ i ];
+			distSqr += d * d;
+		}
+	}
+	return distSqr <= radius * radius;
+}
+
+/*
+========================================================================================================
+
+DynamicBVH
+
+========================================================================================================
+*/
+
+/*
+====================================================
+DynamicBVH::DynamicBVH
+====================================================
+*/
+DynamicBVH::DynamicBVH() :
+m_margin( 0.1f ),
+m_displacementMultiplier( 4.0f ),
+m_root( nullNode ),
+m_freeList( nullNode ),
+m_proxyCount( 0 ) {
+}
+
+/*
+====================================================
+DynamicBVH::Clear
+====================================================
+*/
+void DynamicBVH::Clear() {
+	m_nodes.clear();
+	m_root = nullNode;
+	m_freeList = nullNode;
+	m_proxyCount = 0;
+}
+
+/*
+====================================================
+DynamicBVH::AllocateNode
+====================================================
+*/
+int DynamicBVH::AllocateNode() {
+	int nodeId = m_freeList;
+	if ( nodeId == nullNode ) {
+		nodeId = (int)m_nodes.size();
+		m_nodes.emplace_back();
+	} else {
+		m_freeList = m_nodes[ nodeId ].next;
+	}
+
+	node_t & node = m_nodes[ nodeId ];
+	node.parent = nullNode;
+	node.left = nullNode;
+	node.right = nullNode;
+	node.next = nullNode;
+	node.height = 0;
+	node.userData = -1;
+	return nodeId;
+}
+
+/*
+====================================================
+DynamicBVH::FreeNode
+====================================================
+*/
+void DynamicBVH::FreeNode( int nodeId ) {
+	node_t & node = m_nodes[ nodeId ];
+	node.next = m_freeList;
+	node.height = -1;
+	m_freeList = nodeId;
+}
+
+/*
+====================================================
+DynamicBVH::CreateProxy
+====================================================
+*/
+int DynamicBVH::CreateProxy( const Bounds & bounds, int userData ) {
+	const int proxyId = AllocateNode();
+	m_nodes[ proxyId ].bounds = Fatten( bounds, m_margin );
+	m_nodes[ proxyId ].userData = userData;
+
+	InsertLeaf( proxyId );
+	m_proxyCount++;
+	return proxyId;
+}
+
+/*
+====================================================
+DynamicBVH::CreateProxies
+
+Builds the new leaves into a subtree of their own, split at the median
+of their centers, and inserts that subtree like a single leaf.  Much
+cheaper than one insert each when many proxies arrive at once, like
+the copies of a prefab
+====================================================
+*/
+void DynamicBVH::CreateProxies( const Bounds * bounds, const int * userData, const int num, int * proxyIds ) {
+	if ( num <= 0 ) {
+		return;
+	}
+
+	m_nodes.reserve( m_nodes.size() + 2 * num );
+	std::vector< buildLeaf_t > leaves( num );
+	for ( int i = 0; i < num; i++ ) {
+		proxyIds[ i ] = AllocateNode();
+		m_nodes[ proxyIds[ i ] ].bounds = Fatten( bounds[ i ], m_margin );
+		m_nodes[ proxyIds[ i ] ].userData = userData[ i ];
+		leaves[ i ].center = ( bounds[ i ].mins + bounds[ i ].maxs ) * 0.5f;
+		leaves[ i ].nodeId = proxyIds[ i ];
+	}
+	m_proxyCount += num;
+
+	InsertLeaf( BuildSubtree( leaves.data(), num ) );
+}
+
+/*
+====================================================
+DynamicBVH::BuildSubtree
+
+Returns the root of a subtree over the leaves, the order of the
+leaves array is changed
+====================================================
+*/
+int DynamicBVH::BuildSubtree( buildLeaf_t * leaves, const int num ) {
+	if ( num == 1 ) {
+		return leaves[ 0 ].nodeId;
+	}
+
+	// Split along the longest axis of the centers
+	Bounds centers;
+	for ( int i = 0; i < num; i++ ) {
+		centers.Expand( leaves[ i ].center );
+	}
+	int axis = 0;
+	if ( centers.WidthY() > centers.WidthX() ) {
+		axis = 1;
+	}
+	if ( centers.WidthZ() > std::max( centers.WidthX(), centers.WidthY() ) ) {
+		axis = 2;
+	}
+
+	const int half = num / 2;
+	std::nth_element( leaves, leaves + half, leaves + num, [ axis ]( const buildLeaf_t & a, const buildLeaf_t & b ) {
+		return a.center[ axis ] < b.center[ axis ];
+	} );
+
+	const int left = BuildSubtree( leaves, half );
+	const int right = BuildSubtree( leaves + half, num - half );
+
+	const int parent = AllocateNode();
+	node_t & node = m_nodes[ parent ];
+	node.left = left;
+	node.right = right;
+	node.bounds = Union( m_nodes[ left ].bounds, m_nodes[ right ].bounds );
+	node.height = 1 + std::max( m_nodes[ left ].height, m_nodes[ right ].height );
+	m_nodes[ left ].parent = parent;
+	m_nodes[ right ].parent = parent;
+	return parent;
+}
+
+/*
+====================================================
+DynamicBVH::DestroyProxy
+====================================================
+*/
+void DynamicBVH::DestroyProxy( int proxyId ) {
+	assert( m_nodes[ proxyId ].IsLeaf() );
+
+	RemoveLeaf( proxyId );
+	FreeNode( proxyId );
+	m_proxyCount--;
+}
+
+/*
+====================================================
+DynamicBVH::MoveProxy
+
+Returns true when the proxy had to be re-inserted
+====================================================
+*/
+bool DynamicBVH::MoveProxy( int proxyId, const Bounds & bounds, const Vec3 & displacement ) {
+	assert( m_nodes[ proxyId ].IsLeaf() );
+
+	// Predict where the proxy is heading so it does not need to move again next step
+	Bounds fatBounds = Fatten( bounds, m_margin );
+	const Vec3 d = displacement * m_displacementMultiplier;
+	for ( int i = 0; i < 3; i++ ) {
+		if ( d[ i ] < 0.0f ) {
+			fatBounds.mins[ i ] += d[ i ];
+		} else {
+			fatBounds.maxs[ i ] += d[ i ];
+		}
+	}
+
+	const Bounds & treeBounds = m_nodes[ proxyId ].bounds;
+	if ( Contains( treeBounds, bounds ) ) {
+		// Still inside, unless the stored bounds grew much larger than needed
+		// (a fast body that came to rest) there is nothing to do
+		const Bounds hugeBounds = Fatten( fatBounds, 4.0f * m_margin );
+		if ( Contains( hugeBounds, treeBounds ) ) {
+			return false;
+		}
+	}
+
+	RemoveLeaf( proxyId );
+	m_nodes[ proxyId ].bounds = fatBounds;
+	InsertLeaf( proxyId );
+	return true;
+}
+
+/*
+====================================================
+DynamicBVH::InsertLeaf
+====================================================
+*/
+void DynamicBVH::InsertLeaf( int leaf ) {
+	if ( m_root == nullNode ) {
+		m_root = leaf;
+		m_nodes[ m_root ].parent = nullNode;
+		return;
+	}
+
+	// Walk down the tree picking the child with the smallest surface area cost
+	const Bounds leafBounds = m_nodes[ leaf ].bounds;
+	int index = m_root;
+	while ( !m_nodes[ index ].IsLeaf() ) {
+		const node_t & node = m_nodes[ index ];
+		const int left = node.left;
+		const int right = node.right;
+
+		const float area = SurfaceArea( node.bounds );
+		const float combinedArea = SurfaceArea( Union( node.bounds, leafBounds ) );
+
+		// Cost of creating a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedArea;
+
+		// Minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * ( combinedArea - area );
+
+		float costLeft = SurfaceArea( Union( leafBounds, m_nodes[ left ].bounds ) ) + inheritanceCost;
+		if ( !m_nodes[ left ].IsLeaf() ) {
+			costLeft -= SurfaceArea( m_nodes[ left ].bounds );
+		}
+
+		float costRight = SurfaceArea( Union( leafBounds, m_nodes[ right ].bounds ) ) + inheritanceCost;
+		if ( !m_nodes[ right ].IsLeaf() ) {
+			costRight -= SurfaceArea( m_nodes[ right ].bounds );
+		}
+
+		if ( cost < costLeft && cost < costRight ) {
+			break;
+		}
+
+		index = ( costLeft < costRight ) ? left : right;
+	}
+
+	// Create a new parent for the sibling and the leaf
+	const int sibling = index;
+	const int oldParent = m_nodes[ sibling ].parent;
+	const int newParent = AllocateNode();
+	m_nodes[ newParent ].parent = oldParent;
+	m_nodes[ newParent ].bounds = Union( leafBounds, m_nodes[ sibling ].bounds );
+	m_nodes[ newParent ].height = m_nodes[ sibling ].height + 1;
+	m_nodes[ newParent ].left = sibling;
+	m_nodes[ newParent ].right = leaf;
+	m_nodes[ sibling ].parent = newParent;
+	m_nodes[ leaf ].parent = newParent;
+
+	if ( oldParent != nullNode ) {
+		if ( m_nodes[ oldParent ].left == sibling ) {
+			m_nodes[ oldParent ].left = newParent;
+		} else {
+			m_nodes[ oldParent ].right = newParent;
+		}
+	} else {
+		m_root = newParent;
+	}
+
+	Refit( m_nodes[ leaf ].parent );
+}
+
+/*
+====================================================
+DynamicBVH::RemoveLeaf
+====================================================
+*/
+void DynamicBVH::RemoveLeaf( int leaf ) {
+	if ( leaf == m_root ) {
+		m_root = nullNode;
+		return;
+	}
+
+	const int parent = m_nodes[ leaf ].parent;
+	const int grandParent = m_nodes[ parent ].parent;
+	const int sibling = ( m_nodes[ parent ].left == leaf ) ? m_nodes[ parent ].right : m_nodes[ parent ].left;
+
+	// The sibling takes the place of the parent
+	if ( grandParent != nullNode ) {
+		if ( m_nodes[ grandParent ].left == parent ) {
+			m_nodes[ grandParent ].left = sibling;
+		} else {
+			m_nodes[ grandParent ].right = sibling;
+		}
+		m_nodes[ sibling ].parent = grandParent;
+		FreeNode( parent );
+
+		Refit( grandParent );
+	} else {
+		m_root = sibling;
+		m_nodes[ sibling ].parent = nullNode;
+		FreeNode( parent );
+	}
+}
+
+/*
+====================================================
+DynamicBVH::Refit
+
+Walks back up to the root, re-balancing and fixing the bounds and heights
+====================================================
+*/
+void DynamicBVH::Refit( int nodeId ) {
+	int index = nodeId;
+	while ( index != nullNode ) {
+		index = Balance( index );
+
+		node_t & node = m_nodes[ index ];
+		const node_t & left = m_nodes[ node.left ];
+		const node_t & right = m_nodes[ node.right ];
+		node.height = 1 + std::max( left.height, right.height );
+		node.bounds = Union( left.bounds, right.bounds );
+
+		index = node.parent;
+	}
+}
+
+/*
+====================================================
+DynamicBVH::Balance
+
+Performs a left or right rotation if node A is imbalanced.
+Returns the new root index of the sub tree.
+
+        A
+      /   \
+     B     C
+    / \   / \
+   D   E F   G
+====================================================
+*/
+int DynamicBVH::Balance( int iA ) {
+	node_t * A = &m_nodes[ iA ];
+	if ( A->IsLeaf() || A->height < 2 ) {
+		return iA;
+	}
+
+	const int iB = A->left;
+	const int iC = A->right;
+	node_t * B = &m_nodes[ iB ];
+	node_t * C = &m_nodes[ iC ];
+
+	const int balance = C->height - B->height;
+
+	// Rotate C up
+	if ( balance > 1 ) {
+		const int iF = C->left;
+		const int iG = C->right;
+		node_t * F = &m_nodes[ iF ];
+		node_t * G = &m_nodes[ iG ];
+
+		C->left = iA;
+		C->parent = A->parent;
+		A->parent = iC;
+
+		if ( C->parent != nullNode ) {
+			if ( m_nodes[ C->parent ].left == iA ) {
+				m_nodes[ C->parent ].left = iC;
+			} else {
+				m_nodes[ C->parent ].right = iC;
+			}
+		} else {
+			m_root = iC;
+		}
+
+		if ( F->height > G->height ) {
+			C->right = iF;
+			A->right = iG;
+			G->parent = iA;
+			A->bounds = Union( B->bounds, G->bounds );
+			C->bounds = Union( A->bounds, F->bounds );
+			A->height = 1 + std::max( B->height, G->height );
+			C->height = 1 + std::max( A->height, F->height );
+		} else {
+			C->right = iG;
+			A->right = iF;
+			F->parent = iA;
+			A->bounds = Union( B->bounds, F->bounds );
+			C->bounds = Union( A->bounds, G->bounds );
+			A->height = 1 + std::max( B->height, F->height );
+			C->height = 1 + std::max( A->height, G->height );
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if ( balance < -1 ) {
+		const int iD = B->left;
+		const int iE = B->right;
+		node_t * D = &m_nodes[ iD ];
+		node_t * E = &m_nodes[ iE ];
+
+		B->left = iA;
+		B->parent = A->parent;
+		A->parent = iB;
+
+		if ( B->parent != nullNode ) {
+			if ( m_nodes[ B->parent ].left == iA ) {
+				m_nodes[ B->parent ].left = iB;
+			} else {
+				m_nodes[ B->parent ].right = iB;
+			}
+		} else {
+			m_root = iB;
+		}
+
+		if ( D->height > E->height ) {
+			B->right = iD;
+			A->left = iE;
+			E->parent = iA;
+			A->bounds = Union( C->bounds, E->bounds );
+			B->bounds = Union( A->bounds, D->bounds );
+			A->height = 1 + std::max( C->height, E->height );
+			B->height = 1 + std::max( A->height, D->height );
+		} else {
+			B->right = iE;
+			A->left = iD;
+			D->parent = iA;
+			A->bounds = Union( C->bounds, D->bounds );
+			B->bounds = Union( A->bounds, E->bounds );
+			A->height = 1 + std::max( C->height, D->height );
+			B->height = 1 + std::max( A->height, E->height );
+		}
+		return iB;
+	}
+
+	return iA;
+}
+
+/*
+====================================================
+DynamicBVH::QueryBounds
+====================================================
+*/
+void DynamicBVH::QueryBounds( const Bounds & bounds, std::vector< int > & results ) const {
+	results.clear();
+	if ( m_root == nullNode ) {
+		return;
+	}
+
+	TraversalStack stack;
+	stack.Push( m_root );
+	while ( !stack.IsEmpty() ) {
+		const node_t & node = m_nodes[ stack.Pop() ];
+		if ( !node.bounds.DoesIntersect( bounds ) ) {
+			continue;
+		}
+
+		if ( node.IsLeaf() ) {
+			results.push_back( node.userData );
+		} else {
+			stack.Push( node.left );
+			stack.Push( node.right );
+		}
+	}
+}
+
+/*
+====================================================
+DynamicBVH::QuerySphere
+====================================================
+*/
+void DynamicBVH::QuerySphere( const Vec3 & center, const float radius, std::vector< int > & results ) const {
+	results.clear();
+	if ( m_root == nullNode ) {
+		return;
+	}
+
+	TraversalStack stack;
+	stack.Push( m_root );
+	while ( !stack.IsEmpty() ) {
+		const node_t & node = m_nodes[ stack.Pop() ];
+		if ( !SphereBounds( center, radius, node.bounds ) ) {
+			continue;
+		}
+
+		if ( node.IsLeaf() ) {
+			results.push_back( node.userData );
+		} else {
+			stack.Push( node.left );
+			stack.Push( node.right );
+		}
+	}
+}
+
+/*
+====================================================
+DynamicBVH::RayCast
+
+Collects every leaf whose fat bounds the segment touches
+====================================================
+*/
+void DynamicBVH::RayCast( const Vec3 & start, const Vec3 & end, std::vector< int > & results ) const {
+	results.clear();
+	if ( m_root == nullNode ) {
+		return;
+	}
+
+	const Vec3 dir = end - start;
+
+	TraversalStack stack;
+	stack.Push( m_root );
+	while ( !stack.IsEmpty() ) {
+		const node_t & node = m_nodes[ stack.Pop() ];
+		float t;
+		if ( !RayBounds( start, dir, node.bounds, 1.0f, t ) ) {
+			continue;
+		}
+
+		if ( node.IsLeaf() ) {
+			results.push_back( node.userData );
+		} else {
+			stack.Push( node.left );
+			stack.Push( node.right );
+		}
+	}
+}
+
+/*
+====================================================
+DynamicBVH::RayCast
+
+Finds the closest hit, the callback does the exact test against the
+leaf and the segment is clipped to every hit so far
+====================================================
+*/
+bool DynamicBVH::RayCast( const Vec3 & start, const Vec3 & end, const rayCallback_t & callback, int & userData, float & fraction ) const {
+	userData = -1;
+	fraction = 1.0f;
+	if ( m_root == nullNode ) {
+		return false;
+	}
+
+	const Vec3 dir = end - start;
+	float maxFraction = 1.0f;
+	bool hit = false;
+
+	TraversalStack stack;
+	stack.Push( m_root );
+	while ( !stack.IsEmpty() ) {
+		const node_t & node = m_nodes[ stack.Pop() ];
+		float t;
+		if ( !RayBounds( start, dir, node.bounds, maxFraction, t ) ) {
+			continue;
+		}
+
+		if ( node.IsLeaf() ) {
+			const float value = callback( node.userData, start, end, maxFraction );
+			if ( value >= 0.0f && value <= maxFraction ) {
+				maxFraction = value;
+				userData = node.userData;
+				hit = true;
+			}
+			continue;
+		}
+
+		// Visit the nearer child first so the segment gets clipped sooner
+		const node_t & left = m_nodes[ node.left ];
+		const node_t & right = m_nodes[ node.right ];
+		float tLeft = maxFraction;
+		float tRight = maxFraction;
+		const bool hitLeft = RayBounds( start, dir, left.bounds, maxFraction, tLeft );
+		const bool hitRight = RayBounds( start, dir, right.bounds, maxFraction, tRight );
+
+		if ( hitLeft && hitRight ) {
+			if ( tLeft < tRight ) {
+				stack.Push( node.right );
+				stack.Push( node.left );
+			} else {
+				stack.Push( node.left );
+				stack.Push( node.right );
+			}
+		} else if ( hitLeft ) {
+			stack.Push( node.left );
+		} else if ( hitRight ) {
+			stack.Push( node.right );
+		}
+	}
+
+	fraction = maxFraction;
+	return hit;
+}
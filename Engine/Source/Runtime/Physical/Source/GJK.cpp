@@ -0,0 +1,729 @@
+//
+//  GJK.cpp
+//
+#include "GJK.h"
+#include <float.h>
+#include <algorithm>
+
+/*
+========================================================================================================
+
+Signed Volumes
+
+Projects the origin onto the simplex and returns the barycentric
+coordinates of the closest point, falling back to the sub-simplices
+when the projection lands outside of it.
+
+========================================================================================================
+*/
+
+/*
+====================================================
+SignedVolume1D
+====================================================
+*/
+static Vec2 SignedVolume1D( const Vec3 & s1, const Vec3 & s2 ) {
+	const Vec3 ab = s2 - s1;	// Ray from a to b
+	const Vec3 ap = Vec3( 0.0f ) - s1;	// Ray from a to origin
+	if ( ab.GetLengthSqr() < FLT_EPSILON * FLT_EPSILON ) {
+		return Vec2( 1.0f, 0.0f );
+	}
+	const Vec3 p0 = s1 + ab * ab.Dot( ap ) / ab.GetLengthSqr();	// projection of the origin onto the line
+
+	// Choose the axis with the greatest difference/length
+	int idx = 0;
+	float mu_max = 0;
+	for ( int i = 0; i < 3; i++ ) {
+		const float mu = s2[ i ] - s1[ i ];
+		if ( mu * mu > mu_max * mu_max ) {
+			mu_max = mu;
+			idx = i;
+		}
+	}
+
+	// Project the simplex points and projected origin onto the axis with greatest length
+	const float a = s1[ idx ];
+	const float b = s2[ idx ];
+	const float p = p0[ idx ];
+
+	// Get the signed distance from a to p and from p to b
+	const float C1 = p - a;
+	const float C2 = b - p;
+
+	// if p is between [a,b]
+	if ( ( p > a && p < b ) || ( p > b && p < a ) ) {
+		return Vec2( C2 / mu_max, C1 / mu_max );
+	}
+
+	// if p is on the far side of a
+	if ( ( a <= b && p <= a ) || ( a >= b && p >= a ) ) {
+		return Vec2( 1.0f, 0.0f );
+	}
+
+	// p must be on the far side of b
+	return Vec2( 0.0f, 1.0f );
+}
+
+/*
+====================================================
+CompareSigns
+====================================================
+*/
+static bool CompareSigns( const float a, const float b ) {
+	return ( a > 0.0f && b > 0.0f ) || ( a < 0.0f && b < 0.0f );
+}
+
+/*
+====================================================
+SignedVolume2D
+====================================================
+*/
+static Vec3 SignedVolume2D( const Vec3 & s1, const Vec3 & s2, const Vec3 & s3 ) {
+	const Vec3 normal = ( s2 - s1 ).Cross( s3 - s1 );
+	const Vec3 p0 = normal * s1.Dot( normal ) / normal.GetLengthSqr();
+
+	// Find the axis with the greatest projected area
+	int idx = 0;
+	float area_max = 0;
+	for ( int i = 0; i < 3; i++ ) {
+		const int j = ( i + 1 ) % 3;
+		const int k = ( i + 2 ) % 3;
+
+		const Vec2 a = Vec2( s1[ j ], s1[ k ] );
+		const Vec2 b = Vec2( s2[ j ], s2[ k ] );
+		const Vec2 c = Vec2( s3[ j ], s3[ k ] );
+		const Vec2 ab = b - a;
+		const Vec2 ac = c - a;
+
+		const float area = ab.x * ac.y - ab.y * ac.x;
+		if ( area * area > area_max * area_max ) {
+			idx = i;
+			area_max = area;
+		}
+	}
+
+	// Project onto the appropriate axis
+	const int x = ( idx + 1 ) % 3;
+	const int y = ( idx + 2 ) % 3;
+	Vec2 s[ 3 ];
+	s[ 0 ] = Vec2( s1[ x ], s1[ y ] );
+	s[ 1 ] = Vec2( s2[ x ], s2[ y ] );
+	s[ 2 ] = Vec2( s3[ x ], s3[ y ] );
+	const Vec2 p = Vec2( p0[ x ], p0[ y ] );
+
+	// Get the sub-areas of the triangles formed from the projected origin and the edges
+	Vec3 areas;
+	for ( int i = 0; i < 3; i++ ) {
+		const int j = ( i + 1 ) % 3;
+		const int k = ( i + 2 ) % 3;
+
+		const Vec2 ab = s[ j ] - p;
+		const Vec2 ac = s[ k ] - p;
+
+		areas[ i ] = ab.x * ac.y - ab.y * ac.x;
+	}
+
+	// If the projected origin is inside the triangle, then return the barycentric points
+	if ( CompareSigns( area_max, areas[ 0 ] ) && CompareSigns( area_max, areas[ 1 ] ) && CompareSigns( area_max, areas[ 2 ] ) ) {
+		return areas / area_max;
+	}
+
+	// If we make it here, then we need to project onto the edges and determine the closest point
+	const Vec3 edgesPts[ 3 ] = { s1, s2, s3 };
+	float dist = FLT_MAX;
+	Vec3 lambdas = Vec3( 1, 0, 0 );
+	for ( int i = 0; i < 3; i++ ) {
+		const int k = ( i + 1 ) % 3;
+		const int l = ( i + 2 ) % 3;
+
+		const Vec2 lambdaEdge = SignedVolume1D( edgesPts[ k ], edgesPts[ l ] );
+		const Vec3 pt = edgesPts[ k ] * lambdaEdge[ 0 ] + edgesPts[ l ] * lambdaEdge[ 1 ];
+		if ( pt.GetLengthSqr() < dist ) {
+			dist = pt.GetLengthSqr();
+			lambdas[ i ] = 0;
+			lambdas[ k ] = lambdaEdge[ 0 ];
+			lambdas[ l ] = lambdaEdge[ 1 ];
+		}
+	}
+
+	return lambdas;
+}
+
+/*
+====================================================
+SignedVolume3D
+====================================================
+*/
+static Vec4 SignedVolume3D( const Vec3 & s1, const Vec3 & s2, const Vec3 & s3, const Vec3 & s4 ) {
+	Mat4 M;
+	M.rows[ 0 ] = Vec4( s1.x, s2.x, s3.x, s4.x );
+	M.rows[ 1 ] = Vec4( s1.y, s2.y, s3.y, s4.y );
+	M.rows[ 2 ] = Vec4( s1.z, s2.z, s3.z, s4.z );
+	M.rows[ 3 ] = Vec4( 1.0f, 1.0f, 1.0f, 1.0f );
+
+	Vec4 C4;
+	C4[ 0 ] = M.Cofactor( 3, 0 );
+	C4[ 1 ] = M.Cofactor( 3, 1 );
+	C4[ 2 ] = M.Cofactor( 3, 2 );
+	C4[ 3 ] = M.Cofactor( 3, 3 );
+
+	const float detM = C4[ 0 ] + C4[ 1 ] + C4[ 2 ] + C4[ 3 ];
+
+	// If the barycentric coordinates put the origin inside the simplex, then return them
+	if ( CompareSigns( detM, C4[ 0 ] ) && CompareSigns( detM, C4[ 1 ] ) && CompareSigns( detM, C4[ 2 ] ) && CompareSigns( detM, C4[ 3 ] ) ) {
+		return C4 * ( 1.0f / detM );
+	}
+
+	// If we get here, then we need to project the origin onto the faces and determine the closest one
+	const Vec3 facePts[ 4 ] = { s1, s2, s3, s4 };
+	Vec4 lambdas;
+	float dist = FLT_MAX;
+	for ( int i = 0; i < 4; i++ ) {
+		const int j = ( i + 1 ) % 4;
+		const int k = ( i + 2 ) % 4;
+
+		const Vec3 lambdasFace = SignedVolume2D( facePts[ i ], facePts[ j ], facePts[ k ] );
+		const Vec3 pt = facePts[ i ] * lambdasFace[ 0 ] + facePts[ j ] * lambdasFace[ 1 ] + facePts[ k ] * lambdasFace[ 2 ];
+		if ( pt.GetLengthSqr() < dist ) {
+			dist = pt.GetLengthSqr();
+			lambdas.Zero();
+			lambdas[ i ] = lambdasFace[ 0 ];
+			lambdas[ j ] = lambdasFace[ 1 ];
+			lambdas[ k ] = lambdasFace[ 2 ];
+		}
+	}
+
+	return lambdas;
+}
+
+/*
+========================================================================================================
+
+GJK
+
+========================================================================================================
+*/
+
+struct point_t {
+	Vec3 xyz;	// The point on the minkowski sum
+	Vec3 ptA;	// The point on bodyA
+	Vec3 ptB;	// The point on bodyB
+};
+
+/*
+====================================================
+Support
+====================================================
+*/
+static point_t Support( const Body * bodyA, const Body * bodyB, Vec3 dir, const float bias ) {
+	dir.Normalize();
+
+	point_t point;
+
+	// Find the point in A furthest in direction
+	point.ptA = bodyA->m_shape->Support( dir, bodyA->m_position, bodyA->m_orientation, bias );
+
+	dir *= -1.0f;
+
+	// Find the point in B furthest in the opposite direction
+	point.ptB = bodyB->m_shape->Support( dir, bodyB->m_position, bodyB->m_orientation, bias );
+
+	// Return the point, in the minkowski sum, furthest in the direction
+	point.xyz = point.ptA - point.ptB;
+	return point;
+}
+
+/*
+====================================================
+SimplexSignedVolumes
+
+Writes the direction from the closest point of the simplex towards
+the origin, returns true when the simplex contains the origin
+====================================================
+*/
+static bool SimplexSignedVolumes( const point_t * pts, const int num, Vec3 & newDir, Vec4 & lambdasOut ) {
+	const float epsilonf = 0.0001f * 0.0001f;
+	lambdasOut.Zero();
+
+	switch ( num ) {
+		default:
+		case 1: {
+			lambdasOut[ 0 ] = 1.0f;
+		} break;
+		case 2: {
+			const Vec2 lambdas = SignedVolume1D( pts[ 0 ].xyz, pts[ 1 ].xyz );
+			lambdasOut[ 0 ] = lambdas[ 0 ];
+			lambdasOut[ 1 ] = lambdas[ 1 ];
+		} break;
+		case 3: {
+			const Vec3 lambdas = SignedVolume2D( pts[ 0 ].xyz, pts[ 1 ].xyz, pts[ 2 ].xyz );
+			lambdasOut[ 0 ] = lambdas[ 0 ];
+			lambdasOut[ 1 ] = lambdas[ 1 ];
+			lambdasOut[ 2 ] = lambdas[ 2 ];
+		} break;
+		case 4: {
+			lambdasOut = SignedVolume3D( pts[ 0 ].xyz, pts[ 1 ].xyz, pts[ 2 ].xyz, pts[ 3 ].xyz );
+		} break;
+	}
+
+	Vec3 v( 0.0f );
+	for ( int i = 0; i < num; i++ ) {
+		v += pts[ i ].xyz * lambdasOut[ i ];
+	}
+	newDir = v * -1.0f;
+	return ( v.GetLengthSqr() < epsilonf );
+}
+
+/*
+====================================================
+HasPoint
+====================================================
+*/
+static bool HasPoint( const point_t * pts, const int num, const point_t & newPt ) {
+	const float precision = 1e-6f;
+
+	for ( int i = 0; i < num; i++ ) {
+		const Vec3 delta = pts[ i ].xyz - newPt.xyz;
+		if ( delta.GetLengthSqr() < precision * precision ) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/*
+====================================================
+SortValids
+
+Moves the points with a non-zero weight to the front and returns
+how many there are
+====================================================
+*/
+static int SortValids( point_t * pts, Vec4 & lambdas ) {
+	int numValids = 0;
+	for ( int i = 0; i < 4; i++ ) {
+		if ( 0.0f != lambdas[ i ] ) {
+			pts[ numValids ] = pts[ i ];
+			lambdas[ numValids ] = lambdas[ i ];
+			numValids++;
+		}
+	}
+	for ( int i = numValids; i < 4; i++ ) {
+		lambdas[ i ] = 0.0f;
+	}
+	return numValids;
+}
+
+/*
+====================================================
+GJK_Run
+
+Runs GJK until the simplex contains the origin or stops getting
+closer to it.  The simplex starts from the cached points of the
+previous query when there are any.  With earlyOut set it returns as
+soon as a separating plane is found, and the simplex is not the
+closest one.
+====================================================
+*/
+static bool GJK_Run( const Body * bodyA, const Body * bodyB, const float bias, const bool earlyOut, gjkCache_t * cache, point_t pts[ 4 ], int & numPts, Vec4 & lambdas ) {
+	int numIterations = 0;
+
+	// The cached points are points of the shapes, so moved with their bodies they are still on the minkowski sum
+	numPts = 0;
+	if ( NULL != cache ) {
+		for ( int i = 0; i < cache->numPts; i++ ) {
+			point_t pt;
+			pt.ptA = bodyA->BodySpaceToWorldSpace( cache->ptsA_BodySpace[ i ] );
+			pt.ptB = bodyB->BodySpaceToWorldSpace( cache->ptsB_BodySpace[ i ] );
+			pt.xyz = pt.ptA - pt.ptB;
+			if ( !HasPoint( pts, numPts, pt ) ) {
+				pts[ numPts++ ] = pt;
+			}
+		}
+	}
+	if ( 0 == numPts ) {
+		pts[ 0 ] = Support( bodyA, bodyB, Vec3( 1, 1, 1 ), bias );
+		numPts = 1;
+		numIterations++;
+	}
+
+	Vec3 newDir;
+	bool doesContainOrigin = SimplexSignedVolumes( pts, numPts, newDir, lambdas );
+	numPts = SortValids( pts, lambdas );
+	doesContainOrigin |= ( 4 == numPts );
+	float closestDist = newDir.GetLengthSqr();
+
+	const int maxIterations = 32;
+	while ( !doesContainOrigin && numIterations < maxIterations ) {
+		const point_t newPt = Support( bodyA, bodyB, newDir, bias );
+		numIterations++;
+
+		// No new point means the simplex already holds the closest features
+		if ( HasPoint( pts, numPts, newPt ) ) {
+			break;
+		}
+
+		// The support plane doesn't reach the origin, so it is a separating plane
+		const float dotdot = newDir.Dot( newPt.xyz );
+		if ( earlyOut && dotdot < 0.0f ) {
+			break;
+		}
+
+		// The new point can't get us meaningfully closer to the origin
+		if ( closestDist + dotdot <= closestDist * 1e-6f ) {
+			break;
+		}
+
+		pts[ numPts++ ] = newPt;
+		doesContainOrigin = SimplexSignedVolumes( pts, numPts, newDir, lambdas );
+		numPts = SortValids( pts, lambdas );
+		doesContainOrigin |= ( 4 == numPts );	// every weight is non-zero only when the origin is inside the tetrahedron
+
+		const float dist = newDir.GetLengthSqr();
+		if ( dist >= closestDist ) {
+			break;
+		}
+		closestDist = dist;
+	}
+
+	if ( NULL != cache ) {
+		cache->numPts = numPts;
+		for ( int i = 0; i < numPts; i++ ) {
+			cache->ptsA_BodySpace[ i ] = bodyA->WorldSpaceToBodySpace( pts[ i ].ptA );
+			cache->ptsB_BodySpace[ i ] = bodyB->WorldSpaceToBodySpace( pts[ i ].ptB );
+		}
+		cache->numIterations = numIterations;
+	}
+	return doesContainOrigin;
+}
+
+/*
+====================================================
+SimplexClosestPoints
+====================================================
+*/
+static void SimplexClosestPoints( const point_t * pts, const int numPts, const Vec4 & lambdas, Vec3 & ptOnA, Vec3 & ptOnB ) {
+	ptOnA.Zero();
+	ptOnB.Zero();
+	for ( int i = 0; i < numPts; i++ ) {
+		ptOnA += pts[ i ].ptA * lambdas[ i ];
+		ptOnB += pts[ i ].ptB * lambdas[ i ];
+	}
+}
+
+/*
+========================================================================================================
+
+EPA
+
+========================================================================================================
+*/
+
+/*
+====================================================
+CompleteTetrahedron
+
+EPA needs a simplex with volume, but GJK stops as soon as the origin
+is inside, which can be on a point, an edge or a face.  Returns false
+when the minkowski sum is flat and no tetrahedron fits in it.
+====================================================
+*/
+static bool CompleteTetrahedron( const Body * bodyA, const Body * bodyB, const float bias, point_t pts[ 4 ], int & numPts ) {
+	const float epsilon = 1e-6f;
+
+	if ( 1 == numPts ) {
+		const Vec3 dirs[ 7 ] = { pts[ 0 ].xyz * -1.0f, Vec3( 1, 0, 0 ), Vec3( -1, 0, 0 ), Vec3( 0, 1, 0 ), Vec3( 0, -1, 0 ), Vec3( 0, 0, 1 ), Vec3( 0, 0, -1 ) };
+		for ( int i = 0; i < 7 && 1 == numPts; i++ ) {
+			const point_t newPt = Support( bodyA, bodyB, dirs[ i ], bias );
+			if ( ( newPt.xyz - pts[ 0 ].xyz ).GetLengthSqr() > epsilon ) {
+				pts[ numPts++ ] = newPt;
+			}
+		}
+	}
+
+	if ( 2 == numPts ) {
+		const Vec3 ab = pts[ 1 ].xyz - pts[ 0 ].xyz;
+		Vec3 u, v;
+		ab.GetOrtho( u, v );
+		const Vec3 dirs[ 4 ] = { u, u * -1.0f, v, v * -1.0f };
+		for ( int i = 0; i < 4 && 2 == numPts; i++ ) {
+			const point_t newPt = Support( bodyA, bodyB, dirs[ i ], bias );
+			if ( ab.Cross( newPt.xyz - pts[ 0 ].xyz ).GetLengthSqr() > epsilon ) {
+				pts[ numPts++ ] = newPt;
+			}
+		}
+	}
+
+	if ( 3 == numPts ) {
+		Vec3 normal = ( pts[ 1 ].xyz - pts[ 0 ].xyz ).Cross( pts[ 2 ].xyz - pts[ 0 ].xyz );
+		normal.Normalize();
+		const Vec3 dirs[ 2 ] = { normal, normal * -1.0f };
+		for ( int i = 0; i < 2 && 3 == numPts; i++ ) {
+			const point_t newPt = Support( bodyA, bodyB, dirs[ i ], bias );
+			if ( fabsf( normal.Dot( newPt.xyz - pts[ 0 ].xyz ) ) > epsilon ) {
+				pts[ numPts++ ] = newPt;
+			}
+		}
+	}
+
+	return 4 == numPts;
+}
+
+struct epaTriangle_t {
+	tri_t tri;
+	Vec3 normal;	// zero for triangles without area
+	float dist;		// distance of the plane from the origin
+};
+
+/*
+====================================================
+MakeTriangle
+====================================================
+*/
+static epaTriangle_t MakeTriangle( const int a, const int b, const int c, const point_t * points ) {
+	epaTriangle_t triangle;
+	triangle.tri.a = a;
+	triangle.tri.b = b;
+	triangle.tri.c = c;
+
+	triangle.normal = ( points[ b ].xyz - points[ a ].xyz ).Cross( points[ c ].xyz - points[ a ].xyz );
+	if ( triangle.normal.GetLengthSqr() < FLT_EPSILON * FLT_EPSILON ) {
+		triangle.normal.Zero();
+		triangle.dist = FLT_MAX;
+	} else {
+		triangle.normal.Normalize();
+		triangle.dist = triangle.normal.Dot( points[ a ].xyz );
+	}
+	return triangle;
+}
+
+/*
+====================================================
+ClosestTriangle
+====================================================
+*/
+static int ClosestTriangle( const epaTriangle_t * triangles, const int numTriangles ) {
+	float minDist = FLT_MAX;
+	int idx = 0;
+	for ( int i = 0; i < numTriangles; i++ ) {
+		if ( triangles[ i ].dist < minDist ) {
+			idx = i;
+			minDist = triangles[ i ].dist;
+		}
+	}
+	return idx;
+}
+
+/*
+====================================================
+BarycentricCoordinates
+====================================================
+*/
+static Vec3 BarycentricCoordinates( const Vec3 & a, const Vec3 & b, const Vec3 & c, const Vec3 & pt ) {
+	const Vec3 v0 = b - a;
+	const Vec3 v1 = c - a;
+	const Vec3 v2 = pt - a;
+
+	const float d00 = v0.Dot( v0 );
+	const float d01 = v0.Dot( v1 );
+	const float d11 = v1.Dot( v1 );
+	const float d20 = v2.Dot( v0 );
+	const float d21 = v2.Dot( v1 );
+
+	const float denom = d00 * d11 - d01 * d01;
+	if ( denom * denom < FLT_EPSILON * FLT_EPSILON ) {
+		return Vec3( 1.0f, 0.0f, 0.0f );
+	}
+
+	const float v = ( d11 * d20 - d01 * d21 ) / denom;
+	const float w = ( d00 * d21 - d01 * d20 ) / denom;
+	return Vec3( 1.0f - v - w, v, w );
+}
+
+/*
+====================================================
+EPA_Expand
+
+Grows the tetrahedron towards the surface of the minkowski sum until
+the face closest to the origin can't be pushed out any further.  The
+points and faces live on the stack, so the query never allocates.
+====================================================
+*/
+static void EPA_Expand( const Body * bodyA, const Body * bodyB, const float bias, const point_t simplexPoints[ 4 ], Vec3 & ptOnA, Vec3 & ptOnB, Vec3 & faceNormal ) {
+	const int maxPoints = 64;
+	const int maxTriangles = 2 * maxPoints;
+	point_t points[ maxPoints ];
+	epaTriangle_t triangles[ maxTriangles ];
+	edge_t danglingEdges[ maxTriangles ];
+	int numPoints = 4;
+	int numTriangles = 0;
+
+	for ( int i = 0; i < 4; i++ ) {
+		points[ i ] = simplexPoints[ i ];
+	}
+
+	// Build the triangles, the point each one doesn't use must be behind it
+	for ( int i = 0; i < 4; i++ ) {
+		const int a = i;
+		const int b = ( i + 1 ) % 4;
+		const int c = ( i + 2 ) % 4;
+		const int unusedPt = ( i + 3 ) % 4;
+
+		const Vec3 normal = ( points[ b ].xyz - points[ a ].xyz ).Cross( points[ c ].xyz - points[ a ].xyz );
+		if ( normal.Dot( points[ unusedPt ].xyz - points[ a ].xyz ) > 0.0f ) {
+			triangles[ numTriangles++ ] = MakeTriangle( b, a, c, points );
+		} else {
+			triangles[ numTriangles++ ] = MakeTriangle( a, b, c, points );
+		}
+	}
+
+	const float tolerance = 0.0001f;
+	while ( numPoints < maxPoints ) {
+		const epaTriangle_t & closest = triangles[ ClosestTriangle( triangles, numTriangles ) ];
+
+		// Stop once the support point is on the closest face, the hull can't be expanded further
+		const point_t newPt = Support( bodyA, bodyB, closest.normal, bias );
+		if ( closest.normal.Dot( newPt.xyz ) - closest.dist < tolerance ) {
+			break;
+		}
+
+		// The edges only one of the triangles facing the new point uses are the rim of the hole it leaves.
+		// Collect them first, so running out of room stops the expansion with the hull still closed.
+		int numDanglingEdges = 0;
+		int numFacing = 0;
+		bool overflow = false;
+		for ( int i = 0; i < numTriangles && !overflow; i++ ) {
+			const tri_t tri = triangles[ i ].tri;
+			if ( triangles[ i ].normal.Dot( newPt.xyz ) - triangles[ i ].dist <= 0.0f ) {
+				continue;
+			}
+			numFacing++;
+
+			const edge_t edges[ 3 ] = { { tri.a, tri.b }, { tri.b, tri.c }, { tri.c, tri.a } };
+			for ( int e = 0; e < 3; e++ ) {
+				int shared = -1;
+				for ( int j = 0; j < numDanglingEdges; j++ ) {
+					if ( danglingEdges[ j ] == edges[ e ] ) {
+						shared = j;
+						break;
+					}
+				}
+				if ( shared >= 0 ) {
+					danglingEdges[ shared ] = danglingEdges[ --numDanglingEdges ];
+				} else if ( numDanglingEdges < maxTriangles ) {
+					danglingEdges[ numDanglingEdges++ ] = edges[ e ];
+				} else {
+					overflow = true;
+					break;
+				}
+			}
+		}
+
+		if ( overflow || 0 == numDanglingEdges || numTriangles - numFacing + numDanglingEdges > maxTriangles ) {
+			break;
+		}
+
+		// Then remove the triangles facing the new point
+		for ( int i = 0; i < numTriangles; i++ ) {
+			if ( triangles[ i ].normal.Dot( newPt.xyz ) - triangles[ i ].dist > 0.0f ) {
+				triangles[ i ] = triangles[ --numTriangles ];
+				i--;
+			}
+		}
+
+		// The rim edges keep the winding of the triangles they came from, so the new ones face outwards too
+		const int newIdx = numPoints++;
+		points[ newIdx ] = newPt;
+		for ( int i = 0; i < numDanglingEdges; i++ ) {
+			triangles[ numTriangles++ ] = MakeTriangle( danglingEdges[ i ].a, danglingEdges[ i ].b, newIdx, points );
+		}
+	}
+
+	// Get the projection of the origin on the closest triangle
+	const epaTriangle_t & closest = triangles[ ClosestTriangle( triangles, numTriangles ) ];
+	const tri_t & tri = closest.tri;
+	faceNormal = closest.normal;
+
+	const Vec3 lambdas = BarycentricCoordinates( points[ tri.a ].xyz, points[ tri.b ].xyz, points[ tri.c ].xyz, faceNormal * closest.dist );
+
+	// Get the point on shape A
+	ptOnA = points[ tri.a ].ptA * lambdas[ 0 ] + points[ tri.b ].ptA * lambdas[ 1 ] + points[ tri.c ].ptA * lambdas[ 2 ];
+
+	// Get the point on shape B
+	ptOnB = points[ tri.a ].ptB * lambdas[ 0 ] + points[ tri.b ].ptB * lambdas[ 1 ] + points[ tri.c ].ptB * lambdas[ 2 ];
+}
+
+/*
+========================================================================================================
+
+Queries
+
+========================================================================================================
+*/
+
+/*
+====================================================
+GJK_DoesIntersect
+====================================================
+*/
+bool GJK_DoesIntersect( const Body * bodyA, const Body * bodyB, gjkCache_t * cache ) {
+	point_t pts[ 4 ];
+	int numPts;
+	Vec4 lambdas;
+	return GJK_Run( bodyA, bodyB, 0.0f, true, cache, pts, numPts, lambdas );
+}
+
+/*
+====================================================
+GJK_ClosestPoints
+
+Returns the distance between the shapes, zero when they overlap
+====================================================
+*/
+float GJK_ClosestPoints( const Body * bodyA, const Body * bodyB, Vec3 & ptOnA, Vec3 & ptOnB, gjkCache_t * cache ) {
+	point_t pts[ 4 ];
+	int numPts;
+	Vec4 lambdas;
+	const bool doesIntersect = GJK_Run( bodyA, bodyB, 0.0f, false, cache, pts, numPts, lambdas );
+	SimplexClosestPoints( pts, numPts, lambdas, ptOnA, ptOnB );
+	return doesIntersect ? 0.0f : ( ptOnB - ptOnA ).GetMagnitude();
+}
+
+/*
+====================================================
+GJK_Query
+
+Both shapes are grown by bias, so shapes that are touching, or closer
+than twice the bias, count as overlapping and EPA always has a
+simplex with volume to start from.  When they overlap it returns true
+and the deepest points of each shape inside the other, found by EPA.
+Otherwise it returns false and the closest points.  The points are on
+the surfaces of the real shapes, and the normal points from B towards
+A in both cases, so the separation is ( ptOnA - ptOnB ) dot normal.
+====================================================
+*/
+bool GJK_Query( const Body * bodyA, const Body * bodyB, const float bias, Vec3 & ptOnA, Vec3 & ptOnB, Vec3 & normal, gjkCache_t * cache ) {
+	point_t pts[ 4 ];
+	int numPts;
+	Vec4 lambdas;
+	const bool doesIntersect = GJK_Run( bodyA, bodyB, bias, false, cache, pts, numPts, lambdas );
+
+	if ( doesIntersect && CompleteTetrahedron( bodyA, bodyB, bias, pts, numPts ) ) {
+		EPA_Expand( bodyA, bodyB, bias, pts, ptOnA, ptOnB, normal );
+		normal *= -1.0f;
+	} else {
+		// Closest points, or a flat minkowski sum that EPA can't expand
+		SimplexClosestPoints( pts, numPts, lambdas, ptOnA, ptOnB );
+		normal = ptOnA - ptOnB;
+	}
+
+	if ( normal.GetLengthSqr() < FLT_EPSILON * FLT_EPSILON ) {
+		normal = bodyA->GetCenterOfMassWorldSpace() - bodyB->GetCenterOfMassWorldSpace();
+	}
+	normal.Normalize();
+
+	// Move the points from the grown shapes back onto the real ones
+	ptOnA += normal * bias;
+	ptOnB -= normal * bias;
+	return doesIntersect;
+}
\ No newline at end of file
@@ -2,6 +2,8 @@
 //  Intersections.cpp
 //
 #include "Intersections.h"
+#include <float.h>
+#include <algorithm>
 
 /*
 ====================================================
@@ -82,12 +84,202 @@ bool SphereSphereDynamic( const ShapeSphere * shapeA, const ShapeSphere * shapeB
 	return true;
 }
 
+/*
+====================================================
+SphereSphereStatic
+====================================================
+*/
+bool SphereSphereStatic( const ShapeSphere * sphereA, const ShapeSphere * sphereB, const Vec3 & posA, const Vec3 & posB, Vec3 & ptOnA, Vec3 & ptOnB ) {
+	const Vec3 ab = posB - posA;
+	Vec3 norm = ab;
+	norm.Normalize();
+
+	ptOnA = posA + norm * sphereA->m_radius;
+	ptOnB = posB - norm * sphereB->m_radius;
+
+	const float radiusAB = sphereA->m_radius + sphereB->m_radius;
+	const float lengthSquare = ab.GetLengthSqr();
+	if ( lengthSquare <= ( radiusAB * radiusAB ) ) {
+		return true;
+	}
+
+	return false;
+}
+
+/*
+====================================================
+SphereBoxStatic
+
+Closest points of a sphere and a box, worked out in the box's model
+space instead of by GJK.  GJK stops within a tolerance, and the normal
+it leaves a little tilted off the face turns every bounce of a fast
+ball into some speed along the wall.  A center inside the box is
+pushed out through the nearest face.  The normal points from the box
+towards the sphere, and like GJK_Query the shapes count as touching
+within twice the bias.
+====================================================
+*/
+static bool SphereBoxStatic( const Body * sphereBody, const Body * boxBody, const float bias, Vec3 & ptOnSphere, Vec3 & ptOnBox, Vec3 & normal ) {
+	const float radius = ( (const ShapeSphere *)sphereBody->m_shape )->m_radius;
+	const Bounds & bounds = ( (const ShapeBox *)boxBody->m_shape )->m_bounds;
+
+	const Quat inverseOrient = boxBody->m_orientation.Inverse();
+	const Vec3 center = inverseOrient.RotatePoint( sphereBody->GetCenterOfMassWorldSpace() - boxBody->m_position );
+
+	Vec3 closest;
+	Vec3 localNormal;
+	bool isInside = true;
+	for ( int i = 0; i < 3; i++ ) {
+		closest[ i ] = std::max( bounds.mins[ i ], std::min( center[ i ], bounds.maxs[ i ] ) );
+		isInside = isInside && ( closest[ i ] == center[ i ] );
+	}
+
+	float distance;
+	if ( isInside ) {
+		int axis = 0;
+		float sign = 1.0f;
+		float depth = FLT_MAX;
+		for ( int i = 0; i < 3; i++ ) {
+			if ( bounds.maxs[ i ] - center[ i ] < depth ) {
+				depth = bounds.maxs[ i ] - center[ i ];
+				axis = i;
+				sign = 1.0f;
+			}
+			if ( center[ i ] - bounds.mins[ i ] < depth ) {
+				depth = center[ i ] - bounds.mins[ i ];
+				axis = i;
+				sign = -1.0f;
+			}
+		}
+		localNormal.Zero();
+		localNormal[ axis ] = sign;
+		closest[ axis ] = ( sign > 0.0f ) ? bounds.maxs[ axis ] : bounds.mins[ axis ];
+		distance = -depth;
+	} else {
+		localNormal = center - closest;
+		distance = localNormal.GetMagnitude();
+		localNormal /= distance;
+	}
+
+	normal = boxBody->m_orientation.RotatePoint( localNormal );
+	ptOnBox = boxBody->m_position + boxBody->m_orientation.RotatePoint( closest );
+	ptOnSphere = sphereBody->GetCenterOfMassWorldSpace() - normal * radius;
+	return distance - radius <= 2.0f * bias;
+}
+
+/*
+====================================================
+Intersect
+
+Tests the bodies where they are now.  The contact is filled in even
+when they don't touch, with the closest points and a positive
+separation, which is what conservative advancement steps on.
+====================================================
+*/
+bool Intersect( Body * bodyA, Body * bodyB, contact_t & contact, gjkCache_t * cache ) {
+	contact.bodyA = bodyA;
+	contact.bodyB = bodyB;
+	contact.timeOfImpact = 0.0f;
+
+	bool doesIntersect;
+	if ( bodyA->m_shape->GetType() == Shape::SHAPE_SPHERE && bodyB->m_shape->GetType() == Shape::SHAPE_SPHERE ) {
+		const ShapeSphere * sphereA = (const ShapeSphere *)bodyA->m_shape;
+		const ShapeSphere * sphereB = (const ShapeSphere *)bodyB->m_shape;
+
+		doesIntersect = SphereSphereStatic( sphereA, sphereB, bodyA->m_position, bodyB->m_position, contact.ptOnA_WorldSpace, contact.ptOnB_WorldSpace );
+		contact.normal = bodyA->m_position - bodyB->m_position;
+		contact.normal.Normalize();
+	} else if ( bodyA->m_shape->GetType() == Shape::SHAPE_SPHERE && bodyB->m_shape->GetType() == Shape::SHAPE_BOX ) {
+		doesIntersect = SphereBoxStatic( bodyA, bodyB, 0.001f, contact.ptOnA_WorldSpace, contact.ptOnB_WorldSpace, contact.normal );
+	} else if ( bodyA->m_shape->GetType() == Shape::SHAPE_BOX && bodyB->m_shape->GetType() == Shape::SHAPE_SPHERE ) {
+		doesIntersect = SphereBoxStatic( bodyB, bodyA, 0.001f, contact.ptOnB_WorldSpace, contact.ptOnA_WorldSpace, contact.normal );
+		contact.normal *= -1.0f;
+	} else {
+		const float bias = 0.001f;
+		doesIntersect = GJK_Query( bodyA, bodyB, bias, contact.ptOnA_WorldSpace, contact.ptOnB_WorldSpace, contact.normal, cache );
+
+		// GJK stops within a tolerance, which leaves the point on a sphere a little off the line
+		// through its center.  On a small sphere that lever arm turns every impact into a spin.
+		if ( bodyA->m_shape->GetType() == Shape::SHAPE_SPHERE ) {
+			const float radius = ( (const ShapeSphere *)bodyA->m_shape )->m_radius;
+			contact.ptOnA_WorldSpace = bodyA->GetCenterOfMassWorldSpace() - contact.normal * radius;
+		}
+		if ( bodyB->m_shape->GetType() == Shape::SHAPE_SPHERE ) {
+			const float radius = ( (const ShapeSphere *)bodyB->m_shape )->m_radius;
+			contact.ptOnB_WorldSpace = bodyB->GetCenterOfMassWorldSpace() + contact.normal * radius;
+		}
+	}
+
+	contact.ptOnA_LocalSpace = bodyA->WorldSpaceToBodySpace( contact.ptOnA_WorldSpace );
+	contact.ptOnB_LocalSpace = bodyB->WorldSpaceToBodySpace( contact.ptOnB_WorldSpace );
+	contact.separationDistance = ( contact.ptOnA_WorldSpace - contact.ptOnB_WorldSpace ).Dot( contact.normal );
+	return doesIntersect;
+}
+
+/*
+====================================================
+ConservativeAdvance
+
+Steps the bodies towards each other by the largest amount of time
+that can't make them pass through each other, until they touch or
+the time runs out.  The bodies are copies, Intersect leaves the real
+ones alone.
+====================================================
+*/
+static bool ConservativeAdvance( Body & bodyA, Body & bodyB, float dt, contact_t & contact, gjkCache_t * cache ) {
+	float toi = 0.0f;
+
+	int numIters = 0;
+
+	// Advance the positions of the bodies until they touch or there's not time left
+	while ( dt > 0.0f ) {
+		// Check for intersection
+		if ( Intersect( &bodyA, &bodyB, contact, cache ) ) {
+			contact.timeOfImpact = toi;
+			return true;
+		}
+
+		++numIters;
+		if ( numIters > 10 ) {
+			break;
+		}
+
+		// Get the vector from the closest point on A to the closest point on B
+		Vec3 ab = contact.ptOnB_WorldSpace - contact.ptOnA_WorldSpace;
+		ab.Normalize();
+
+		// project the relative velocity onto the ray of shortest distance
+		const Vec3 relativeVelocity = bodyA.m_linearVelocity - bodyB.m_linearVelocity;
+		float orthoSpeed = relativeVelocity.Dot( ab );
+
+		// Add to the orthoSpeed the maximum angular speeds of the relative shapes
+		const float angularSpeedA = bodyA.m_shape->FastestLinearSpeed( bodyA.m_angularVelocity, ab );
+		const float angularSpeedB = bodyB.m_shape->FastestLinearSpeed( bodyB.m_angularVelocity, ab * -1.0f );
+		orthoSpeed += angularSpeedA + angularSpeedB;
+		if ( orthoSpeed <= 0.0f ) {
+			break;
+		}
+
+		const float timeToGo = contact.separationDistance / orthoSpeed;
+		if ( timeToGo > dt ) {
+			break;
+		}
+
+		dt -= timeToGo;
+		toi += timeToGo;
+		bodyA.Update( timeToGo );
+		bodyB.Update( timeToGo );
+	}
+
+	return false;
+}
+
 /*
 ====================================================
 Intersect
 ====================================================
 */
-bool Intersect( Body * bodyA, Body * bodyB, const float dt, contact_t & contact ) {
+bool Intersect( Body * bodyA, Body * bodyB, const float dt, contact_t & contact, gjkCache_t * cache ) {
 	contact.bodyA = bodyA;
 	contact.bodyB = bodyB;
 
@@ -102,27 +294,115 @@ bool Intersect( Body * bodyA, Body * bodyB, const float dt, contact_t & contact
 		Vec3 velB = bodyB->m_linearVelocity;
 
 		if ( SphereSphereDynamic( sphereA, sphereB, posA, posB, velA, velB, dt, contact.ptOnA_WorldSpace, contact.ptOnB_WorldSpace, contact.timeOfImpact ) ) {
-			// Step bodies forward to get local space collision points
-			bodyA->Update( contact.timeOfImpact );
-			bodyB->Update( contact.timeOfImpact );
+			// Step copies of the bodies forward to get local space collision points.
+			// The bodies themselves are left untouched, so pairs that share a body
+			// can be tested from different threads.
+			Body futureA = *bodyA;
+			Body futureB = *bodyB;
+			futureA.Update( contact.timeOfImpact );
+			futureB.Update( contact.timeOfImpact );
 
 			// Convert world space contacts to local space
-			contact.ptOnA_LocalSpace = bodyA->WorldSpaceToBodySpace( contact.ptOnA_WorldSpace );
-			contact.ptOnB_LocalSpace = bodyB->WorldSpaceToBodySpace( contact.ptOnB_WorldSpace );
+			contact.ptOnA_LocalSpace = futureA.WorldSpaceToBodySpace( contact.ptOnA_WorldSpace );
+			contact.ptOnB_LocalSpace = futureB.WorldSpaceToBodySpace( contact.ptOnB_WorldSpace );
 
-			contact.normal = bodyA->m_position - bodyB->m_position;
+			contact.normal = futureA.m_position - futureB.m_position;
 			contact.normal.Normalize();
 
-			// Unwind time step
-			bodyA->Update( -contact.timeOfImpact );
-			bodyB->Update( -contact.timeOfImpact );
-
 			// Calculate the separation distance
 			Vec3 ab = bodyB->m_position - bodyA->m_position;
 			float r = ab.GetMagnitude() - ( sphereA->m_radius + sphereB->m_radius );
 			contact.separationDistance = r;
 			return true;
 		}
+		return false;
 	}
-	return false;
+
+	// Everything else goes through GJK, on copies that can be stepped forward
+	Body futureA = *bodyA;
+	Body futureB = *bodyB;
+	if ( !ConservativeAdvance( futureA, futureB, dt, contact, cache ) ) {
+		return false;
+	}
+
+	// Point the contact back at the real bodies, the local space points stay valid
+	contact.bodyA = bodyA;
+	contact.bodyB = bodyB;
+	return true;
 }
+
+/*
+====================================================
+GetPerturbedContacts
+
+GJK/EPA only reports the deepest point, so a box lying flat on
+another one would need several steps of rocking before its manifold
+has enough points to keep it flat.  This tilts the smaller body a
+little around the contact normal in a few directions and queries
+again, each tilt finds a different corner of the touching feature.
+The points are moved back onto the untilted body, and only the ones
+still touching are returned.
+====================================================
+*/
+int GetPerturbedContacts( Body * bodyA, Body * bodyB, const contact_t & contact, contact_t * contacts, const int maxContacts ) {
+	// A sphere only ever touches in one point
+	if ( Shape::SHAPE_SPHERE == bodyA->m_shape->GetType() || Shape::SHAPE_SPHERE == bodyB->m_shape->GetType() ) {
+		return 0;
+	}
+
+	const Bounds boundsA = bodyA->m_shape->GetBounds();
+	const Bounds boundsB = bodyB->m_shape->GetBounds();
+	const bool tiltA = ( boundsA.maxs - boundsA.mins ).GetLengthSqr() <= ( boundsB.maxs - boundsB.mins ).GetLengthSqr();
+	const Body * tilted = tiltA ? bodyA : bodyB;
+
+	Vec3 u;
+	Vec3 v;
+	contact.normal.GetOrtho( u, v );
+
+	const float angle = 0.05f;
+	const float bias = 0.001f;
+	const float threshold = 0.02f;
+	const Vec3 centerOfMass = tilted->GetCenterOfMassWorldSpace();
+
+	int numContacts = 0;
+	for ( int i = 0; i < 4 && numContacts < maxContacts; i++ ) {
+		// Diagonal axes, so an axis aligned box tips onto one corner instead of an edge
+		const float theta = ( 0.25f + 0.5f * (float)i ) * 3.14159265f;
+		const Quat tilt( u * cosf( theta ) + v * sinf( theta ), angle );
+
+		Body copy = *tilted;
+		copy.m_orientation = tilt * tilted->m_orientation;
+		copy.m_orientation.Normalize();
+		copy.m_position = centerOfMass + tilt.RotatePoint( tilted->m_position - centerOfMass );
+
+		Body * queryA = tiltA ? &copy : bodyA;
+		Body * queryB = tiltA ? bodyB : &copy;
+
+		Vec3 ptOnA;
+		Vec3 ptOnB;
+		Vec3 normal;
+		GJK_Query( queryA, queryB, bias, ptOnA, ptOnB, normal );
+
+		// Carry the point on the tilted body back to where the body really is, and drop it straight
+		// onto the other body along the normal, its surface there is the face the query found
+		contact_t & result = contacts[ numContacts ];
+		result = contact;
+		if ( tiltA ) {
+			result.ptOnA_WorldSpace = bodyA->BodySpaceToWorldSpace( copy.WorldSpaceToBodySpace( ptOnA ) );
+			result.separationDistance = ( result.ptOnA_WorldSpace - ptOnB ).Dot( contact.normal );
+			result.ptOnB_WorldSpace = result.ptOnA_WorldSpace - contact.normal * result.separationDistance;
+		} else {
+			result.ptOnB_WorldSpace = bodyB->BodySpaceToWorldSpace( copy.WorldSpaceToBodySpace( ptOnB ) );
+			result.separationDistance = ( ptOnA - result.ptOnB_WorldSpace ).Dot( contact.normal );
+			result.ptOnA_WorldSpace = result.ptOnB_WorldSpace + contact.normal * result.separationDistance;
+		}
+		result.ptOnA_LocalSpace = bodyA->WorldSpaceToBodySpace( result.ptOnA_WorldSpace );
+		result.ptOnB_LocalSpace = bodyB->WorldSpaceToBodySpace( result.ptOnB_WorldSpace );
+
+		if ( result.separationDistance < threshold ) {
+			numContacts++;
+		}
+	}
+
+	return numContacts;
+}
\ No newline at end of file
@@ -0,0 +1,333 @@
+//
+//  Manifold.cpp
+//
+#include "Manifold.h"
+#include <algorithm>
+
+/*
+====================================================
+Area4Points
+
+Area spanned by four unordered points, the largest of the three ways
+to pair them up as the diagonals of a quad
+====================================================
+*/
+static float Area4Points( const Vec3 & p0, const Vec3 & p1, const Vec3 & p2, const Vec3 & p3 ) {
+	const float a = ( p0 - p1 ).Cross( p2 - p3 ).GetLengthSqr();
+	const float b = ( p0 - p2 ).Cross( p1 - p3 ).GetLengthSqr();
+	const float c = ( p0 - p3 ).Cross( p1 - p2 ).GetLengthSqr();
+	return std::max( a, std::max( b, c ) );
+}
+
+/*
+====================================================
+Manifold::Manifold
+====================================================
+*/
+Manifold::Manifold() :
+m_bodyA( NULL ),
+m_bodyB( NULL ),
+m_numContacts( 0 ),
+m_friction( 0.0f ) {
+}
+
+/*
+====================================================
+Manifold::SetBodies
+
+The contacts only store body space points, so the bodies can be
+re-pointed when the body array they live in moves
+====================================================
+*/
+void Manifold::SetBodies( Body * bodyA, Body * bodyB ) {
+	m_bodyA = bodyA;
+	m_bodyB = bodyB;
+	for ( int i = 0; i < m_numContacts; i++ ) {
+		m_points[ i ].contact.bodyA = bodyA;
+		m_points[ i ].contact.bodyB = bodyB;
+	}
+}
+
+/*
+====================================================
+Manifold::AddContact
+====================================================
+*/
+void Manifold::AddContact( const contact_t & contact ) {
+	// A contact close to one we already have is the same point, refresh its
+	// geometry but keep its impulses so it can be warm started
+	const float threshold = 0.02f;
+	for ( int i = 0; i < m_numContacts; i++ ) {
+		const contact_t & old = m_points[ i ].contact;
+		const Vec3 oldA = m_bodyA->BodySpaceToWorldSpace( old.ptOnA_LocalSpace );
+		const Vec3 oldB = m_bodyB->BodySpaceToWorldSpace( old.ptOnB_LocalSpace );
+		if ( ( contact.ptOnA_WorldSpace - oldA ).GetLengthSqr() < threshold * threshold ||
+			( contact.ptOnB_WorldSpace - oldB ).GetLengthSqr() < threshold * threshold ) {
+			m_points[ i ].contact = contact;
+			return;
+		}
+	}
+
+	int idx = m_numContacts;
+	if ( MAX_CONTACTS == m_numContacts ) {
+		// Full, keep the deepest point and the three others that span the largest area.  A flat
+		// contact reports points of about equal depth, so the deepest one is only protected when
+		// it is clearly deeper than the new one, otherwise noise would decide which corners stay.
+		Vec3 pts[ MAX_CONTACTS + 1 ];
+		for ( int i = 0; i < MAX_CONTACTS; i++ ) {
+			pts[ i ] = m_bodyA->BodySpaceToWorldSpace( m_points[ i ].contact.ptOnA_LocalSpace );
+		}
+		pts[ MAX_CONTACTS ] = contact.ptOnA_WorldSpace;
+
+		int deepest = 0;
+		for ( int i = 1; i < MAX_CONTACTS; i++ ) {
+			if ( m_points[ i ].contact.separationDistance < m_points[ deepest ].contact.separationDistance ) {
+				deepest = i;
+			}
+		}
+		const float depthTolerance = 0.005f;
+		if ( m_points[ deepest ].contact.separationDistance + depthTolerance > contact.separationDistance ) {
+			deepest = -1;
+		}
+
+		// Start from dropping the new contact, so a tie keeps the points that carry impulses
+		float maxArea = Area4Points( pts[ 0 ], pts[ 1 ], pts[ 2 ], pts[ 3 ] );
+		for ( int drop = 0; drop < MAX_CONTACTS; drop++ ) {
+			if ( drop == deepest ) {
+				continue;
+			}
+
+			Vec3 kept[ MAX_CONTACTS ];
+			int numKept = 0;
+			for ( int i = 0; i <= MAX_CONTACTS; i++ ) {
+				if ( i != drop ) {
+					kept[ numKept++ ] = pts[ i ];
+				}
+			}
+
+			const float area = Area4Points( kept[ 0 ], kept[ 1 ], kept[ 2 ], kept[ 3 ] );
+			if ( area > maxArea ) {
+				maxArea = area;
+				idx = drop;
+			}
+		}
+
+		// The new contact is the one that adds the least
+		if ( MAX_CONTACTS == idx ) {
+			return;
+		}
+	} else {
+		m_numContacts++;
+	}
+
+	manifoldPoint_t & point = m_points[ idx ];
+	point.contact = contact;
+	point.normalImpulse = 0.0f;
+	point.tangentImpulse[ 0 ] = 0.0f;
+	point.tangentImpulse[ 1 ] = 0.0f;
+}
+
+/*
+====================================================
+Manifold::RemoveExpiredContacts
+
+Drops the points that separated, or slid apart along the surface,
+since they were found
+====================================================
+*/
+void Manifold::RemoveExpiredContacts() {
+	const float threshold = 0.02f;
+
+	for ( int i = 0; i < m_numContacts; i++ ) {
+		contact_t & contact = m_points[ i ].contact;
+
+		contact.ptOnA_WorldSpace = m_bodyA->BodySpaceToWorldSpace( contact.ptOnA_LocalSpace );
+		contact.ptOnB_WorldSpace = m_bodyB->BodySpaceToWorldSpace( contact.ptOnB_LocalSpace );
+
+		const Vec3 ab = contact.ptOnA_WorldSpace - contact.ptOnB_WorldSpace;
+		contact.separationDistance = ab.Dot( contact.normal );
+
+		const Vec3 tangential = ab - contact.normal * contact.separationDistance;
+		if ( contact.separationDistance > threshold || tangential.GetLengthSqr() > threshold * threshold ) {
+			m_points[ i ] = m_points[ m_numContacts - 1 ];
+			m_numContacts--;
+			i--;
+		}
+	}
+}
+
+/*
+====================================================
+Manifold::BuildRow
+====================================================
+*/
+void Manifold::BuildRow( row_t & row, const Vec3 & dir, const Vec3 & rA, const Vec3 & rB ) const {
+	row.dir = dir;
+	row.angularA = rA.Cross( dir );
+	row.angularB = rB.Cross( dir );
+	row.spinA = m_invInertiaA * row.angularA;
+	row.spinB = m_invInertiaB * row.angularB;
+
+	const float invMass = m_bodyA->m_invMass + m_bodyB->m_invMass + row.spinA.Dot( row.angularA ) + row.spinB.Dot( row.angularB );
+	row.mass = ( invMass > 0.0f ) ? 1.0f / invMass : 0.0f;
+}
+
+/*
+====================================================
+Manifold::GetRelativeSpeed
+
+Speed of the point on A relative to the point on B along the row
+====================================================
+*/
+float Manifold::GetRelativeSpeed( const row_t & row ) const {
+	return row.dir.Dot( m_bodyA->m_linearVelocity - m_bodyB->m_linearVelocity ) +
+		m_bodyA->m_angularVelocity.Dot( row.angularA ) - m_bodyB->m_angularVelocity.Dot( row.angularB );
+}
+
+/*
+====================================================
+Manifold::ApplyImpulse
+
+Pushes A along the row and B against it.  Velocities are written
+directly, Body::ApplyImpulse would clamp the spin in the middle of the
+iterations.  Static bodies are shared between islands and never
+written.
+====================================================
+*/
+void Manifold::ApplyImpulse( const row_t & row, const float impulse ) {
+	if ( 0.0f != m_bodyA->m_invMass ) {
+		m_bodyA->m_linearVelocity += row.dir * ( impulse * m_bodyA->m_invMass );
+		m_bodyA->m_angularVelocity += row.spinA * impulse;
+	}
+	if ( 0.0f != m_bodyB->m_invMass ) {
+		m_bodyB->m_linearVelocity -= row.dir * ( impulse * m_bodyB->m_invMass );
+		m_bodyB->m_angularVelocity -= row.spinB * impulse;
+	}
+}
+
+/*
+====================================================
+Manifold::GetRelativePushSpeed
+====================================================
+*/
+float Manifold::GetRelativePushSpeed( const row_t & row ) const {
+	return row.dir.Dot( m_bodyA->m_pushLinearVelocity - m_bodyB->m_pushLinearVelocity ) +
+		m_bodyA->m_pushAngularVelocity.Dot( row.angularA ) - m_bodyB->m_pushAngularVelocity.Dot( row.angularB );
+}
+
+/*
+====================================================
+Manifold::ApplyPushImpulse
+
+Like ApplyImpulse, on the push velocities
+====================================================
+*/
+void Manifold::ApplyPushImpulse( const row_t & row, const float impulse ) {
+	if ( 0.0f != m_bodyA->m_invMass ) {
+		m_bodyA->m_pushLinearVelocity += row.dir * ( impulse * m_bodyA->m_invMass );
+		m_bodyA->m_pushAngularVelocity += row.spinA * impulse;
+	}
+	if ( 0.0f != m_bodyB->m_invMass ) {
+		m_bodyB->m_pushLinearVelocity -= row.dir * ( impulse * m_bodyB->m_invMass );
+		m_bodyB->m_pushAngularVelocity -= row.spinB * impulse;
+	}
+}
+
+/*
+====================================================
+Manifold::PreSolve
+====================================================
+*/
+void Manifold::PreSolve( const float dt_sec, const bool warmStart ) {
+	const float baumgarte = 0.2f;				// fraction of the penetration pushed out per step
+	const float allowedPenetration = 0.005f;	// keeps resting contacts touching, so they aren't dropped and re-added
+	const float restitutionThreshold = 1.0f;	// slower impacts don't bounce, resting contacts would never settle
+
+	m_invInertiaA = m_bodyA->GetInverseInertiaTensorWorldSpace();
+	m_invInertiaB = m_bodyB->GetInverseInertiaTensorWorldSpace();
+	m_friction = m_bodyA->m_friction * m_bodyB->m_friction;
+	const float elasticity = m_bodyA->m_elasticity * m_bodyB->m_elasticity;
+
+	const Vec3 centerA = m_bodyA->GetCenterOfMassWorldSpace();
+	const Vec3 centerB = m_bodyB->GetCenterOfMassWorldSpace();
+
+	for ( int i = 0; i < m_numContacts; i++ ) {
+		manifoldPoint_t & point = m_points[ i ];
+		const contact_t & contact = point.contact;
+		const Vec3 & n = contact.normal;
+
+		const Vec3 ptA = m_bodyA->BodySpaceToWorldSpace( contact.ptOnA_LocalSpace );
+		const Vec3 ptB = m_bodyB->BodySpaceToWorldSpace( contact.ptOnB_LocalSpace );
+		const Vec3 rA = ptA - centerA;
+		const Vec3 rB = ptB - centerB;
+
+		Vec3 tangents[ 2 ];
+		n.GetOrtho( tangents[ 0 ], tangents[ 1 ] );
+		BuildRow( point.normal, n, rA, rB );
+		BuildRow( point.tangent[ 0 ], tangents[ 0 ], rA, rB );
+		BuildRow( point.tangent[ 1 ], tangents[ 1 ], rA, rB );
+
+		// A gap may be closed within the step, a penetration is pushed out a fraction at a time
+		// through the push velocities, so the real ones come to rest instead of carrying the push
+		const float separation = ( ptA - ptB ).Dot( n );
+		point.bias = std::min( -separation / dt_sec, 0.0f );
+		point.pushBias = -baumgarte / dt_sec * std::min( separation + allowedPenetration, 0.0f );
+		point.pushImpulse = 0.0f;
+
+		const float approachSpeed = -GetRelativeSpeed( point.normal );
+		if ( approachSpeed > restitutionThreshold ) {
+			point.bias = std::max( point.bias, elasticity * approachSpeed );
+		}
+
+		if ( warmStart ) {
+			ApplyImpulse( point.normal, point.normalImpulse );
+			ApplyImpulse( point.tangent[ 0 ], point.tangentImpulse[ 0 ] );
+			ApplyImpulse( point.tangent[ 1 ], point.tangentImpulse[ 1 ] );
+		} else {
+			point.normalImpulse = 0.0f;
+			point.tangentImpulse[ 0 ] = 0.0f;
+			point.tangentImpulse[ 1 ] = 0.0f;
+		}
+	}
+}
+
+/*
+====================================================
+Manifold::Solve
+
+One sequential impulse iteration over the points.  The impulses are
+clamped on their accumulated value, not on each delta, so an
+iteration can take back what an earlier one over applied.
+====================================================
+*/
+void Manifold::Solve() {
+	// Friction first, bounded by the normal impulse each point currently carries
+	for ( int i = 0; i < m_numContacts; i++ ) {
+		manifoldPoint_t & point = m_points[ i ];
+		const float maxFriction = m_friction * point.normalImpulse;
+		for ( int k = 0; k < 2; k++ ) {
+			const row_t & row = point.tangent[ k ];
+			const float oldImpulse = point.tangentImpulse[ k ];
+			const float newImpulse = std::max( -maxFriction, std::min( oldImpulse - GetRelativeSpeed( row ) * row.mass, maxFriction ) );
+			point.tangentImpulse[ k ] = newImpulse;
+			ApplyImpulse( row, newImpulse - oldImpulse );
+		}
+	}
+
+	// The normal impulse can only push the bodies apart
+	for ( int i = 0; i < m_numContacts; i++ ) {
+		manifoldPoint_t & point = m_points[ i ];
+		const row_t & row = point.normal;
+		const float oldImpulse = point.normalImpulse;
+		const float newImpulse = std::max( oldImpulse + ( point.bias - GetRelativeSpeed( row ) ) * row.mass, 0.0f );
+		point.normalImpulse = newImpulse;
+		ApplyImpulse( row, newImpulse - oldImpulse );
+
+		// Only penetrating points push
+		if ( point.pushBias > 0.0f ) {
+			const float oldPush = point.pushImpulse;
+			point.pushImpulse = std::max( oldPush + ( point.pushBias - GetRelativePushSpeed( row ) ) * row.mass, 0.0f );
+			ApplyPushImpulse( row, point.pushImpulse - oldPush );
+		}
+	}
+}
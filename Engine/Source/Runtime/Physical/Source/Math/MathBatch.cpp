@@ -0,0 +1,109 @@
+//
+//	MathBatch.cpp
+//
+#include "Math/MathBatch.h"
+
+static_assert( sizeof( Vec3 ) == sizeof( float ) * 3, "batch kernels read Vec3 arrays as packed floats" );
+static_assert( sizeof( Quat ) == sizeof( float ) * 4, "batch kernels read Quat arrays as packed floats" );
+
+/*
+====================================================
+DotBatch
+====================================================
+*/
+void DotBatch( const Vec3 * a, const Vec3 * b, float * results, const int num ) {
+	int i = 0;
+#if defined( PHYSICS_SIMD_ENABLED )
+	for ( ; i + 4 <= num; i += 4 ) {
+		simd4_t ax, ay, az;
+		simd4_t bx, by, bz;
+		Simd4LoadVec3x4( a[ i ].ToPtr(), ax, ay, az );
+		Simd4LoadVec3x4( b[ i ].ToPtr(), bx, by, bz );
+
+		const simd4_t dot = Simd4MulAdd( az, bz, Simd4MulAdd( ay, by, Simd4Mul( ax, bx ) ) );
+		Simd4Store( results + i, dot );
+	}
+#endif
+
+	for ( ; i < num; i++ ) {
+		results[ i ] = a[ i ].Dot( b[ i ] );
+	}
+}
+
+/*
+====================================================
+CrossBatch
+====================================================
+*/
+void CrossBatch( const Vec3 * a, const Vec3 * b, Vec3 * results, const int num ) {
+	int i = 0;
+#if defined( PHYSICS_SIMD_ENABLED )
+	for ( ; i + 4 <= num; i += 4 ) {
+		simd4_t ax, ay, az;
+		simd4_t bx, by, bz;
+		Simd4LoadVec3x4( a[ i ].ToPtr(), ax, ay, az );
+		Simd4LoadVec3x4( b[ i ].ToPtr(), bx, by, bz );
+
+		const simd4_t cx = Simd4Sub( Simd4Mul( ay, bz ), Simd4Mul( by, az ) );
+		const simd4_t cy = Simd4Sub( Simd4Mul( bx, az ), Simd4Mul( ax, bz ) );
+		const simd4_t cz = Simd4Sub( Simd4Mul( ax, by ), Simd4Mul( bx, ay ) );
+		Simd4StoreVec3x4( &results[ i ].x, cx, cy, cz );
+	}
+#endif
+
+	for ( ; i < num; i++ ) {
+		results[ i ] = a[ i ].Cross( b[ i ] );
+	}
+}
+
+/*
+====================================================
+RotateBatch
+
+Same expansion of q * v * q^-1 as Quat::RotatePoint.
+====================================================
+*/
+void RotateBatch( const Quat * orientations, const Vec3 * points, Vec3 * results, const int num ) {
+	int i = 0;
+#if defined( PHYSICS_SIMD_ENABLED )
+	const simd4_t two = Simd4Splat( 2.0f );
+	const simd4_t one = Simd4Splat( 1.0f );
+	for ( ; i + 4 <= num; i += 4 ) {
+		simd4_t qw, qx, qy, qz;
+		simd4_t vx, vy, vz;
+		Simd4LoadTranspose4( &orientations[ i ].w, qw, qx, qy, qz );
+		Simd4LoadVec3x4( points[ i ].ToPtr(), vx, vy, vz );
+
+		const simd4_t qq = Simd4MulAdd( qz, qz, Simd4MulAdd( qy, qy, Simd4Mul( qx, qx ) ) );
+		const simd4_t ww = Simd4Mul( qw, qw );
+		const simd4_t invMagSqr = Simd4Div( one, Simd4Add( qq, ww ) );
+		const simd4_t scaleV = Simd4Sub( ww, qq );
+		const simd4_t scaleQ = Simd4Mul( two, Simd4MulAdd( qz, vz, Simd4MulAdd( qy, vy, Simd4Mul( qx, vx ) ) ) );
+		const simd4_t scaleC = Simd4Mul( two, qw );
+
+		const simd4_t cx = Simd4Sub( Simd4Mul( qy, vz ), Simd4Mul( vy, qz ) );
+		const simd4_t cy = Simd4Sub( Simd4Mul( vx, qz ), Simd4Mul( qx, vz ) );
+		const simd4_t cz = Simd4Sub( Simd4Mul( qx, vy ), Simd4Mul( vx, qy ) );
+
+		const simd4_t rx = Simd4Mul( Simd4MulAdd( cx, scaleC, Simd4MulAdd( qx, scaleQ, Simd4Mul( vx, scaleV ) ) ), invMagSqr );
+		const simd4_t ry = Simd4Mul( Simd4MulAdd( cy, scaleC, Simd4MulAdd( qy, scaleQ, Simd4Mul( vy, scaleV ) ) ), invMagSqr );
+		const simd4_t rz = Simd4Mul( Simd4MulAdd( cz, scaleC, Simd4MulAdd( qz, scaleQ, Simd4Mul( vz, scaleV ) ) ), invMagSqr );
+		Simd4StoreVec3x4( &results[ i ].x, rx, ry, rz );
+	}
+#endif
+
+	for ( ; i < num; i++ ) {
+		results[ i ] = orientations[ i ].RotatePoint( points[ i ] );
+	}
+}
+
+/*
+====================================================
+MulBatch
+====================================================
+*/
+void MulBatch( const Mat3 * a, const Mat3 * b, Mat3 * results, const int num ) {
+	for ( int i = 0; i < num; i++ ) {
+		results[ i ] = a[ i ] * b[ i ];
+	}
+}
\ No newline at end of file
@@ -0,0 +1,851 @@
+//
+//  PhysicsWorld.cpp
+//
+#include "PhysicsWorld.h"
+#include "Intersections.h"
+#include "Async/PriorityThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
+/*
+====================================================
+PhysicsWorld::PhysicsWorld
+====================================================
+*/
+PhysicsWorld::PhysicsWorld() :
+m_gravity( 0.0f, 0.0f, -10.0f ),
+m_numSolverIterations( 12 ),
+m_warmStarting( true ),
+m_maxSubsteps( 8 ),
+m_allowSleeping( true ),
+m_sleepLinearSpeed( 0.05f ),
+m_sleepAngularSpeed( 0.05f ),
+m_timeToSleep( 0.5f ),
+m_threadPool( NULL ),
+m_numTasks( 1 ),
+m_stepCount( 0 ) {
+}
+
+/*
+====================================================
+PhysicsWorld::SetThreadPool
+
+numTasks is the number of tasks a parallel phase is split into,
+the calling thread runs one of them.  Pass NULL to step serially.
+====================================================
+*/
+void PhysicsWorld::SetThreadPool( PriorityThreadPool * threadPool, const int numTasks ) {
+	m_threadPool = threadPool;
+	m_numTasks = std::max( numTasks, 1 );
+}
+
+/*
+====================================================
+PhysicsWorld::ParallelFor
+
+Tasks pull batches from a shared counter, so the split of work over
+the threads varies from run to run.  Callers must only write to data
+owned by the indices they were given.
+====================================================
+*/
+void PhysicsWorld::ParallelFor( const int num, const int batchSize, const rangeTask_t & task ) {
+	if ( num <= 0 ) {
+		return;
+	}
+
+	const int numBatches = ( num + batchSize - 1 ) / batchSize;
+	const int numTasks = std::min( m_numTasks, numBatches );
+	if ( NULL == m_threadPool || numTasks <= 1 ) {
+		task( 0, num );
+		return;
+	}
+
+	std::atomic< int > nextBatch( 0 );
+	auto runBatches = [ & ]() {
+		for ( int batch = nextBatch.fetch_add( 1 ); batch < numBatches; batch = nextBatch.fetch_add( 1 ) ) {
+			const int begin = batch * batchSize;
+			const int end = std::min( begin + batchSize, num );
+			task( begin, end );
+		}
+	};
+
+	std::mutex mutex;
+	std::condition_variable finished;
+	int numPending = numTasks - 1;
+
+	for ( int i = 1; i < numTasks; i++ ) {
+		m_threadPool->Submit( PriorityThreadPool::Priority::High, [ & ]() {
+			runBatches();
+
+			// Notify while holding the lock, the waiting thread owns the condition variable
+			std::lock_guard< std::mutex > lock( mutex );
+			numPending--;
+			finished.notify_one();
+		} );
+	}
+
+	runBatches();
+
+	std::unique_lock< std::mutex > lock( mutex );
+	finished.wait( lock, [ & ]() { return 0 == numPending; } );
+}
+
+/*
+====================================================
+PhysicsWorld::Step
+====================================================
+*/
+void PhysicsWorld::Step( const float dt_sec ) {
+	const int num = (int)m_bodies.size();
+	Body * bodies = m_bodies.data();
+	m_stepCount++;
+
+	UpdateSleepGroups();
+
+	//
+	//	Gravity impulse
+	//
+	ParallelFor( num, 256, [ & ]( int begin, int end ) {
+		for ( int i = begin; i < end; i++ ) {
+			Body & body = bodies[ i ];
+			if ( 0.0f == body.m_invMass || !body.m_isAwake ) {
+				continue;
+			}
+
+			// Gravity needs to be an impulse
+			// I = dp, F = dp/dt => dp = F * dt => I = F * dt
+			// F = mgs
+			const float mass = 1.0f / body.m_invMass;
+			const Vec3 impulseGravity = m_gravity * mass * dt_sec;
+			body.ApplyImpulseLinear( impulseGravity );
+		}
+	} );
+
+	//
+	//	Broadphase, again whenever sleeping bodies were woken, so the pairs between them are found too
+	//
+	m_broadPhase.Update( bodies, num, m_pairs, dt_sec );
+	while ( WakeTouchedBodies( dt_sec ) ) {
+		m_broadPhase.Update( bodies, num, m_pairs, dt_sec );
+	}
+
+	//
+	//	NarrowPhase (perform actual collision detection)
+	//
+	NarrowPhase( dt_sec );
+
+	//
+	//	Solve the islands of touching dynamic bodies independently
+	//
+	BuildIslands();
+	ParallelFor( GetNumIslands(), 16, [ & ]( int begin, int end ) {
+		for ( int i = begin; i < end; i++ ) {
+			SolveIsland( i, dt_sec );
+		}
+	} );
+	PutIslandsToSleep();
+
+	// Static bodies are not part of any island
+	for ( int i = 0; i < num; i++ ) {
+		if ( 0.0f == bodies[ i ].m_invMass ) {
+			bodies[ i ].Update( dt_sec );
+		}
+	}
+}
+
+/*
+====================================================
+IsResting
+====================================================
+*/
+static bool IsResting( const Body & body ) {
+	return 0.0f == body.m_invMass || !body.m_isAwake;
+}
+
+/*
+====================================================
+PhysicsWorld::UpdateSleepGroups
+
+Wakes the rest of the group of a body that was woken from outside the
+step, by an impulse or SetAwake.  The groups are dropped, and their
+bodies woken, when the body list changed size, the indices they hold
+can't be trusted anymore.
+====================================================
+*/
+void PhysicsWorld::UpdateSleepGroups() {
+	const int num = (int)m_bodies.size();
+	if ( (int)m_sleepGroupOfBody.size() != num ) {
+		for ( int i = 0; i < (int)m_sleepGroups.size(); i++ ) {
+			const std::vector< int > & members = m_sleepGroups[ i ];
+			for ( int j = 0; j < (int)members.size(); j++ ) {
+				if ( members[ j ] < num ) {
+					m_bodies[ members[ j ] ].SetAwake( true );
+				}
+			}
+		}
+		m_sleepGroups.clear();
+		m_freeSleepGroups.clear();
+		m_sleepGroupOfBody.assign( num, -1 );
+	}
+
+	for ( int i = 0; i < num; i++ ) {
+		const Body & body = m_bodies[ i ];
+		const bool wokenOutside = ( m_sleepGroupOfBody[ i ] >= 0 && body.m_isAwake );
+		const bool sleepingNotAllowed = ( !body.m_isAwake && !m_allowSleeping );
+		if ( wokenOutside || sleepingNotAllowed ) {
+			WakeBody( i );
+		}
+	}
+}
+
+/*
+====================================================
+PhysicsWorld::WakeTouchedBodies
+
+Wakes the sleeping bodies that an awake body touches, or reaches
+within the step.  Returns true when any body was woken.
+====================================================
+*/
+bool PhysicsWorld::WakeTouchedBodies( const float dt_sec ) {
+	bool woken = false;
+	for ( int i = 0; i < (int)m_pairs.size(); i++ ) {
+		const collisionPair_t & pair = m_pairs[ i ];
+		Body * bodyA = &m_bodies[ pair.a ];
+		Body * bodyB = &m_bodies[ pair.b ];
+		const bool sleepingA = ( 0.0f != bodyA->m_invMass && !bodyA->m_isAwake );
+		const bool sleepingB = ( 0.0f != bodyB->m_invMass && !bodyB->m_isAwake );
+		if ( !( sleepingA && !IsResting( *bodyB ) ) && !( sleepingB && !IsResting( *bodyA ) ) ) {
+			continue;
+		}
+
+		contact_t contact;
+		if ( !Intersect( bodyA, bodyB, dt_sec, contact ) ) {
+			continue;
+		}
+
+		WakeBody( sleepingA ? pair.a : pair.b );
+		woken = true;
+	}
+	return woken;
+}
+
+/*
+====================================================
+PhysicsWorld::WakeBody
+
+Wakes the body together with every body it fell asleep with
+====================================================
+*/
+void PhysicsWorld::WakeBody( const int id ) {
+	const int group = m_sleepGroupOfBody[ id ];
+	if ( group < 0 ) {
+		m_bodies[ id ].SetAwake( true );
+		return;
+	}
+
+	std::vector< int > & members = m_sleepGroups[ group ];
+	for ( int i = 0; i < (int)members.size(); i++ ) {
+		m_bodies[ members[ i ] ].SetAwake( true );
+		m_sleepGroupOfBody[ members[ i ] ] = -1;
+	}
+	members.clear();
+	m_freeSleepGroups.push_back( group );
+}
+
+/*
+====================================================
+PhysicsWorld::PutIslandsToSleep
+
+Runs after the islands were solved, SolveIsland only marks the ones
+that can sleep, the groups are shared between them.
+====================================================
+*/
+void PhysicsWorld::PutIslandsToSleep() {
+	const int numIslands = GetNumIslands();
+	for ( int island = 0; island < numIslands; island++ ) {
+		if ( !m_islandCanSleep[ island ] ) {
+			continue;
+		}
+
+		int group;
+		if ( m_freeSleepGroups.empty() ) {
+			group = (int)m_sleepGroups.size();
+			m_sleepGroups.emplace_back();
+		} else {
+			group = m_freeSleepGroups.back();
+			m_freeSleepGroups.pop_back();
+		}
+
+		std::vector< int > & members = m_sleepGroups[ group ];
+		members.assign( m_islandBodies.begin() + m_islandBodyStart[ island ], m_islandBodies.begin() + m_islandBodyStart[ island + 1 ] );
+		for ( int i = 0; i < (int)members.size(); i++ ) {
+			m_bodies[ members[ i ] ].SetAwake( false );
+			m_sleepGroupOfBody[ members[ i ] ] = group;
+		}
+	}
+}
+
+/*
+====================================================
+GetThickness
+
+Smallest extent of the shape, the distance it takes to pass through it
+====================================================
+*/
+static float GetThickness( const Shape * shape ) {
+	const Bounds bounds = shape->GetBounds();
+	return std::min( bounds.WidthX(), std::min( bounds.WidthY(), bounds.WidthZ() ) );
+}
+
+/*
+====================================================
+GetThicknessesPerStep
+
+How many times the thickness of the thinner body the pair can move
+within the step
+====================================================
+*/
+static float GetThicknessesPerStep( const Body & bodyA, const Body & bodyB, const float dt_sec ) {
+	Vec3 ab = bodyB.GetCenterOfMassWorldSpace() - bodyA.GetCenterOfMassWorldSpace();
+	ab.Normalize();
+
+	float speed = ( bodyA.m_linearVelocity - bodyB.m_linearVelocity ).GetMagnitude();
+	speed += bodyA.m_shape->FastestLinearSpeed( bodyA.m_angularVelocity, ab );
+	speed += bodyB.m_shape->FastestLinearSpeed( bodyB.m_angularVelocity, ab * -1.0f );
+
+	const float thickness = std::min( GetThickness( bodyA.m_shape ), GetThickness( bodyB.m_shape ) );
+	return speed * dt_sec / thickness;
+}
+
+/*
+====================================================
+IsFastPair
+
+A pair is fast when its bodies can move through half of the thinner
+one within the step.  Slower pairs can't skip past each other, the
+contact found at the start of the next step catches them.
+====================================================
+*/
+static bool IsFastPair( const Body & bodyA, const Body & bodyB, const float dt_sec ) {
+	return GetThicknessesPerStep( bodyA, bodyB, dt_sec ) > 0.5f;
+}
+
+/*
+====================================================
+IsApproaching
+====================================================
+*/
+static bool IsApproaching( const contact_t & contact ) {
+	const Body * bodyA = contact.bodyA;
+	const Body * bodyB = contact.bodyB;
+	const Vec3 ra = contact.ptOnA_WorldSpace - bodyA->GetCenterOfMassWorldSpace();
+	const Vec3 rb = contact.ptOnB_WorldSpace - bodyB->GetCenterOfMassWorldSpace();
+	const Vec3 velA = bodyA->m_linearVelocity + bodyA->m_angularVelocity.Cross( ra );
+	const Vec3 velB = bodyB->m_linearVelocity + bodyB->m_angularVelocity.Cross( rb );
+	return ( velA - velB ).Dot( contact.normal ) < 0.0f;
+}
+
+/*
+====================================================
+PhysicsWorld::NarrowPhase
+====================================================
+*/
+void PhysicsWorld::NarrowPhase( const float dt_sec ) {
+	const int numPairs = (int)m_pairs.size();
+	Body * bodies = m_bodies.data();
+
+	m_narrowContacts.resize( numPairs );
+	m_narrowHits.assign( numPairs, 0 );
+	m_narrowFast.assign( numPairs, 0 );
+
+	// Look the pair caches up before going wide, the map can't be written from several threads
+	m_narrowCaches.assign( numPairs, NULL );
+	for ( int i = 0; i < numPairs; i++ ) {
+		const collisionPair_t & pair = m_pairs[ i ];
+		Body * bodyA = &bodies[ pair.a ];
+		Body * bodyB = &bodies[ pair.b ];
+		if ( 0.0f == bodyA->m_invMass && 0.0f == bodyB->m_invMass ) {
+			continue;
+		}
+
+		// Pairs with a sleeping body were tested by WakeTouchedBodies, they don't touch
+		if ( !bodyA->m_isAwake || !bodyB->m_isAwake ) {
+			continue;
+		}
+
+		const uint64_t key = ( (uint64_t)pair.a << 32 ) | (uint32_t)pair.b;
+		pairCache_t & cache = m_pairCaches[ key ];
+		cache.lastStep = m_stepCount;
+		cache.manifold.SetBodies( bodyA, bodyB );	// the body array may have moved since the last step
+		m_narrowCaches[ i ] = &cache;
+	}
+
+	// Intersect only reads the bodies, and each pair owns its cache, so pairs can be tested in any order
+	ParallelFor( numPairs, 64, [ & ]( int begin, int end ) {
+		for ( int i = begin; i < end; i++ ) {
+			pairCache_t * cache = m_narrowCaches[ i ];
+
+			// Skip body pairs with infinite mass
+			if ( NULL == cache ) {
+				continue;
+			}
+
+			Manifold & manifold = cache->manifold;
+			manifold.RemoveExpiredContacts();
+
+			if ( m_maxSubsteps > 0 && IsFastPair( *manifold.m_bodyA, *manifold.m_bodyB, dt_sec ) ) {
+				m_narrowFast[ i ] = 1;
+			}
+
+			// Spheres don't need a simplex, there is nothing to warm start
+			gjkCache_t * simplex = NULL;
+			if ( Shape::SHAPE_SPHERE != manifold.m_bodyA->m_shape->GetType() || Shape::SHAPE_SPHERE != manifold.m_bodyB->m_shape->GetType() ) {
+				simplex = &cache->simplex;
+			}
+
+			contact_t & contact = m_narrowContacts[ i ];
+			if ( !Intersect( manifold.m_bodyA, manifold.m_bodyB, dt_sec, contact, simplex ) ) {
+				continue;
+			}
+
+			// Bodies that already touch go to the persistent manifold, later impacts are handled in time order
+			if ( 0.0f == contact.timeOfImpact ) {
+				manifold.AddContact( contact );
+
+				// Fill the rest of the manifold right away, instead of waiting for the bodies to rock onto the other corners
+				if ( manifold.GetNumContacts() < Manifold::MAX_CONTACTS ) {
+					contact_t perturbed[ 4 ];
+					const int numPerturbed = GetPerturbedContacts( manifold.m_bodyA, manifold.m_bodyB, contact, perturbed, 4 );
+					for ( int j = 0; j < numPerturbed; j++ ) {
+						manifold.AddContact( perturbed[ j ] );
+					}
+				}
+			} else {
+				m_narrowHits[ i ] = 1;
+			}
+		}
+	} );
+
+	// Pairs that fell asleep keep their cache, the manifold is warm started again once they wake
+	const int num = (int)m_bodies.size();
+	for ( std::unordered_map< uint64_t, pairCache_t >::iterator it = m_pairCaches.begin(); it != m_pairCaches.end(); ) {
+		const int a = (int)( it->first >> 32 );
+		const int b = (int)( it->first & 0xffffffff );
+		const bool asleep = ( a < num && b < num && IsResting( bodies[ a ] ) && IsResting( bodies[ b ] ) );
+		if ( it->second.lastStep != m_stepCount && !asleep ) {
+			it = m_pairCaches.erase( it );
+		} else {
+			++it;
+		}
+	}
+
+	// Compact in pair order so the contact lists do not depend on the threading
+	m_contacts.clear();
+	m_contactPairs.clear();
+	m_manifolds.clear();
+	m_fastPairs.clear();
+	for ( int i = 0; i < numPairs; i++ ) {
+		if ( m_narrowHits[ i ] ) {
+			m_contacts.push_back( m_narrowContacts[ i ] );
+			m_contactPairs.push_back( i );
+		}
+		if ( m_narrowFast[ i ] ) {
+			m_fastPairs.push_back( i );
+		}
+		if ( NULL != m_narrowCaches[ i ] && m_narrowCaches[ i ]->manifold.GetNumContacts() > 0 ) {
+			m_manifolds.push_back( &m_narrowCaches[ i ]->manifold );
+		}
+	}
+}
+
+/*
+====================================================
+PhysicsWorld::FindRoot
+====================================================
+*/
+int PhysicsWorld::FindRoot( int id ) {
+	while ( m_parents[ id ] != id ) {
+		m_parents[ id ] = m_parents[ m_parents[ id ] ];
+		id = m_parents[ id ];
+	}
+	return id;
+}
+
+/*
+====================================================
+PhysicsWorld::Union
+
+The lower index always becomes the root, so every island is rooted
+at its lowest body.
+====================================================
+*/
+void PhysicsWorld::Union( int a, int b ) {
+	a = FindRoot( a );
+	b = FindRoot( b );
+	if ( a == b ) {
+		return;
+	}
+
+	if ( a < b ) {
+		m_parents[ b ] = a;
+	} else {
+		m_parents[ a ] = b;
+	}
+}
+
+/*
+====================================================
+PhysicsWorld::BuildIslands
+====================================================
+*/
+void PhysicsWorld::BuildIslands() {
+	const int num = (int)m_bodies.size();
+	const int numContacts = (int)m_contacts.size();
+	const int numManifolds = (int)m_manifolds.size();
+	const int numFastPairs = (int)m_fastPairs.size();
+	const Body * bodies = m_bodies.data();
+
+	m_parents.resize( num );
+	for ( int i = 0; i < num; i++ ) {
+		m_parents[ i ] = i;
+	}
+
+	// Static bodies don't carry impulses between the bodies resting on them, so they never join an island
+	for ( int i = 0; i < numContacts; i++ ) {
+		const contact_t & contact = m_contacts[ i ];
+		if ( 0.0f == contact.bodyA->m_invMass || 0.0f == contact.bodyB->m_invMass ) {
+			continue;
+		}
+		Union( (int)( contact.bodyA - bodies ), (int)( contact.bodyB - bodies ) );
+	}
+	for ( int i = 0; i < numManifolds; i++ ) {
+		const Manifold * manifold = m_manifolds[ i ];
+		if ( 0.0f == manifold->m_bodyA->m_invMass || 0.0f == manifold->m_bodyB->m_invMass ) {
+			continue;
+		}
+		Union( (int)( manifold->m_bodyA - bodies ), (int)( manifold->m_bodyB - bodies ) );
+	}
+
+	// Fast pairs may collide after a bounce, they need to be in the same island to be tested again
+	for ( int i = 0; i < numFastPairs; i++ ) {
+		const collisionPair_t & pair = m_pairs[ m_fastPairs[ i ] ];
+		if ( 0.0f == bodies[ pair.a ].m_invMass || 0.0f == bodies[ pair.b ].m_invMass ) {
+			continue;
+		}
+		Union( pair.a, pair.b );
+	}
+
+	// Number the islands in the order of their lowest body
+	int numIslands = 0;
+	m_islandOfBody.assign( num, -1 );
+	m_bodyTimes.resize( num );
+	for ( int i = 0; i < num; i++ ) {
+		if ( IsResting( bodies[ i ] ) ) {
+			continue;
+		}
+
+		const int root = FindRoot( i );
+		if ( root == i ) {
+			m_islandOfBody[ i ] = numIslands++;
+		} else {
+			m_islandOfBody[ i ] = m_islandOfBody[ root ];
+		}
+	}
+
+	// Bucket the bodies, contacts, manifolds and fast pairs by island, keeping them in their original order
+	m_islandBodyStart.assign( numIslands + 1, 0 );
+	m_islandContactStart.assign( numIslands + 1, 0 );
+	m_islandManifoldStart.assign( numIslands + 1, 0 );
+	m_islandFastPairStart.assign( numIslands + 1, 0 );
+	m_islandCanSleep.assign( numIslands, 0 );
+	for ( int i = 0; i < num; i++ ) {
+		if ( m_islandOfBody[ i ] >= 0 ) {
+			m_islandBodyStart[ m_islandOfBody[ i ] + 1 ]++;
+		}
+	}
+	for ( int i = 0; i < numContacts; i++ ) {
+		const contact_t & contact = m_contacts[ i ];
+		const Body * body = ( 0.0f != contact.bodyA->m_invMass ) ? contact.bodyA : contact.bodyB;
+		m_islandContactStart[ m_islandOfBody[ body - bodies ] + 1 ]++;
+	}
+	for ( int i = 0; i < numManifolds; i++ ) {
+		const Manifold * manifold = m_manifolds[ i ];
+		const Body * body = ( 0.0f != manifold->m_bodyA->m_invMass ) ? manifold->m_bodyA : manifold->m_bodyB;
+		m_islandManifoldStart[ m_islandOfBody[ body - bodies ] + 1 ]++;
+	}
+	for ( int i = 0; i < numFastPairs; i++ ) {
+		const collisionPair_t & pair = m_pairs[ m_fastPairs[ i ] ];
+		const int body = ( 0.0f != bodies[ pair.a ].m_invMass ) ? pair.a : pair.b;
+		m_islandFastPairStart[ m_islandOfBody[ body ] + 1 ]++;
+	}
+	for ( int i = 0; i < numIslands; i++ ) {
+		m_islandBodyStart[ i + 1 ] += m_islandBodyStart[ i ];
+		m_islandContactStart[ i + 1 ] += m_islandContactStart[ i ];
+		m_islandManifoldStart[ i + 1 ] += m_islandManifoldStart[ i ];
+		m_islandFastPairStart[ i + 1 ] += m_islandFastPairStart[ i ];
+	}
+
+	std::vector< int > & bodyCursor = m_islandCursor;
+	bodyCursor.assign( m_islandBodyStart.begin(), m_islandBodyStart.end() - 1 );
+	m_islandBodies.resize( m_islandBodyStart[ numIslands ] );
+	for ( int i = 0; i < num; i++ ) {
+		if ( m_islandOfBody[ i ] >= 0 ) {
+			m_islandBodies[ bodyCursor[ m_islandOfBody[ i ] ]++ ] = i;
+		}
+	}
+
+	std::vector< int > & contactCursor = m_islandCursor;
+	contactCursor.assign( m_islandContactStart.begin(), m_islandContactStart.end() - 1 );
+	m_islandContacts.resize( numContacts );
+	for ( int i = 0; i < numContacts; i++ ) {
+		const contact_t & contact = m_contacts[ i ];
+		const Body * body = ( 0.0f != contact.bodyA->m_invMass ) ? contact.bodyA : contact.bodyB;
+		m_islandContacts[ contactCursor[ m_islandOfBody[ body - bodies ] ]++ ] = i;
+	}
+
+	std::vector< int > & manifoldCursor = m_islandCursor;
+	manifoldCursor.assign( m_islandManifoldStart.begin(), m_islandManifoldStart.end() - 1 );
+	m_islandManifolds.resize( numManifolds );
+	for ( int i = 0; i < numManifolds; i++ ) {
+		const Manifold * manifold = m_manifolds[ i ];
+		const Body * body = ( 0.0f != manifold->m_bodyA->m_invMass ) ? manifold->m_bodyA : manifold->m_bodyB;
+		m_islandManifolds[ manifoldCursor[ m_islandOfBody[ body - bodies ] ]++ ] = i;
+	}
+
+	std::vector< int > & fastPairCursor = m_islandCursor;
+	fastPairCursor.assign( m_islandFastPairStart.begin(), m_islandFastPairStart.end() - 1 );
+	m_islandFastPairs.resize( numFastPairs );
+	for ( int i = 0; i < numFastPairs; i++ ) {
+		const collisionPair_t & pair = m_pairs[ m_fastPairs[ i ] ];
+		const int body = ( 0.0f != bodies[ pair.a ].m_invMass ) ? pair.a : pair.b;
+		m_islandFastPairs[ fastPairCursor[ m_islandOfBody[ body ] ]++ ] = m_fastPairs[ i ];
+	}
+}
+
+/*
+====================================================
+PhysicsWorld::SolveIsland
+====================================================
+*/
+void PhysicsWorld::SolveIsland( const int island, const float dt_sec ) {
+	const int * bodyIds = m_islandBodies.data() + m_islandBodyStart[ island ];
+	const int numBodies = m_islandBodyStart[ island + 1 ] - m_islandBodyStart[ island ];
+	int * contactIds = m_islandContacts.data() + m_islandContactStart[ island ];
+	const int numContacts = m_islandContactStart[ island + 1 ] - m_islandContactStart[ island ];
+	const int * manifoldIds = m_islandManifolds.data() + m_islandManifoldStart[ island ];
+	const int numManifolds = m_islandManifoldStart[ island + 1 ] - m_islandManifoldStart[ island ];
+
+	// Resting contacts are solved together at the start of the step
+	for ( int i = 0; i < numManifolds; i++ ) {
+		m_manifolds[ manifoldIds[ i ] ]->PreSolve( dt_sec, m_warmStarting );
+	}
+	// Every other iteration runs backwards, so an impulse reaches the far end of a pile in one
+	// iteration whichever end it starts from
+	for ( int iter = 0; iter < m_numSolverIterations; iter++ ) {
+		for ( int k = 0; k < numManifolds; k++ ) {
+			const int i = ( iter & 1 ) ? numManifolds - 1 - k : k;
+			m_manifolds[ manifoldIds[ i ] ]->Solve();
+		}
+	}
+
+	// Sort the times of impact from first to last, ties keep the narrowphase order
+	const contact_t * contacts = m_contacts.data();
+	std::sort( contactIds, contactIds + numContacts, [ contacts ]( int a, int b ) {
+		if ( contacts[ a ].timeOfImpact != contacts[ b ].timeOfImpact ) {
+			return contacts[ a ].timeOfImpact < contacts[ b ].timeOfImpact;
+		}
+		return a < b;
+	} );
+
+	// Bodies are only advanced when they take part in a contact, so each one keeps its own time.
+	// Velocities only change in ResolveContact, which makes this the same as moving the whole
+	// island to every time of impact, without touching every body for every contact.
+	for ( int j = 0; j < numBodies; j++ ) {
+		m_bodyTimes[ bodyIds[ j ] ] = 0.0f;
+	}
+
+	if ( m_islandFastPairStart[ island + 1 ] > m_islandFastPairStart[ island ] ) {
+		SubstepIsland( island, dt_sec );
+	} else {
+		for ( int i = 0; i < numContacts; i++ ) {
+			contact_t & contact = m_contacts[ contactIds[ i ] ];
+
+			// Position update
+			AdvanceBody( contact.bodyA, contact.timeOfImpact );
+			AdvanceBody( contact.bodyB, contact.timeOfImpact );
+
+			ResolveContact( contact );
+		}
+	}
+
+	// Update the positions for the rest of this frame's time, then push the penetrating bodies apart
+	for ( int j = 0; j < numBodies; j++ ) {
+		AdvanceBody( &m_bodies[ bodyIds[ j ] ], dt_sec );
+		m_bodies[ bodyIds[ j ] ].ApplyPushVelocity( dt_sec );
+	}
+
+	if ( !m_allowSleeping ) {
+		return;
+	}
+
+	// The island can only sleep as a whole, once every body in it stayed slow long enough
+	const float linearSqr = m_sleepLinearSpeed * m_sleepLinearSpeed;
+	const float angularSqr = m_sleepAngularSpeed * m_sleepAngularSpeed;
+	float minSleepTime = m_timeToSleep;
+	for ( int j = 0; j < numBodies; j++ ) {
+		Body & body = m_bodies[ bodyIds[ j ] ];
+		if ( body.m_linearVelocity.GetLengthSqr() > linearSqr || body.m_angularVelocity.GetLengthSqr() > angularSqr ) {
+			body.m_sleepTime = 0.0f;
+		} else {
+			body.m_sleepTime += dt_sec;
+		}
+		minSleepTime = std::min( minSleepTime, body.m_sleepTime );
+	}
+	m_islandCanSleep[ island ] = ( minSleepTime >= m_timeToSleep ) ? 1 : 0;
+}
+
+/*
+====================================================
+PhysicsWorld::SubstepIsland
+
+Resolves the island's impacts in time order, like SolveIsland, but
+after each one the fast pairs of the bodies that were hit are tested
+again from that time to the end of the step.  Their earlier times of
+impact were found for velocities that no longer hold, so they are
+dropped and replaced by what the new test finds.  After m_maxSubsteps
+tests, or one per thickness the fastest pair moves within the step
+when that's more, the remaining impacts are resolved as they are.
+====================================================
+*/
+void PhysicsWorld::SubstepIsland( const int island, const float dt_sec ) {
+	const int * contactIds = m_islandContacts.data() + m_islandContactStart[ island ];
+	const int numContacts = m_islandContactStart[ island + 1 ] - m_islandContactStart[ island ];
+	const int * fastPairIds = m_islandFastPairs.data() + m_islandFastPairStart[ island ];
+	const int numFastPairs = m_islandFastPairStart[ island + 1 ] - m_islandFastPairStart[ island ];
+
+	// A ball bouncing between thin walls hits one about every wall thickness it moves, so a fixed
+	// budget runs out on fast enough balls.  The limit keeps a runaway body from stalling the step.
+	const int substepLimit = 128;
+	int maxSubsteps = m_maxSubsteps;
+	for ( int j = 0; j < numFastPairs; j++ ) {
+		const collisionPair_t & pair = m_pairs[ fastPairIds[ j ] ];
+		const float thicknesses = GetThicknessesPerStep( m_bodies[ pair.a ], m_bodies[ pair.b ], dt_sec );
+		maxSubsteps = std::max( maxSubsteps, (int)std::min( std::ceil( thicknesses ), (float)substepLimit ) );
+	}
+
+	// Already sorted by SolveIsland
+	std::vector< pendingContact_t > pending( numContacts );
+	for ( int i = 0; i < numContacts; i++ ) {
+		pending[ i ].contact = m_contacts[ contactIds[ i ] ];
+		pending[ i ].pair = m_contactPairs[ contactIds[ i ] ];
+		pending[ i ].dropped = false;
+	}
+
+	// The manifolds were solved after the narrowphase looked for impacts, so the fast pairs start
+	// out with a test of their own.  NULL bodies match every pair.
+	int numSubsteps = 0;
+	if ( m_islandManifoldStart[ island + 1 ] > m_islandManifoldStart[ island ] ) {
+		RetestFastPairs( pending, 0, fastPairIds, numFastPairs, NULL, NULL, 0.0f, dt_sec );
+		numSubsteps++;
+	}
+
+	for ( int next = 0; next < (int)pending.size(); next++ ) {
+		if ( pending[ next ].dropped ) {
+			continue;
+		}
+
+		// Copied, the retest below can move the list
+		contact_t contact = pending[ next ].contact;
+		const float time = contact.timeOfImpact;
+
+		AdvanceBody( contact.bodyA, time );
+		AdvanceBody( contact.bodyB, time );
+		ResolveContact( contact );
+
+		if ( numSubsteps >= maxSubsteps ) {
+			continue;
+		}
+		numSubsteps++;
+
+		// Static bodies didn't change course, pairs with them only need testing again through the other body
+		const Body * hitA = ( 0.0f != contact.bodyA->m_invMass ) ? contact.bodyA : contact.bodyB;
+		const Body * hitB = ( 0.0f != contact.bodyB->m_invMass ) ? contact.bodyB : contact.bodyA;
+		RetestFastPairs( pending, next + 1, fastPairIds, numFastPairs, hitA, hitB, time, dt_sec );
+	}
+}
+
+/*
+====================================================
+PhysicsWorld::RetestFastPairs
+
+Drops the pending impacts of the fast pairs that contain hitA or hitB
+from index first on, and tests those pairs again from time to the end
+of the step.  Impacts found are inserted in time order.
+====================================================
+*/
+void PhysicsWorld::RetestFastPairs( std::vector< pendingContact_t > & pending, const int first, const int * fastPairIds, const int numFastPairs, const Body * hitA, const Body * hitB, const float time, const float dt_sec ) {
+	const bool matchAll = ( NULL == hitA && NULL == hitB );
+
+	for ( int j = first; j < (int)pending.size(); j++ ) {
+		const contact_t & other = pending[ j ].contact;
+		if ( !m_narrowFast[ pending[ j ].pair ] ) {
+			continue;
+		}
+		if ( matchAll || other.bodyA == hitA || other.bodyA == hitB || other.bodyB == hitA || other.bodyB == hitB ) {
+			pending[ j ].dropped = true;
+		}
+	}
+
+	for ( int j = 0; j < numFastPairs; j++ ) {
+		const int pairIdx = fastPairIds[ j ];
+		Body * bodyA = &m_bodies[ m_pairs[ pairIdx ].a ];
+		Body * bodyB = &m_bodies[ m_pairs[ pairIdx ].b ];
+		if ( !matchAll && bodyA != hitA && bodyA != hitB && bodyB != hitA && bodyB != hitB ) {
+			continue;
+		}
+
+		AdvanceBody( bodyA, time );
+		AdvanceBody( bodyB, time );
+
+		pendingContact_t found;
+		found.pair = pairIdx;
+		found.dropped = false;
+		if ( !Intersect( bodyA, bodyB, dt_sec - time, found.contact ) ) {
+			continue;
+		}
+		found.contact.timeOfImpact += time;
+
+		// A pair that was just resolved still touches, but it's moving apart now
+		if ( !IsApproaching( found.contact ) ) {
+			continue;
+		}
+
+		// Ties go after the impacts already waiting, like the narrowphase order
+		int insertAt = (int)pending.size();
+		while ( insertAt > first && pending[ insertAt - 1 ].contact.timeOfImpact > found.contact.timeOfImpact ) {
+			insertAt--;
+		}
+		pending.insert( pending.begin() + insertAt, found );
+	}
+}
+
+/*
+====================================================
+PhysicsWorld::AdvanceBody
+====================================================
+*/
+void PhysicsWorld::AdvanceBody( Body * body, const float time ) {
+	// Static bodies are shared between islands and moved once after they are solved
+	if ( 0.0f == body->m_invMass ) {
+		return;
+	}
+
+	float & bodyTime = m_bodyTimes[ body - m_bodies.data() ];
+	if ( time > bodyTime ) {
+		body->Update( time - bodyTime );
+		bodyTime = time;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+//
+//  ShapeBox.cpp
+//
+#include "Shapes/ShapeBox.h"
+#include <algorithm>
+
+/*
+========================================================================================================
+
+ShapeBox
+
+========================================================================================================
+*/
+
+/*
+====================================================
+ShapeBox::Build
+====================================================
+*/
+void ShapeBox::Build( const Vec3 * pts, const int num ) {
+	m_bounds.Clear();
+	m_bounds.Expand( pts, num );
+
+	m_points[ 0 ] = Vec3( m_bounds.mins.x, m_bounds.mins.y, m_bounds.mins.z );
+	m_points[ 1 ] = Vec3( m_bounds.maxs.x, m_bounds.mins.y, m_bounds.mins.z );
+	m_points[ 2 ] = Vec3( m_bounds.mins.x, m_bounds.maxs.y, m_bounds.mins.z );
+	m_points[ 3 ] = Vec3( m_bounds.mins.x, m_bounds.mins.y, m_bounds.maxs.z );
+
+	m_points[ 4 ] = Vec3( m_bounds.maxs.x, m_bounds.maxs.y, m_bounds.maxs.z );
+	m_points[ 5 ] = Vec3( m_bounds.mins.x, m_bounds.maxs.y, m_bounds.maxs.z );
+	m_points[ 6 ] = Vec3( m_bounds.maxs.x, m_bounds.mins.y, m_bounds.maxs.z );
+	m_points[ 7 ] = Vec3( m_bounds.maxs.x, m_bounds.maxs.y, m_bounds.mins.z );
+
+	m_centerOfMass = ( m_bounds.maxs + m_bounds.mins ) * 0.5f;
+}
+
+/*
+====================================================
+ShapeBox::Support
+====================================================
+*/
+Vec3 ShapeBox::Support( const Vec3 & dir, const Vec3 & pos, const Quat & orient, const float bias ) const {
+	// Find the corner furthest in the model space direction, then only transform that one
+	const Vec3 localDir = orient.Inverse().RotatePoint( dir );
+
+	Vec3 maxPt = m_points[ 0 ];
+	float maxDist = localDir.Dot( maxPt );
+	for ( int i = 1; i < 8; i++ ) {
+		const float dist = localDir.Dot( m_points[ i ] );
+		if ( dist > maxDist ) {
+			maxDist = dist;
+			maxPt = m_points[ i ];
+		}
+	}
+
+	Vec3 norm = dir;
+	norm.Normalize();
+	return orient.RotatePoint( maxPt ) + pos + norm * bias;
+}
+
+/*
+====================================================
+ShapeBox::InertiaTensor
+
+About the center of mass, for a unit mass
+====================================================
+*/
+Mat3 ShapeBox::InertiaTensor() const {
+	const float dx = m_bounds.WidthX();
+	const float dy = m_bounds.WidthY();
+	const float dz = m_bounds.WidthZ();
+
+	Mat3 tensor;
+	tensor.Zero();
+	tensor.rows[ 0 ][ 0 ] = ( dy * dy + dz * dz ) / 12.0f;
+	tensor.rows[ 1 ][ 1 ] = ( dx * dx + dz * dz ) / 12.0f;
+	tensor.rows[ 2 ][ 2 ] = ( dx * dx + dy * dy ) / 12.0f;
+	return tensor;
+}
+
+/*
+====================================================
+ShapeBox::GetBounds
+====================================================
+*/
+Bounds ShapeBox::GetBounds( const Vec3 & pos, const Quat & orient ) const {
+	Bounds bounds;
+	for ( int i = 0; i < 8; i++ ) {
+		bounds.Expand( orient.RotatePoint( m_points[ i ] ) + pos );
+	}
+	return bounds;
+}
+
+/*
+====================================================
+ShapeBox::FastestLinearSpeed
+
+Upper bound on the speed of any point of the box along dir.  It
+doesn't depend on the orientation, every corner is half the diagonal
+away from the center of mass.
+====================================================
+*/
+float ShapeBox::FastestLinearSpeed( const Vec3 & angularVelocity, const Vec3 & /*dir*/ ) const {
+	return angularVelocity.GetMagnitude() * ( m_bounds.maxs - m_bounds.mins ).GetMagnitude() * 0.5f;
+}
\ No newline at end of file
@@ -0,0 +1,513 @@
+//
+//  ShapeConvex.cpp
+//
+#include "Shapes/ShapeConvex.h"
+#include <algorithm>
+#include <stdint.h>
+#include <unordered_map>
+
+/*
+========================================================================================================
+
+Convex Hull
+
+========================================================================================================
+*/
+
+/*
+====================================================
+FindPointFurthestInDir
+====================================================
+*/
+static int FindPointFurthestInDir( const Vec3 * pts, const int num, const Vec3 & dir ) {
+	int maxIdx = 0;
+	float maxDist = dir.Dot( pts[ 0 ] );
+	for ( int i = 1; i < num; i++ ) {
+		const float dist = dir.Dot( pts[ i ] );
+		if ( dist > maxDist ) {
+			maxDist = dist;
+			maxIdx = i;
+		}
+	}
+	return maxIdx;
+}
+
+/*
+====================================================
+DistanceFromLine
+====================================================
+*/
+static float DistanceFromLine( const Vec3 & a, const Vec3 & b, const Vec3 & pt ) {
+	Vec3 ab = b - a;
+	ab.Normalize();
+
+	const Vec3 ray = pt - a;
+	const Vec3 projection = ab * ray.Dot( ab );	// projection of the ray onto ab
+	const Vec3 perpindicular = ray - projection;
+	return perpindicular.GetMagnitude();
+}
+
+/*
+====================================================
+DistanceFromTriangle
+
+Signed, positive on the side the counter clockwise normal points to
+====================================================
+*/
+static float DistanceFromTriangle( const Vec3 & a, const Vec3 & b, const Vec3 & c, const Vec3 & pt ) {
+	Vec3 normal = ( b - a ).Cross( c - a );
+	normal.Normalize();
+	return normal.Dot( pt - a );
+}
+
+/*
+====================================================
+BuildTetrahedron
+
+Returns false when the points are flat and enclose no volume
+====================================================
+*/
+static bool BuildTetrahedron( const Vec3 * verts, const int num, const float epsilon, std::vector< tri_t > & hullTris, int ids[ 4 ] ) {
+	ids[ 0 ] = FindPointFurthestInDir( verts, num, Vec3( 1, 0, 0 ) );
+	ids[ 1 ] = FindPointFurthestInDir( verts, num, verts[ ids[ 0 ] ] * -1.0f );
+
+	float maxDist = 0.0f;
+	ids[ 2 ] = -1;
+	for ( int i = 0; i < num; i++ ) {
+		const float dist = DistanceFromLine( verts[ ids[ 0 ] ], verts[ ids[ 1 ] ], verts[ i ] );
+		if ( dist > maxDist ) {
+			maxDist = dist;
+			ids[ 2 ] = i;
+		}
+	}
+	if ( maxDist <= epsilon ) {
+		return false;
+	}
+
+	maxDist = 0.0f;
+	ids[ 3 ] = -1;
+	for ( int i = 0; i < num; i++ ) {
+		const float dist = fabsf( DistanceFromTriangle( verts[ ids[ 0 ] ], verts[ ids[ 1 ] ], verts[ ids[ 2 ] ], verts[ i ] ) );
+		if ( dist > maxDist ) {
+			maxDist = dist;
+			ids[ 3 ] = i;
+		}
+	}
+	if ( maxDist <= epsilon ) {
+		return false;
+	}
+
+	// Wind every face so that the vertex it doesn't use is behind it
+	const int faces[ 4 ][ 4 ] = { { 0, 1, 2, 3 }, { 0, 2, 3, 1 }, { 0, 3, 1, 2 }, { 1, 3, 2, 0 } };
+	for ( int i = 0; i < 4; i++ ) {
+		tri_t tri;
+		tri.a = ids[ faces[ i ][ 0 ] ];
+		tri.b = ids[ faces[ i ][ 1 ] ];
+		tri.c = ids[ faces[ i ][ 2 ] ];
+		const Vec3 & opposite = verts[ ids[ faces[ i ][ 3 ] ] ];
+		if ( DistanceFromTriangle( verts[ tri.a ], verts[ tri.b ], verts[ tri.c ], opposite ) > 0.0f ) {
+			std::swap( tri.b, tri.c );
+		}
+		hullTris.push_back( tri );
+	}
+	return true;
+}
+
+/*
+====================================================
+HullBuilder
+
+Quickhull.  Every triangle keeps the points in front of it, and the
+hull is always grown by the point furthest in front of a triangle, so
+only the points of the triangles that get replaced are tested again.
+The triangles the new point can see are found by walking an edge to
+triangle map from the one it was picked from, which keeps the removed
+region connected even with the nearly coplanar triangles of dense
+point clouds.  Removed triangles are only flagged and get compacted at
+the end.
+====================================================
+*/
+class HullBuilder {
+public:
+	HullBuilder( const Vec3 * verts, const float epsilon ) : m_verts( verts ), m_epsilon( epsilon ) {}
+
+	void AddTriangle( const int a, const int b, const int c );
+	void AssignPoints( const int * ids, const int num, const int firstTri );
+	void Expand();
+	void GetTriangles( std::vector< tri_t > & hullTris ) const;
+
+private:
+	static uint64_t EdgeKey( const int a, const int b ) { return ( (uint64_t)a << 32 ) | (uint32_t)b; }
+
+	float Distance( const int tri, const int idx ) const;
+	void RemoveTriangle( const int tri );
+	void AddPoint( const int tri, const int idx );
+
+	const Vec3 * m_verts;
+	const float m_epsilon;
+
+	std::vector< tri_t > m_tris;
+	std::vector< uint8_t > m_alive;
+	std::vector< std::vector< int > > m_outside;	// points in front of each triangle
+	std::unordered_map< uint64_t, int > m_edgeToTri;	// directed edge -> the triangle that winds through it
+
+	std::vector< int > m_visible;
+	std::vector< edge_t > m_rim;
+	std::vector< int > m_orphans;
+};
+
+/*
+====================================================
+HullBuilder::AddTriangle
+====================================================
+*/
+void HullBuilder::AddTriangle( const int a, const int b, const int c ) {
+	const int tri = (int)m_tris.size();
+	m_tris.push_back( { a, b, c } );
+	m_alive.push_back( 1 );
+	m_outside.push_back( std::vector< int >() );
+
+	m_edgeToTri[ EdgeKey( a, b ) ] = tri;
+	m_edgeToTri[ EdgeKey( b, c ) ] = tri;
+	m_edgeToTri[ EdgeKey( c, a ) ] = tri;
+}
+
+/*
+====================================================
+HullBuilder::RemoveTriangle
+====================================================
+*/
+void HullBuilder::RemoveTriangle( const int tri ) {
+	const tri_t & t = m_tris[ tri ];
+	m_edgeToTri.erase( EdgeKey( t.a, t.b ) );
+	m_edgeToTri.erase( EdgeKey( t.b, t.c ) );
+	m_edgeToTri.erase( EdgeKey( t.c, t.a ) );
+	m_alive[ tri ] = 0;
+
+	m_orphans.insert( m_orphans.end(), m_outside[ tri ].begin(), m_outside[ tri ].end() );
+	std::vector< int >().swap( m_outside[ tri ] );
+}
+
+/*
+====================================================
+HullBuilder::Distance
+====================================================
+*/
+float HullBuilder::Distance( const int tri, const int idx ) const {
+	const tri_t & t = m_tris[ tri ];
+	return DistanceFromTriangle( m_verts[ t.a ], m_verts[ t.b ], m_verts[ t.c ], m_verts[ idx ] );
+}
+
+/*
+====================================================
+HullBuilder::AssignPoints
+
+Gives every point to the triangle, from firstTri on, it is furthest
+in front of.  Points behind all of them are inside the hull.
+====================================================
+*/
+void HullBuilder::AssignPoints( const int * ids, const int num, const int firstTri ) {
+	for ( int i = 0; i < num; i++ ) {
+		int best = -1;
+		float maxDist = m_epsilon;
+		for ( int tri = firstTri; tri < (int)m_tris.size(); tri++ ) {
+			const float dist = Distance( tri, ids[ i ] );
+			if ( dist > maxDist ) {
+				maxDist = dist;
+				best = tri;
+			}
+		}
+		if ( best >= 0 ) {
+			m_outside[ best ].push_back( ids[ i ] );
+		}
+	}
+}
+
+/*
+====================================================
+HullBuilder::AddPoint
+====================================================
+*/
+void HullBuilder::AddPoint( const int tri, const int idx ) {
+	// Flood out from the triangle over the ones the point can see, the edges that lead to
+	// triangles it can't see form the rim of the hole.  They keep the winding of the removed
+	// triangles, so fanning new triangles out from the point keeps them facing outwards.
+	m_visible.clear();
+	m_rim.clear();
+	m_orphans.clear();
+	m_visible.push_back( tri );
+	RemoveTriangle( tri );
+	for ( int i = 0; i < (int)m_visible.size(); i++ ) {
+		const tri_t t = m_tris[ m_visible[ i ] ];
+		const edge_t edges[ 3 ] = { { t.a, t.b }, { t.b, t.c }, { t.c, t.a } };
+		for ( int e = 0; e < 3; e++ ) {
+			std::unordered_map< uint64_t, int >::const_iterator it = m_edgeToTri.find( EdgeKey( edges[ e ].b, edges[ e ].a ) );
+			if ( it == m_edgeToTri.end() ) {
+				continue;	// the neighbor was already removed
+			}
+
+			const int neighbor = it->second;
+			if ( Distance( neighbor, idx ) > m_epsilon ) {
+				RemoveTriangle( neighbor );
+				m_visible.push_back( neighbor );
+			} else {
+				m_rim.push_back( edges[ e ] );
+			}
+		}
+	}
+
+	const int firstTri = (int)m_tris.size();
+	for ( int i = 0; i < (int)m_rim.size(); i++ ) {
+		AddTriangle( m_rim[ i ].a, m_rim[ i ].b, idx );
+	}
+
+	// The points of the removed triangles can only be in front of the new ones
+	std::vector< int >::iterator self = std::find( m_orphans.begin(), m_orphans.end(), idx );
+	if ( self != m_orphans.end() ) {
+		*self = m_orphans.back();
+		m_orphans.pop_back();
+	}
+	AssignPoints( m_orphans.data(), (int)m_orphans.size(), firstTri );
+}
+
+/*
+====================================================
+HullBuilder::Expand
+====================================================
+*/
+void HullBuilder::Expand() {
+	for ( int tri = 0; tri < (int)m_tris.size(); tri++ ) {
+		if ( !m_alive[ tri ] || m_outside[ tri ].empty() ) {
+			continue;
+		}
+
+		// Grow the hull by the point furthest in front of this triangle
+		const std::vector< int > & outside = m_outside[ tri ];
+		int furthest = outside[ 0 ];
+		float maxDist = Distance( tri, furthest );
+		for ( int i = 1; i < (int)outside.size(); i++ ) {
+			const float dist = Distance( tri, outside[ i ] );
+			if ( dist > maxDist ) {
+				maxDist = dist;
+				furthest = outside[ i ];
+			}
+		}
+		AddPoint( tri, furthest );
+	}
+}
+
+/*
+====================================================
+HullBuilder::GetTriangles
+====================================================
+*/
+void HullBuilder::GetTriangles( std::vector< tri_t > & hullTris ) const {
+	hullTris.clear();
+	for ( int i = 0; i < (int)m_tris.size(); i++ ) {
+		if ( m_alive[ i ] ) {
+			hullTris.push_back( m_tris[ i ] );
+		}
+	}
+}
+
+/*
+====================================================
+BuildConvexHull
+
+Flat point clouds have no hull, all points are returned without
+triangles.
+====================================================
+*/
+void BuildConvexHull( const Vec3 * verts, const int num, std::vector< Vec3 > & hullPts, std::vector< tri_t > & hullTris ) {
+	hullPts.clear();
+	hullTris.clear();
+	if ( num < 4 ) {
+		hullPts.assign( verts, verts + num );
+		return;
+	}
+
+	Bounds bounds;
+	bounds.Expand( verts, num );
+	const float epsilon = 1e-5f * ( bounds.maxs - bounds.mins ).GetMagnitude();
+
+	int ids[ 4 ];
+	if ( !BuildTetrahedron( verts, num, epsilon, hullTris, ids ) ) {
+		hullPts.assign( verts, verts + num );
+		return;
+	}
+
+	HullBuilder builder( verts, epsilon );
+	for ( int i = 0; i < 4; i++ ) {
+		builder.AddTriangle( hullTris[ i ].a, hullTris[ i ].b, hullTris[ i ].c );
+	}
+
+	std::vector< int > remaining;
+	remaining.reserve( num );
+	for ( int i = 0; i < num; i++ ) {
+		if ( i != ids[ 0 ] && i != ids[ 1 ] && i != ids[ 2 ] && i != ids[ 3 ] ) {
+			remaining.push_back( i );
+		}
+	}
+	builder.AssignPoints( remaining.data(), (int)remaining.size(), 0 );
+	builder.Expand();
+	builder.GetTriangles( hullTris );
+
+	// Keep only the points the faces use and remap the faces to them
+	std::vector< int > remap( num, -1 );
+	for ( int i = 0; i < (int)hullTris.size(); i++ ) {
+		int * corners = &hullTris[ i ].a;
+		for ( int j = 0; j < 3; j++ ) {
+			if ( remap[ corners[ j ] ] < 0 ) {
+				remap[ corners[ j ] ] = (int)hullPts.size();
+				hullPts.push_back( verts[ corners[ j ] ] );
+			}
+			corners[ j ] = remap[ corners[ j ] ];
+		}
+	}
+}
+
+/*
+====================================================
+OuterProduct
+====================================================
+*/
+static Mat3 OuterProduct( const Vec3 & a, const Vec3 & b ) {
+	Mat3 m;
+	m.rows[ 0 ] = b * a.x;
+	m.rows[ 1 ] = b * a.y;
+	m.rows[ 2 ] = b * a.z;
+	return m;
+}
+
+/*
+========================================================================================================
+
+ShapeConvex
+
+========================================================================================================
+*/
+
+/*
+====================================================
+MaxDistanceFrom
+====================================================
+*/
+static float MaxDistanceFrom( const Vec3 * pts, const int num, const Vec3 & center ) {
+	float maxDistSqr = 0.0f;
+	for ( int i = 0; i < num; i++ ) {
+		maxDistSqr = std::max( maxDistSqr, ( pts[ i ] - center ).GetLengthSqr() );
+	}
+	return sqrtf( maxDistSqr );
+}
+
+/*
+====================================================
+ShapeConvex::Build
+====================================================
+*/
+void ShapeConvex::Build( const Vec3 * pts, const int num ) {
+	std::vector< tri_t > hullTris;
+	BuildConvexHull( pts, num, m_points, hullTris );
+
+	m_bounds.Clear();
+	m_bounds.Expand( m_points.data(), (int)m_points.size() );
+
+	// Flat hulls have no volume to integrate, fall back to a box around them
+	if ( hullTris.empty() ) {
+		const float dx = m_bounds.WidthX();
+		const float dy = m_bounds.WidthY();
+		const float dz = m_bounds.WidthZ();
+		m_centerOfMass = ( m_bounds.maxs + m_bounds.mins ) * 0.5f;
+		m_inertiaTensor.Zero();
+		m_inertiaTensor.rows[ 0 ][ 0 ] = ( dy * dy + dz * dz ) / 12.0f;
+		m_inertiaTensor.rows[ 1 ][ 1 ] = ( dx * dx + dz * dz ) / 12.0f;
+		m_inertiaTensor.rows[ 2 ][ 2 ] = ( dx * dx + dy * dy ) / 12.0f;
+		m_maxRadius = MaxDistanceFrom( m_points.data(), (int)m_points.size(), m_centerOfMass );
+		return;
+	}
+
+	// Split the hull into tetrahedrons from an interior point, and sum their volumes and second moments.
+	// For a tetrahedron ( 0, a, b, c ) the integral of x * x^T is V / 20 * ( aa^T + bb^T + cc^T + ss^T ), s = a + b + c
+	Vec3 ref( 0.0f );
+	for ( int i = 0; i < (int)m_points.size(); i++ ) {
+		ref += m_points[ i ];
+	}
+	ref /= (float)m_points.size();
+
+	float volume = 0.0f;
+	Vec3 firstMoment( 0.0f );
+	Mat3 secondMoment;
+	secondMoment.Zero();
+	for ( int i = 0; i < (int)hullTris.size(); i++ ) {
+		const Vec3 a = m_points[ hullTris[ i ].a ] - ref;
+		const Vec3 b = m_points[ hullTris[ i ].b ] - ref;
+		const Vec3 c = m_points[ hullTris[ i ].c ] - ref;
+		const Vec3 s = a + b + c;
+
+		const float tetVolume = a.Dot( b.Cross( c ) ) / 6.0f;
+		volume += tetVolume;
+		firstMoment += s * ( tetVolume * 0.25f );
+		secondMoment += ( OuterProduct( a, a ) + OuterProduct( b, b ) + OuterProduct( c, c ) + OuterProduct( s, s ) ) * ( tetVolume / 20.0f );
+	}
+
+	// Unit mass, moved from the reference point to the center of mass
+	const Vec3 cm = firstMoment / volume;
+	const Mat3 covariance = secondMoment * ( 1.0f / volume ) + OuterProduct( cm, cm ) * -1.0f;
+	m_centerOfMass = ref + cm;
+	m_maxRadius = MaxDistanceFrom( m_points.data(), (int)m_points.size(), m_centerOfMass );
+
+	const float trace = covariance.rows[ 0 ][ 0 ] + covariance.rows[ 1 ][ 1 ] + covariance.rows[ 2 ][ 2 ];
+	m_inertiaTensor.Identity();
+	m_inertiaTensor = m_inertiaTensor * trace + covariance * -1.0f;
+}
+
+/*
+====================================================
+ShapeConvex::Support
+====================================================
+*/
+Vec3 ShapeConvex::Support( const Vec3 & dir, const Vec3 & pos, const Quat & orient, const float bias ) const {
+	// Find the point furthest in the model space direction, then only transform that one
+	const Vec3 localDir = orient.Inverse().RotatePoint( dir );
+	const Vec3 & maxPt = m_points[ FindPointFurthestInDir( m_points.data(), (int)m_points.size(), localDir ) ];
+
+	Vec3 norm = dir;
+	norm.Normalize();
+	return orient.RotatePoint( maxPt ) + pos + norm * bias;
+}
+
+/*
+====================================================
+ShapeConvex::GetBounds
+====================================================
+*/
+Bounds ShapeConvex::GetBounds( const Vec3 & pos, const Quat & orient ) const {
+	Vec3 corners[ 8 ];
+	corners[ 0 ] = Vec3( m_bounds.mins.x, m_bounds.mins.y, m_bounds.mins.z );
+	corners[ 1 ] = Vec3( m_bounds.mins.x, m_bounds.mins.y, m_bounds.maxs.z );
+	corners[ 2 ] = Vec3( m_bounds.mins.x, m_bounds.maxs.y, m_bounds.mins.z );
+	corners[ 3 ] = Vec3( m_bounds.maxs.x, m_bounds.mins.y, m_bounds.mins.z );
+
+	corners[ 4 ] = Vec3( m_bounds.maxs.x, m_bounds.maxs.y, m_bounds.maxs.z );
+	corners[ 5 ] = Vec3( m_bounds.maxs.x, m_bounds.maxs.y, m_bounds.mins.z );
+	corners[ 6 ] = Vec3( m_bounds.maxs.x, m_bounds.mins.y, m_bounds.maxs.z );
+	corners[ 7 ] = Vec3( m_bounds.mins.x, m_bounds.maxs.y, m_bounds.maxs.z );
+
+	Bounds bounds;
+	for ( int i = 0; i < 8; i++ ) {
+		bounds.Expand( orient.RotatePoint( corners[ i ] ) + pos );
+	}
+	return bounds;
+}
+
+/*
+====================================================
+ShapeConvex::FastestLinearSpeed
+
+Upper bound on the speed of any point of the hull along dir, see
+ShapeBox::FastestLinearSpeed
+====================================================
+*/
+float ShapeConvex::FastestLinearSpeed( const Vec3 & angularVelocity, const Vec3 & /*dir*/ ) const {
+	return angularVelocity.GetMagnitude() * m_maxRadius;
+}
\ No newline at end of file
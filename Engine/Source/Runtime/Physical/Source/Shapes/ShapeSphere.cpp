@@ -16,13 +16,11 @@ ShapeSphere
 ShapeSphere::Support
 ====================================================
 */
-Vec3 ShapeSphere::Support(const Vec3 &dir, const Vec3 &pos, const Quat &orient, const float bias) const
+Vec3 ShapeSphere::Support(const Vec3 &dir, const Vec3 &pos, const Quat & /*orient*/, const float bias) const
 {
-	Vec3 supportPt;
-
-	// TODO: Add code
-
-	return supportPt;
+	Vec3 norm = dir;
+	norm.Normalize();
+	return pos + norm * (m_radius + bias);
 }
 
 /*
@@ -45,7 +43,7 @@ Mat3 ShapeSphere::InertiaTensor() const
 ShapeSphere::GetBounds
 ====================================================
 */
-Bounds ShapeSphere::GetBounds(const Vec3 &pos, const Quat &orient) const
+Bounds ShapeSphere::GetBounds(const Vec3 &pos, const Quat & /*orient*/) const
 {
 	Bounds tmp;
 	tmp.mins = Vec3(-m_radius) + pos;
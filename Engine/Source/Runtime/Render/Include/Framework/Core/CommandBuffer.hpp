@@ -141,19 +141,25 @@ namespace vkb
         void execute_commands(vkb::CommandBuffer& secondary_command_buffer);
         void execute_commands(std::vector<std::shared_ptr<vkb::CommandBuffer>>& secondary_command_buffers);
         CommandBufferLevelType get_level() const;
+
+        /**
+         * @brief Framebuffer of the render pass being recorded, or the one a secondary command buffer continues
+         */
+        const FramebufferType* get_current_framebuffer() const;
         RenderPassType& get_render_pass(RenderTargetType const& render_target,
                                         std::vector<LoadStoreInfoType> const& load_store_infos,
                                         std::vector<std::unique_ptr<vkb::Subpass>> const& subpasses);
         void image_memory_barrier(ImageViewType const& image_view, ImageMemoryBarrierType const& memory_barrier) const;
         void image_memory_barrier(RenderTargetType& render_target, uint32_t view_index,
                                   ImageMemoryBarrierType const& memory_barrier) const;
-        void next_subpass();
+        void next_subpass(SubpassContentsType contents = VK_SUBPASS_CONTENTS_INLINE);
 
         /**
          * @brief Records byte data into the command buffer to be pushed as push constants to each draw call
          * @param values The byte data to store
          */
         void push_constants(const std::vector<uint8_t>& values);
+        void push_constants(const uint8_t* data, size_t size);
         template <typename T>
         void push_constants(const T& value);
 
@@ -269,17 +275,7 @@ namespace vkb
     template <typename T>
     void CommandBuffer::push_constants(const T& value)
     {
-        auto data = to_bytes(value);
-
-        uint32_t size = to_u32(stored_push_constants.size() + data.size());
-
-        if (size > max_push_constants_size)
-        {
-            LOGE("Push constant limit exceeded ({} / {} bytes)", size, max_push_constants_size);
-            // TODO throw std::runtime_error("Cannot overflow push constant limit");
-        }
-
-        stored_push_constants.insert(stored_push_constants.end(), data.begin(), data.end());
+        push_constants(reinterpret_cast<const uint8_t*>(&value), sizeof(T));
     }
 
     template <class T>
@@ -27,6 +27,7 @@ namespace vkb
         VkDeviceSize get_offset() const;
         VkDeviceSize get_size() const;
         void update(const std::vector<uint8_t> &data, uint32_t offset = 0);
+        void update(const uint8_t *data, size_t size, uint32_t offset = 0);
         template <typename T>
         void update(const T &value, uint32_t offset = 0);
 
@@ -39,7 +40,7 @@ namespace vkb
     template <typename T>
     inline void BufferAllocation::update(const T &value, uint32_t offset)
     {
-        update(to_bytes(value), offset);
+        update(reinterpret_cast<const uint8_t *>(&value), sizeof(T), offset);
     }
 
     class BufferBlock
@@ -4,6 +4,7 @@
 
 #include "ResourceRecord.hpp"
 #include "ResourceReplay.hpp"
+#include "ResourceMapGuard.hpp"
 #include "Framework/Core/PipelineLayout.hpp"
 #include "Framework/Core/DescriptorSetLayout.hpp"
 #include "Framework/Core/DescriptorPool.hpp"
@@ -108,20 +109,27 @@ namespace vkb
 
 		ResourceCacheState state;
 
-		std::mutex descriptor_set_mutex;
+		ResourceMapGuard<DescriptorPool> descriptor_pool_guard;
 
-		std::mutex pipeline_layout_mutex;
+		ResourceMapGuard<DescriptorSet> descriptor_set_guard;
 
-		std::mutex shader_module_mutex;
+		ResourceMapGuard<PipelineLayout> pipeline_layout_guard;
 
-		std::mutex descriptor_set_layout_mutex;
+		ResourceMapGuard<ShaderModule> shader_module_guard;
 
-		std::mutex graphics_pipeline_mutex;
+		ResourceMapGuard<DescriptorSetLayout> descriptor_set_layout_guard;
 
-		std::mutex render_pass_mutex;
+		ResourceMapGuard<GraphicsPipeline> graphics_pipeline_guard;
 
-		std::mutex compute_pipeline_mutex;
+		ResourceMapGuard<RenderPass> render_pass_guard;
 
-		std::mutex framebuffer_mutex;
+		ResourceMapGuard<ComputePipeline> compute_pipeline_guard;
+
+		ResourceMapGuard<Framebuffer> framebuffer_guard;
+
+		/// Descriptor sets allocate from pools shared by every set of a layout, so building them stays serialized
+		std::mutex descriptor_pool_mutex;
+
+		std::mutex recorder_mutex;
 	};
 } // namespace vkb
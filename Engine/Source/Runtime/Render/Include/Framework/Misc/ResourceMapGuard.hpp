@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <future>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace vkb
+{
+    /**
+     * @brief Guards one map of the resource cache so threads that only want a cache hit never wait for a build
+     *
+     * Hits take a shared lock for the lookup. A miss registers a future for its key and builds the resource with
+     * no lock held, other threads missing the same key wait on that future instead of building it again, and
+     * misses of other keys build next to it. References into the map stay valid since an unordered_map never
+     * moves its elements.
+     */
+    template <class T>
+    class ResourceMapGuard
+    {
+    public:
+        /**
+         * @brief Finds the resource with the hash in resources or builds it
+         * @param build Called without any lock held, returns the new resource
+         * @param on_insert Called with the resource once it is in the map, only on the thread that built it
+         * @return The cached resource, exceptions of build are thrown on every thread waiting for it
+         */
+        template <class Build, class OnInsert>
+        T &request(std::unordered_map<std::size_t, T> &resources, std::size_t hash, Build &&build,
+                   OnInsert &&on_insert)
+        {
+            {
+                std::shared_lock<std::shared_mutex> read_lock(mutex);
+                auto res_it = resources.find(hash);
+                if (res_it != resources.end())
+                {
+                    return res_it->second;
+                }
+            }
+
+            std::promise<T *> promise;
+            {
+                std::unique_lock<std::shared_mutex> write_lock(mutex);
+
+                // Another thread may have finished it while this one waited for the lock
+                auto res_it = resources.find(hash);
+                if (res_it != resources.end())
+                {
+                    return res_it->second;
+                }
+
+                auto building_it = in_flight.find(hash);
+                if (building_it != in_flight.end())
+                {
+                    std::shared_future<T *> building = building_it->second;
+                    write_lock.unlock();
+                    return *building.get();
+                }
+
+                in_flight.emplace(hash, promise.get_future().share());
+            }
+
+            T *resource = nullptr;
+            try
+            {
+                T built = build();
+
+                std::lock_guard<std::shared_mutex> write_lock(mutex);
+                in_flight.erase(hash);
+
+                auto res_ins_it = resources.emplace(hash, std::move(built));
+                if (!res_ins_it.second)
+                {
+                    throw std::runtime_error{"Insertion error for cache object " + std::to_string(hash)};
+                }
+                resource = &res_ins_it.first->second;
+            }
+            catch (...)
+            {
+                {
+                    std::lock_guard<std::shared_mutex> write_lock(mutex);
+                    in_flight.erase(hash);
+                }
+                promise.set_exception(std::current_exception());
+                throw;
+            }
+
+            promise.set_value(resource);
+            on_insert(*resource);
+
+            return *resource;
+        }
+
+        /**
+         * @brief Locks the map against every request, for changes that go past request
+         */
+        std::unique_lock<std::shared_mutex> lock()
+        {
+            return std::unique_lock<std::shared_mutex>(mutex);
+        }
+
+    private:
+        std::shared_mutex mutex;
+
+        /// Keys being built, erased once their resource is in the map
+        std::unordered_map<std::size_t, std::shared_future<T *>> in_flight;
+    };
+} // namespace vkb
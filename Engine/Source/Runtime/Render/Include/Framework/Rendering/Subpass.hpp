@@ -61,6 +61,19 @@ namespace vkb
          */
         virtual void draw(vkb::CommandBuffer &command_buffer) = 0;
 
+        /**
+         * @brief Called before the render pass of the sub-pass begins, for work that get_subpass_contents depends on.
+         * Does nothing by default.
+         */
+        virtual void prepare_draw();
+
+        /**
+         * @brief How the commands of the sub-pass are recorded, inline into the primary command buffer by default.
+         * A sub-pass that returns VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS records secondary command buffers in draw
+         * and executes them on the primary one.
+         */
+        virtual VkSubpassContents get_subpass_contents() const;
+
         /**
          * @brief Pure virtual function, used to prepare the shaders and shader variants required for the sub-channels.
          */
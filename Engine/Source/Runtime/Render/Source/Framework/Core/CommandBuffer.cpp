@@ -108,6 +108,13 @@ namespace vkb
             inheritance_info.subpass = subpass_index;
 
             begin_info.pInheritanceInfo = &inheritance_info;
+
+            // Pipelines built from the secondary have to match the subpass it continues
+            pipeline_state.set_subpass_index(subpass_index);
+
+            auto blend_state = pipeline_state.get_color_blend_state();
+            blend_state.attachments.resize(current_render_pass->get_color_output_count(subpass_index));
+            pipeline_state.set_color_blend_state(blend_state);
         }
 
         VkResult result = vkBeginCommandBuffer(this->GetHandle(), &begin_info);
@@ -449,6 +456,11 @@ namespace vkb
         return level;
     }
 
+    const vkb::Framebuffer* CommandBuffer::get_current_framebuffer() const
+    {
+        return current_framebuffer;
+    }
+
     void CommandBuffer::execute_commands(vkb::CommandBuffer& secondary_command_buffer)
     {
         // vkCmdExecuteCommands expects a pointer to an array of command buffers
@@ -578,7 +590,7 @@ namespace vkb
             &image_memory_barrier);
     }
 
-    void CommandBuffer::next_subpass()
+    void CommandBuffer::next_subpass(VkSubpassContents contents)
     {
         // Increment subpass index
         pipeline_state.set_subpass_index(pipeline_state.get_subpass_index() + 1);
@@ -597,22 +609,27 @@ namespace vkb
 
         vkCmdNextSubpass(
             this->GetHandle(), // VkCommandBuffer
-            VK_SUBPASS_CONTENTS_INLINE);
+            contents);
     }
 
     void CommandBuffer::push_constants(const std::vector<uint8_t>& values)
     {
-        uint32_t push_constant_size = to_u32(stored_push_constants.size() + values.size());
+        push_constants(values.data(), values.size());
+    }
+
+    void CommandBuffer::push_constants(const uint8_t* data, size_t size)
+    {
+        uint32_t push_constant_size = to_u32(stored_push_constants.size() + size);
 
         if (push_constant_size > max_push_constants_size)
         {
             LOGE("Push constant limit of {} exceeded (pushing {} bytes for a total of {} bytes)",
-                 max_push_constants_size, values.size(), push_constant_size);
+                 max_push_constants_size, size, push_constant_size);
             // TODO throw std::runtime_error("Push constant limit exceeded.");
         }
         else
         {
-            stored_push_constants.insert(stored_push_constants.end(), values.begin(), values.end());
+            stored_push_constants.insert(stored_push_constants.end(), data, data + size);
         }
     }
 
@@ -29,12 +29,17 @@ namespace vkb
     }
 
     void BufferAllocation::update(const std::vector<uint8_t>& data, uint32_t offset)
+    {
+        update(data.data(), data.size(), offset);
+    }
+
+    void BufferAllocation::update(const uint8_t* data, size_t size, uint32_t offset)
     {
         assert(buffer && "Invalid buffer pointer");
 
-        if (offset + data.size() <= size)
+        if (offset + size <= this->size)
         {
-            buffer->update(data, to_u32(this->offset) + offset);
+            buffer->update(data, size, to_u32(this->offset) + offset);
         }
         else
         {
@@ -26,15 +26,56 @@ namespace vkb
 {
     namespace
     {
+        /**
+         * @brief Looks the resource up under a shared lock and builds it outside of any lock on a miss
+         * @param build_mutex Held while building, for resources whose construction isn't thread safe
+         */
         template <class T, class... A>
-        T &request_resource(VulkanDevice &device, ResourceRecord &recorder, std::mutex &resource_mutex,
+        T &request_resource(VulkanDevice &device, ResourceRecord &recorder, std::mutex &recorder_mutex,
+                            ResourceMapGuard<T> &guard, std::mutex *build_mutex,
                             std::unordered_map<std::size_t, T> &resources, A &...args)
         {
-            std::lock_guard<std::mutex> guard(resource_mutex);
+            std::size_t hash{0U};
+            hash_param(hash, args...);
 
-            auto &res = request_resource(device, &recorder, resources, args...);
+            const char *res_type = typeid(T).name();
 
-            return res;
+            auto build = [&]()
+            {
+                LOG_DEBUG("Building cache object {:X} ({})", hash, res_type);
+
+                std::unique_lock<std::mutex> build_lock;
+                if (build_mutex)
+                {
+                    build_lock = std::unique_lock<std::mutex>(*build_mutex);
+                }
+
+                // Only error handle in release
+#ifndef DEBUG
+                try
+                {
+#endif
+                    return T(device, args...);
+#ifndef DEBUG
+                }
+                catch (const std::exception &e)
+                {
+                    LOG_ERROR("Creation error for cache object {:X} ({})", hash, res_type);
+                    throw;
+                }
+#endif
+            };
+
+            auto record = [&](T &resource)
+            {
+                std::lock_guard<std::mutex> record_lock(recorder_mutex);
+
+                RecordHelper<T, A...> record_helper;
+                size_t index = record_helper.record(recorder, args...);
+                record_helper.index(recorder, index, resource);
+            };
+
+            return guard.request(resources, hash, build, record);
         }
     } // namespace
 
@@ -63,67 +104,76 @@ namespace vkb
                                                        const ShaderVariant &shader_variant)
     {
         std::string entry_point{"main"};
-        return request_resource(device, recorder, shader_module_mutex, state.shader_modules, stage, glsl_source,
-                                entry_point, shader_variant);
+        return request_resource(device, recorder, recorder_mutex, shader_module_guard, nullptr,
+                                state.shader_modules, stage, glsl_source, entry_point, shader_variant);
     }
 
     PipelineLayout &ResourceCache::request_pipeline_layout(const std::vector<ShaderModule *> &shader_modules)
     {
-        return request_resource(device, recorder, pipeline_layout_mutex, state.pipeline_layouts, shader_modules);
+        return request_resource(device, recorder, recorder_mutex, pipeline_layout_guard, nullptr,
+                                state.pipeline_layouts, shader_modules);
     }
 
     DescriptorSetLayout &ResourceCache::request_descriptor_set_layout(const uint32_t set_index,
                                                                       const std::vector<ShaderModule *> &shader_modules,
                                                                       const std::vector<ShaderResource> &set_resources)
     {
-        return request_resource(device, recorder, descriptor_set_layout_mutex, state.descriptor_set_layouts, set_index,
-                                shader_modules, set_resources);
+        return request_resource(device, recorder, recorder_mutex, descriptor_set_layout_guard, nullptr,
+                                state.descriptor_set_layouts, set_index, shader_modules, set_resources);
     }
 
     GraphicsPipeline &ResourceCache::request_graphics_pipeline(PipelineState &pipeline_state)
     {
-        return request_resource(device, recorder, graphics_pipeline_mutex, state.graphics_pipelines, pipeline_cache,
-                                pipeline_state);
+        return request_resource(device, recorder, recorder_mutex, graphics_pipeline_guard, nullptr,
+                                state.graphics_pipelines, pipeline_cache, pipeline_state);
     }
 
     ComputePipeline &ResourceCache::request_compute_pipeline(PipelineState &pipeline_state)
     {
-        return request_resource(device, recorder, compute_pipeline_mutex, state.compute_pipelines, pipeline_cache,
-                                pipeline_state);
+        return request_resource(device, recorder, recorder_mutex, compute_pipeline_guard, nullptr,
+                                state.compute_pipelines, pipeline_cache, pipeline_state);
     }
 
     DescriptorSet &ResourceCache::request_descriptor_set(DescriptorSetLayout &descriptor_set_layout,
                                                          const BindingMap<VkDescriptorBufferInfo> &buffer_infos,
                                                          const BindingMap<VkDescriptorImageInfo> &image_infos)
     {
-        auto &descriptor_pool = request_resource(device, recorder, descriptor_set_mutex, state.descriptor_pools,
-                                                 descriptor_set_layout);
-        return request_resource(device, recorder, descriptor_set_mutex, state.descriptor_sets, descriptor_set_layout,
-                                descriptor_pool, buffer_infos, image_infos);
+        auto &descriptor_pool = request_resource(device, recorder, recorder_mutex, descriptor_pool_guard, nullptr,
+                                                 state.descriptor_pools, descriptor_set_layout);
+        return request_resource(device, recorder, recorder_mutex, descriptor_set_guard, &descriptor_pool_mutex,
+                                state.descriptor_sets, descriptor_set_layout, descriptor_pool, buffer_infos,
+                                image_infos);
     }
 
     RenderPass &ResourceCache::request_render_pass(const std::vector<Attachment> &attachments,
                                                    const std::vector<LoadStoreInfo> &load_store_infos,
                                                    const std::vector<SubpassInfo> &subpasses)
     {
-        return request_resource(device, recorder, render_pass_mutex, state.render_passes, attachments, load_store_infos,
-                                subpasses);
+        return request_resource(device, recorder, recorder_mutex, render_pass_guard, nullptr,
+                                state.render_passes, attachments, load_store_infos, subpasses);
     }
 
     Framebuffer &ResourceCache::request_framebuffer(const RenderTarget &render_target, const RenderPass &render_pass)
     {
-        return request_resource(device, recorder, framebuffer_mutex, state.framebuffers, render_target, render_pass);
+        return request_resource(device, recorder, recorder_mutex, framebuffer_guard, nullptr,
+                                state.framebuffers, render_target, render_pass);
     }
 
     void ResourceCache::clear_pipelines()
     {
-        state.graphics_pipelines.clear();
+        {
+            auto lock = graphics_pipeline_guard.lock();
+            state.graphics_pipelines.clear();
+        }
+        auto lock = compute_pipeline_guard.lock();
         state.compute_pipelines.clear();
     }
 
     void ResourceCache::update_descriptor_sets(const std::vector<ImageView> &old_views,
                                                const std::vector<ImageView> &new_views)
     {
+        auto lock = descriptor_set_guard.lock();
+
         // Find descriptor sets referring to the old image view
         std::vector<VkWriteDescriptorSet> set_updates;
         std::set<size_t> matches;
@@ -210,16 +260,32 @@ namespace vkb
 
     void ResourceCache::clear_framebuffers()
     {
+        auto lock = framebuffer_guard.lock();
         state.framebuffers.clear();
     }
 
     void ResourceCache::clear()
     {
-        state.shader_modules.clear();
-        state.pipeline_layouts.clear();
-        state.descriptor_sets.clear();
-        state.descriptor_set_layouts.clear();
-        state.render_passes.clear();
+        {
+            auto lock = shader_module_guard.lock();
+            state.shader_modules.clear();
+        }
+        {
+            auto lock = pipeline_layout_guard.lock();
+            state.pipeline_layouts.clear();
+        }
+        {
+            auto lock = descriptor_set_guard.lock();
+            state.descriptor_sets.clear();
+        }
+        {
+            auto lock = descriptor_set_layout_guard.lock();
+            state.descriptor_set_layouts.clear();
+        }
+        {
+            auto lock = render_pass_guard.lock();
+            state.render_passes.clear();
+        }
         clear_pipelines();
         clear_framebuffers();
     }
@@ -92,6 +92,12 @@ namespace vkb
             clear_value.push_back({0.0f, 0.0f, 0.0f, 1.0f});
         }
 
+        // The contents of every sub-pass are known before the render pass begins
+        for (auto& subpass : subpasses)
+        {
+            subpass->prepare_draw();
+        }
+
         for (size_t i = 0; i < subpasses.size(); ++i)
         {
             active_subpass_index = i;
@@ -100,13 +106,20 @@ namespace vkb
 
             subpass->update_render_target_attachments(render_target);
 
+            // A sub-pass recording secondary command buffers needs them whatever the caller asked for
+            VkSubpassContents subpass_contents = subpass->get_subpass_contents();
+            if (i == 0 && subpass_contents == VK_SUBPASS_CONTENTS_INLINE)
+            {
+                subpass_contents = contents;
+            }
+
             if (i == 0)
             {
-                command_buffer.begin_render_pass(render_target, load_store, clear_value, subpasses, contents);
+                command_buffer.begin_render_pass(render_target, load_store, clear_value, subpasses, subpass_contents);
             }
             else
             {
-                command_buffer.next_subpass();
+                command_buffer.next_subpass(subpass_contents);
             }
 
             if (subpass->get_debug_name().empty())
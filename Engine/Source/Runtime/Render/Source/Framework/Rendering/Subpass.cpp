@@ -11,6 +11,15 @@ namespace vkb
     {
     }
 
+    void Subpass::prepare_draw()
+    {
+    }
+
+    VkSubpassContents Subpass::get_subpass_contents() const
+    {
+        return VK_SUBPASS_CONTENTS_INLINE;
+    }
+
     const std::vector<uint32_t> &Subpass::get_input_attachments() const
     {
         return input_attachments;
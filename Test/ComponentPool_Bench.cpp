@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Engine/SceneGraph/ComponentPool.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps results alive so the optimizer can't drop the benchmarked work
+    volatile float g_sink = 0.0f;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /// About the size of a light or camera component
+    struct BenchComponent
+    {
+        scene::Node* owner = nullptr;
+        glm::mat4 matrix = glm::mat4(1.0f);
+        glm::vec4 color = glm::vec4(1.0f);
+        float value = 1.0f;
+    };
+
+    /// The pool before the sparse set, a vector and two hash maps
+    class LegacyPool
+    {
+    public:
+        size_t AddComponent(scene::NodeID id)
+        {
+            size_t newIndex = components.size();
+            components.emplace_back();
+
+            ownerNodeMap[id] = newIndex;
+            indexToNodeMap[newIndex] = id;
+
+            return newIndex;
+        }
+
+        BenchComponent* GetComponent(scene::NodeID nodeID)
+        {
+            if (ownerNodeMap.count(nodeID))
+            {
+                return &components[ownerNodeMap[nodeID]];
+            }
+            return nullptr;
+        }
+
+        void DestroyComponentForNode(scene::NodeID nodeID)
+        {
+            if (!ownerNodeMap.count(nodeID)) return;
+
+            size_t indexOfRemoved = ownerNodeMap[nodeID];
+            size_t indexOfLast = components.size() - 1;
+            scene::NodeID nodeOfLast = indexToNodeMap[indexOfLast];
+
+            components[indexOfRemoved] = std::move(components[indexOfLast]);
+
+            ownerNodeMap[nodeOfLast] = indexOfRemoved;
+            indexToNodeMap[indexOfRemoved] = nodeOfLast;
+
+            components.pop_back();
+
+            ownerNodeMap.erase(nodeID);
+            indexToNodeMap.erase(indexOfLast);
+        }
+
+        template <typename Func>
+        void ForEach(Func&& func)
+        {
+            for (auto& component : components)
+            {
+                func(component);
+            }
+        }
+
+    private:
+        std::vector<BenchComponent> components;
+        std::unordered_map<uint32_t, size_t> ownerNodeMap;
+        std::unordered_map<size_t, uint32_t> indexToNodeMap;
+    };
+
+    /// Adapts the new pool to the calls of the legacy one
+    class SparsePool
+    {
+    public:
+        void AddComponent(scene::NodeID id)
+        {
+            pool.AddComponent(id, nullptr);
+        }
+
+        BenchComponent* GetComponent(scene::NodeID nodeID)
+        {
+            return pool.GetComponent(nodeID);
+        }
+
+        void DestroyComponentForNode(scene::NodeID nodeID)
+        {
+            pool.DestroyComponentForNode(nodeID);
+        }
+
+        template <typename Func>
+        void ForEach(Func&& func)
+        {
+            pool.ForEach(func);
+        }
+
+    private:
+        scene::ComponentPool<BenchComponent> pool;
+    };
+
+    struct Timings
+    {
+        double add = 0.0;
+        double get = 0.0;
+        double iterate = 0.0;
+        double churn = 0.0;
+        int moved = 0;
+    };
+
+    /// Adds count components, looks every one up in random order, sums them, then removes and re-adds
+    /// churn components per round. Moved counts how many of the first 1000 components changed address
+    /// while the pool grew to twice its size.
+    template <typename Pool>
+    Timings BenchPool(int count, int churn, int rounds)
+    {
+        Timings timings;
+        std::srand(4242);
+
+        std::vector<scene::NodeID> ids(count);
+        for (int i = 0; i < count; i++)
+        {
+            ids[i] = static_cast<scene::NodeID>(i);
+        }
+        std::vector<scene::NodeID> lookups = ids;
+        for (int i = count - 1; i > 0; i--)
+        {
+            std::swap(lookups[i], lookups[std::rand() % (i + 1)]);
+        }
+
+        Pool pool;
+        auto start = Clock::now();
+        for (scene::NodeID id : ids)
+        {
+            pool.AddComponent(id);
+        }
+        timings.add = ElapsedMs(start);
+
+        start = Clock::now();
+        float sum = 0.0f;
+        for (scene::NodeID id : lookups)
+        {
+            sum += pool.GetComponent(id)->value;
+        }
+        timings.get = ElapsedMs(start);
+
+        start = Clock::now();
+        const int iterations = 20;
+        for (int i = 0; i < iterations; i++)
+        {
+            pool.ForEach([&sum](BenchComponent& component) { sum += component.matrix[3][0] + component.value; });
+        }
+        timings.iterate = ElapsedMs(start) / iterations;
+
+        scene::NodeID nextID = static_cast<scene::NodeID>(count);
+        start = Clock::now();
+        for (int round = 0; round < rounds; round++)
+        {
+            for (int i = 0; i < churn; i++)
+            {
+                const int victim = std::rand() % count;
+                pool.DestroyComponentForNode(ids[victim]);
+                ids[victim] = nextID++;
+                pool.AddComponent(ids[victim]);
+            }
+            for (int i = 0; i < churn; i++)
+            {
+                sum += pool.GetComponent(ids[std::rand() % count])->value;
+            }
+        }
+        timings.churn = ElapsedMs(start) / rounds;
+
+        std::vector<BenchComponent*> pointers;
+        for (int i = 0; i < 1000; i++)
+        {
+            pointers.push_back(pool.GetComponent(ids[i]));
+        }
+        for (int i = 0; i < count; i++)
+        {
+            pool.AddComponent(nextID++);
+        }
+        for (int i = 0; i < 1000; i++)
+        {
+            timings.moved += (pool.GetComponent(ids[i]) != pointers[i]) ? 1 : 0;
+        }
+
+        g_sink = g_sink + sum;
+        return timings;
+    }
+
+    void BenchComponentPools(int count, int churn, int rounds)
+    {
+        const Timings legacy = BenchPool<LegacyPool>(count, churn, rounds);
+        const Timings sparse = BenchPool<SparsePool>(count, churn, rounds);
+
+        std::printf("ComponentPool %d components\n", count);
+        std::printf("  %-22s %9s %9s %9s\n", "", "legacy", "sparse", "speedup");
+        std::printf("  %-22s %9.3f %9.3f %8.2fx\n", "add all (ms)", legacy.add, sparse.add, legacy.add / sparse.add);
+        std::printf("  %-22s %9.3f %9.3f %8.2fx\n", "random get all (ms)", legacy.get, sparse.get, legacy.get / sparse.get);
+        std::printf("  %-22s %9.3f %9.3f %8.2fx\n", "iterate (ms)", legacy.iterate, sparse.iterate, legacy.iterate / sparse.iterate);
+        std::printf("  %-22s %9.3f %9.3f %8.2fx\n", "churn round (ms)", legacy.churn, sparse.churn, legacy.churn / sparse.churn);
+        std::printf("  %-22s %9d %9d\n", "moved by growth /1000", legacy.moved, sparse.moved);
+    }
+}
+
+int main()
+{
+    // Every churn round removes, re-adds and looks up 10% of the components
+    BenchComponentPools(100000, 10000, 20);
+    return 0;
+}
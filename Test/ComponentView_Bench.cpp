@@ -0,0 +1,207 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Engine/SceneGraph/ComponentPool.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps results alive so the optimizer can't drop the benchmarked work
+    volatile float g_sink = 0.0f;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Position
+    {
+        scene::Node* owner = nullptr;
+        glm::vec3 position = glm::vec3(0.0f);
+    };
+
+    struct Velocity
+    {
+        scene::Node* owner = nullptr;
+        glm::vec3 velocity = glm::vec3(1.0f, 0.5f, 0.25f);
+    };
+
+    struct Tint
+    {
+        scene::Node* owner = nullptr;
+        glm::vec4 color = glm::vec4(1.0f);
+    };
+
+    /// How systems joined components before views, one hash map per type as in the old ComponentPool
+    template <typename T>
+    struct LegacyPool
+    {
+        std::vector<T> components;
+        std::unordered_map<uint32_t, size_t> ownerNodeMap;
+
+        void Add(scene::NodeID id)
+        {
+            ownerNodeMap[id] = components.size();
+            components.emplace_back();
+        }
+
+        T* GetComponent(scene::NodeID id)
+        {
+            if (ownerNodeMap.count(id))
+            {
+                return &components[ownerNodeMap[id]];
+            }
+            return nullptr;
+        }
+    };
+
+    struct World
+    {
+        scene::ComponentPool<Position> positions;
+        scene::ComponentPool<Velocity> velocities;
+        scene::ComponentPool<Tint> tints;
+
+        LegacyPool<Position> legacyPositions;
+        LegacyPool<Velocity> legacyVelocities;
+        LegacyPool<Tint> legacyTints;
+        std::vector<scene::NodeID> legacyOwners;
+    };
+
+    /// Every node has a Position, half of them a Velocity and half of them a Tint, picked at random
+    void BuildWorld(World& world, int count)
+    {
+        std::srand(97531);
+        for (int i = 0; i < count; i++)
+        {
+            const auto id = static_cast<scene::NodeID>(i);
+            world.positions.AddComponent(id, nullptr);
+            world.legacyPositions.Add(id);
+            world.legacyOwners.push_back(id);
+            if (std::rand() % 2 == 0)
+            {
+                world.velocities.AddComponent(id, nullptr);
+                world.legacyVelocities.Add(id);
+            }
+            if (std::rand() % 2 == 0)
+            {
+                world.tints.AddComponent(id, nullptr);
+                world.legacyTints.Add(id);
+            }
+        }
+    }
+
+    float Integrate(Position& position, const Velocity& velocity, const Tint& tint)
+    {
+        position.position += velocity.velocity * 0.016f;
+        return position.position.x * tint.color.w;
+    }
+
+    template <typename Func>
+    double TimeIterations(int iterations, Func&& func)
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < iterations; i++)
+        {
+            func();
+        }
+        return ElapsedMs(start) / iterations;
+    }
+
+    void BenchViews(int count, int iterations)
+    {
+        World world;
+        BuildWorld(world, count);
+
+        int matches = 0;
+        const double legacyMs = TimeIterations(iterations, [&world, &matches]()
+        {
+            float sum = 0.0f;
+            matches = 0;
+            for (size_t i = 0; i < world.legacyPositions.components.size(); i++)
+            {
+                const scene::NodeID id = world.legacyOwners[i];
+                Velocity* velocity = world.legacyVelocities.GetComponent(id);
+                Tint* tint = world.legacyTints.GetComponent(id);
+                if (velocity && tint)
+                {
+                    sum += Integrate(world.legacyPositions.components[i], *velocity, *tint);
+                    matches++;
+                }
+            }
+            g_sink = g_sink + sum;
+        });
+
+        scene::View<Position, Velocity, Tint> view(&world.positions, &world.velocities, &world.tints);
+        const double viewMs = TimeIterations(iterations, [&view]()
+        {
+            float sum = 0.0f;
+            view.ForEach([&sum](scene::NodeID, Position& position, Velocity& velocity, Tint& tint)
+            {
+                sum += Integrate(position, velocity, tint);
+            });
+            g_sink = g_sink + sum;
+        });
+
+        const double rangeMs = TimeIterations(iterations, [&view]()
+        {
+            float sum = 0.0f;
+            for (auto [id, position, velocity, tint] : view)
+            {
+                sum += Integrate(position, velocity, tint);
+            }
+            g_sink = g_sink + sum;
+        });
+
+        auto start = Clock::now();
+        scene::GroupStorage storage({&world.positions, &world.velocities, &world.tints});
+        const double buildGroupMs = ElapsedMs(start);
+
+        scene::Group<Position, Velocity, Tint> group(storage, &world.positions, &world.velocities, &world.tints);
+        const double groupMs = TimeIterations(iterations, [&group]()
+        {
+            float sum = 0.0f;
+            group.ForEach([&sum](scene::NodeID, Position& position, Velocity& velocity, Tint& tint)
+            {
+                sum += Integrate(position, velocity, tint);
+            });
+            g_sink = g_sink + sum;
+        });
+
+        const size_t groupSize = group.size();
+
+        // Keeping the group sorted costs a few swaps on every change of a grouped pool
+        start = Clock::now();
+        for (int i = 0; i < count / 10; i++)
+        {
+            const auto id = static_cast<scene::NodeID>(std::rand() % count);
+            if (world.tints.Contains(id))
+            {
+                world.tints.DestroyComponentForNode(id);
+            }
+            else
+            {
+                world.tints.AddComponent(id, nullptr);
+            }
+        }
+        const double groupChurnMs = ElapsedMs(start);
+
+        std::printf("Views %d nodes, %d with Position + Velocity + Tint, per iteration\n", count, matches);
+        std::printf("  hand join (hash lookups) %8.3f ms\n", legacyMs);
+        std::printf("  View ForEach             %8.3f ms %6.2fx\n", viewMs, legacyMs / viewMs);
+        std::printf("  View range for           %8.3f ms %6.2fx\n", rangeMs, legacyMs / rangeMs);
+        std::printf("  Group ForEach            %8.3f ms %6.2fx  (%zu nodes, built in %.3f ms)\n", groupMs, legacyMs / groupMs, groupSize, buildGroupMs);
+        std::printf("  toggle %d Tints, grouped %8.3f ms\n", count / 10, groupChurnMs);
+    }
+}
+
+int main()
+{
+    BenchViews(100000, 50);
+    return 0;
+}
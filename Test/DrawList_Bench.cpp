@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+#include "Rendering/DrawList.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    volatile uint64_t g_sink = 0;
+
+    /// What GeometrySubpass knows of a draw when it sorts
+    struct Draw
+    {
+        uint32_t pipeline;
+        uint32_t material;
+        uint32_t mesh;
+        float depth;
+        bool transparent;
+    };
+
+    /// Copies of a few meshes spread over a level, a mesh always has the same material
+    std::vector<Draw> MakeDraws(int count, int pipelines, int materials, int meshes)
+    {
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> mesh(0, meshes - 1);
+        std::uniform_real_distribution<float> depth(0.1f, 500.0f);
+
+        std::vector<Draw> draws(count);
+        for (Draw& draw : draws)
+        {
+            // A material always uses the same shader variant
+            draw.mesh = static_cast<uint32_t>(mesh(random));
+            draw.material = draw.mesh % materials;
+            draw.pipeline = draw.material % pipelines;
+            draw.depth = depth(random);
+            draw.transparent = random() % 10 == 0;
+        }
+        return draws;
+    }
+
+    /// Binds a walk over the draws has to make, a new pipeline also rebinds the material
+    struct Binds
+    {
+        size_t pipelines = 0;
+        size_t materials = 0;
+
+        /// Draw calls once copies next to each other are merged into instanced draws
+        size_t draws = 0;
+    };
+
+    bool SameInstance(const Draw& a, const Draw& b)
+    {
+        return a.mesh == b.mesh && a.material == b.material && a.transparent == b.transparent;
+    }
+
+    template <typename Order>
+    Binds CountBinds(const std::vector<Draw>& draws, const Order& order)
+    {
+        Binds binds;
+        const Draw* previous = nullptr;
+        for (uint32_t index : order)
+        {
+            const Draw& draw = draws[index];
+            const bool samePipeline = previous && previous->pipeline == draw.pipeline;
+            const bool sameMaterial = samePipeline && previous->material == draw.material;
+            binds.pipelines += samePipeline ? 0 : 1;
+            binds.materials += sameMaterial ? 0 : 1;
+            binds.draws += previous && SameInstance(*previous, draw) ? 0 : 1;
+            previous = &draw;
+        }
+        return binds;
+    }
+
+    /// Returns false when the draw list order or its batches differ from the multimap
+    bool BenchDrawList(int count, int pipelines, int materials, int meshes, int frames)
+    {
+        const std::vector<Draw> draws = MakeDraws(count, pipelines, materials, meshes);
+        std::vector<uint32_t> order;
+        order.reserve(count);
+
+        // Two multimaps of every draw, the key was always 0 so the order was the order of the meshes
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            std::multimap<float, uint32_t> opaque;
+            std::multimap<float, uint32_t> transparent;
+            for (uint32_t i = 0; i < draws.size(); i++)
+            {
+                (draws[i].transparent ? transparent : opaque).emplace(0.0f, i);
+            }
+            order.clear();
+            for (const auto& [key, index] : opaque)
+            {
+                order.push_back(index);
+            }
+            for (auto it = transparent.rbegin(); it != transparent.rend(); ++it)
+            {
+                order.push_back(it->second);
+            }
+        }
+        const double multimapMs = ElapsedMs(start) / frames;
+        const Binds multimapBinds = CountBinds(draws, order);
+
+        // The same maps keyed by depth, sorted by distance but not by state
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            std::multimap<float, uint32_t> opaque;
+            std::multimap<float, uint32_t> transparent;
+            for (uint32_t i = 0; i < draws.size(); i++)
+            {
+                (draws[i].transparent ? transparent : opaque).emplace(draws[i].depth, i);
+            }
+            order.clear();
+            for (const auto& [key, index] : opaque)
+            {
+                order.push_back(index);
+            }
+            for (auto it = transparent.rbegin(); it != transparent.rend(); ++it)
+            {
+                order.push_back(it->second);
+            }
+        }
+        const double depthMapMs = ElapsedMs(start) / frames;
+        const Binds depthMapBinds = CountBinds(draws, order);
+
+        vkb::DrawList drawList;
+        drawList.reserve(count);
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            drawList.clear();
+            for (uint32_t i = 0; i < draws.size(); i++)
+            {
+                const Draw& draw = draws[i];
+                drawList.add(vkb::DrawList::make_key(0, draw.transparent, draw.pipeline, draw.material, draw.mesh, draw.depth), i);
+            }
+            drawList.sort();
+            g_sink = drawList.get_packets().front().key;
+        }
+        const double radixMs = ElapsedMs(start) / frames;
+
+        std::vector<vkb::DrawList::Batch> batches;
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            batches.clear();
+            drawList.build_batches(0, drawList.get_packets().size(),
+                                   [&](const vkb::DrawList::Packet& a, const vkb::DrawList::Packet& b)
+                                   {
+                                       return SameInstance(draws[a.index], draws[b.index]);
+                                   },
+                                   batches);
+        }
+        const double batchMs = ElapsedMs(start) / frames;
+
+        order.clear();
+        for (const auto& packet : drawList.get_packets())
+        {
+            order.push_back(packet.index);
+        }
+        const Binds drawListBinds = CountBinds(draws, order);
+
+        // The radix sort against std::stable_sort of the same packets
+        std::vector<vkb::DrawList::Packet> packets;
+        for (uint32_t i = 0; i < draws.size(); i++)
+        {
+            const Draw& draw = draws[i];
+            packets.push_back({vkb::DrawList::make_key(0, draw.transparent, draw.pipeline, draw.material, draw.mesh, draw.depth), i});
+        }
+        start = Clock::now();
+        std::vector<vkb::DrawList::Packet> sorted = packets;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return a.key < b.key; });
+        const double stableSortMs = ElapsedMs(start);
+
+        bool matches = sorted.size() == drawList.get_packets().size();
+        for (size_t i = 0; matches && i < sorted.size(); i++)
+        {
+            matches = sorted[i].index == drawList.get_packets()[i].index;
+        }
+
+        // Opaque copies of a mesh have to be front to back, transparent draws back to front. Opaque keys keep 5
+        // bits of mantissa and transparent ones 21, closer depths tie and keep their order.
+        const auto inFront = [](float a, float b, float precision) { return a <= b * (1.0f + precision); };
+        const size_t firstTransparent = drawList.find_first_transparent();
+        for (size_t i = 1; matches && i < order.size(); i++)
+        {
+            const Draw& a = draws[order[i - 1]];
+            const Draw& b = draws[order[i]];
+            if (i < firstTransparent && a.mesh == b.mesh)
+            {
+                matches = inFront(a.depth, b.depth, 1.0f / 16.0f);
+            }
+            else if (i > firstTransparent)
+            {
+                matches = a.transparent && b.transparent && inFront(b.depth, a.depth, 1e-5f);
+            }
+        }
+
+        std::printf("%d draws, %d pipelines, %d materials, %d meshes\n", count, pipelines, materials, meshes);
+        std::printf("  multimap, key 0     %8.3f ms  %7zu pipeline binds %7zu material binds %7zu draws\n",
+                    multimapMs, multimapBinds.pipelines, multimapBinds.materials, multimapBinds.draws);
+        std::printf("  multimap, depth     %8.3f ms  %7zu pipeline binds %7zu material binds %7zu draws\n",
+                    depthMapMs, depthMapBinds.pipelines, depthMapBinds.materials, depthMapBinds.draws);
+        std::printf("  draw list, radix    %8.3f ms  %7zu pipeline binds %7zu material binds %7zu draws %6.2fx %s\n",
+                    radixMs, drawListBinds.pipelines, drawListBinds.materials, batches.size(), depthMapMs / radixMs,
+                    matches && batches.size() == drawListBinds.draws ? "" : "MISMATCH");
+        std::printf("  batching            %8.3f ms\n", batchMs);
+        std::printf("  std::stable_sort    %8.3f ms\n", stableSortMs);
+        return matches && batches.size() == drawListBinds.draws;
+    }
+
+    /// Ids past 16 bits saturate, a large id must not wrap around and sort in front of small ones
+    bool CheckIdSaturation()
+    {
+        const uint64_t small = vkb::DrawList::make_key(0, false, 1, 0, 0, 1.0f);
+        const uint64_t wrapped = vkb::DrawList::make_key(0, false, 0x10000, 0, 0, 1.0f);
+        const uint64_t largest = vkb::DrawList::make_key(0, false, 0xFFFF, 0, 0, 1.0f);
+        const bool matches = small < wrapped && wrapped == largest;
+        std::printf("DrawList ids past 16 bits saturate %s\n", matches ? "" : "MISMATCH");
+        return matches;
+    }
+}
+
+int main()
+{
+    bool matches = CheckIdSaturation();
+    matches = BenchDrawList(1000, 8, 64, 100, 200) && matches;
+    matches = BenchDrawList(100000, 24, 400, 2000, 20) && matches;
+    matches = BenchDrawList(100000, 200, 4000, 4000, 20) && matches;
+    return matches ? 0 : 1;
+}
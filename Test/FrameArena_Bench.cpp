@@ -0,0 +1,196 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Async/WorkStealingThreadPool.hpp"
+#include "Memory/FrameAllocator.hpp"
+
+namespace
+{
+    std::atomic<size_t> g_heapAllocations{0};
+}
+
+// Every allocation of the process goes through here, so a frame can count what it took from the heap
+void* operator new(size_t size)
+{
+    g_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    volatile size_t g_sink = 0;
+
+    struct SubMesh
+    {
+        glm::mat4 world;
+        float depth;
+        bool visible;
+    };
+
+    /// What GeometrySubpass::prepare_draw keeps for one frame only, the view depth and frustum result of every
+    /// submesh and the model matrices of the visible ones on their way into the instance buffer
+    template <typename Floats, typename Bytes, typename Matrices>
+    size_t PrepareFrame(const std::vector<SubMesh>& subMeshes, Floats& depths, Bytes& visible, Matrices& instances)
+    {
+        depths.clear();
+        visible.clear();
+        instances.clear();
+        for (const SubMesh& subMesh : subMeshes)
+        {
+            depths.push_back(subMesh.depth);
+            visible.push_back(subMesh.visible ? 1 : 0);
+        }
+        for (size_t i = 0; i < subMeshes.size(); i++)
+        {
+            if (visible[i] != 0 && depths[i] >= 0.0f)
+            {
+                instances.push_back(subMeshes[i].world);
+            }
+        }
+        return instances.size();
+    }
+
+    void BenchFrames(int subMeshCount, int frames)
+    {
+        std::vector<SubMesh> subMeshes(subMeshCount);
+        for (int i = 0; i < subMeshCount; i++)
+        {
+            subMeshes[i] = {glm::mat4(1.0f), static_cast<float>(i % 64), i % 3 != 0};
+        }
+
+        std::printf("%d submeshes a frame, %d frames\n", subMeshCount, frames);
+
+        // Containers made fresh every frame, as locals of the frame would be without an arena
+        size_t heapAllocations = 0;
+        auto start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            const size_t before = g_heapAllocations.load();
+            std::vector<float> depths;
+            std::vector<uint8_t> visible;
+            std::vector<glm::mat4> instances;
+            g_sink = PrepareFrame(subMeshes, depths, visible, instances);
+            heapAllocations = g_heapAllocations.load() - before;
+        }
+        const double heapMs = ElapsedMs(start) / frames;
+        std::printf("  general heap  %8.3f ms/frame  %8zu heap allocations/frame\n", heapMs, heapAllocations);
+
+        // Members that keep their capacity, no allocations either but each one holds its peak for good
+        std::vector<float> keptDepths;
+        std::vector<uint8_t> keptVisible;
+        std::vector<glm::mat4> keptInstances;
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            const size_t before = g_heapAllocations.load();
+            g_sink = PrepareFrame(subMeshes, keptDepths, keptVisible, keptInstances);
+            heapAllocations = g_heapAllocations.load() - before;
+        }
+        const double keptMs = ElapsedMs(start) / frames;
+        std::printf("  kept members  %8.3f ms/frame  %8zu heap allocations/frame %6.2fx\n", keptMs, heapAllocations,
+                    heapMs / keptMs);
+
+        start = Clock::now();
+        for (int frame = 0; frame < frames; frame++)
+        {
+            FrameAllocator::BeginFrame();
+            const size_t before = g_heapAllocations.load();
+            {
+                LinearArena& arena = FrameAllocator::Get();
+                std::pmr::vector<float> depths(&arena);
+                std::pmr::vector<uint8_t> visible(&arena);
+                std::pmr::vector<glm::mat4> instances(&arena);
+                depths.reserve(subMeshes.size());
+                visible.reserve(subMeshes.size());
+                instances.reserve(subMeshes.size());
+                g_sink = PrepareFrame(subMeshes, depths, visible, instances);
+            }
+            heapAllocations = g_heapAllocations.load() - before;
+
+            if (frame < 3)
+            {
+                // The statistics of a frame are complete once the next one began
+                FrameAllocator::BeginFrame();
+                const FrameAllocator::FrameStats stats = FrameAllocator::GetLastFrameStats();
+                std::printf("  frame %d       %8zu arena allocations %8zu KB  %zu arena blocks from the heap, %zu heap allocations\n",
+                            frame, stats.allocations, stats.bytes / 1024, stats.heapAllocations, heapAllocations);
+            }
+        }
+        const double arenaMs = ElapsedMs(start) / frames;
+        std::printf("  frame arena   %8.3f ms/frame  %8zu heap allocations/frame %6.2fx\n", arenaMs, heapAllocations,
+                    heapMs / arenaMs);
+    }
+
+    /// Workers fill scratch arrays from their own arenas, after the first frames none of them uses the heap
+    void BenchWorkers(int tasks, int frames)
+    {
+        WorkStealingThreadPool threadPool(4);
+        std::printf("%d scratch tasks a frame on %zu workers\n", tasks, threadPool.GetWorkerCount());
+
+        for (int frame = 0; frame < frames; frame++)
+        {
+            FrameAllocator::BeginFrame();
+            if (frame > 0 && (frame < 4 || frame == frames - 1))
+            {
+                const FrameAllocator::FrameStats stats = FrameAllocator::GetLastFrameStats();
+                std::printf("  frame %2d  %zu threads %8zu arena allocations %4zu arena blocks from the heap\n", frame - 1,
+                            stats.threads, stats.allocations, stats.heapAllocations);
+            }
+
+            std::atomic<int> pending{tasks};
+            for (int task = 0; task < tasks; task++)
+            {
+                threadPool.Submit([&pending, task]()
+                {
+                    std::pmr::vector<uint32_t> scratch(&FrameAllocator::Get());
+                    for (int i = 0; i < 256 + task % 64; i++)
+                    {
+                        scratch.push_back(static_cast<uint32_t>(i));
+                    }
+                    g_sink = scratch.size();
+                    pending.fetch_sub(1);
+                });
+            }
+            while (pending.load() > 0)
+            {
+                threadPool.RunPendingTask();
+            }
+        }
+    }
+}
+
+int main()
+{
+    BenchFrames(1000, 200);
+    BenchFrames(20000, 50);
+    BenchWorkers(256, 20);
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Async/WorkStealingThreadPool.hpp"
+#include "Engine/SceneGraph/Bounds.hpp"
+#include "Engine/SceneGraph/FrustumCuller.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /// Submesh bounds spread over a level, every tenth one without bounds like a mesh that wasn't imported
+    /// with them. The count is odd so the last group of four is padded.
+    std::vector<scene::AABB> MakeBounds(int count, std::mt19937& random)
+    {
+        const float levelSize = 8.0f * std::sqrt(static_cast<float>(count));
+        std::uniform_real_distribution<float> position(-levelSize * 0.5f, levelSize * 0.5f);
+        std::uniform_real_distribution<float> height(0.0f, 20.0f);
+        std::uniform_real_distribution<float> size(0.2f, 4.0f);
+
+        std::vector<scene::AABB> bounds;
+        for (int i = 0; i < count; i++)
+        {
+            if (i % 10 == 9)
+            {
+                bounds.emplace_back();
+                continue;
+            }
+            const glm::vec3 center(position(random), height(random), position(random));
+            const glm::vec3 extents(size(random), size(random), size(random));
+            bounds.emplace_back(center - extents, center + extents);
+        }
+        return bounds;
+    }
+
+    /// Returns false when a four wide frame disagrees with the box by box test
+    bool BenchCulling(int count, int frames, WorkStealingThreadPool& threadPool)
+    {
+        std::mt19937 random(count);
+        const std::vector<scene::AABB> bounds = MakeBounds(count, random);
+
+        std::vector<scene::Frustum> frustums;
+        std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+        const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f);
+        for (int frame = 0; frame < frames; frame++)
+        {
+            const float yaw = angle(random);
+            const glm::vec3 eye(0.0f, 2.0f, 0.0f);
+            const glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(std::cos(yaw), 0.0f, std::sin(yaw)),
+                                               glm::vec3(0.0f, 1.0f, 0.0f));
+            frustums.emplace_back(projection * view);
+        }
+
+        // Every box through Frustum::Overlaps one at a time, invalid bounds are kept like the culler does
+        std::vector<uint8_t> expected(count);
+        size_t scalarVisible = 0;
+        auto start = Clock::now();
+        for (const scene::Frustum& frustum : frustums)
+        {
+            scalarVisible = 0;
+            for (int i = 0; i < count; i++)
+            {
+                expected[i] = !bounds[i].IsValid() || frustum.Overlaps(bounds[i]) ? 1 : 0;
+                scalarVisible += expected[i];
+            }
+        }
+        const double scalarMs = ElapsedMs(start) / frames;
+
+        scene::FrustumCuller culler;
+        culler.Reserve(count);
+        for (const scene::AABB& box : bounds)
+        {
+            culler.Add(box);
+        }
+
+        std::vector<uint8_t> visible;
+        size_t mismatches = 0;
+        scene::FrustumCuller::Stats stats;
+        const auto timeCuller = [&](WorkStealingThreadPool* pool)
+        {
+            mismatches = 0;
+            const auto begin = Clock::now();
+            double checkMs = 0.0;
+            for (const scene::Frustum& frustum : frustums)
+            {
+                stats = culler.Cull(frustum, visible, pool);
+
+                const auto checkStart = Clock::now();
+                for (int i = 0; i < count; i++)
+                {
+                    const bool overlaps = !bounds[i].IsValid() || frustum.Overlaps(bounds[i]);
+                    mismatches += (visible[i] != 0) != overlaps ? 1 : 0;
+                }
+                checkMs += ElapsedMs(checkStart);
+            }
+            return (ElapsedMs(begin) - checkMs) / frames;
+        };
+        const double simdMs = timeCuller(nullptr);
+        const size_t simdMismatches = mismatches;
+        const double parallelMs = timeCuller(&threadPool);
+        const size_t parallelMismatches = mismatches;
+
+        std::printf("%7d submeshes, last frame %zu visible %zu culled\n", count, stats.visible, stats.culled);
+        std::printf("  one box at a time %8.3f ms/frame (%zu visible)\n", scalarMs, scalarVisible);
+        std::printf("  four wide         %8.3f ms/frame %6.2fx %s\n", simdMs, scalarMs / simdMs,
+                    simdMismatches == 0 ? "" : "MISMATCH");
+        std::printf("  four wide, %zu workers %5.3f ms/frame %6.2fx %s\n", threadPool.GetWorkerCount(), parallelMs,
+                    scalarMs / parallelMs, parallelMismatches == 0 ? "" : "MISMATCH");
+        return simdMismatches == 0 && parallelMismatches == 0;
+    }
+}
+
+int main()
+{
+    WorkStealingThreadPool threadPool(4);
+    bool matches = true;
+    for (int count : {1001, 25001, 250001})
+    {
+        matches = BenchCulling(count, 50, threadPool) && matches;
+    }
+    return matches ? 0 : 1;
+}
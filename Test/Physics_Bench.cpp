@@ -0,0 +1,942 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "Async/PriorityThreadPool.hpp"
+#include "Body.h"
+#include "BodyStorage.h"
+#include "Broadphase.h"
+#include "GJK.h"
+#include "Math/LCP.h"
+#include "Math/MathBatch.h"
+#include "PhysicsWorld.h"
+
+// Count heap allocations so the benchmarks can show which paths are allocation free
+static std::atomic<size_t> g_allocationCount{0};
+
+// The replacements below pair malloc with free, GCC only sees that new got inlined next to a free
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(size_t size)
+{
+    g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept
+{
+    std::free(ptr);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps results alive so the optimizer can't drop the benchmarked work
+    volatile float g_sink = 0.0f;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    float RandomRange(float min, float max)
+    {
+        return min + (max - min) * (static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX));
+    }
+
+    /// Spheres resting on a grid, a few of them moving
+    void BuildRestingScene(std::vector<Body>& bodies, ShapeSphere& shape, int num, float movingFraction)
+    {
+        std::srand(1234);
+        bodies.resize(num);
+
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(num))));
+        for (int i = 0; i < num; i++)
+        {
+            Body& body = bodies[i];
+            body.m_position = Vec3(static_cast<float>(i % side) * 1.05f, 0.0f, static_cast<float>(i / side) * 1.05f);
+            body.m_orientation = Quat(0, 0, 0, 1);
+            body.m_linearVelocity.Zero();
+            body.m_angularVelocity.Zero();
+            body.m_invMass = 1.0f;
+            body.m_elasticity = 0.5f;
+            body.m_friction = 0.5f;
+            body.m_shape = &shape;
+
+            if (RandomRange(0.0f, 1.0f) < movingFraction)
+            {
+                body.m_linearVelocity = Vec3(RandomRange(-2, 2), RandomRange(-2, 2), RandomRange(-2, 2));
+            }
+        }
+    }
+
+    /// Spheres scattered through a large volume, all of them moving
+    void BuildSpreadScene(std::vector<Body>& bodies, ShapeSphere& shape, int num)
+    {
+        std::srand(1234);
+        bodies.resize(num);
+
+        const float extent = std::cbrt(static_cast<float>(num)) * 8.0f;
+        for (int i = 0; i < num; i++)
+        {
+            Body& body = bodies[i];
+            body.m_position = Vec3(RandomRange(0, extent), RandomRange(0, extent), RandomRange(0, extent));
+            body.m_orientation = Quat(0, 0, 0, 1);
+            body.m_linearVelocity = Vec3(RandomRange(-2, 2), RandomRange(-2, 2), RandomRange(-2, 2));
+            body.m_angularVelocity.Zero();
+            body.m_invMass = 1.0f;
+            body.m_elasticity = 0.5f;
+            body.m_friction = 0.5f;
+            body.m_shape = &shape;
+        }
+    }
+
+    void MoveBodies(std::vector<Body>& bodies, float dt)
+    {
+        for (auto& body : bodies)
+        {
+            body.m_position += body.m_linearVelocity * dt;
+        }
+    }
+
+    template <typename BuildScene, typename Step>
+    double RunBroadphase(const BuildScene& buildScene, const Step& step, int steps, size_t& pairsPerStep)
+    {
+        const float dt = 1.0f / 60.0f;
+        std::vector<Body> bodies;
+        std::vector<collisionPair_t> pairs;
+        buildScene(bodies);
+
+        size_t totalPairs = 0;
+        const auto start = Clock::now();
+        for (int i = 0; i < steps; i++)
+        {
+            MoveBodies(bodies, dt);
+            step(bodies, pairs, dt);
+            totalPairs += pairs.size();
+        }
+        pairsPerStep = totalPairs / steps;
+        return ElapsedMs(start) / steps;
+    }
+
+    template <typename BuildScene>
+    void BenchBroadphase(const char* sceneName, const BuildScene& buildScene, int num, int steps)
+    {
+        size_t pairs1D = 0;
+        const double ms1D = RunBroadphase(buildScene, [](std::vector<Body>& bodies, std::vector<collisionPair_t>& pairs, float dt)
+        {
+            SweepAndPrune1D(bodies.data(), static_cast<int>(bodies.size()), pairs, dt);
+        }, steps, pairs1D);
+
+        SweepAndPrune sap;
+        size_t pairsSAP = 0;
+        const double msSAP = RunBroadphase(buildScene, [&sap](std::vector<Body>& bodies, std::vector<collisionPair_t>& pairs, float dt)
+        {
+            sap.Update(bodies.data(), static_cast<int>(bodies.size()), pairs, dt);
+        }, steps, pairsSAP);
+
+        BVHBroadPhase bvh;
+        size_t pairsBVH = 0;
+        const double msBVH = RunBroadphase(buildScene, [&bvh](std::vector<Body>& bodies, std::vector<collisionPair_t>& pairs, float dt)
+        {
+            bvh.Update(bodies.data(), static_cast<int>(bodies.size()), pairs, dt);
+        }, steps, pairsBVH);
+
+        std::printf("Broadphase %-7s %6d bodies | SweepAndPrune1D %9.3f ms %9zu pairs | SweepAndPrune %7.3f ms %7zu pairs | BVHBroadPhase %7.3f ms %7zu pairs\n",
+                    sceneName, num, ms1D, pairs1D, msSAP, pairsSAP, msBVH, pairsBVH);
+    }
+
+    void BenchBroadphase(int num, int steps)
+    {
+        ShapeSphere shape(0.5f);
+        BenchBroadphase("resting", [&](std::vector<Body>& bodies) { BuildRestingScene(bodies, shape, num, 0.05f); }, num, steps);
+        BenchBroadphase("spread", [&](std::vector<Body>& bodies) { BuildSpreadScene(bodies, shape, num); }, num, steps);
+    }
+
+    /// Columns of spheres dropped onto a large static ground sphere
+    void BuildDropScene(PhysicsWorld& world, ShapeSphere& shape, ShapeSphere& groundShape, int num)
+    {
+        std::srand(1234);
+        world.m_bodies.resize(num + 1);
+
+        const int side = static_cast<int>(std::ceil(std::sqrt(num / 16.0f)));
+        for (int i = 0; i < num; i++)
+        {
+            const int x = i % side;
+            const int y = (i / side) % side;
+            const int z = i / (side * side);
+
+            Body& body = world.m_bodies[i];
+            body.m_position = Vec3(static_cast<float>(x - side / 2) * 1.2f, static_cast<float>(y - side / 2) * 1.2f, 1.0f + static_cast<float>(z) * 1.2f);
+            body.m_orientation = Quat(0, 0, 0, 1);
+            body.m_linearVelocity = Vec3(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            body.m_angularVelocity.Zero();
+            body.m_invMass = 1.0f;
+            body.m_elasticity = 0.5f;
+            body.m_friction = 0.5f;
+            body.m_shape = &shape;
+        }
+
+        Body& ground = world.m_bodies[num];
+        ground.m_position = Vec3(0, 0, -1000);
+        ground.m_orientation = Quat(0, 0, 0, 1);
+        ground.m_linearVelocity.Zero();
+        ground.m_angularVelocity.Zero();
+        ground.m_invMass = 0.0f;
+        ground.m_elasticity = 1.0f;
+        ground.m_friction = 0.5f;
+        ground.m_shape = &groundShape;
+    }
+
+    double PositionChecksum(const PhysicsWorld& world)
+    {
+        double sum = 0.0;
+        for (const auto& body : world.m_bodies)
+        {
+            sum += body.m_position.x + body.m_position.y * 3.0 + body.m_position.z * 7.0;
+        }
+        return sum;
+    }
+
+    /// Returns false when the bodies end up elsewhere than with one thread
+    bool BenchWorld(int threads, int num, int steps, double& baselineMs, double& baselineChecksum)
+    {
+        ShapeSphere shape(0.5f);
+        ShapeSphere groundShape(1000.0f);
+        PhysicsWorld world;
+        BuildDropScene(world, shape, groundShape, num);
+
+        // The calling thread runs one of the tasks
+        std::unique_ptr<PriorityThreadPool> pool;
+        if (threads > 1)
+        {
+            pool = std::make_unique<PriorityThreadPool>(threads - 1);
+            world.SetThreadPool(pool.get(), threads);
+        }
+
+        const float dt = 1.0f / 60.0f;
+        size_t islands = 0;
+        size_t contacts = 0;
+        size_t manifolds = 0;
+        const auto start = Clock::now();
+        for (int i = 0; i < steps; i++)
+        {
+            world.Step(dt);
+            islands += world.GetNumIslands();
+            contacts += world.GetNumContacts();
+            manifolds += world.GetNumManifolds();
+        }
+        const double ms = ElapsedMs(start) / steps;
+        const double checksum = PositionChecksum(world);
+
+        if (threads == 1)
+        {
+            baselineMs = ms;
+            baselineChecksum = checksum;
+        }
+
+        std::printf("PhysicsWorld %6d bodies %2d threads | %8.3f ms/step | speedup %5.2fx | %6zu islands %6zu manifolds %6zu toi contacts | checksum %.6f %s\n",
+                    num, threads, ms, baselineMs / ms, islands / steps, manifolds / steps, contacts / steps, checksum,
+                    checksum == baselineChecksum ? "(matches 1 thread)" : "(DIFFERS from 1 thread)");
+        return checksum == baselineChecksum;
+    }
+
+    bool BenchWorld(int num, int steps)
+    {
+        const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+        std::vector<int> threadCounts = {1, 2, 4, 8};
+        if (std::find(threadCounts.begin(), threadCounts.end(), hardwareThreads) == threadCounts.end())
+        {
+            threadCounts.push_back(hardwareThreads);
+        }
+
+        double baselineMs = 0.0;
+        double baselineChecksum = 0.0;
+        bool matches = true;
+        for (int threads : threadCounts)
+        {
+            matches = BenchWorld(threads, num, steps, baselineMs, baselineChecksum) && matches;
+        }
+        return matches;
+    }
+
+    void BenchIntegration(int num, int steps)
+    {
+        const float dt = 1.0f / 60.0f;
+        ShapeSphere shape(0.5f);
+
+        std::srand(4321);
+        std::vector<Body> bodies(num);
+        for (Body& body : bodies)
+        {
+            body.m_position = Vec3(RandomRange(-500, 500), RandomRange(-500, 500), RandomRange(-500, 500));
+            body.m_orientation = Quat(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            body.m_orientation.Normalize();
+            body.m_linearVelocity = Vec3(RandomRange(-5, 5), RandomRange(-5, 5), RandomRange(-5, 5));
+            body.m_invMass = 1.0f;
+            body.m_shape = &shape;
+        }
+
+        // Half of the bodies spin, the rest only translate
+        for (int i = 0; i < num; i += 2)
+        {
+            bodies[i].m_angularVelocity = Vec3(RandomRange(-3, 3), RandomRange(-3, 3), RandomRange(-3, 3));
+        }
+
+        BodyStorage storage;
+        storage.Reserve(num);
+        for (const Body& body : bodies)
+        {
+            storage.Add(body);
+        }
+
+        auto start = Clock::now();
+        for (int step = 0; step < steps; step++)
+        {
+            for (Body& body : bodies)
+            {
+                body.Update(dt);
+            }
+        }
+        const double aosMs = ElapsedMs(start) / steps;
+
+        start = Clock::now();
+        for (int step = 0; step < steps; step++)
+        {
+            storage.IntegrateAll(dt);
+        }
+        const double soaMs = ElapsedMs(start) / steps;
+
+        // Tensor reads right after integrating rebuild the cache, the second pass reuses it
+        start = Clock::now();
+        float sink = 0.0f;
+        for (int i = 0; i < num; i++)
+        {
+            sink += bodies[i].GetInverseInertiaTensorWorldSpace().rows[0].x;
+        }
+        const double bodyTensorNs = ElapsedMs(start) * 1e6 / num;
+
+        double cachedTensorNs[2];
+        for (double& ns : cachedTensorNs)
+        {
+            start = Clock::now();
+            for (int i = 0; i < num; i++)
+            {
+                sink += storage.GetInverseInertiaTensorWorldSpace(i).rows[0].x;
+            }
+            ns = ElapsedMs(start) * 1e6 / num;
+        }
+        g_sink = sink;
+
+        float maxError = 0.0f;
+        for (int i = 0; i < num; i++)
+        {
+            maxError = std::max(maxError, (bodies[i].m_position - storage.m_positions[i]).GetMagnitude());
+        }
+
+        std::printf("Integrate %6d bodies | Body::Update %7.3f ms | IntegrateAll %7.3f ms | %5.2fx | max position error %g\n",
+                    num, aosMs, soaMs, aosMs / soaMs, maxError);
+        std::printf("Inverse inertia world space | Body %6.1f ns | storage rebuild %6.1f ns | cached %6.1f ns\n",
+                    bodyTensorNs, cachedTensorNs[0], cachedTensorNs[1]);
+    }
+
+    void BenchGJK(int numPairs, int frames)
+    {
+        const Vec3 boxPoints[2] = {Vec3(-0.5f), Vec3(0.5f)};
+        ShapeBox box(boxPoints, 2);
+
+        std::srand(2468);
+        std::vector<Vec3> cloud(256);
+        for (Vec3& pt : cloud)
+        {
+            pt = Vec3(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            pt.Normalize();
+            pt *= 0.6f;
+        }
+        ShapeConvex hull(cloud.data(), static_cast<int>(cloud.size()));
+
+        // Resting and slightly overlapping pairs, the kind of contact that persists over many frames
+        std::vector<Body> bodiesA(numPairs), bodiesB(numPairs);
+        for (int i = 0; i < numPairs; i++)
+        {
+            bodiesA[i].m_shape = &box;
+            bodiesA[i].m_orientation = Quat(Vec3(0, 0, 1), RandomRange(-0.3f, 0.3f));
+            bodiesB[i].m_shape = (i & 1) ? static_cast<Shape*>(&hull) : static_cast<Shape*>(&box);
+            bodiesB[i].m_position = Vec3(RandomRange(-0.2f, 0.2f), RandomRange(-0.2f, 0.2f), RandomRange(1.0f, 1.1f));
+            bodiesB[i].m_orientation = Quat(Vec3(1, 0, 0), RandomRange(-0.3f, 0.3f));
+        }
+
+        std::vector<gjkCache_t> caches(numPairs);
+        double coldMs = 0.0;
+        double warmMs = 0.0;
+        long long coldIterations = 0;
+        long long warmIterations = 0;
+        float sink = 0.0f;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            // Jitter the upper bodies a little, like a settling stack
+            for (int i = 0; i < numPairs; i++)
+            {
+                bodiesB[i].m_position.z += (frame & 1) ? 0.001f : -0.001f;
+                bodiesB[i].m_orientation = bodiesB[i].m_orientation * Quat(Vec3(0, 1, 0), 0.001f);
+            }
+
+            Vec3 ptOnA, ptOnB, normal;
+            auto start = Clock::now();
+            for (int i = 0; i < numPairs; i++)
+            {
+                gjkCache_t cold;
+                GJK_Query(&bodiesA[i], &bodiesB[i], 0.001f, ptOnA, ptOnB, normal, &cold);
+                coldIterations += cold.numIterations;
+                sink += ptOnA.z;
+            }
+            coldMs += ElapsedMs(start);
+
+            start = Clock::now();
+            for (int i = 0; i < numPairs; i++)
+            {
+                GJK_Query(&bodiesA[i], &bodiesB[i], 0.001f, ptOnA, ptOnB, normal, &caches[i]);
+                warmIterations += (frame > 0) ? caches[i].numIterations : 0;
+                sink += ptOnA.z;
+            }
+            if (frame > 0)
+            {
+                warmMs += ElapsedMs(start);
+            }
+        }
+        g_sink = sink;
+
+        const double queries = static_cast<double>(numPairs) * frames;
+        const double warmQueries = static_cast<double>(numPairs) * (frames - 1);
+        std::printf("GJK+EPA %5d pairs | cold %7.1f ns %5.2f supports | warm %7.1f ns %5.2f supports\n",
+                    numPairs, coldMs * 1e6 / queries, coldIterations / queries,
+                    warmMs * 1e6 / warmQueries, warmIterations / warmQueries);
+    }
+
+    /// A single column of boxes on a static ground box
+    void BuildStackScene(PhysicsWorld& world, ShapeBox& box, ShapeBox& groundBox, int height)
+    {
+        std::srand(1357);
+        world.m_bodies.resize(height + 1);
+
+        for (int i = 0; i < height; i++)
+        {
+            // A little jitter so the boxes don't land perfectly aligned
+            Body& body = world.m_bodies[i];
+            body.m_position = Vec3(RandomRange(-0.02f, 0.02f), RandomRange(-0.02f, 0.02f), 0.5f + static_cast<float>(i) * 1.01f);
+            body.m_orientation = Quat(Vec3(0, 0, 1), RandomRange(-0.05f, 0.05f));
+            body.m_linearVelocity.Zero();
+            body.m_angularVelocity.Zero();
+            body.m_invMass = 1.0f;
+            body.m_elasticity = 0.0f;
+            body.m_friction = 0.8f;
+            body.m_shape = &box;
+        }
+
+        Body& ground = world.m_bodies[height];
+        ground.m_position = Vec3(0, 0, -5);
+        ground.m_orientation = Quat(0, 0, 0, 1);
+        ground.m_linearVelocity.Zero();
+        ground.m_angularVelocity.Zero();
+        ground.m_invMass = 0.0f;
+        ground.m_elasticity = 1.0f;
+        ground.m_friction = 0.8f;
+        ground.m_shape = &groundBox;
+    }
+
+    void BenchStack(int height, int iterations, bool warmStart, int steps)
+    {
+        const Vec3 boxPoints[2] = {Vec3(-0.5f), Vec3(0.5f)};
+        const Vec3 groundPoints[2] = {Vec3(-20, -20, -5), Vec3(20, 20, 5)};
+        ShapeBox box(boxPoints, 2);
+        ShapeBox groundBox(groundPoints, 2);
+
+        PhysicsWorld world;
+        BuildStackScene(world, box, groundBox, height);
+        world.m_numSolverIterations = iterations;
+        world.m_warmStarting = warmStart;
+
+        // A sleeping stack would pass as settled without the solver getting it there
+        world.m_allowSleeping = false;
+
+        // At rest once every box stayed slow for half a second
+        const float dt = 1.0f / 60.0f;
+        const float restSpeed = 0.05f;
+        int restingSince = -1;
+        int settledStep = -1;
+        const auto start = Clock::now();
+        for (int i = 0; i < steps; i++)
+        {
+            world.Step(dt);
+
+            float maxSpeed = 0.0f;
+            for (int j = 0; j < height; j++)
+            {
+                maxSpeed = std::max(maxSpeed, world.m_bodies[j].m_linearVelocity.GetMagnitude());
+            }
+
+            if (maxSpeed > restSpeed)
+            {
+                restingSince = -1;
+                settledStep = -1;
+            }
+            else if (restingSince < 0)
+            {
+                restingSince = i;
+            }
+            else if (settledStep < 0 && i - restingSince >= 30)
+            {
+                settledStep = restingSince;
+            }
+        }
+        const double ms = ElapsedMs(start) / steps;
+
+        // How far the top box ended up from where a perfect stack would put it
+        const Vec3& top = world.m_bodies[height - 1].m_position;
+        const float drift = std::sqrt(top.x * top.x + top.y * top.y);
+        const float sag = (0.5f + static_cast<float>(height - 1)) - top.z;
+
+        char settled[32];
+        if (sag > 0.5f)
+        {
+            std::snprintf(settled, sizeof(settled), " collapsed");
+        }
+        else if (settledStep >= 0)
+        {
+            std::snprintf(settled, sizeof(settled), "%4d steps", settledStep);
+        }
+        else
+        {
+            std::snprintf(settled, sizeof(settled), "     never");
+        }
+        const bool isDefault = iterations == PhysicsWorld().m_numSolverIterations;
+        std::printf("Stack %2d boxes %2d iterations%s warm start %-3s | %7.3f ms/step | at rest after %s | top drift %6.3f sag %6.3f\n",
+                    height, iterations, isDefault ? " (default)" : "          ", warmStart ? "on" : "off", ms, settled,
+                    drift, sag);
+    }
+
+    void BenchStack(int height, int steps)
+    {
+        // Always includes the default count, that's the one that has to bring the stack to rest
+        std::vector<int> counts = {4, 8, 16};
+        const int defaultIterations = PhysicsWorld().m_numSolverIterations;
+        if (std::find(counts.begin(), counts.end(), defaultIterations) == counts.end())
+        {
+            counts.insert(std::upper_bound(counts.begin(), counts.end(), defaultIterations), defaultIterations);
+        }
+        for (int iterations : counts)
+        {
+            BenchStack(height, iterations, false, steps);
+            BenchStack(height, iterations, true, steps);
+        }
+    }
+
+    /// A fast ball bouncing between two thin static walls, several times per step
+    void BuildCorridorScene(PhysicsWorld& world, ShapeSphere& ball, ShapeBox& wall, float speed)
+    {
+        world.m_gravity.Zero();
+        world.m_bodies.resize(3);
+
+        Body& body = world.m_bodies[0];
+        body.m_position.Zero();
+        body.m_orientation = Quat(0, 0, 0, 1);
+        body.m_linearVelocity = Vec3(speed, 0, 0);
+        body.m_angularVelocity.Zero();
+        body.m_invMass = 1.0f;
+        body.m_elasticity = 1.0f;
+        body.m_friction = 0.0f;
+        body.m_shape = &ball;
+
+        for (int i = 1; i < 3; i++)
+        {
+            Body& side = world.m_bodies[i];
+            side.m_position = Vec3(i == 1 ? -0.55f : 0.55f, 0, 0);
+            side.m_orientation = Quat(0, 0, 0, 1);
+            side.m_linearVelocity.Zero();
+            side.m_angularVelocity.Zero();
+            side.m_invMass = 0.0f;
+            side.m_elasticity = 1.0f;
+            side.m_friction = 0.0f;
+            side.m_shape = &wall;
+        }
+    }
+
+    /// Returns false when the ball left the corridor
+    bool BenchProjectile(float speed, int maxSubsteps, int stepsPerFrame, int frames)
+    {
+        const Vec3 wallPoints[2] = {Vec3(-0.05f, -5, -5), Vec3(0.05f, 5, 5)};
+        ShapeSphere ball(0.1f);
+        ShapeBox wall(wallPoints, 2);
+
+        PhysicsWorld world;
+        BuildCorridorScene(world, ball, wall, speed);
+        world.m_maxSubsteps = maxSubsteps;
+
+        const float dt = 1.0f / 60.0f / static_cast<float>(stepsPerFrame);
+        int escapedFrame = -1;
+        int frame = 0;
+        const auto start = Clock::now();
+        for (; frame < frames && escapedFrame < 0; frame++)
+        {
+            for (int i = 0; i < stepsPerFrame; i++)
+            {
+                world.Step(dt);
+            }
+            if (std::fabs(world.m_bodies[0].m_position.x) > 0.5f)
+            {
+                escapedFrame = frame;
+            }
+        }
+        const double ms = ElapsedMs(start) / frame;
+
+        char escaped[32];
+        if (escapedFrame >= 0)
+        {
+            std::snprintf(escaped, sizeof(escaped), "escaped in frame %d", escapedFrame);
+        }
+        else
+        {
+            std::snprintf(escaped, sizeof(escaped), "contained");
+        }
+        std::printf("Projectile %4.0f m/s %2d substeps %2d steps/frame | %7.4f ms/frame | %s\n",
+                    speed, maxSubsteps, stepsPerFrame, ms, escaped);
+        return escapedFrame < 0;
+    }
+
+    /// Returns false when the ball escaped with the default substeps
+    bool BenchProjectile(float speed, int frames)
+    {
+        // Crossing the 0.8m gap takes a fraction of a 60Hz step, so it bounces several times per step
+        BenchProjectile(speed, 0, 1, frames);
+        BenchProjectile(speed, 0, 8, frames);
+        const bool contained = BenchProjectile(speed, PhysicsWorld().m_maxSubsteps, 1, frames);
+        BenchProjectile(speed, 16, 1, frames);
+        return contained;
+    }
+
+    /// A grid of boxes resting apart on a static ground box
+    void BuildRestingBoxesScene(PhysicsWorld& world, ShapeBox& box, ShapeBox& groundBox, int num)
+    {
+        world.m_bodies.resize(num + 1);
+
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(num))));
+        for (int i = 0; i < num; i++)
+        {
+            Body& body = world.m_bodies[i];
+            body.m_position = Vec3(static_cast<float>(i % side - side / 2) * 2.0f, static_cast<float>(i / side - side / 2) * 2.0f, 0.5f);
+            body.m_orientation = Quat(0, 0, 0, 1);
+            body.m_linearVelocity.Zero();
+            body.m_angularVelocity.Zero();
+            body.m_invMass = 1.0f;
+            body.m_elasticity = 0.0f;
+            body.m_friction = 0.8f;
+            body.m_shape = &box;
+        }
+
+        Body& ground = world.m_bodies[num];
+        ground.m_position = Vec3(0, 0, -5);
+        ground.m_orientation = Quat(0, 0, 0, 1);
+        ground.m_linearVelocity.Zero();
+        ground.m_angularVelocity.Zero();
+        ground.m_invMass = 0.0f;
+        ground.m_elasticity = 1.0f;
+        ground.m_friction = 0.8f;
+        ground.m_shape = &groundBox;
+    }
+
+    void BenchSleeping(int num, bool allowSleeping, int steps, double& baselineMs)
+    {
+        const int side = static_cast<int>(std::ceil(std::sqrt(static_cast<float>(num))));
+        const Vec3 boxPoints[2] = {Vec3(-0.5f), Vec3(0.5f)};
+        const Vec3 groundPoints[2] = {Vec3(static_cast<float>(-side - 2), static_cast<float>(-side - 2), -5.0f), Vec3(static_cast<float>(side + 2), static_cast<float>(side + 2), 5.0f)};
+        ShapeBox box(boxPoints, 2);
+        ShapeBox groundBox(groundPoints, 2);
+
+        PhysicsWorld world;
+        BuildRestingBoxesScene(world, box, groundBox, num);
+        world.m_allowSleeping = allowSleeping;
+
+        // Every tenth box is thrown up once a second and stays busy, the rest only lie there.
+        // The impulse has to wake the boxes by itself.
+        const float dt = 1.0f / 60.0f;
+        const int warmupSteps = 60;
+        size_t awake = 0;
+        float maxHeight = 0.0f;
+        auto start = Clock::now();
+        for (int i = 0; i < warmupSteps + steps; i++)
+        {
+            if (i == warmupSteps)
+            {
+                start = Clock::now();
+            }
+
+            if (i % 60 == 0)
+            {
+                for (int j = 0; j < num; j += 10)
+                {
+                    world.m_bodies[j].ApplyImpulseLinear(Vec3(0, 0, 4));
+                }
+            }
+
+            world.Step(dt);
+
+            if (i >= warmupSteps)
+            {
+                for (int j = 0; j < num; j++)
+                {
+                    awake += world.m_bodies[j].m_isAwake ? 1 : 0;
+                    maxHeight = std::max(maxHeight, world.m_bodies[j].m_position.z);
+                }
+            }
+        }
+        const double ms = ElapsedMs(start) / steps;
+
+        if (!allowSleeping)
+        {
+            baselineMs = ms;
+        }
+
+        std::printf("Sleeping %5d boxes | sleeping %-3s | %7.3f ms/step | speedup %5.2fx | %5zu awake | highest box %5.2f\n",
+                    num, allowSleeping ? "on" : "off", ms, baselineMs / ms, awake / steps, maxHeight);
+    }
+
+    void BenchSleeping(int num, int steps)
+    {
+        double baselineMs = 0.0;
+        BenchSleeping(num, false, steps, baselineMs);
+        BenchSleeping(num, true, steps, baselineMs);
+    }
+
+    /// Mat3::Inverse before the adjugate was built from row cross products, nine cofactors that each call pow()
+    Mat3 InverseByCofactors(const Mat3& m)
+    {
+        Mat3 inv;
+        for (int i = 0; i < 3; i++)
+        {
+            for (int j = 0; j < 3; j++)
+            {
+                inv.rows[j][i] = static_cast<float>(std::pow(-1, i + 1 + j + 1)) * m.Minor(i, j).Determinant();
+            }
+        }
+        inv *= 1.0f / m.Determinant();
+        return inv;
+    }
+
+    template <typename Kernel>
+    void BenchKernel(const char* name, int count, int repeats, const Kernel& kernel)
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < repeats; i++)
+        {
+            kernel();
+        }
+        const double ns = ElapsedMs(start) * 1e6 / (static_cast<double>(count) * repeats);
+        std::printf("Math %-8s %-40s %7.2f ns/op\n", PHYSICS_SIMD_NAME, name, ns);
+    }
+
+    void BenchMath()
+    {
+        const int count = 4096;
+        const int repeats = 500;
+
+        std::srand(1234);
+        std::vector<Vec3> a(count), b(count), c(count);
+        std::vector<Vec4> v4(count), r4(count);
+        std::vector<float> dots(count);
+        std::vector<Quat> quats(count);
+        std::vector<Mat3> m3a(count), m3b(count), m3c(count);
+        std::vector<Mat4> m4a(count), m4b(count), m4c(count);
+        for (int i = 0; i < count; i++)
+        {
+            a[i] = Vec3(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            b[i] = Vec3(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            v4[i] = Vec4(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1), 1.0f);
+            quats[i] = Quat(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            quats[i].Normalize();
+            for (int r = 0; r < 3; r++)
+            {
+                m3a[i].rows[r] = Vec3(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+                m3b[i].rows[r] = Vec3(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+                m3a[i].rows[r][r] += 3.0f;
+            }
+            for (int r = 0; r < 4; r++)
+            {
+                m4a[i].rows[r] = Vec4(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+                m4b[i].rows[r] = Vec4(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            }
+        }
+
+        BenchKernel("Vec3::Dot", count, repeats, [&]() { for (int i = 0; i < count; i++) dots[i] = a[i].Dot(b[i]); });
+        BenchKernel("DotBatch", count, repeats, [&]() { DotBatch(a.data(), b.data(), dots.data(), count); });
+        BenchKernel("Vec3::Cross", count, repeats, [&]() { for (int i = 0; i < count; i++) c[i] = a[i].Cross(b[i]); });
+        BenchKernel("CrossBatch", count, repeats, [&]() { CrossBatch(a.data(), b.data(), c.data(), count); });
+        BenchKernel("Quat::RotatePoint", count, repeats, [&]() { for (int i = 0; i < count; i++) c[i] = quats[i].RotatePoint(a[i]); });
+        BenchKernel("RotateBatch", count, repeats, [&]() { RotateBatch(quats.data(), a.data(), c.data(), count); });
+        BenchKernel("Vec4::Dot", count, repeats, [&]() { for (int i = 0; i < count; i++) dots[i] = v4[i].Dot(v4[count - 1 - i]); });
+        BenchKernel("Mat3 * Mat3", count, repeats, [&]() { MulBatch(m3a.data(), m3b.data(), m3c.data(), count); });
+        BenchKernel("Mat3::Inverse", count, repeats, [&]() { for (int i = 0; i < count; i++) m3c[i] = m3a[i].Inverse(); });
+        BenchKernel("Mat3 inverse by cofactors", count, repeats / 10, [&]()
+        {
+            for (int i = 0; i < count; i++) m3c[i] = InverseByCofactors(m3a[i]);
+        });
+        BenchKernel("Mat4 * Mat4", count, repeats, [&]() { for (int i = 0; i < count; i++) m4c[i] = m4a[i] * m4b[i]; });
+        BenchKernel("Mat4 * Vec4", count, repeats, [&]() { for (int i = 0; i < count; i++) r4[i] = m4a[i] * v4[i]; });
+
+        ShapeSphere shape(0.5f);
+        std::vector<Body> bodies;
+        BuildSpreadScene(bodies, shape, count);
+        for (auto& body : bodies)
+        {
+            body.m_orientation = Quat(RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1), RandomRange(-1, 1));
+            body.m_orientation.Normalize();
+        }
+        BenchKernel("Body::GetInverseInertiaTensorWorldSpace", count, repeats / 5, [&]()
+        {
+            for (int i = 0; i < count; i++) m3c[i] = bodies[i].GetInverseInertiaTensorWorldSpace();
+        });
+        BenchKernel("GetInverseInertiaTensorsWorldSpace", count, repeats / 5, [&]()
+        {
+            GetInverseInertiaTensorsWorldSpace(bodies.data(), count, m3c.data());
+        });
+        BenchKernel("Body::GetCenterOfMassWorldSpace", count, repeats / 5, [&]()
+        {
+            for (int i = 0; i < count; i++) c[i] = bodies[i].GetCenterOfMassWorldSpace();
+        });
+        BenchKernel("GetCentersOfMassWorldSpace", count, repeats / 5, [&]()
+        {
+            GetCentersOfMassWorldSpace(bodies.data(), count, c.data());
+        });
+
+        g_sink = dots[count / 2] + c[count / 2].x + m3c[count / 2].rows[0].x + m4c[count / 2].rows[0].x + r4[count / 2].x;
+    }
+
+    /// Symmetric, diagonally dominant system like the ones built from constraint Jacobians
+    template <int N>
+    void BuildSystem(MatN<N>& A, VecN<N>& b, float drift)
+    {
+        MatN<N> B;
+        for (int i = 0; i < N; i++)
+        {
+            for (int j = 0; j < N; j++)
+            {
+                B.rows[i][j] = std::sin(static_cast<float>(i * N + j) + drift);
+            }
+            b[i] = std::cos(static_cast<float>(i) + drift);
+        }
+
+        MatN<N> Bt = B;
+        Bt.Transpose();
+        A = B * Bt;
+        for (int i = 0; i < N; i++)
+        {
+            A.rows[i][i] += static_cast<float>(N);
+        }
+    }
+
+    template <int N>
+    void BenchLCP(int frames)
+    {
+        const float tolerance = 1e-5f;
+        const int maxIterations = 64;
+
+        std::vector<MatN<N>> systems(frames);
+        std::vector<VecN<N>> rhs(frames);
+        for (int i = 0; i < frames; i++)
+        {
+            BuildSystem(systems[i], rhs[i], static_cast<float>(i) * 0.001f);
+        }
+
+        // Fixed N sweeps from zero, the same work the solver always did
+        float sink = 0.0f;
+        size_t allocations = g_allocationCount.load();
+        auto start = Clock::now();
+        for (int i = 0; i < frames; i++)
+        {
+            const VecN<N> x = LCP_GaussSeidel(systems[i], rhs[i]);
+            sink += x[0];
+        }
+        const double fixedNs = ElapsedMs(start) * 1e6 / frames;
+        const size_t fixedAllocations = g_allocationCount.load() - allocations;
+
+        // Cold start, iterate to the tolerance
+        int coldIterations = 0;
+        start = Clock::now();
+        for (int i = 0; i < frames; i++)
+        {
+            VecN<N> x;
+            x.Zero();
+            coldIterations += LCP_GaussSeidel(systems[i], rhs[i], x, maxIterations, tolerance);
+            sink += x[0];
+        }
+        const double coldNs = ElapsedMs(start) * 1e6 / frames;
+
+        // Warm start from the previous frame's solution
+        int warmIterations = 0;
+        VecN<N> x;
+        x.Zero();
+        allocations = g_allocationCount.load();
+        start = Clock::now();
+        for (int i = 0; i < frames; i++)
+        {
+            warmIterations += LCP_GaussSeidel(systems[i], rhs[i], x, maxIterations, tolerance);
+            sink += x[0];
+        }
+        const double warmNs = ElapsedMs(start) * 1e6 / frames;
+        const size_t warmAllocations = g_allocationCount.load() - allocations;
+
+        std::printf("LCP_GaussSeidel N=%2d | fixed %7.1f ns %zu allocs | cold %7.1f ns %5.1f iters | warm %7.1f ns %5.1f iters %zu allocs\n",
+                    N, fixedNs, fixedAllocations, coldNs, static_cast<double>(coldIterations) / frames,
+                    warmNs, static_cast<double>(warmIterations) / frames, warmAllocations);
+        g_sink = sink;
+    }
+}
+
+int main()
+{
+    BenchMath();
+
+    BenchLCP<6>(20000);
+    BenchLCP<12>(20000);
+    BenchLCP<24>(5000);
+
+    BenchBroadphase(1000, 60);
+    BenchBroadphase(4000, 60);
+    BenchBroadphase(16000, 20);
+
+    BenchIntegration(100000, 60);
+
+    BenchGJK(2000, 60);
+
+    BenchStack(10, 600);
+    bool contained = BenchProjectile(200.0f, 600);
+    contained = BenchProjectile(500.0f, 600) && contained;
+    BenchSleeping(2000, 300);
+
+    const bool matches = BenchWorld(10000, 120);
+    return (contained && matches) ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Engine/SceneGraph/Component.hpp"
+#include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Engine/SceneGraph/Components/Light.hpp"
+#include "Engine/SceneGraph/Components/Mesh.hpp"
+#include "Engine/SceneGraph/Components/SubMesh.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Prefab.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+#include "Engine/SceneGraph/SpatialIndex.hpp"
+#include "Engine/SceneGraph/TransformSystem.hpp"
+#include "Logging/Logger.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Health : scene::Component
+    {
+        float current = 100.0f;
+        float maximum = 100.0f;
+    };
+
+    struct Collider : scene::Component
+    {
+        glm::vec3 halfExtents = glm::vec3(0.5f);
+        float friction = 0.5f;
+        uint32_t layer = 0;
+    };
+
+    /// The imported geometry of the crate, shared by the submeshes of every prop
+    struct CrateData
+    {
+        CrateData()
+        {
+            body.bounds = scene::AABB(glm::vec3(-1.0f), glm::vec3(1.0f));
+            lid.bounds = scene::AABB(glm::vec3(-1.0f, -0.1f, -1.0f), glm::vec3(1.0f, 0.1f, 1.0f));
+            handle.bounds = scene::AABB(glm::vec3(-0.1f), glm::vec3(0.1f));
+        }
+
+        scene::MeshData body;
+        scene::MeshData lid;
+        scene::MeshData handle;
+    };
+
+    const CrateData& GetCrateData()
+    {
+        static const CrateData data;
+        return data;
+    }
+
+    scene::SubMesh* AddSubmesh(scene::ComponentManager& manager, scene::Mesh& mesh, scene::Node* node,
+                               const scene::MeshData& data)
+    {
+        scene::SubMesh* submesh = manager.AddComponent<scene::SubMesh>(node);
+        submesh->ModelPath = "Models/Crate.gltf";
+        submesh->set_mesh_data(const_cast<scene::MeshData*>(&data));
+        mesh.SetSubmesh(*submesh);
+        return submesh;
+    }
+
+    /// A crate with a body, a lid, two handles and a lamp, one node at a time, the only way to place a prop
+    /// before prefabs
+    scene::Node* SpawnProp(scene::Scene& scene, const glm::vec3& translation)
+    {
+        const CrateData& data = GetCrateData();
+        scene::ComponentManager& manager = *scene.GetComponentManager();
+        auto root = std::make_unique<scene::Node>(&scene, "Crate");
+        scene::Node* crate = root.get();
+        crate->GetTransform().SetTranslation(translation);
+        scene.AddNode(std::move(root));
+        manager.AddComponent<Health>(crate)->maximum = 250.0f;
+        scene::Mesh& mesh = *manager.AddComponent<scene::Mesh>(crate);
+
+        AddSubmesh(manager, mesh, crate->CreateChild("Body"), data.body);
+
+        scene::Node* lid = crate->CreateChild("Lid");
+        lid->GetTransform().SetTranslation(glm::vec3(0.0f, 1.0f, 0.0f));
+        AddSubmesh(manager, mesh, lid, data.lid);
+        Collider* collider = manager.AddComponent<Collider>(lid);
+        collider->halfExtents = glm::vec3(1.0f, 0.1f, 1.0f);
+        collider->layer = 2;
+
+        for (int side = 0; side < 2; side++)
+        {
+            scene::Node* handle = crate->CreateChild("Handle");
+            handle->GetTransform().SetTranslation(glm::vec3(side == 0 ? -1.0f : 1.0f, 0.5f, 0.0f));
+            AddSubmesh(manager, mesh, handle, data.handle);
+        }
+
+        scene::Node* lamp = crate->CreateChild("Lamp");
+        lamp->GetTransform().SetTranslation(glm::vec3(0.0f, 1.5f, 0.0f));
+        scene::Light* light = manager.AddComponent<scene::Light>(lamp);
+        light->set_light_type(scene::Point);
+        scene::LightProperties properties;
+        properties.color = glm::vec3(1.0f, 0.8f, 0.6f);
+        properties.intensity = 3.0f;
+        properties.range = 5.0f;
+        light->set_properties(properties);
+
+        return crate;
+    }
+
+    std::vector<glm::vec3> Placements(int count)
+    {
+        std::vector<glm::vec3> translations;
+        for (int i = 0; i < count; i++)
+        {
+            translations.emplace_back(static_cast<float>(i % 100) * 3.0f, 0.0f, static_cast<float>(i / 100) * 3.0f);
+        }
+        return translations;
+    }
+
+    /// Sums of the component values and the world positions, equal when both scenes hold the same props.
+    /// Negative when a mesh has a submesh of another prop or a submesh lost its mesh data.
+    double Checksum(scene::Scene& scene)
+    {
+        scene.GetTransformSystem().UpdateWorldMatrices();
+        scene::ComponentManager& manager = *scene.GetComponentManager();
+        double sum = 0.0;
+        for (const Health& health : manager.GetComponentsByClass<Health>())
+        {
+            sum += health.maximum;
+        }
+        for (const Collider& collider : manager.GetComponentsByClass<Collider>())
+        {
+            sum += collider.halfExtents.x + collider.friction + collider.layer;
+        }
+        for (const scene::Mesh& mesh : manager.GetComponentsByClass<scene::Mesh>())
+        {
+            for (size_t s = 0; s < mesh.GetSubmeshCount(); s++)
+            {
+                const scene::SubMesh* submesh = mesh.GetSubmesh(s);
+                if (!submesh || submesh->GetOwner()->GetParent() != mesh.GetOwner() || !submesh->bHasMeshData)
+                {
+                    return -1.0;
+                }
+                sum += submesh->get_bounds().max.x + submesh->GetOwner()->GetTransform().GetWorldMatrix()[3].x;
+            }
+        }
+        for (scene::Light& light : manager.GetComponentsByClass<scene::Light>())
+        {
+            if (light.get_node() != light.GetOwner())
+            {
+                return -1.0;
+            }
+            sum += light.get_light_type() + light.get_properties().intensity + light.get_properties().range +
+                   light.GetOwner()->GetTransform().GetWorldMatrix()[3].y;
+        }
+        return sum + static_cast<double>(scene.GetSpatialIndex().GetCount());
+    }
+
+    /// Returns false when the instances differ from the props built one by one. Each path runs a few times
+    /// into a fresh scene and keeps its best time, single runs vary too much on a busy machine.
+    bool BenchPrefab(int count)
+    {
+        constexpr int runs = 5;
+        const std::vector<glm::vec3> translations = Placements(count);
+
+        scene::Scene library("Library");
+        const scene::Prefab prefab(*SpawnProp(library, glm::vec3(0.0f)));
+
+        double oneByOneMs = 0.0;
+        double batchedMs = 0.0;
+        bool matches = true;
+        for (int run = 0; run < runs; run++)
+        {
+            scene::Scene oneByOne("OneByOne");
+            auto start = Clock::now();
+            for (const auto& translation : translations)
+            {
+                SpawnProp(oneByOne, translation);
+            }
+            const double oneByOneRunMs = ElapsedMs(start);
+
+            scene::Scene batched("Batched");
+            start = Clock::now();
+            const std::vector<scene::Node*> roots = prefab.Instantiate(batched, translations);
+            const double batchedRunMs = ElapsedMs(start);
+
+            oneByOneMs = (run == 0) ? oneByOneRunMs : std::min(oneByOneMs, oneByOneRunMs);
+            batchedMs = (run == 0) ? batchedRunMs : std::min(batchedMs, batchedRunMs);
+            matches = matches && roots.size() == translations.size() &&
+                      batched.GetTransformSystem().GetCount() == oneByOne.GetTransformSystem().GetCount() &&
+                      Checksum(batched) >= 0.0 && Checksum(batched) == Checksum(oneByOne);
+        }
+
+        std::printf("%6d props of %zu nodes and %zu components\n", count, prefab.GetNodeCount(),
+                    prefab.GetComponentCount());
+        std::printf("  one by one  %9.3f ms %12.0f instances/s\n", oneByOneMs, count * 1000.0 / oneByOneMs);
+        std::printf("  prefab      %9.3f ms %12.0f instances/s %6.2fx %s\n", batchedMs, count * 1000.0 / batchedMs,
+                    oneByOneMs / batchedMs, matches ? "" : "MISMATCH");
+        return matches;
+    }
+}
+
+int main()
+{
+    Logger::Init("Prefab_Bench");
+    bool matches = true;
+    for (int count : {500, 5000, 50000})
+    {
+        matches = BenchPrefab(count) && matches;
+    }
+    return matches ? 0 : 1;
+}
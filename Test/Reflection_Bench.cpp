@@ -0,0 +1,307 @@
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <rttr/registration>
+
+#include "Engine/SceneGraph/Component.hpp"
+#include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+#include "Engine/SceneGraph/SceneSerializer.hpp"
+#include "Logging/Logger.hpp"
+#include "Reflection/StaticRefl.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    volatile float g_sink = 0.0f;
+
+    /// The same fields, once described to RTTR and once with a ReflInfo
+    struct RttrBody : scene::Component
+    {
+        RTTR_ENABLE(scene::Component)
+    public:
+        glm::vec3 velocity = glm::vec3(0.0f);
+        float mass = 1.0f;
+        int32_t team = 0;
+        bool sleeping = false;
+    };
+
+    struct Body : scene::Component
+    {
+        glm::vec3 velocity = glm::vec3(0.0f);
+        float mass = 1.0f;
+        int32_t team = 0;
+        bool sleeping = false;
+    };
+
+    /// More component types, so the pool map of a scene has as many entries as a real one
+    template <typename T>
+    struct Tag : scene::Component
+    {
+        float value = static_cast<float>(sizeof(T));
+    };
+}
+
+RTTR_REGISTRATION
+{
+    rttr::registration::class_<RttrBody>("RttrBody")
+        .property("velocity", &RttrBody::velocity)
+        .property("mass", &RttrBody::mass)
+        .property("team", &RttrBody::team)
+        .property("sleeping", &RttrBody::sleeping);
+}
+
+REFL_INGO(Body)
+VARIABLES(VAR(&Body::velocity), VAR(&Body::mass), VAR(&Body::team), VAR(&Body::sleeping))
+REFL_END()
+
+namespace
+{
+    float Sum(float value) { return value; }
+
+    float Sum(int32_t value) { return static_cast<float>(value); }
+
+    float Sum(bool value) { return value ? 1.0f : 0.0f; }
+
+    float Sum(const glm::vec3& value) { return value.x + value.y + value.z; }
+
+    float Sum(const rttr::variant& value)
+    {
+        const rttr::type type = value.get_type();
+        if (type == rttr::type::get<float>())
+        {
+            return value.get_value<float>();
+        }
+        if (type == rttr::type::get<int32_t>())
+        {
+            return static_cast<float>(value.get_value<int32_t>());
+        }
+        if (type == rttr::type::get<bool>())
+        {
+            return value.get_value<bool>() ? 1.0f : 0.0f;
+        }
+        if (type == rttr::type::get<glm::vec3>())
+        {
+            return Sum(value.get_value<glm::vec3>());
+        }
+        return 0.0f;
+    }
+
+    template <typename... Types>
+    void AddComponents(scene::ComponentManager& manager, scene::Node* node)
+    {
+        (manager.AddComponent<Types>(node), ...);
+    }
+
+    /// How a pool was found before, an RTTR type hashed into an unordered_map, against the array indexed
+    /// by the dense id the ComponentManager uses now
+    void BenchPoolLookup(int count, int rounds)
+    {
+        scene::Scene scene("Lookup");
+        scene::ComponentManager& manager = *scene.GetComponentManager();
+        std::vector<scene::NodeID> ids;
+        for (int i = 0; i < count; i++)
+        {
+            auto node = std::make_unique<scene::Node>(&scene, "Node");
+            AddComponents<Tag<char>, Tag<short>, Tag<int>, Tag<long long>, Tag<float>, Tag<double>, Tag<bool>,
+                          Tag<void*>>(manager, node.get());
+            ids.push_back(node->GetID());
+            scene.AddNode(std::move(node));
+        }
+
+        std::unordered_map<rttr::type, scene::IComponentPool*> rttrPools;
+        const auto addPool = [&](auto* pool, rttr::type type) { rttrPools[type] = pool; };
+        addPool(&manager.GetComponentsByClass<Tag<char>>(), rttr::type::get<Tag<char>>());
+        addPool(&manager.GetComponentsByClass<Tag<short>>(), rttr::type::get<Tag<short>>());
+        addPool(&manager.GetComponentsByClass<Tag<int>>(), rttr::type::get<Tag<int>>());
+        addPool(&manager.GetComponentsByClass<Tag<long long>>(), rttr::type::get<Tag<long long>>());
+        addPool(&manager.GetComponentsByClass<Tag<float>>(), rttr::type::get<Tag<float>>());
+        addPool(&manager.GetComponentsByClass<Tag<double>>(), rttr::type::get<Tag<double>>());
+        addPool(&manager.GetComponentsByClass<Tag<bool>>(), rttr::type::get<Tag<bool>>());
+        addPool(&manager.GetComponentsByClass<Tag<void*>>(), rttr::type::get<Tag<void*>>());
+
+        const auto rttrLookup = [&rttrPools](scene::NodeID id)
+        {
+            auto* pool = static_cast<scene::ComponentPool<Tag<double>>*>(rttrPools.at(rttr::type::get<Tag<double>>()));
+            return pool->GetComponent(id);
+        };
+
+        float sum = 0.0f;
+        auto start = Clock::now();
+        for (int round = 0; round < rounds; round++)
+        {
+            for (scene::NodeID id : ids)
+            {
+                sum += rttrLookup(id)->value;
+            }
+        }
+        const double rttrMs = ElapsedMs(start);
+
+        start = Clock::now();
+        for (int round = 0; round < rounds; round++)
+        {
+            for (scene::NodeID id : ids)
+            {
+                sum += manager.GetComponentFormNode<Tag<double>>(id)->value;
+            }
+        }
+        const double denseMs = ElapsedMs(start);
+        g_sink = sum;
+
+        const double lookups = static_cast<double>(count) * rounds;
+        std::printf("Pool lookup, %d nodes with 8 component types, %d rounds\n", count, rounds);
+        std::printf("  rttr::type hash map %8.3f ms %6.2f ns/lookup\n", rttrMs, rttrMs * 1e6 / lookups);
+        std::printf("  dense type id       %8.3f ms %6.2f ns/lookup %6.2fx\n", denseMs, denseMs * 1e6 / lookups,
+                    rttrMs / denseMs);
+    }
+
+    /// Returns false when the static walk sums other values than RTTR
+    bool BenchPropertyIteration(int count)
+    {
+        std::vector<RttrBody> rttrBodies(count);
+        std::vector<Body> bodies(count);
+        for (int i = 0; i < count; i++)
+        {
+            rttrBodies[i].mass = bodies[i].mass = static_cast<float>(i % 7);
+            rttrBodies[i].team = bodies[i].team = i % 4;
+        }
+
+        // Every property by RTTR, how the serializer and a generic inspector walked a component
+        const rttr::type type = rttr::type::get<RttrBody>();
+        float rttrSum = 0.0f;
+        auto start = Clock::now();
+        for (auto& body : rttrBodies)
+        {
+            for (const auto& property : type.get_properties())
+            {
+                rttrSum += Sum(property.get_value(body));
+            }
+        }
+        const double rttrMs = ElapsedMs(start);
+
+        // A property looked up by name for every value, how DetailsPanel style code reads one field
+        float byNameSum = 0.0f;
+        start = Clock::now();
+        for (auto& body : rttrBodies)
+        {
+            byNameSum += Sum(type.get_property("mass").get_value(body));
+        }
+        const double byNameMs = ElapsedMs(start);
+
+        float staticSum = 0.0f;
+        start = Clock::now();
+        for (auto& body : bodies)
+        {
+            ForEachVariable(body, [&staticSum](std::string_view, const auto& value) { staticSum += Sum(value); });
+        }
+        const double staticMs = ElapsedMs(start);
+
+        float staticNameSum = 0.0f;
+        start = Clock::now();
+        for (auto& body : bodies)
+        {
+            ForEachVariable(body, [&staticNameSum](std::string_view name, const auto& value)
+            {
+                if (name == "mass")
+                {
+                    staticNameSum += Sum(value);
+                }
+            });
+        }
+        const double staticNameMs = ElapsedMs(start);
+        g_sink = rttrSum + byNameSum + staticSum + staticNameSum;
+
+        // The name property RTTR also walks adds nothing, the sums of the fields have to match
+        const bool matches = rttrSum == staticSum && byNameSum == staticNameSum;
+        std::printf("Property iteration, %d components of 4 fields\n", count);
+        std::printf("  rttr, every property    %8.3f ms\n", rttrMs);
+        std::printf("  static, every variable  %8.3f ms %7.2fx\n", staticMs, rttrMs / staticMs);
+        std::printf("  rttr, one by name       %8.3f ms\n", byNameMs);
+        std::printf("  static, one by name     %8.3f ms %7.2fx %s\n", staticNameMs, byNameMs / staticNameMs,
+                    matches ? "" : "MISMATCH");
+        return matches;
+    }
+
+    template <typename T>
+    void BuildBodies(scene::Scene& scene, int count)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            auto node = std::make_unique<scene::Node>(&scene, "Node");
+            T* body = scene.GetComponentManager()->AddComponent<T>(node.get());
+            body->SetName("Body");
+            body->velocity = glm::vec3(static_cast<float>(i));
+            body->mass = static_cast<float>(i % 7);
+            body->team = i % 4;
+            scene.AddNode(std::move(node));
+        }
+    }
+
+    template <typename T>
+    size_t CountMismatches(scene::Scene& scene)
+    {
+        auto& pool = scene.GetComponentManager()->GetComponentsByClass<T>();
+        size_t mismatches = 0;
+        for (size_t i = 0; i < pool.size(); i++)
+        {
+            const T& body = pool[i];
+            const bool matches = body.GetName() == "Body" && body.velocity == glm::vec3(static_cast<float>(i)) &&
+                                 body.mass == static_cast<float>(i % 7) && body.team == static_cast<int32_t>(i % 4);
+            mismatches += matches ? 0 : 1;
+        }
+        return mismatches;
+    }
+
+    /// Returns false when the loaded components differ from the saved ones
+    template <typename T>
+    bool BenchSerializer(const char* label, int count)
+    {
+        const auto path = std::filesystem::temp_directory_path() / "Reflection_Bench.scene";
+        scene::Scene source("Source");
+        BuildBodies<T>(source, count);
+
+        auto start = Clock::now();
+        scene::SceneSerializer::Save(source, path);
+        const double saveMs = ElapsedMs(start);
+
+        start = Clock::now();
+        auto loaded = scene::SceneSerializer::Load(path, "Loaded");
+        const double loadMs = ElapsedMs(start);
+
+        const size_t mismatches = loaded ? CountMismatches<T>(*loaded) : static_cast<size_t>(count);
+        const bool complete =
+            loaded && loaded->GetComponentManager()->GetComponentsByClass<T>().size() == static_cast<size_t>(count);
+        std::printf("  %-8s save %8.3f ms  load %8.3f ms  mismatches %zu %s\n", label, saveMs, loadMs, mismatches,
+                    complete ? "" : "MISMATCH");
+        std::filesystem::remove(path);
+        return mismatches == 0 && complete;
+    }
+}
+
+int main()
+{
+    Logger::Init("Reflection_Bench");
+    scene::SceneSerializer::RegisterComponent<RttrBody>();
+    scene::SceneSerializer::RegisterComponent<Body>();
+
+    BenchPoolLookup(100000, 20);
+    bool matches = BenchPropertyIteration(1000000);
+
+    std::printf("Scene serializer, 100000 components\n");
+    matches = BenchSerializer<RttrBody>("rttr", 100000) && matches;
+    matches = BenchSerializer<Body>("static", 100000) && matches;
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "Framework/Misc/ResourceMapGuard.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    /// Stands in for a pipeline or shader module, only built through the cache
+    struct Resource
+    {
+        std::size_t key = 0;
+        std::vector<uint8_t> blob;
+    };
+
+    std::atomic<size_t> g_builds{0};
+
+    /// A pipeline compile mostly waits on the driver, a sleep keeps the numbers about blocking and not about
+    /// how many cores the machine has
+    Resource Build(std::size_t key, std::chrono::microseconds buildTime)
+    {
+        std::this_thread::sleep_for(buildTime);
+        g_builds++;
+        return Resource{key, std::vector<uint8_t>(256, static_cast<uint8_t>(key))};
+    }
+
+    /// The old request_resource, one mutex held across the lookup and the build
+    class LockedCache
+    {
+    public:
+        Resource& Request(std::size_t key, std::chrono::microseconds buildTime)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = resources.find(key);
+            if (it == resources.end())
+            {
+                it = resources.emplace(key, Build(key, buildTime)).first;
+            }
+            return it->second;
+        }
+
+    private:
+        std::mutex mutex;
+        std::unordered_map<std::size_t, Resource> resources;
+    };
+
+    class GuardedCache
+    {
+    public:
+        Resource& Request(std::size_t key, std::chrono::microseconds buildTime)
+        {
+            return guard.request(resources, key, [&]() { return Build(key, buildTime); }, [](Resource&) {});
+        }
+
+    private:
+        vkb::ResourceMapGuard<Resource> guard;
+        std::unordered_map<std::size_t, Resource> resources;
+    };
+
+    struct Result
+    {
+        double wallMs = 0.0;
+        double meanHitUs = 0.0;
+        double maxHitUs = 0.0;
+        size_t builds = 0;
+        bool wrongResource = false;
+    };
+
+    /**
+     * Every thread asks for random hot keys and every missEvery-th request for the next new key, all threads
+     * walk the same new keys so they miss on them at about the same time, like recording threads meeting a
+     * new material
+     */
+    template <typename Cache>
+    Result Run(int threads, int requests, int hotKeys, int missEvery, std::chrono::microseconds buildTime)
+    {
+        Cache cache;
+        for (int key = 0; key < hotKeys; key++)
+        {
+            cache.Request(key, std::chrono::microseconds(0));
+        }
+        g_builds = 0;
+
+        std::atomic<int> ready{0};
+        std::atomic<bool> wrongResource{false};
+        std::vector<double> hitUs(threads, 0.0);
+        std::vector<double> maxHitUs(threads, 0.0);
+        std::vector<size_t> hits(threads, 0);
+
+        std::vector<std::thread> workers;
+        Clock::time_point start;
+        for (int thread = 0; thread < threads; thread++)
+        {
+            workers.emplace_back([&, thread]()
+            {
+                std::mt19937 random(thread);
+                std::uniform_int_distribution<int> hot(0, hotKeys - 1);
+
+                ready++;
+                while (ready.load() < threads)
+                {
+                    std::this_thread::yield();
+                }
+
+                for (int request = 0; request < requests; request++)
+                {
+                    const bool miss = request % missEvery == missEvery - 1;
+                    const std::size_t key = miss ? hotKeys + request / missEvery : hot(random);
+
+                    const auto begin = Clock::now();
+                    const Resource& resource = cache.Request(key, buildTime);
+                    const double us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+
+                    wrongResource = wrongResource || resource.key != key;
+                    if (!miss)
+                    {
+                        hitUs[thread] += us;
+                        maxHitUs[thread] = std::max(maxHitUs[thread], us);
+                        hits[thread]++;
+                    }
+                }
+            });
+        }
+        while (ready.load() < threads)
+        {
+            std::this_thread::yield();
+        }
+        start = Clock::now();
+        for (std::thread& worker : workers)
+        {
+            worker.join();
+        }
+
+        Result result;
+        result.wallMs = ElapsedMs(start);
+        size_t hitCount = 0;
+        for (int thread = 0; thread < threads; thread++)
+        {
+            result.meanHitUs += hitUs[thread];
+            result.maxHitUs = std::max(result.maxHitUs, maxHitUs[thread]);
+            hitCount += hits[thread];
+        }
+        result.meanHitUs /= static_cast<double>(std::max<size_t>(hitCount, 1));
+        result.builds = g_builds;
+        result.wrongResource = wrongResource;
+        return result;
+    }
+
+    /// Returns false when a cache built a key twice or returned the resource of another key
+    bool BenchResourceCache(int threads, int requests, int hotKeys, int missEvery, int buildUs)
+    {
+        const std::chrono::microseconds buildTime(buildUs);
+        const size_t newKeys = static_cast<size_t>(requests / missEvery);
+
+        const Result locked = Run<LockedCache>(threads, requests, hotKeys, missEvery, buildTime);
+        const Result guarded = Run<GuardedCache>(threads, requests, hotKeys, missEvery, buildTime);
+
+        const auto matches = [&](const Result& result) { return result.builds == newKeys && !result.wrongResource; };
+
+        std::printf("%d threads, %d requests each, %d hot keys, a new key every %d requests, %d us builds\n", threads,
+                    requests, hotKeys, missEvery, buildUs);
+        const auto print = [&](const char* name, const Result& result)
+        {
+            std::printf("  %-22s %9.2f ms  hits %8.3f us mean %9.1f us max  %4zu builds %s\n", name, result.wallMs,
+                        result.meanHitUs, result.maxHitUs, result.builds, matches(result) ? "" : "MISMATCH");
+        };
+        print("mutex across build", locked);
+        print("shared lock, in flight", guarded);
+        std::printf("  %6.2fx wall time %6.2fx mean hit\n", locked.wallMs / guarded.wallMs,
+                    locked.meanHitUs / guarded.meanHitUs);
+
+        return matches(locked) && matches(guarded);
+    }
+}
+
+int main()
+{
+    bool matches = BenchResourceCache(16, 20000, 512, 1000, 2000);
+    matches = BenchResourceCache(16, 20000, 512, 200, 500) && matches;
+    matches = BenchResourceCache(16, 200000, 4096, 100000, 5000) && matches;
+    return matches ? 0 : 1;
+}
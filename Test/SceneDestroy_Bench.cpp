@@ -0,0 +1,130 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Health
+    {
+        scene::Node* owner = nullptr;
+        float value = 100.0f;
+    };
+
+    struct Tag
+    {
+        scene::Node* owner = nullptr;
+        int value = 0;
+    };
+
+    /// A level of numRoots trees, every root with childrenPerRoot children, half of the nodes with components
+    std::vector<scene::Node*> LoadLevel(scene::Scene& scene, int numRoots, int childrenPerRoot)
+    {
+        std::vector<scene::Node*> roots;
+        for (int i = 0; i < numRoots; i++)
+        {
+            auto root = std::make_unique<scene::Node>(&scene, "Root");
+            scene.GetComponentManager()->AddComponent<Health>(root.get());
+            for (int j = 0; j < childrenPerRoot; j++)
+            {
+                scene::Node* child = root->CreateChild("Child");
+                if (j % 2 == 0)
+                {
+                    scene.GetComponentManager()->AddComponent<Tag>(child);
+                }
+            }
+            roots.push_back(root.get());
+            scene.AddNode(std::move(root));
+        }
+        return roots;
+    }
+
+    /// Marking before FlushDestroyed, a linear search for every marked node
+    double MarkWithLinearSearch(const std::vector<scene::Node*>& roots)
+    {
+        std::vector<scene::Node*> nodesToDestroy;
+        const auto start = Clock::now();
+        std::vector<scene::Node*> stack(roots.begin(), roots.end());
+        while (!stack.empty())
+        {
+            scene::Node* node = stack.back();
+            stack.pop_back();
+            if (std::find(nodesToDestroy.begin(), nodesToDestroy.end(), node) == nodesToDestroy.end())
+            {
+                nodesToDestroy.push_back(node);
+            }
+            for (const auto& child : node->GetChildren())
+            {
+                stack.push_back(child.get());
+            }
+        }
+        return ElapsedMs(start);
+    }
+
+    void BenchUnload(int numRoots, int childrenPerRoot, int levels)
+    {
+        const int numNodes = numRoots * (childrenPerRoot + 1);
+
+        double linearMs = 0.0;
+        {
+            scene::Scene scene("Linear");
+            const auto roots = LoadLevel(scene, numRoots, childrenPerRoot);
+            linearMs = MarkWithLinearSearch(roots);
+        }
+
+        scene::Scene scene("Levels");
+        double markMs = 0.0;
+        double flushMs = 0.0;
+        scene::NodeID highestID = 0;
+        for (int level = 0; level < levels; level++)
+        {
+            const auto roots = LoadLevel(scene, numRoots, childrenPerRoot);
+            for (const auto& node : scene.GetNodes())
+            {
+                highestID = std::max(highestID, node->GetID());
+                for (const auto& child : node->GetChildren())
+                {
+                    highestID = std::max(highestID, child->GetID());
+                }
+            }
+
+            auto start = Clock::now();
+            for (scene::Node* root : roots)
+            {
+                root->Destroy();
+            }
+            markMs += ElapsedMs(start);
+
+            start = Clock::now();
+            scene.FlushDestroyed();
+            flushMs += ElapsedMs(start);
+        }
+
+        std::printf("Unload %d nodes (%d roots x %d children), %d levels loaded and unloaded\n", numNodes, numRoots,
+                    childrenPerRoot + 1, levels);
+        std::printf("  mark, linear search    %9.3f ms\n", linearMs);
+        std::printf("  mark                   %9.3f ms\n", markMs / levels);
+        std::printf("  FlushDestroyed         %9.3f ms\n", flushMs / levels);
+        auto* components = scene.GetComponentManager();
+        std::printf("  nodes left %zu, components left %zu, highest NodeID %u\n", scene.GetNodes().size(),
+                    components->GetComponentsByClass<Health>().size() + components->GetComponentsByClass<Tag>().size(), highestID);
+    }
+}
+
+int main()
+{
+    BenchUnload(5000, 9, 4);
+    return 0;
+}
@@ -0,0 +1,387 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <future>
+#include <memory>
+#include <string>
+
+#include <glm/glm.hpp>
+#include <nlohmann/json.hpp>
+#include <rttr/registration>
+
+#include "Engine/SceneGraph/Component.hpp"
+#include "Engine/SceneGraph/ComponentPool.hpp"
+#include "Engine/SceneGraph/Components/Light.hpp"
+#include "Engine/SceneGraph/Components/Material.hpp"
+#include "Engine/SceneGraph/Components/Mesh.hpp"
+#include "Engine/SceneGraph/Components/SubMesh.hpp"
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+#include "Engine/SceneGraph/SceneSerializer.hpp"
+#include "Engine/SceneGraph/SpatialIndex.hpp"
+#include "Logging/Logger.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    struct Body : scene::Component
+    {
+        RTTR_ENABLE(scene::Component)
+    public:
+        glm::vec3 velocity = glm::vec3(0.0f);
+        float mass = 1.0f;
+        int32_t team = 0;
+        bool sleeping = false;
+    };
+}
+
+RTTR_REGISTRATION
+{
+    rttr::registration::class_<Body>("Body")
+        .property("velocity", &Body::velocity)
+        .property("mass", &Body::mass)
+        .property("team", &Body::team)
+        .property("sleeping", &Body::sleeping);
+}
+
+namespace
+{
+    /// numRoots trees of childrenPerRoot children, every child with a Body
+    void BuildLevel(scene::Scene& scene, int numRoots, int childrenPerRoot)
+    {
+        for (int i = 0; i < numRoots; i++)
+        {
+            auto root = std::make_unique<scene::Node>(&scene, "Root" + std::to_string(i));
+            root->GetTransform().SetTranslation(glm::vec3(static_cast<float>(i), 0.0f, 0.0f));
+            for (int j = 0; j < childrenPerRoot; j++)
+            {
+                scene::Node* child = root->CreateChild("Child" + std::to_string(j));
+                child->GetTransform().SetTranslation(glm::vec3(0.0f, static_cast<float>(j), 0.0f));
+                Body* body = scene.GetComponentManager()->AddComponent<Body>(child);
+                body->SetName("Body");
+                body->velocity = glm::vec3(0.0f, 0.0f, static_cast<float>(j));
+                body->mass = 1.0f + static_cast<float>(j);
+                body->team = i % 4;
+            }
+            scene.AddNode(std::move(root));
+        }
+    }
+
+    /// What loading from a text format costs, a JSON parse and a property looked up by name per value
+    std::unique_ptr<scene::Scene> LoadFromJson(const std::filesystem::path& path)
+    {
+        std::ifstream stream(path);
+        const nlohmann::json document = nlohmann::json::parse(stream);
+
+        auto scene = std::make_unique<scene::Scene>("Json");
+        std::vector<scene::Node*> nodes;
+        for (const auto& record : document["nodes"])
+        {
+            const std::string name = record["name"];
+            scene::Node* node;
+            if (record["parent"].is_null())
+            {
+                auto root = std::make_unique<scene::Node>(scene.get(), name);
+                node = root.get();
+                scene->AddNode(std::move(root));
+            }
+            else
+            {
+                node = nodes[record["parent"].get<size_t>()]->CreateChild(name);
+            }
+            const auto& t = record["translation"];
+            const auto& r = record["rotation"];
+            const auto& s = record["scale"];
+            node->GetTransform().SetTranslation(glm::vec3(t[0], t[1], t[2]));
+            node->GetTransform().SetRotation(glm::quat(r[3], r[0], r[1], r[2]));
+            node->GetTransform().SetScale(glm::vec3(s[0], s[1], s[2]));
+            nodes.push_back(node);
+        }
+
+        const rttr::type type = rttr::type::get_by_name("Body");
+        for (const auto& componentType : document["components"])
+        {
+            for (const auto& record : componentType["components"])
+            {
+                Body* body = scene->GetComponentManager()->AddComponent<Body>(nodes[record["node"].get<size_t>()]);
+                for (const auto& [name, value] : record.items())
+                {
+                    const rttr::property property = type.get_property(name);
+                    if (!property.is_valid())
+                    {
+                        continue;
+                    }
+                    const auto& data = value["value"];
+                    if (property.get_type() == rttr::type::get<glm::vec3>())
+                    {
+                        property.set_value(*body, glm::vec3(data[0], data[1], data[2]));
+                    }
+                    else if (property.get_type() == rttr::type::get<float>())
+                    {
+                        property.set_value(*body, data.get<float>());
+                    }
+                    else if (property.get_type() == rttr::type::get<int32_t>())
+                    {
+                        property.set_value(*body, data.get<int32_t>());
+                    }
+                    else if (property.get_type() == rttr::type::get<bool>())
+                    {
+                        property.set_value(*body, data.get<bool>());
+                    }
+                    else if (property.get_type() == rttr::type::get<std::string>())
+                    {
+                        property.set_value(*body, data.get<std::string>());
+                    }
+                }
+            }
+        }
+        return scene;
+    }
+
+    /// Returns false when a light or a submesh comes back different, the engine types register themselves
+    bool CheckEngineComponents()
+    {
+        const auto path = std::filesystem::temp_directory_path() / "SceneSerialization_Engine.scene";
+
+        scene::Scene source("Source");
+        auto node = std::make_unique<scene::Node>(&source, "Lamp");
+        scene::LightProperties properties;
+        properties.direction = glm::vec3(0.0f, -1.0f, 0.0f);
+        properties.color = glm::vec3(1.0f, 0.5f, 0.25f);
+        properties.intensity = 4.0f;
+        properties.range = 12.0f;
+        properties.inner_cone_angle = 0.2f;
+        properties.outer_cone_angle = 0.4f;
+        scene::Light* light = source.GetComponentManager()->AddComponent<scene::Light>(node.get());
+        light->SetName("Spot");
+        light->set_light_type(scene::LightType::Spot);
+        light->set_properties(properties);
+        scene::SubMesh* submesh = source.GetComponentManager()->AddComponent<scene::SubMesh>(node.get());
+        submesh->SetName("Shade");
+        submesh->ModelPath = "Models/Lamp.gltf";
+        scene::Node* lamp = node.get();
+        source.AddNode(std::move(node));
+        submesh->set_bounds(scene::AABB(glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(1.0f, 2.0f, 1.0f)));
+        const bool indexed = source.GetSpatialIndex().Find(lamp->GetID()) != scene::SpatialIndex::InvalidHandle;
+
+        scene::SceneSerializer::Save(source, path);
+        auto loaded = scene::SceneSerializer::Load(path, "Loaded");
+        std::filesystem::remove(path);
+
+        bool matches = indexed && loaded != nullptr;
+        if (matches)
+        {
+            auto& lights = loaded->GetComponentManager()->GetComponentsByClass<scene::Light>();
+            auto& submeshes = loaded->GetComponentManager()->GetComponentsByClass<scene::SubMesh>();
+            matches = lights.size() == 1 && submeshes.size() == 1;
+            if (matches)
+            {
+                scene::Light& loadedLight = lights[0];
+                const scene::LightProperties& loadedProperties = loadedLight.get_properties();
+                const scene::SubMesh& loadedSubmesh = submeshes[0];
+                matches = loadedLight.GetName() == "Spot" && loadedLight.get_light_type() == scene::LightType::Spot &&
+                          loadedProperties.direction == properties.direction &&
+                          loadedProperties.color == properties.color &&
+                          loadedProperties.intensity == properties.intensity &&
+                          loadedProperties.range == properties.range &&
+                          loadedProperties.inner_cone_angle == properties.inner_cone_angle &&
+                          loadedProperties.outer_cone_angle == properties.outer_cone_angle &&
+                          loadedLight.get_node() == loadedLight.GetOwner() &&
+                          loadedSubmesh.GetName() == "Shade" && loadedSubmesh.ModelPath == "Models/Lamp.gltf" &&
+                          loadedSubmesh.bounds.min == submesh->bounds.min &&
+                          loadedSubmesh.bounds.max == submesh->bounds.max &&
+                          loadedSubmesh.GetOwner() == loadedLight.GetOwner() &&
+                          loaded->GetSpatialIndex().Find(loadedSubmesh.GetOwner()->GetID()) !=
+                              scene::SpatialIndex::InvalidHandle;
+            }
+        }
+
+        std::printf("Engine components, light and submesh %s\n", matches ? "match" : "MISMATCH");
+        return matches;
+    }
+
+    /// Returns false when a mesh doesn't get its submeshes back, or they don't get the geometry and the materials
+    /// of the model once resolved
+    bool CheckMeshRoundTrip()
+    {
+        const auto path = std::filesystem::temp_directory_path() / "SceneSerialization_Mesh.scene";
+
+        // What an importer would keep for Models/Crate.gltf, the submeshes hold no scene
+        scene::MeshData meshData[3];
+        scene::Material wood("Wood");
+        scene::Material metal("Metal");
+        scene::Material painted("Painted");
+        scene::SubMesh imported[3];
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            meshData[i].bounds = scene::AABB(glm::vec3(-1.0f), glm::vec3(1.0f + static_cast<float>(i)));
+            imported[i].set_mesh_data(&meshData[i]);
+            imported[i].set_material(i == 0 ? wood : metal);
+        }
+
+        scene::Scene source("Source");
+        scene::ComponentManager& sourceManager = *source.GetComponentManager();
+        auto root = std::make_unique<scene::Node>(&source, "Crate");
+        scene::Mesh& mesh = *sourceManager.AddComponent<scene::Mesh>(root.get());
+        for (uint32_t i = 0; i < 3; i++)
+        {
+            scene::SubMesh* submesh = sourceManager.AddComponent<scene::SubMesh>(root->CreateChild("Part"));
+            submesh->ModelPath = "Models/Crate.gltf";
+            submesh->SubmeshIndex = i;
+            submesh->set_asset(imported[i]);
+            mesh.SetSubmesh(*submesh);
+        }
+        // Repainted after the import, the material isn't the one of the model
+        mesh.GetSubmesh(2)->set_material(painted);
+        source.AddNode(std::move(root));
+
+        scene::SceneSerializer::Save(source, path);
+        auto loaded = scene::SceneSerializer::Load(path, "Loaded");
+        std::filesystem::remove(path);
+        if (!loaded)
+        {
+            std::printf("Mesh and submeshes MISMATCH, the scene didn't load\n");
+            return false;
+        }
+
+        scene::SceneSerializer::AssetResolver resolver;
+        resolver.findSubMesh = [&imported](const std::string& modelPath, uint32_t submeshIndex) -> const scene::SubMesh*
+        {
+            return (modelPath == "Models/Crate.gltf" && submeshIndex < 3) ? &imported[submeshIndex] : nullptr;
+        };
+        resolver.findMaterial = [&painted](const std::string& name) -> const scene::Material*
+        {
+            return name == "Painted" ? &painted : nullptr;
+        };
+        const size_t missing = scene::SceneSerializer::ResolveSubMeshes(*loaded, resolver);
+
+        auto& meshes = loaded->GetComponentManager()->GetComponentsByClass<scene::Mesh>();
+        bool matches = missing == 0 && meshes.size() == 1 && meshes[0].GetSubmeshCount() == mesh.GetSubmeshCount();
+        for (size_t i = 0; matches && i < mesh.GetSubmeshCount(); i++)
+        {
+            const scene::SubMesh* saved = mesh.GetSubmesh(i);
+            const scene::SubMesh* submesh = meshes[0].GetSubmesh(i);
+            matches = submesh && submesh->SubmeshIndex == saved->SubmeshIndex &&
+                      submesh->get_material() == saved->get_material() && submesh->meshData == saved->meshData &&
+                      submesh->bHasMeshData && submesh->GetOwner()->GetParent() == meshes[0].GetOwner() &&
+                      loaded->GetSpatialIndex().Find(submesh->GetOwner()->GetID()) !=
+                          scene::SpatialIndex::InvalidHandle;
+        }
+
+        std::printf("Mesh with %zu submeshes, geometry and materials %s\n", mesh.GetSubmeshCount(),
+                    matches ? "match" : "MISMATCH");
+        return matches;
+    }
+
+    /// Returns false when a loaded scene differs from the saved one
+    bool BenchSerialization(int numRoots, int childrenPerRoot)
+    {
+        const auto directory = std::filesystem::temp_directory_path();
+        const auto binaryPath = directory / "SceneSerialization_Bench.scene";
+        const auto jsonPath = directory / "SceneSerialization_Bench.json";
+
+        scene::Scene source("Source");
+        BuildLevel(source, numRoots, childrenPerRoot);
+
+        auto start = Clock::now();
+        scene::SceneSerializer::Save(source, binaryPath);
+        const double saveMs = ElapsedMs(start);
+
+        start = Clock::now();
+        scene::SceneSerializer::ExportJson(binaryPath, jsonPath);
+        const double exportMs = ElapsedMs(start);
+
+        start = Clock::now();
+        auto loaded = scene::SceneSerializer::Load(binaryPath, "Binary");
+        const double loadMs = ElapsedMs(start);
+
+        start = Clock::now();
+        auto loadedJson = LoadFromJson(jsonPath);
+        const double jsonMs = ElapsedMs(start);
+
+        // The loaded scene has to match the saved one
+        if (!loaded)
+        {
+            std::printf("Scene serialization, loading %s failed MISMATCH\n", binaryPath.string().c_str());
+            return false;
+        }
+        auto& bodies = loaded->GetComponentManager()->GetComponentsByClass<Body>();
+        size_t mismatches = 0;
+        for (size_t i = 0; i < bodies.size(); i++)
+        {
+            const Body& body = bodies[i];
+            scene::Node* owner = body.GetOwner();
+            const int root = std::stoi(owner->GetParent()->GetName().substr(4));
+            const int child = std::stoi(owner->GetName().substr(5));
+            const bool matches = body.GetName() == "Body" && body.mass == 1.0f + static_cast<float>(child) &&
+                                 body.velocity.z == static_cast<float>(child) && body.team == root % 4 &&
+                                 owner->GetTransform().GetTranslation().y == static_cast<float>(child);
+            mismatches += matches ? 0 : 1;
+        }
+
+        // A frame of the active world keeps running while the next one streams in
+        scene::Scene active("Active");
+        BuildLevel(active, numRoots / 10, childrenPerRoot);
+        start = Clock::now();
+        auto pending = std::async(std::launch::async, [&binaryPath]()
+        {
+            return scene::SceneSerializer::Load(binaryPath, "Streamed");
+        });
+        int frames = 0;
+        double longestFrameMs = 0.0;
+        while (pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            const auto frameStart = Clock::now();
+            for (const auto& node : active.GetNodes())
+            {
+                node->GetTransform().SetTranslation(node->GetTransform().GetTranslation() + glm::vec3(0.001f));
+            }
+            active.Update(0.016f);
+            longestFrameMs = std::max(longestFrameMs, ElapsedMs(frameStart));
+            frames++;
+        }
+        const double streamMs = ElapsedMs(start);
+        auto streamed = pending.get();
+
+        std::printf("Scene serialization, %d nodes, %zu components\n", numRoots * (childrenPerRoot + 1), bodies.size());
+        std::printf("  file size binary %8.1f KB, json %8.1f KB\n", std::filesystem::file_size(binaryPath) / 1024.0,
+                    std::filesystem::file_size(jsonPath) / 1024.0);
+        std::printf("  save binary            %9.3f ms\n", saveMs);
+        std::printf("  export json            %9.3f ms\n", exportMs);
+        std::printf("  load json, by name     %9.3f ms\n", jsonMs);
+        std::printf("  load binary, mapped    %9.3f ms %6.2fx\n", loadMs, jsonMs / loadMs);
+        std::printf("  mismatches %zu, json scene nodes %zu\n", mismatches, loadedJson->GetNodes().size());
+        std::printf("  streamed in %.3f ms while %d frames ticked, longest frame %.3f ms, %zu roots\n", streamMs, frames,
+                    longestFrameMs, streamed ? streamed->GetNodes().size() : 0);
+
+        const size_t sourceBodies = source.GetComponentManager()->GetComponentsByClass<Body>().size();
+        const bool matches = mismatches == 0 && bodies.size() == sourceBodies &&
+                             loadedJson->GetNodes().size() == source.GetNodes().size() && streamed &&
+                             streamed->GetNodes().size() == source.GetNodes().size();
+        if (!matches)
+        {
+            std::printf("  MISMATCH\n");
+        }
+
+        std::filesystem::remove(binaryPath);
+        std::filesystem::remove(jsonPath);
+        return matches;
+    }
+}
+
+int main()
+{
+    Logger::Init("SceneSerialization_Bench");
+    scene::SceneSerializer::RegisterComponent<Body>();
+    const bool engineMatches = CheckEngineComponents();
+    const bool meshMatches = CheckMeshRoundTrip();
+    return BenchSerialization(5000, 19) && engineMatches && meshMatches ? 0 : 1;
+}
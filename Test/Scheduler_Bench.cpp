@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "Async/WorkStealingThreadPool.hpp"
+#include "Engine/SceneGraph/SystemScheduler.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps results alive so the optimizer can't drop the benchmarked work
+    volatile float g_sink = 0.0f;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    // Component types the systems declare, the systems don't touch any data
+    struct Position {};
+    struct Velocity {};
+    struct Health {};
+    struct AIState {};
+    struct Animation {};
+    struct Audio {};
+    struct Particle {};
+
+    /// Keeps the thread busy for about the given number of sin() calls
+    void Work(int amount)
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < amount; i++)
+        {
+            sum += std::sin(static_cast<float>(i) * 0.001f);
+        }
+        g_sink = g_sink + sum;
+    }
+
+    /// A frame of a small game, physics feeds movement, everything else only shares reads
+    void AddSystems(scene::SystemScheduler& scheduler, int unit)
+    {
+        scheduler.AddSystem("Physics", [unit](float) { Work(unit * 4); }).Reads<Velocity>().Writes<Position>();
+        scheduler.AddSystem("AI", [unit](float) { Work(unit * 3); }).Reads<Position>().Writes<AIState, Velocity>();
+        scheduler.AddSystem("Damage", [unit](float) { Work(unit * 2); }).Reads<Position>().Writes<Health>();
+        scheduler.AddSystem("Animation", [unit](float) { Work(unit * 3); }).Reads<AIState>().Writes<Animation>();
+        scheduler.AddSystem("Audio", [unit](float) { Work(unit * 1); }).Reads<Position, Health>().Writes<Audio>();
+        scheduler.AddSystem("Particles", [unit](float) { Work(unit * 4); }).Writes<Particle>();
+        scheduler.AddSystem("Movement", [unit](float) { Work(unit * 2); }).Reads<Velocity>().Writes<Position>();
+    }
+
+    double RunFrames(scene::SystemScheduler& scheduler, WorkStealingThreadPool* threadPool, int frames)
+    {
+        scheduler.Run(0.016f, threadPool);
+
+        const auto start = Clock::now();
+        for (int i = 0; i < frames; i++)
+        {
+            scheduler.Run(0.016f, threadPool);
+        }
+        return ElapsedMs(start) / frames;
+    }
+
+    void PrintTimings(const scene::SystemScheduler& scheduler)
+    {
+        for (const auto& timing : scheduler.GetTimings())
+        {
+            std::printf("    %-10s start %7.3f ms  took %7.3f ms %s\n", timing.system->GetName().c_str(), timing.startMs,
+                        timing.durationMs, timing.onCriticalPath ? "  critical path" : "");
+        }
+        std::printf("    frame %.3f ms, critical path %.3f ms\n", scheduler.GetFrameMs(), scheduler.GetCriticalPathMs());
+    }
+
+    void BenchScheduler(int unit, int frames)
+    {
+        scene::SystemScheduler scheduler;
+        AddSystems(scheduler, unit);
+
+        const double serialMs = RunFrames(scheduler, nullptr, frames);
+        std::printf("Scheduler, 7 systems, %d sin() per unit of work\n", unit);
+        std::printf("  serial             %7.3f ms\n", serialMs);
+        PrintTimings(scheduler);
+
+        const int maxThreads = std::max(4, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int threads = 2; threads <= maxThreads; threads *= 2)
+        {
+            // The calling thread helps, so it counts as one of the threads
+            WorkStealingThreadPool threadPool(threads - 1);
+            const double parallelMs = RunFrames(scheduler, &threadPool, frames);
+            std::printf("  %2d threads         %7.3f ms %5.2fx\n", threads, parallelMs, serialMs / parallelMs);
+            if (threads * 2 > maxThreads)
+            {
+                PrintTimings(scheduler);
+            }
+        }
+    }
+
+    /// Cost of scheduling itself, systems that do nothing
+    void BenchOverhead(int frames)
+    {
+        scene::SystemScheduler scheduler;
+        AddSystems(scheduler, 0);
+
+        WorkStealingThreadPool threadPool(std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1));
+        const double serialMs = RunFrames(scheduler, nullptr, frames);
+        const double parallelMs = RunFrames(scheduler, &threadPool, frames);
+        std::printf("Scheduler overhead per frame, empty systems: serial %.4f ms, thread pool %.4f ms\n", serialMs, parallelMs);
+    }
+
+    /// A throwing system must not take down a worker, its dependents still run and Run rethrows
+    bool CheckThrowingSystem()
+    {
+        scene::SystemScheduler scheduler;
+        bool dependentRan = false;
+        scheduler.AddSystem("Throws", [](float) { throw std::runtime_error("system failed"); }).Writes<Position>();
+        scheduler.AddSystem("Dependent", [&dependentRan](float) { dependentRan = true; }).Reads<Position>();
+
+        WorkStealingThreadPool threadPool(2);
+        for (WorkStealingThreadPool* pool : {static_cast<WorkStealingThreadPool*>(nullptr), &threadPool})
+        {
+            dependentRan = false;
+            bool caught = false;
+            try
+            {
+                scheduler.Run(0.016f, pool);
+            }
+            catch (const std::runtime_error&)
+            {
+                caught = true;
+            }
+            if (!caught || !dependentRan)
+            {
+                std::printf("Scheduler, throwing system on %s: caught %d, dependent ran %d, MISMATCH\n",
+                            pool ? "thread pool" : "calling thread", caught, dependentRan);
+                return false;
+            }
+        }
+        std::printf("Scheduler, throwing system: rethrown from Run, dependent still ran\n");
+        return true;
+    }
+}
+
+int main()
+{
+    const bool ok = CheckThrowingSystem();
+    BenchScheduler(20000, 100);
+    BenchOverhead(10000);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Engine/SceneGraph/Node.hpp"
+#include "Engine/SceneGraph/Scene.hpp"
+#include "Engine/SceneGraph/SpatialIndex.hpp"
+#include "Engine/SceneGraph/TransformSystem.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    const scene::AABB UnitBounds(glm::vec3(-0.5f), glm::vec3(0.5f));
+
+    /// How queries worked before the index, every node's bounds moved to the world and tested
+    template <typename Test>
+    size_t WalkAllNodes(scene::Scene& scene, Test&& test)
+    {
+        size_t hits = 0;
+        for (const auto& node : scene.GetNodes())
+        {
+            hits += test(UnitBounds.Transformed(node->GetTransform().GetWorldMatrix())) ? 1 : 0;
+        }
+        return hits;
+    }
+
+    template <typename Func>
+    double TimeQueries(int queries, Func&& func)
+    {
+        const auto start = Clock::now();
+        for (int i = 0; i < queries; i++)
+        {
+            func(i);
+        }
+        return ElapsedMs(start) / queries;
+    }
+
+    /// count unit boxes at the same density for every size, queries of the same size so the number of
+    /// hits stays about the same while the scene grows. Returns false when a query misses a hit of the walk
+    bool BenchSpatialIndex(int count, int queries)
+    {
+        std::mt19937 random(1234);
+        const float worldSize = 4.0f * std::cbrt(static_cast<float>(count));
+        std::uniform_real_distribution<float> position(-worldSize * 0.5f, worldSize * 0.5f);
+
+        scene::Scene scene("SpatialIndex");
+        std::vector<scene::Node*> nodes;
+        for (int i = 0; i < count; i++)
+        {
+            auto node = std::make_unique<scene::Node>(&scene, "Box");
+            node->GetTransform().SetTranslation(glm::vec3(position(random), position(random), position(random)));
+            nodes.push_back(node.get());
+            scene.AddNode(std::move(node));
+        }
+        scene.GetTransformSystem().UpdateWorldMatrices();
+
+        scene::SpatialIndex& index = scene.GetSpatialIndex();
+        auto start = Clock::now();
+        for (scene::Node* node : nodes)
+        {
+            index.SetBounds(*node, UnitBounds);
+        }
+        const double buildMs = ElapsedMs(start);
+
+        // 1% of the boxes move a bit every frame, some of them leave their leaf
+        const int frames = 10;
+        double updateMs = 0.0;
+        std::uniform_real_distribution<float> step(-0.2f, 0.2f);
+        for (int frame = 0; frame < frames; frame++)
+        {
+            for (int i = 0; i < count / 100; i++)
+            {
+                scene::Transform& transform = nodes[random() % count]->GetTransform();
+                transform.SetTranslation(transform.GetTranslation() + glm::vec3(step(random), step(random), step(random)));
+            }
+            scene.GetTransformSystem().UpdateWorldMatrices();
+
+            start = Clock::now();
+            index.Update(scene.GetTransformSystem());
+            updateMs += ElapsedMs(start);
+        }
+
+        // A single box moves, the update costs what moved and not what is in the index
+        double oneMovedMs = 0.0;
+        for (int frame = 0; frame < frames; frame++)
+        {
+            scene::Transform& transform = nodes[random() % count]->GetTransform();
+            transform.SetTranslation(transform.GetTranslation() + glm::vec3(step(random), step(random), step(random)));
+            scene.GetTransformSystem().UpdateWorldMatrices();
+
+            start = Clock::now();
+            index.Update(scene.GetTransformSystem());
+            oneMovedMs += ElapsedMs(start);
+        }
+
+        // A camera with a 60 degree view 40 units deep, a sphere of 10 and rays 100 long
+        std::vector<glm::vec3> origins;
+        std::vector<glm::vec3> directions;
+        for (int i = 0; i < queries; i++)
+        {
+            origins.emplace_back(position(random), position(random), position(random));
+            directions.push_back(glm::normalize(glm::vec3(position(random), position(random), position(random))));
+        }
+        const auto frustumOf = [&](int i)
+        {
+            const glm::mat4 view = glm::lookAt(origins[i], origins[i] + directions[i], glm::vec3(0.0f, 1.0f, 0.0f));
+            return scene::Frustum(glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 40.0f) * view);
+        };
+
+        std::vector<scene::SpatialIndex::Handle> results;
+        size_t frustumHits = 0;
+        size_t sphereHits = 0;
+        size_t rayHits = 0;
+        size_t walkedFrustumHits = 0;
+        size_t walkedSphereHits = 0;
+
+        const double frustumMs = TimeQueries(queries, [&](int i)
+        {
+            results.clear();
+            index.QueryFrustum(frustumOf(i), results);
+            frustumHits += results.size();
+        });
+        const double sphereMs = TimeQueries(queries, [&](int i)
+        {
+            results.clear();
+            index.QuerySphere(origins[i], 10.0f, results);
+            sphereHits += results.size();
+        });
+        const double rayMs = TimeQueries(queries, [&](int i)
+        {
+            results.clear();
+            index.QueryRay({origins[i], directions[i]}, 100.0f, results);
+            rayHits += results.size();
+        });
+
+        // Walking every node is slow at the large sizes, a few queries are enough
+        const int walkQueries = std::max(1, std::min(queries, 2000000 / count));
+        size_t frustumCheck = 0;
+        size_t sphereCheck = 0;
+        const double walkFrustumMs = TimeQueries(walkQueries, [&](int i)
+        {
+            const scene::Frustum frustum = frustumOf(i);
+            walkedFrustumHits += WalkAllNodes(scene, [&frustum](const scene::AABB& bounds) { return frustum.Overlaps(bounds); });
+        });
+        const double walkSphereMs = TimeQueries(walkQueries, [&](int i)
+        {
+            walkedSphereHits += WalkAllNodes(scene, [&](const scene::AABB& bounds) { return bounds.Overlaps(origins[i], 10.0f); });
+        });
+        for (int i = 0; i < walkQueries; i++)
+        {
+            results.clear();
+            index.QueryFrustum(frustumOf(i), results);
+            frustumCheck += results.size();
+            results.clear();
+            index.QuerySphere(origins[i], 10.0f, results);
+            sphereCheck += results.size();
+        }
+
+        std::printf("%8d objects, height %2d  build %8.2f ms  update %7.3f ms/frame, one moved %7.4f ms/frame\n", count,
+                    index.GetHeight(), buildMs, updateMs / frames, oneMovedMs / frames);
+        std::printf("  frustum %8.4f ms (%6.1f hits), walking all nodes %9.3f ms %8.1fx %s\n", frustumMs,
+                    static_cast<double>(frustumHits) / queries, walkFrustumMs, walkFrustumMs / frustumMs,
+                    frustumCheck == walkedFrustumHits ? "" : "MISMATCH");
+        std::printf("  sphere  %8.4f ms (%6.1f hits), walking all nodes %9.3f ms %8.1fx %s\n", sphereMs,
+                    static_cast<double>(sphereHits) / queries, walkSphereMs, walkSphereMs / sphereMs,
+                    sphereCheck == walkedSphereHits ? "" : "MISMATCH");
+        std::printf("  ray     %8.4f ms (%6.1f hits)\n", rayMs, static_cast<double>(rayHits) / queries);
+        return frustumCheck == walkedFrustumHits && sphereCheck == walkedSphereHits;
+    }
+}
+
+int main()
+{
+    bool matches = true;
+    for (int count = 1000; count <= 1000000; count *= 10)
+    {
+        matches = BenchSpatialIndex(count, 1000) && matches;
+    }
+    return matches ? 0 : 1;
+}
@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "Async/WorkStealingThreadPool.hpp"
+#include "Engine/SceneGraph/TransformSystem.hpp"
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keeps results alive so the optimizer can't drop the benchmarked work
+    volatile float g_sink = 0.0f;
+
+    double ElapsedMs(Clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    }
+
+    float RandomRange(float min, float max)
+    {
+        return min + (max - min) * (static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX));
+    }
+
+    /// The recursive path of scene::Transform before the TransformSystem, on nodes owned through unique_ptr
+    /// like scene::Node. Only the changed node is invalidated unless invalidateChildren is set.
+    struct RecursiveNode
+    {
+        RecursiveNode* parent = nullptr;
+        std::vector<std::unique_ptr<RecursiveNode>> children;
+
+        glm::vec3 translation = glm::vec3(0.0f);
+        glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+        glm::mat4 worldMatrix = glm::mat4(1.0f);
+        bool updateWorldMatrix = false;
+
+        void Invalidate(bool invalidateChildren)
+        {
+            updateWorldMatrix = true;
+            if (invalidateChildren)
+            {
+                for (auto& child : children)
+                {
+                    child->Invalidate(true);
+                }
+            }
+        }
+
+        glm::mat4 GetMatrix() const
+        {
+            return glm::translate(glm::mat4(1.0f), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0f), scale);
+        }
+
+        glm::mat4 GetWorldMatrix()
+        {
+            if (updateWorldMatrix)
+            {
+                worldMatrix = GetMatrix();
+                if (parent)
+                {
+                    worldMatrix = parent->GetWorldMatrix() * worldMatrix;
+                }
+                updateWorldMatrix = false;
+            }
+            return worldMatrix;
+        }
+    };
+
+    struct LocalTransform
+    {
+        glm::vec3 translation;
+        glm::quat rotation;
+        glm::vec3 scale;
+    };
+
+    /// Random local transforms for a forest of numRoots trees, parents[i] < i, -1 for roots
+    void BuildForest(int numRoots, int fanOut, int depth, std::vector<int>& parents, std::vector<LocalTransform>& locals)
+    {
+        std::srand(2468);
+        parents.clear();
+        for (int root = 0; root < numRoots; root++)
+        {
+            int levelBegin = static_cast<int>(parents.size());
+            parents.push_back(-1);
+            for (int level = 1; level < depth; level++)
+            {
+                const int levelEnd = static_cast<int>(parents.size());
+                for (int parent = levelBegin; parent < levelEnd; parent++)
+                {
+                    for (int i = 0; i < fanOut; i++)
+                    {
+                        parents.push_back(parent);
+                    }
+                }
+                levelBegin = levelEnd;
+            }
+        }
+
+        locals.resize(parents.size());
+        for (auto& local : locals)
+        {
+            local.translation = glm::vec3(RandomRange(-2, 2), RandomRange(-2, 2), RandomRange(-2, 2));
+            local.rotation = glm::angleAxis(RandomRange(-1, 1), glm::normalize(glm::vec3(RandomRange(0.1f, 1), RandomRange(0.1f, 1), RandomRange(0.1f, 1))));
+            local.scale = glm::vec3(RandomRange(0.9f, 1.1f));
+        }
+    }
+
+    /// The nodes changed in every frame, the same for every path
+    std::vector<std::vector<int>> BuildEdits(int numNodes, float movedFraction, int frames)
+    {
+        std::srand(1357);
+        const int moved = std::max(1, static_cast<int>(static_cast<float>(numNodes) * movedFraction));
+        std::vector<std::vector<int>> edits(frames);
+        for (auto& frame : edits)
+        {
+            frame.resize(moved);
+            for (int& node : frame)
+            {
+                node = std::rand() % numNodes;
+            }
+        }
+        return edits;
+    }
+
+    glm::vec3 EditedTranslation(int frame, int node)
+    {
+        return glm::vec3(std::sin(static_cast<float>(frame + node)), std::cos(static_cast<float>(frame)), 0.5f);
+    }
+
+    int CountDifferent(const std::vector<glm::mat4>& a, const std::vector<glm::mat4>& b)
+    {
+        int different = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            float error = 0.0f;
+            for (int c = 0; c < 4; c++)
+            {
+                const glm::vec4 d = glm::abs(a[i][c] - b[i][c]);
+                error = std::max(error, std::max(std::max(d.x, d.y), std::max(d.z, d.w)));
+            }
+            different += (error > 1e-3f) ? 1 : 0;
+        }
+        return different;
+    }
+
+    /// Changes the edited nodes, then reads every world matrix like the renderer does
+    double RunRecursive(const std::vector<int>& parents, const std::vector<LocalTransform>& locals,
+                        const std::vector<std::vector<int>>& edits, bool invalidateChildren, std::vector<glm::mat4>& result)
+    {
+        const int num = static_cast<int>(parents.size());
+        std::vector<std::unique_ptr<RecursiveNode>> roots;
+        std::vector<RecursiveNode*> nodes(num);
+        for (int i = 0; i < num; i++)
+        {
+            auto node = std::make_unique<RecursiveNode>();
+            nodes[i] = node.get();
+            node->translation = locals[i].translation;
+            node->rotation = locals[i].rotation;
+            node->scale = locals[i].scale;
+            node->updateWorldMatrix = true;
+            if (parents[i] < 0)
+            {
+                roots.push_back(std::move(node));
+            }
+            else
+            {
+                node->parent = nodes[parents[i]];
+                nodes[parents[i]]->children.push_back(std::move(node));
+            }
+        }
+
+        const auto start = Clock::now();
+        for (size_t frame = 0; frame < edits.size(); frame++)
+        {
+            for (int i : edits[frame])
+            {
+                nodes[i]->translation = EditedTranslation(static_cast<int>(frame), i);
+                nodes[i]->Invalidate(invalidateChildren);
+            }
+
+            float sum = 0.0f;
+            for (RecursiveNode* node : nodes)
+            {
+                sum += node->GetWorldMatrix()[3][0];
+            }
+            g_sink = g_sink + sum;
+        }
+        const double ms = ElapsedMs(start) / static_cast<double>(edits.size());
+
+        result.resize(num);
+        for (int i = 0; i < num; i++)
+        {
+            result[i] = nodes[i]->GetWorldMatrix();
+        }
+        return ms;
+    }
+
+    double RunSystem(const std::vector<int>& parents, const std::vector<LocalTransform>& locals,
+                     const std::vector<std::vector<int>>& edits, int threads, std::vector<glm::mat4>& result)
+    {
+        const int num = static_cast<int>(parents.size());
+        scene::TransformSystem system;
+        std::vector<scene::TransformSystem::Handle> handles(num);
+        for (int i = 0; i < num; i++)
+        {
+            handles[i] = system.Create();
+            if (parents[i] >= 0)
+            {
+                system.SetParent(handles[i], handles[parents[i]]);
+            }
+            system.SetLocal(handles[i], locals[i].translation, locals[i].rotation, locals[i].scale);
+        }
+
+        // The calling thread helps with the tasks
+        std::unique_ptr<WorkStealingThreadPool> pool;
+        if (threads > 1)
+        {
+            pool = std::make_unique<WorkStealingThreadPool>(threads - 1);
+        }
+
+        const auto start = Clock::now();
+        for (size_t frame = 0; frame < edits.size(); frame++)
+        {
+            for (int i : edits[frame])
+            {
+                system.SetLocal(handles[i], EditedTranslation(static_cast<int>(frame), i), locals[i].rotation, locals[i].scale);
+            }
+
+            system.UpdateWorldMatrices(pool.get());
+
+            float sum = 0.0f;
+            for (scene::TransformSystem::Handle handle : handles)
+            {
+                sum += system.GetWorldMatrix(handle)[3][0];
+            }
+            g_sink = g_sink + sum;
+        }
+        const double ms = ElapsedMs(start) / static_cast<double>(edits.size());
+
+        result.resize(num);
+        for (int i = 0; i < num; i++)
+        {
+            result[i] = system.GetWorldMatrix(handles[i]);
+        }
+        return ms;
+    }
+
+    /// Reads every world matrix after the edits and before the update, like an editor panel between the scene
+    /// update and the renderer. Only the edited subtrees should cost more than a lookup.
+    bool BenchReadsBeforeUpdate(int numRoots, int fanOut, int depth, int frames)
+    {
+        std::vector<int> parents;
+        std::vector<LocalTransform> locals;
+        BuildForest(numRoots, fanOut, depth, parents, locals);
+        const auto edits = BuildEdits(static_cast<int>(parents.size()), 0.0f, frames);
+
+        const int num = static_cast<int>(parents.size());
+        scene::TransformSystem system;
+        std::vector<scene::TransformSystem::Handle> handles(num);
+        for (int i = 0; i < num; i++)
+        {
+            handles[i] = system.Create();
+            if (parents[i] >= 0)
+            {
+                system.SetParent(handles[i], handles[parents[i]]);
+            }
+            system.SetLocal(handles[i], locals[i].translation, locals[i].rotation, locals[i].scale);
+        }
+        system.UpdateWorldMatrices();
+
+        std::vector<glm::mat4> before(num);
+        std::vector<glm::mat4> after(num);
+        int stale = 0;
+        double readMs = 0.0;
+        double cleanMs = 0.0;
+        for (size_t frame = 0; frame < edits.size(); frame++)
+        {
+            for (int i : edits[frame])
+            {
+                system.SetLocal(handles[i], EditedTranslation(static_cast<int>(frame), i), locals[i].rotation, locals[i].scale);
+            }
+
+            auto start = Clock::now();
+            for (int i = 0; i < num; i++)
+            {
+                before[i] = system.GetWorldMatrix(handles[i]);
+            }
+            readMs += ElapsedMs(start);
+
+            system.UpdateWorldMatrices();
+
+            start = Clock::now();
+            for (int i = 0; i < num; i++)
+            {
+                after[i] = system.GetWorldMatrix(handles[i]);
+            }
+            cleanMs += ElapsedMs(start);
+            stale += CountDifferent(before, after);
+        }
+
+        readMs /= static_cast<double>(edits.size());
+        cleanMs /= static_cast<double>(edits.size());
+        std::printf("Reads of %6d nodes with one edit pending %7.3f ms, after the update %7.3f ms, %d stale%s\n", num,
+                    readMs, cleanMs, stale, stale == 0 ? "" : " MISMATCH");
+        return stale == 0;
+    }
+
+    /// Returns false when the TransformSystem, threaded or not, disagrees with updating every child
+    bool BenchTransforms(int numRoots, int fanOut, int depth, float movedFraction, int frames)
+    {
+        std::vector<int> parents;
+        std::vector<LocalTransform> locals;
+        BuildForest(numRoots, fanOut, depth, parents, locals);
+        const auto edits = BuildEdits(static_cast<int>(parents.size()), movedFraction, frames);
+
+        std::vector<glm::mat4> reference;
+        std::vector<glm::mat4> result;
+        const double systemMs = RunSystem(parents, locals, edits, 1, reference);
+        const double selfMs = RunRecursive(parents, locals, edits, false, result);
+        const int selfStale = CountDifferent(reference, result);
+        const double subtreeMs = RunRecursive(parents, locals, edits, true, result);
+        const int subtreeStale = CountDifferent(reference, result);
+
+        std::printf("Transforms %6zu nodes %5.1f%% moved | recursive %7.3f ms %6d stale | recursive + children %7.3f ms %6d stale | TransformSystem %7.3f ms %5.2fx",
+                    parents.size(), movedFraction * 100.0f, selfMs, selfStale, subtreeMs, subtreeStale, systemMs, subtreeMs / systemMs);
+
+        int threadedStale = 0;
+        const int hardwareThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        if (hardwareThreads > 1)
+        {
+            const double threadedMs = RunSystem(parents, locals, edits, hardwareThreads, result);
+            threadedStale = CountDifferent(reference, result);
+            std::printf(" | %2d threads %7.3f ms %5.2fx %d stale", hardwareThreads, threadedMs, subtreeMs / threadedMs, threadedStale);
+        }
+        std::printf("%s\n", subtreeStale == 0 && threadedStale == 0 ? "" : " MISMATCH");
+        return subtreeStale == 0 && threadedStale == 0;
+    }
+}
+
+int main()
+{
+    // 400 trees of 121 nodes, five levels deep
+    bool matches = BenchTransforms(400, 3, 5, 0.001f, 120);
+    matches = BenchTransforms(400, 3, 5, 0.01f, 120) && matches;
+    matches = BenchTransforms(400, 3, 5, 0.1f, 120) && matches;
+    matches = BenchTransforms(400, 3, 5, 1.0f, 60) && matches;
+    matches = BenchReadsBeforeUpdate(400, 3, 5, 120) && matches;
+    return matches ? 0 : 1;
+}